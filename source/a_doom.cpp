@@ -448,6 +448,7 @@ void A_SkelMissile(actionargs_t *actionargs)
    mo->x += mo->momx;
    mo->y += mo->momy;
    mo->backupPosition();
+   P_SyncBlockThing(mo);
    P_SetTarget<Mobj>(&mo->tracer, actor->target);  // killough 11/98
 }
 
@@ -839,6 +840,7 @@ void A_VileAttack(actionargs_t *actionargs)
                                         -FixedMul(24 * FRACUNIT, finesine[an]));
    fire->x = pos.x;
    fire->y = pos.y;
+   P_SyncBlockThing(fire);
    
    // ioanch: set the correct group ID now
    if(full_demo_version >= make_full_version(340, 48))
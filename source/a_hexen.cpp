@@ -778,6 +778,7 @@ void A_WraithFX3(Mobj *actor)
       mo->x += (P_Random(pr_wraithfx3) - 128) << 11;
       mo->y += (P_Random(pr_wraithfx3) - 128) << 11;
       mo->z += (P_Random(pr_wraithfx3) << 10);
+      P_SyncBlockThing(mo);
       P_SetTarget<Mobj>(&mo->target, actor);
    }
 }
@@ -818,6 +819,7 @@ void A_WraithFX4(Mobj *actor)
       mo->x += (P_Random(pr_wraithfx4b) - 128) << 12;
       mo->y += (P_Random(pr_wraithfx4b) - 128) << 12;
       mo->z += (P_Random(pr_wraithfx4b) << 10);
+      P_SyncBlockThing(mo);
       P_SetTarget(&mo->target, actor);
    }
    if(spawnflags & WFX4_SPAWN_TYPE2)
@@ -826,6 +828,7 @@ void A_WraithFX4(Mobj *actor)
       mo->x += (P_Random(pr_wraithfx4c) - 128) << 11;
       mo->y += (P_Random(pr_wraithfx4c) - 128) << 11;
       mo->z += (P_Random(pr_wraithfx4c) << 10);
+      P_SyncBlockThing(mo);
       P_SetTarget<Mobj>(&mo->target, actor);
    }
 }
@@ -53,6 +53,7 @@
 #include "p_maputl.h"
 #include "p_portal.h"   // ioanch 20160116
 #include "p_spec.h"
+#include "p_tickpar.h"
 #include "p_xenemy.h"
 #include "r_data.h"
 #include "r_main.h"
@@ -977,6 +978,8 @@ static void ACS_setLineBlocking(int tag, int block)
    line_t *l;
    int linenum = -1;
 
+   P_SightGeometryChanged();
+
    while((l = P_FindLine(tag, &linenum)) != NULL)
    {
       switch(block)
@@ -1330,8 +1333,8 @@ void ACS_SetThingVar(Mobj *thing, uint32_t var, int32_t val)
    case ACS_THINGVAR_SigilPieces:    break;
    case ACS_THINGVAR_TID:            P_RemoveThingTID(thing); P_AddThingTID(thing, val); break;
    case ACS_THINGVAR_Type:           break;
-   case ACS_THINGVAR_X:              thing->x = val; break;
-   case ACS_THINGVAR_Y:              thing->y = val; break;
+   case ACS_THINGVAR_X:              thing->x = val; P_SyncBlockThing(thing); break;
+   case ACS_THINGVAR_Y:              thing->y = val; P_SyncBlockThing(thing); break;
    case ACS_THINGVAR_Z:              thing->z = val; break;
    }
 }
@@ -1213,8 +1213,23 @@ static bool AM_clipMline(mline_t *ml, fline_t *fl)
 }
 #undef DOOUTCODE
 
+//
+// AM_putDot
+//
+// Plots a single solid pixel in either screen bitdepth.
+//
+inline static void AM_putDot(int x, int y, int color)
+{
+   byte *dest = VBADDRESS(&vbscreen, x, y);
+
+   if(vbscreen.pixelsize == 4)
+      *(uint32_t *)dest = Col2RGB32[color];
+   else
+      *dest = (byte)color;
+}
+
 // haleyjd 06/12/09: this macro is now shared by Bresenham and Wu
-#define PUTDOT(xx,yy,cc) *(VBADDRESS(&vbscreen, xx, yy)) = (cc)
+#define PUTDOT(xx,yy,cc) AM_putDot(xx, yy, cc)
 
 //
 // AM_drawFline()
@@ -1305,6 +1320,13 @@ static void AM_putWuDot(int x, int y, int color, int weight)
    unsigned int *bg2rgb = Col2RGB8[64 - weight];
    unsigned int fg, bg;
 
+   if(vbscreen.pixelsize == 4)
+   {
+      uint32_t *dest32 = (uint32_t *)dest;
+      *dest32 = V_BlendRGB32(Col2RGB32[color], *dest32, weight * 4);
+      return;
+   }
+
    fg = fg2rgb[color];
    bg = bg2rgb[*dest];
    fg = (fg + bg) | 0x1f07c1f;
@@ -2273,8 +2295,7 @@ static void AM_drawMarks()
 //
 inline static void AM_drawCrosshair(int color)
 {
-   vbscreen.data[(vbscreen.pitch * ((f_h + 1) >> 1)) + (vbscreen.width >> 1)] =
-      color; // single point for now
+   PUTDOT(vbscreen.width >> 1, (f_h + 1) >> 1, color); // single point for now
 }
 
 //
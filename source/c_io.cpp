@@ -459,17 +459,20 @@ void C_Drawer(void)
    int real_height;
    static int oldscreenheight = 0;
    static int oldscreenwidth = 0;
+   static int oldscreendepth = 0;
 
    if(!consoleactive) 
       return;   // dont draw if not active
 
    // Check for change in screen res
    // SoM: Check width too.
-   if(oldscreenheight != video.height || oldscreenwidth != video.width)
+   if(oldscreenheight != video.height || oldscreenwidth != video.width ||
+      oldscreendepth != video.bitdepth)
    {
       C_initBackdrop();       // re-init to the new screen size
       oldscreenheight = video.height;
       oldscreenwidth = video.width;
+      oldscreendepth = video.bitdepth;
    }
 
    // fullscreen console for fullscreen mode
@@ -1040,8 +1043,12 @@ static void Egg()
       for(y = 0; y < video.height; ++y)
       {
          byte *s = egg + ((y % 44 * 42) + (x % 42));
-         if(*s)
-            cback.data[y * video.width + x] = *s;
+         if(!*s)
+            continue;
+         if(cback.pixelsize == 4)
+            *(uint32_t *)VBADDRESS(&cback, x, y) = Col2RGB32[*s];
+         else
+            *VBADDRESS(&cback, x, y) = *s;
       }
    }
 
@@ -92,6 +92,9 @@
 
 #define RECURSION_LIMIT 64
 
+// levels of portal recursion a camsightscratch_t can hold
+#define CAMSCRATCHLEVELS 2
+
 //=============================================================================
 //
 // Structures
@@ -204,6 +207,82 @@ void camsightparams_t::setTargetMobj(const Mobj *mo)
    tgroupid = mo->groupid;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Sight Scratch
+//
+// Sight checks made away from the main thread can't allocate from the zone
+// heap, so they take their line sets and intercepts from storage made ahead
+// of time. Each path traversal that is running at once needs its own.
+//
+
+struct camscratchlevel_t
+{
+   byte        *validlines;
+   byte        *validpolys;
+   intercept_t *intercepts;    // one per line; lines are only added once
+   size_t       numintercepts;
+};
+
+struct camsightscratch_t
+{
+   camscratchlevel_t levels[CAMSCRATCHLEVELS];
+   int  numlines;       // map size the storage was made for
+   int  numpolys;
+   bool failed;         // recursed too deep, so the result can't be trusted
+};
+
+//
+// CAM_NewSightScratch
+//
+// Must be called from the main thread.
+//
+camsightscratch_t *CAM_NewSightScratch()
+{
+   camsightscratch_t *scratch = estructalloc(camsightscratch_t, 1);
+
+   scratch->numlines = ::numlines;
+   scratch->numpolys = ::numPolyObjects;
+
+   for(int i = 0; i < CAMSCRATCHLEVELS; i++)
+   {
+      camscratchlevel_t &level = scratch->levels[i];
+
+      VALID_ALLOC(level.validlines, ::numlines);
+      VALID_ALLOC(level.validpolys, ::numPolyObjects);
+      level.intercepts = estructalloc(intercept_t, ::numlines + 1);
+   }
+
+   return scratch;
+}
+
+//
+// CAM_FreeSightScratch
+//
+void CAM_FreeSightScratch(camsightscratch_t *scratch)
+{
+   for(int i = 0; i < CAMSCRATCHLEVELS; i++)
+   {
+      camscratchlevel_t &level = scratch->levels[i];
+
+      VALID_FREE(level.validlines);
+      VALID_FREE(level.validpolys);
+      efree(level.intercepts);
+   }
+
+   efree(scratch);
+}
+
+//
+// CAM_SightScratchFits
+//
+// True if the scratch was made for a map the size of the current one.
+//
+bool CAM_SightScratchFits(const camsightscratch_t *scratch)
+{
+   return scratch->numlines == ::numlines && scratch->numpolys == ::numPolyObjects;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // PTDef
@@ -226,16 +305,31 @@ class PathTraverser
 {
 public:
    bool traverse(fixed_t cx, fixed_t cy, fixed_t tx, fixed_t ty);
-   PathTraverser(const PTDef &indef, void *incontext) : 
-      trace(), def(indef), context(incontext), portalguard()
+   PathTraverser(const PTDef &indef, void *incontext, 
+                 camscratchlevel_t *inscratch = nullptr) : 
+      trace(), def(indef), context(incontext), portalguard(), scratch(inscratch)
    {
-      VALID_ALLOC(validlines, ::numlines);
-      VALID_ALLOC(validpolys, ::numPolyObjects);
+      if(scratch)
+      {
+         validlines = scratch->validlines;
+         validpolys = scratch->validpolys;
+         memset(validlines, 0, ((::numlines + 7) & ~7) / 8);
+         memset(validpolys, 0, ((::numPolyObjects + 7) & ~7) / 8);
+         scratch->numintercepts = 0;
+      }
+      else
+      {
+         VALID_ALLOC(validlines, ::numlines);
+         VALID_ALLOC(validpolys, ::numPolyObjects);
+      }
    }
    ~PathTraverser()
    {
-      VALID_FREE(validlines);
-      VALID_FREE(validpolys);
+      if(!scratch)
+      {
+         VALID_FREE(validlines);
+         VALID_FREE(validpolys);
+      }
    }
 
    divline_t trace;
@@ -244,6 +338,7 @@ private:
    bool blockLinesIterator(int x, int y);
    bool blockThingsIterator(int x, int y);
    bool traverseIntercepts() const;
+   intercept_t &newIntercept();
 
    const PTDef def;
    void *const context;
@@ -254,9 +349,25 @@ private:
       bool hitpblock;
       bool addedportal;
    } portalguard;
+   camscratchlevel_t *const scratch; // if set, used instead of the zone heap
    PODCollection<intercept_t> intercepts;
 };
 
+//
+// PathTraverser::newIntercept
+//
+intercept_t &PathTraverser::newIntercept()
+{
+   if(!scratch)
+      return intercepts.addNew();
+
+   intercept_t &inter = scratch->intercepts[scratch->numintercepts];
+   if(scratch->numintercepts < size_t(::numlines))
+      ++scratch->numintercepts;
+   inter = intercept_t();
+   return inter;
+}
+
 //
 // PathTraverser::traverseIntercepts
 //
@@ -264,18 +375,27 @@ private:
 //
 bool PathTraverser::traverseIntercepts() const
 {
-   size_t    count;
-   fixed_t   dist;
-   divline_t dl;
-   PODCollection<intercept_t>::iterator scan, end, in;
+   size_t       count;
+   fixed_t      dist;
+   divline_t    dl;
+   intercept_t *begin, *scan, *end, *in;
 
-   count = intercepts.getLength();
-   end   = intercepts.end();
+   if(scratch)
+   {
+      begin = scratch->intercepts;
+      count = scratch->numintercepts;
+   }
+   else
+   {
+      begin = intercepts.begin();
+      count = intercepts.getLength();
+   }
+   end = begin + count;
 
    //
    // calculate intercept distance
    //
-   for(scan = intercepts.begin(); scan < end; scan++)
+   for(scan = begin; scan < end; scan++)
    {
       if(!scan->isaline)
          continue;   // ioanch 20151230: only lines need this treatment
@@ -292,7 +412,7 @@ bool PathTraverser::traverseIntercepts() const
    {
       dist = D_MAXINT;
 
-      for(scan = intercepts.begin(); scan < end; scan++)
+      for(scan = begin; scan < end; scan++)
       {
          if(scan->frac < dist)
          {
@@ -365,7 +485,7 @@ bool PathTraverser::blockThingsIterator(int x, int y)
       if(frac < 0)
          continue;                // behind source
 
-      intercept_t &inter = intercepts.addNew();
+      intercept_t &inter = newIntercept();
       inter.frac = frac;
       inter.isaline = false;
       inter.d.thing = thing;
@@ -412,7 +532,7 @@ bool PathTraverser::checkLine(size_t linenum)
    }
 
    // store the line for later intersection testing
-   intercept_t &inter = intercepts.addNew();
+   intercept_t &inter = newIntercept();
    inter.isaline = true;
    inter.d.line = ld;
 
@@ -765,11 +885,13 @@ public:
       int reclevel;
    };
 
-   static bool checkSight(const camsightparams_t &inparams, const State *state);
+   static bool checkSight(const camsightparams_t &inparams, const State *state,
+      camsightscratch_t *scratch = nullptr, int depth = 0);
       
 private:
 
-   CamContext(const camsightparams_t &inparams, const State *state);
+   CamContext(const camsightparams_t &inparams, const State *state,
+      camsightscratch_t *scratch, int depth);
    static bool sightTraverse(const intercept_t *in, void *context, 
       const divline_t &trace);
    bool checkPortalSector(const sector_t *sector, fixed_t totalfrac, 
@@ -781,6 +903,8 @@ private:
    State state;
    const camsightparams_t *params;
    fixed_t sightzstart;
+   camsightscratch_t *scratch; // storage for worker threads, if any
+   int depth;                  // scratch level in use by this context
 };
 
 //
@@ -789,8 +913,10 @@ private:
 // Constructs it, either from a previous state or scratch
 //
 CamContext::CamContext(const camsightparams_t &inparams, 
-                       const State *instate) : 
-portalexit(false), portalresult(false), params(&inparams)
+                       const State *instate, camsightscratch_t *inscratch,
+                       int indepth) : 
+portalexit(false), portalresult(false), params(&inparams), scratch(inscratch),
+depth(indepth)
 {
    
    sightzstart = params->cz + params->cheight - (params->cheight >> 2);
@@ -1023,7 +1149,7 @@ bool CamContext::recurse(int newfromid, fixed_t x, fixed_t y,
    params.tgroupid = this->params->tgroupid;
    params.prev = this->params;
 
-   *result = checkSight(params, &instate);
+   *result = checkSight(params, &instate, scratch, depth + 1);
    return true;
 }
 
@@ -1037,8 +1163,16 @@ bool CamContext::recurse(int newfromid, fixed_t x, fixed_t y,
 // Also added bottomslope and topslope pre-setting
 //
 bool CamContext::checkSight(const camsightparams_t &params, 
-                            const CamContext::State *state)
+                            const CamContext::State *state,
+                            camsightscratch_t *scratch, int depth)
 {
+   // out of scratch storage; the caller must redo the check on its own
+   if(scratch && depth >= CAMSCRATCHLEVELS)
+   {
+      scratch->failed = true;
+      return false;
+   }
+
    linkoffset_t *link = nullptr;
    // Camera and target are not in same group?
    if(params.cgroupid != params.tgroupid)
@@ -1078,7 +1212,7 @@ bool CamContext::checkSight(const camsightparams_t &params,
       //
       // check precisely
       //
-      CamContext context(params, state);
+      CamContext context(params, state, scratch, depth);
 
       // if there is a valid portal link, adjust the target's coordinates now
       // so that we trace in the proper direction given the current link
@@ -1096,7 +1230,8 @@ bool CamContext::checkSight(const camsightparams_t &params,
       def.flags = CAM_ADDLINES;
       def.earlyOut = true;
       def.trav = CamContext::sightTraverse;
-      PathTraverser traverser(def, &context);
+      PathTraverser traverser(def, &context, 
+                              scratch ? &scratch->levels[depth] : nullptr);
       result = traverser.traverse(params.cx, params.cy, tx, ty);
 
       if(context.portalexit)
@@ -1128,6 +1263,23 @@ bool CAM_CheckSight(const camsightparams_t &params)
    return CamContext::checkSight(params, nullptr);
 }
 
+//
+// CAM_CheckSightScratch
+//
+// As CAM_CheckSight, but touches nothing outside of the scratch storage, so
+// it may be called from a worker thread. Returns -1 if the check went through
+// more portals than the scratch has room for.
+//
+int CAM_CheckSightScratch(const camsightparams_t &params, 
+                          camsightscratch_t *scratch)
+{
+   scratch->failed = false;
+
+   bool result = CamContext::checkSight(params, nullptr, scratch, 0);
+
+   return scratch->failed ? -1 : result;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // AimContext
@@ -33,6 +33,7 @@
 #include "tables.h"
 
 struct camera_t;
+struct camsightscratch_t;
 struct divline_t;
 struct intercept_t;
 struct player_t;  // ioanch 20160131: for use
@@ -60,6 +61,13 @@ struct camsightparams_t
 
 bool CAM_CheckSight(const camsightparams_t &params);
 
+// Sight checking away from the main thread
+camsightscratch_t *CAM_NewSightScratch();
+void CAM_FreeSightScratch(camsightscratch_t *scratch);
+bool CAM_SightScratchFits(const camsightscratch_t *scratch);
+int  CAM_CheckSightScratch(const camsightparams_t &params, 
+                           camsightscratch_t *scratch);
+
 fixed_t CAM_AimLineAttack(const Mobj *t1, angle_t angle, fixed_t distance, 
                           uint32_t mask, Mobj **outTarget);
 // ioanch 20160101: bullet attack
@@ -67,6 +67,7 @@
 #include "m_argv.h"
 #include "m_compare.h"
 #include "m_misc.h"
+#include "m_profile.h"
 #include "m_syscfg.h"
 #include "m_qstr.h"
 #include "mn_engin.h"
@@ -609,8 +610,11 @@ void D_Display()
             R_RenderPlayerView(&players[displayplayer], camera);
          }
          
-         ST_Drawer(scaledwindow.height == SCREENHEIGHT);  // killough 11/98
-         HU_Drawer();
+         {
+            AutoProfile prof(PROF_HUD);
+            ST_Drawer(scaledwindow.height == SCREENHEIGHT);  // killough 11/98
+            HU_Drawer();
+         }
          break;
       case GS_INTERMISSION:
          IN_Drawer();
@@ -713,7 +717,11 @@ void D_Display()
       D_showMemStats();
 #endif
    
+   M_ProfileStart(PROF_FINISHUPDATE);
    I_FinishUpdate();              // page flip or blit buffer
+   M_ProfileStop(PROF_FINISHUPDATE);
+
+   M_ProfileEndFrame();
 
    i_haltimer.EndDisplay();
 }
@@ -756,8 +756,8 @@ static void F_InitDemonScroller()
    lsize1 = W_LumpLength(lnum1);
    lsize2 = W_LumpLength(lnum2);
 
-   // init VBuffer
-   V_InitVBufferFrom(&vbuf, 320, 400, 320, video.bitdepth, DemonBuffer);
+   // init VBuffer; this is a paletted image, whatever the screen's bitdepth
+   V_InitVBufferFrom(&vbuf, 320, 400, 320, 8, DemonBuffer);
    
    if(lsize2 == 64000) // raw screen
       wGlobalDir.readLump(lnum2, DemonBuffer);
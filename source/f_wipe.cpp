@@ -68,10 +68,40 @@ static int worms[SCREENWIDTH];
 
 static int starting_height;
 
-static void Wipe_meltStartScreen(void)
+//
+// Wipe_meltCopyColumns
+//
+// Copies the screen into the column-major start_screen buffer. Templated on
+// the pixel type of the screen.
+//
+template<typename pixel_t>
+static void Wipe_meltCopyColumns()
 {
    int x, y;
-   byte *dest, *src;
+   pixel_t *dest, *src;
+
+   // SoM 2-4-04: ANYRES
+   for(x = 0; x < video.width; ++x)
+   {
+      // limit check
+      int wormx = (x << FRACBITS) / video.xscale;
+      int wormy = video.y1lookup[worms[wormx] > 0 ? worms[wormx] : 0];
+      
+      src  = (pixel_t *)vbscreen.data + x;
+      dest = (pixel_t *)start_screen[x];
+      
+      for(y = 0; y < video.height - wormy; y++)
+      {
+         *dest = *src;
+         src = (pixel_t *)((byte *)src + vbscreen.pitch);
+         dest++;
+      }
+   }
+}
+
+static void Wipe_meltStartScreen(void)
+{
+   int x;
 
    // SoM 2-4-04: ANYRES
    // use console height
@@ -92,31 +122,19 @@ static void Wipe_meltStartScreen(void)
    }
 
    for(x = 0; x < video.width; ++x)
-      start_screen[x] = wipe_buffer + (x * video.height);
+      start_screen[x] = wipe_buffer + (x * video.height * video.pixelsize);
 
-   // SoM 2-4-04: ANYRES
-   for(x = 0; x < video.width; ++x)
-   {
-      // limit check
-      int wormx = (x << FRACBITS) / video.xscale;
-      int wormy = video.y1lookup[worms[wormx] > 0 ? worms[wormx] : 0];
-      
-      src = vbscreen.data + x;
-      dest = start_screen[x];
-      
-      for(y = 0; y < video.height - wormy; y++)
-      {
-         *dest = *src;
-         src += vbscreen.pitch;
-         dest++;
-      }
-   }
+   if(video.pixelsize == 4)
+      Wipe_meltCopyColumns<uint32_t>();
+   else
+      Wipe_meltCopyColumns<byte>();
 }
 
-static void Wipe_meltDrawer(void)
+template<typename pixel_t>
+static void Wipe_meltDrawColumns()
 {
    int x, y;
-   byte *dest, *src;
+   pixel_t *dest, *src;
 
    // SoM 2-4-04: ANYRES
    for(x = 0; x < video.width; ++x)
@@ -128,17 +146,25 @@ static void Wipe_meltDrawer(void)
 
       wormy = video.y1lookup[wormy];
 
-      src = start_screen[x];
-      dest = vbscreen.data + vbscreen.pitch * wormy + x;
+      src  = (pixel_t *)start_screen[x];
+      dest = (pixel_t *)(vbscreen.data + vbscreen.pitch * wormy) + x;
       
       for(y = video.height - wormy; y--;)
       {
          *dest = *src++;
-         dest += vbscreen.pitch;
+         dest = (pixel_t *)((byte *)dest + vbscreen.pitch);
       }
    }
 }
 
+static void Wipe_meltDrawer(void)
+{
+   if(video.pixelsize == 4)
+      Wipe_meltDrawColumns<uint32_t>();
+   else
+      Wipe_meltDrawColumns<byte>();
+}
+
 static bool Wipe_meltTicker(void)
 {
    bool done;
@@ -191,12 +217,44 @@ static int fadelvl;
 static void Wipe_fadeStartScreen(void)
 {
    fadelvl = 0;
-   I_ReadScreen(wipe_buffer);
+
+   if(video.pixelsize == 4)
+   {
+      // truecolor screens are copied as-is; I_ReadScreen returns 8-bit
+      for(int y = 0; y < vbscreen.height; y++)
+      {
+         memcpy(wipe_buffer + y * vbscreen.width * 4, 
+                vbscreen.data + y * vbscreen.pitch, vbscreen.width * 4);
+      }
+   }
+   else
+      I_ReadScreen(wipe_buffer);
+}
+
+//
+// Wipe_fadeDrawer32
+//
+// Crossfade for truecolor screens, with the full 0-256 blend range.
+//
+static void Wipe_fadeDrawer32(void)
+{
+   const uint32_t *src = (const uint32_t *)wipe_buffer;
+   unsigned int alpha = (MAXFADE - fadelvl) * 256 / MAXFADE;
+
+   for(int y = 0; y < vbscreen.height; ++y)
+   {
+      uint32_t *dest = (uint32_t *)(vbscreen.data + y * vbscreen.pitch);
+
+      for(int x = 0; x < vbscreen.width; ++x, ++src)
+         dest[x] = V_BlendRGB32(*src, dest[x], alpha);
+   }
 }
 
 static void Wipe_fadeDrawer(void)
 {
-   if(fadelvl <= MAXFADE)
+   if(fadelvl <= MAXFADE && video.pixelsize == 4)
+      Wipe_fadeDrawer32();
+   else if(fadelvl <= MAXFADE)
    {
       byte *src, *dest;
       unsigned int *fg2rgb = Col2RGB8[fadelvl];
@@ -282,7 +340,7 @@ void Wipe_StartScreen(void)
    {
       // SoM: Reformatted and cleaned up (ANYRES)
       // haleyjd: make purgable, allocate at required size
-      wipe_buffer = (byte *)(Z_Malloc(video.height * video.width, PU_STATIC, 
+      wipe_buffer = (byte *)(Z_Malloc(video.height * video.width * video.pixelsize, PU_STATIC, 
                                       (void **)&wipe_buffer));
    }
    else
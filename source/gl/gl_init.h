@@ -58,6 +58,8 @@ struct GL_versioninfo
 
 extern GL_versioninfo GL_version;
 
+void GL_GetVersion();
+
 #endif
 
 #endif
@@ -42,6 +42,8 @@ int  cfg_gl_filter_type;     // texture filtering type
 int  cfg_gl_texture_format;  // texture internal format
 bool cfg_gl_use_extensions;  // must be true for extensions to be used
 bool cfg_gl_arb_pixelbuffer; // enable ARB PBO extension
+bool cfg_gl_palette_shader;  // apply the palette in a fragment shader
+bool cfg_gl_world_renderer;  // draw the world through GL
 
 VARIABLE_INT(cfg_gl_colordepth, NULL, 16, 32, NULL);
 CONSOLE_VARIABLE(gl_colordepth, cfg_gl_colordepth, 0) {}
@@ -78,5 +80,11 @@ CONSOLE_VARIABLE(gl_use_extensions, cfg_gl_use_extensions, 0) {}
 VARIABLE_TOGGLE(cfg_gl_arb_pixelbuffer, NULL, yesno);
 CONSOLE_VARIABLE(gl_arb_pixelbuffer, cfg_gl_arb_pixelbuffer, 0) {}
 
+VARIABLE_TOGGLE(cfg_gl_palette_shader, NULL, yesno);
+CONSOLE_VARIABLE(gl_palette_shader, cfg_gl_palette_shader, 0) {}
+
+VARIABLE_TOGGLE(cfg_gl_world_renderer, NULL, yesno);
+CONSOLE_VARIABLE(gl_world_renderer, cfg_gl_world_renderer, 0) {}
+
 // EOF
 
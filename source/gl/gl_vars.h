@@ -64,6 +64,8 @@ extern int  cfg_gl_filter_type;
 extern int  cfg_gl_texture_format;
 extern bool cfg_gl_use_extensions;
 extern bool cfg_gl_arb_pixelbuffer;
+extern bool cfg_gl_palette_shader;
+extern bool cfg_gl_world_renderer;
 
 void GL_AddCommands();
 
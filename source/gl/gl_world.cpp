@@ -0,0 +1,2459 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+// Additional terms and conditions compatible with the GPLv3 apply. See the
+// file COPYING-EE for details.
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//
+//  OpenGL World Renderer
+//
+//  Draws walls, flats, sprites, and the sky of the view through OpenGL 2.0
+//  instead of the column and span drawers. Each frame the BSP is walked for
+//  the subsectors in view, their geometry is streamed into a vertex buffer,
+//  and the triangles are grouped by texture atlas page so that each page is
+//  bound and drawn once.
+//
+//  The world is drawn in palette indices into an offscreen framebuffer: the
+//  fragment shader looks each texel up in the translation and colormap
+//  tables with the software renderer's light diminishing, and translucent
+//  things are blended through the same 64K maps the column drawers use.
+//  The result is read back into the view window of the 8-bit screen, so the
+//  player sprites, HUD, menus, and palette flashes go over it exactly as
+//  they do over the software renderer's view.
+//
+//  Flats are drawn from convex outlines of the subsectors, found by cutting
+//  the map's bounds down through the node partitions and then by the
+//  subsector's own segs. They are built on the first frame of a level.
+//
+//  Not drawn yet: deep water's fake flats, portals, particles, and plane
+//  rotation.
+//
+//-----------------------------------------------------------------------------
+
+#ifdef EE_FEATURE_OPENGL
+
+#include <stddef.h>
+
+#include "../z_zone.h"
+#include "../doomstat.h"
+#include "../d_player.h"
+#include "../e_exdata.h"
+#include "../m_bbox.h"
+#include "../m_compare.h"
+#include "../p_info.h"
+#include "../p_mobj.h"
+#include "../p_slopes.h"
+#include "../r_data.h"
+#include "../r_draw.h"
+#include "../r_dynseg.h"
+#include "../r_interpolate.h"
+#include "../r_lighting.h"
+#include "../r_main.h"
+#include "../r_patch.h"
+#include "../r_pvs.h"
+#include "../r_sky.h"
+#include "../r_state.h"
+#include "../v_misc.h"
+#include "../v_patchfmt.h"
+#include "../v_video.h"
+#include "../w_wad.h"
+
+// SDL_opengl.h carries glext.h's declarations on every platform
+#include "SDL_opengl.h"
+
+#include "gl_includes.h"
+#include "gl_init.h"
+#include "gl_texture.h"
+#include "gl_world.h"
+
+// Vertex layout of the world program's attributes
+struct glwvertex_t
+{
+   GLfloat x, y, z;
+   GLfloat s, t, tile; // texel in the graphic; it repeats if tile is set
+   GLfloat rect[4];    // graphic's place in its atlas page: x, y, w, h
+   GLfloat light[4];   // start, kind, colormap row, translation row
+};
+
+// Attribute locations
+enum
+{
+   GLW_ATTR_POS,
+   GLW_ATTR_ST,
+   GLW_ATTR_RECT,
+   GLW_ATTR_LIGHT
+};
+
+// Ways of finding the colormap row, in light[1]
+enum
+{
+   GLW_LIGHTSCALE, // walls and sprites: start is the software startcmap
+   GLW_LIGHTPLANE, // flats: start is the software plane startmap
+   GLW_LIGHTFIXED  // start is the row itself
+};
+
+// Ways a translucent surface is laid over what's behind it
+enum
+{
+   GLW_BLENDNONE,
+   GLW_BLENDMAP,  // through a 64K map indexed [(dest << 8) + src]
+   GLW_BLENDFUZZ  // the spectre effect
+};
+
+// Texture units; unit 1 belongs to the video driver's palette
+enum
+{
+   GLW_UNIT_ATLAS        = 0,
+   GLW_UNIT_COLORMAPS    = 2,
+   GLW_UNIT_TRANSLATIONS = 3,
+   GLW_UNIT_BLENDMAP     = 4,
+   GLW_UNIT_BEHIND       = 5
+};
+
+// Light of a surface, before it goes into its vertices
+struct glwlight_t
+{
+   float start;
+   int   kind;
+   int   cmrow;
+   int   trans;
+};
+
+// A graphic's place in the atlas
+struct glwgraphic_t
+{
+   int     page;
+   GLfloat rect[4];
+};
+
+#define GLW_UNMADE   -2 // graphic isn't in the atlas yet
+#define GLW_UNUSABLE -1 // graphic is too big for any texture
+
+// Atlas page, filled in shelves from the top
+struct glwpage_t
+{
+   GLuint tex;
+   int    width, height;
+   int    shelfx, shelfy, shelfh;
+};
+
+// Translucent triangles, drawn one group at a time from far to near
+struct glwtransitem_t
+{
+   int         firstvert;
+   int         numverts;
+   int         page;
+   int         blend;
+   const byte *map;
+   float       depth;
+};
+
+// Convex outline of a subsector, in subpoints
+struct glwsubpoly_t
+{
+   int firstpoint;
+   int numpoints;
+};
+
+struct glwpoint_t
+{
+   double x, y;
+};
+
+// A blend map made into a texture
+struct glwblendtex_t
+{
+   const byte *map;
+   GLuint      tex;
+};
+
+#define MAXGLWPOINTS 64        // most points an outline may have while cutting
+#define GLW_EPSILON  (1.0/16)  // distance points may be outside a cut
+#define GLW_ZNEAR    4.0       // near clipping plane
+#define GLW_ZFAR     131072.0  // far clipping plane
+#define GLW_SKYSTRIPS 16       // strips the sky backdrop is split into
+#define GLW_PAGESIZE 2048      // size of the shared atlas pages
+#define GLW_NUMBLENDTEX 16     // blend maps kept as textures at once
+
+// Batch of sky flats, which only fill the depth buffer. Atlas pages are
+// batched as their number plus one.
+#define GLW_SKYKEY 0
+
+static bool worldactive; // the renderer is set up and wanted
+
+//=============================================================================
+//
+// Extension Functions
+//
+
+// Buffer objects (OpenGL 1.5)
+static PFNGLGENBUFFERSPROC    pglGenBuffers    = NULL;
+static PFNGLDELETEBUFFERSPROC pglDeleteBuffers = NULL;
+static PFNGLBINDBUFFERPROC    pglBindBuffer    = NULL;
+static PFNGLBUFFERDATAPROC    pglBufferData    = NULL;
+static PFNGLBUFFERSUBDATAPROC pglBufferSubData = NULL;
+
+// Shaders (OpenGL 2.0)
+static PFNGLACTIVETEXTUREPROC            pglActiveTexture            = NULL;
+static PFNGLCREATESHADERPROC             pglCreateShader             = NULL;
+static PFNGLSHADERSOURCEPROC             pglShaderSource             = NULL;
+static PFNGLCOMPILESHADERPROC            pglCompileShader            = NULL;
+static PFNGLGETSHADERIVPROC              pglGetShaderiv              = NULL;
+static PFNGLDELETESHADERPROC             pglDeleteShader             = NULL;
+static PFNGLCREATEPROGRAMPROC            pglCreateProgram            = NULL;
+static PFNGLATTACHSHADERPROC             pglAttachShader             = NULL;
+static PFNGLBINDATTRIBLOCATIONPROC       pglBindAttribLocation       = NULL;
+static PFNGLLINKPROGRAMPROC              pglLinkProgram              = NULL;
+static PFNGLGETPROGRAMIVPROC             pglGetProgramiv             = NULL;
+static PFNGLDELETEPROGRAMPROC            pglDeleteProgram            = NULL;
+static PFNGLUSEPROGRAMPROC               pglUseProgram               = NULL;
+static PFNGLGETUNIFORMLOCATIONPROC       pglGetUniformLocation       = NULL;
+static PFNGLUNIFORM1IPROC                pglUniform1i                = NULL;
+static PFNGLUNIFORM1FPROC                pglUniform1f                = NULL;
+static PFNGLUNIFORM2FPROC                pglUniform2f                = NULL;
+static PFNGLUNIFORMMATRIX4FVPROC         pglUniformMatrix4fv         = NULL;
+static PFNGLVERTEXATTRIBPOINTERPROC      pglVertexAttribPointer      = NULL;
+static PFNGLENABLEVERTEXATTRIBARRAYPROC  pglEnableVertexAttribArray  = NULL;
+static PFNGLDISABLEVERTEXATTRIBARRAYPROC pglDisableVertexAttribArray = NULL;
+
+// Framebuffer objects (OpenGL 3.0 or GL_ARB_framebuffer_object)
+static PFNGLGENFRAMEBUFFERSPROC         pglGenFramebuffers         = NULL;
+static PFNGLDELETEFRAMEBUFFERSPROC      pglDeleteFramebuffers      = NULL;
+static PFNGLBINDFRAMEBUFFERPROC         pglBindFramebuffer         = NULL;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC pglFramebufferRenderbuffer = NULL;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC  pglCheckFramebufferStatus  = NULL;
+static PFNGLGENRENDERBUFFERSPROC        pglGenRenderbuffers        = NULL;
+static PFNGLDELETERENDERBUFFERSPROC     pglDeleteRenderbuffers     = NULL;
+static PFNGLBINDRENDERBUFFERPROC        pglBindRenderbuffer        = NULL;
+static PFNGLRENDERBUFFERSTORAGEPROC     pglRenderbufferStorage     = NULL;
+
+//=============================================================================
+//
+// Static Data
+//
+
+// The world program
+static GLuint worldprogram;
+
+static struct
+{
+   GLint view, proj;
+   GLint atlassize, viewsize;
+   GLint cmrows, transrows;
+   GLint planebias;
+   GLint blend, fuzzrow, fuzzseed;
+   GLint depthonly;
+} uniforms;
+
+static const GLchar *worldVertexSource =
+   "#version 120\n"
+   "uniform mat4 view;\n"
+   "uniform mat4 proj;\n"
+   "attribute vec3 pos;\n"
+   "attribute vec3 st;\n"
+   "attribute vec4 rect;\n"
+   "attribute vec4 light;\n"
+   "varying vec3 v_st;\n"
+   "varying vec4 v_rect;\n"
+   "varying vec4 v_light;\n"
+   "varying float v_depth;\n"
+   "void main()\n"
+   "{\n"
+   "   vec4 eye = view * vec4(pos, 1.0);\n"
+   "   v_st    = st;\n"
+   "   v_rect  = rect;\n"
+   "   v_light = light;\n"
+   "   v_depth = -eye.z;\n"
+   "   gl_Position = proj * eye;\n"
+   "}\n";
+
+// Every value passed through a varying that's the same at each vertex is
+// rounded, since interpolating it may leave it a hair off.
+static const GLchar *worldFragmentSource =
+   "#version 120\n"
+   "uniform sampler2D atlas;\n"
+   "uniform sampler2D colormaps;\n"
+   "uniform sampler2D translations;\n"
+   "uniform sampler2D blendmap;\n"
+   "uniform sampler2D behind;\n"
+   "uniform vec2  atlassize;\n"
+   "uniform vec2  viewsize;\n"
+   "uniform float cmrows;\n"
+   "uniform float transrows;\n"
+   "uniform float planebias;\n"
+   "uniform int   blend;\n"
+   "uniform float fuzzrow;\n"
+   "uniform float fuzzseed;\n"
+   "uniform bool  depthonly;\n"
+   "varying vec3 v_st;\n"
+   "varying vec4 v_rect;\n"
+   "varying vec4 v_light;\n"
+   "varying float v_depth;\n"
+   "float lookup(sampler2D table, float index, float row, float rows)\n"
+   "{\n"
+   "   vec2 st = vec2((index + 0.5) / 256.0, (row + 0.5) / rows);\n"
+   "   return floor(texture2D(table, st).r * 255.0 + 0.5);\n"
+   "}\n"
+   "void main()\n"
+   "{\n"
+   "   if(depthonly)\n"
+   "   {\n"
+   "      gl_FragColor = vec4(0.0);\n"
+   "      return;\n"
+   "   }\n"
+   "   vec4  rect = floor(v_rect + 0.5);\n"
+   "   vec2  texel;\n"
+   "   if(v_st.z > 0.5)\n"
+   "      texel = floor(mod(v_st.xy, rect.zw));\n"
+   "   else\n"
+   "      texel = clamp(floor(v_st.xy), vec2(0.0), rect.zw - 1.0);\n"
+   "   vec4 c = texture2D(atlas, (rect.xy + texel + 0.5) / atlassize);\n"
+   "   if(c.a < 0.5)\n"
+   "      discard;\n"
+   "   float index = floor(c.r * 255.0 + 0.5);\n"
+   "   float trans = floor(v_light.w + 0.5);\n"
+   "   if(trans >= 0.0)\n"
+   "      index = lookup(translations, index, trans, transrows);\n"
+   "   float kind  = floor(v_light.y + 0.5);\n"
+   "   float level;\n"
+   "   if(kind == 0.0)\n"
+   "   {\n"
+   "      float scale = min(floor(2560.0 / v_depth), 47.0);\n"
+   "      level = clamp(floor(v_light.x + 0.5) - floor(scale / 2.0), 0.0, 31.0);\n"
+   "   }\n"
+   "   else if(kind == 1.0)\n"
+   "      level = clamp(float(int(v_light.x - 1280.0 / v_depth)) + planebias, 0.0, 31.0);\n"
+   "   else\n"
+   "      level = floor(v_light.x + 0.5);\n"
+   "   float color = lookup(colormaps, index, floor(v_light.z + 0.5) + level, cmrows);\n"
+   "   if(blend == 1)\n"
+   "   {\n"
+   "      float dest = floor(texture2D(behind, gl_FragCoord.xy / viewsize).r * 255.0 + 0.5);\n"
+   "      color = lookup(blendmap, color, dest, 256.0);\n"
+   "   }\n"
+   "   else if(blend == 2)\n"
+   "   {\n"
+   "      float r = fract(sin(dot(gl_FragCoord.xy, vec2(12.9898, 78.233)) + fuzzseed) * 43758.5453);\n"
+   "      vec2 at = gl_FragCoord.xy + vec2(0.0, r < 0.5 ? -1.0 : 1.0);\n"
+   "      float dest = floor(texture2D(behind, at / viewsize).r * 255.0 + 0.5);\n"
+   "      color = lookup(colormaps, dest, fuzzrow, cmrows);\n"
+   "   }\n"
+   "   gl_FragColor = vec4(color / 255.0, 0.0, 0.0, 1.0);\n"
+   "}\n";
+
+// Vertex buffer the frame's triangles are streamed into
+static GLuint worldvbo;
+
+// Offscreen target the size of the view window, and a copy of it that
+// translucent surfaces read what's behind them from
+static GLuint fbo, colorrb, depthrb, behindtex;
+static int    targetwidth, targetheight;
+
+// Colormaps, one 256-wide row per light level of every set, and the rows
+// each set starts at
+static GLuint cmaptex;
+static int    cmaprows;
+static int   *cmaprowbase;
+static int    cmapsets;
+
+// Translation tables, one row each
+static GLuint transtex;
+static int    transrows;
+
+// Blend maps in use, replaced in turn
+static glwblendtex_t blendtextures[GLW_NUMBLENDTEX];
+static int           nextblendtex;
+
+// Atlas of graphics by key: wall textures and flats first, then sprite
+// lumps. They are put in when first drawn.
+static glwgraphic_t *glgraphics;
+static int           numglkeys;
+static glwpage_t    *glpages;
+static int           numpages, maxpages;
+static int           sharedpage = -1; // page small graphics go on
+static int           pagesize, maxtexsize;
+
+// Scratch space for making graphics
+static byte  *glpixels, *glsource, *glmask;
+static size_t glpixelsize, glsourcesize, glmasksize;
+
+// Subsector outlines; PU_LEVEL, so they go away with the level
+static glwsubpoly_t *subpolys;
+static float        *subpoints;
+
+// Outline points as they are built
+static float *buildpoints;
+static int    numbuildpoints, maxbuildpoints;
+
+// Opaque triangles gathered this frame, three vertices each, and their keys
+static glwvertex_t *triverts;
+static int         *trikeys;
+static int          numtris, maxtris;
+
+// Triangles grouped by key
+static glwvertex_t *sortverts;
+static int         *keycounts;
+static int         *usedkeys;
+static int          numusedkeys, maxkeys;
+
+// Translucent triangles gathered this frame
+static glwvertex_t    *transverts;
+static int             numtransverts, maxtransverts;
+static glwtransitem_t *transitems;
+static int             numtransitems, maxtransitems;
+
+// Sky backdrop, as a triangle strip
+static glwvertex_t skyverts[(GLW_SKYSTRIPS + 1) * 2];
+static int         numskyverts;
+
+// View and projection of this frame, column-major
+static GLfloat viewmatrix[16], projmatrix[16];
+
+static unsigned int frameseed;
+
+//=============================================================================
+//
+// Setup
+//
+
+#define GETPROC(ptr, name, type) \
+   ptr = (type)getproc(name); \
+   procs_ok = (procs_ok && ptr != NULL)
+
+//
+// GL_loadProcs
+//
+// Finds the functions past OpenGL 1.1 that the renderer needs.
+//
+static bool GL_loadProcs(void *(*getproc)(const char *))
+{
+   bool procs_ok = true;
+
+   GETPROC(pglGenBuffers,    "glGenBuffers",    PFNGLGENBUFFERSPROC);
+   GETPROC(pglDeleteBuffers, "glDeleteBuffers", PFNGLDELETEBUFFERSPROC);
+   GETPROC(pglBindBuffer,    "glBindBuffer",    PFNGLBINDBUFFERPROC);
+   GETPROC(pglBufferData,    "glBufferData",    PFNGLBUFFERDATAPROC);
+   GETPROC(pglBufferSubData, "glBufferSubData", PFNGLBUFFERSUBDATAPROC);
+
+   GETPROC(pglActiveTexture,            "glActiveTexture",            PFNGLACTIVETEXTUREPROC);
+   GETPROC(pglCreateShader,             "glCreateShader",             PFNGLCREATESHADERPROC);
+   GETPROC(pglShaderSource,             "glShaderSource",             PFNGLSHADERSOURCEPROC);
+   GETPROC(pglCompileShader,            "glCompileShader",            PFNGLCOMPILESHADERPROC);
+   GETPROC(pglGetShaderiv,              "glGetShaderiv",              PFNGLGETSHADERIVPROC);
+   GETPROC(pglDeleteShader,             "glDeleteShader",             PFNGLDELETESHADERPROC);
+   GETPROC(pglCreateProgram,            "glCreateProgram",            PFNGLCREATEPROGRAMPROC);
+   GETPROC(pglAttachShader,             "glAttachShader",             PFNGLATTACHSHADERPROC);
+   GETPROC(pglBindAttribLocation,       "glBindAttribLocation",       PFNGLBINDATTRIBLOCATIONPROC);
+   GETPROC(pglLinkProgram,              "glLinkProgram",              PFNGLLINKPROGRAMPROC);
+   GETPROC(pglGetProgramiv,             "glGetProgramiv",             PFNGLGETPROGRAMIVPROC);
+   GETPROC(pglDeleteProgram,            "glDeleteProgram",            PFNGLDELETEPROGRAMPROC);
+   GETPROC(pglUseProgram,               "glUseProgram",               PFNGLUSEPROGRAMPROC);
+   GETPROC(pglGetUniformLocation,       "glGetUniformLocation",       PFNGLGETUNIFORMLOCATIONPROC);
+   GETPROC(pglUniform1i,                "glUniform1i",                PFNGLUNIFORM1IPROC);
+   GETPROC(pglUniform1f,                "glUniform1f",                PFNGLUNIFORM1FPROC);
+   GETPROC(pglUniform2f,                "glUniform2f",                PFNGLUNIFORM2FPROC);
+   GETPROC(pglUniformMatrix4fv,         "glUniformMatrix4fv",         PFNGLUNIFORMMATRIX4FVPROC);
+   GETPROC(pglVertexAttribPointer,      "glVertexAttribPointer",      PFNGLVERTEXATTRIBPOINTERPROC);
+   GETPROC(pglEnableVertexAttribArray,  "glEnableVertexAttribArray",  PFNGLENABLEVERTEXATTRIBARRAYPROC);
+   GETPROC(pglDisableVertexAttribArray, "glDisableVertexAttribArray", PFNGLDISABLEVERTEXATTRIBARRAYPROC);
+
+   GETPROC(pglGenFramebuffers,         "glGenFramebuffers",         PFNGLGENFRAMEBUFFERSPROC);
+   GETPROC(pglDeleteFramebuffers,      "glDeleteFramebuffers",      PFNGLDELETEFRAMEBUFFERSPROC);
+   GETPROC(pglBindFramebuffer,         "glBindFramebuffer",         PFNGLBINDFRAMEBUFFERPROC);
+   GETPROC(pglFramebufferRenderbuffer, "glFramebufferRenderbuffer", PFNGLFRAMEBUFFERRENDERBUFFERPROC);
+   GETPROC(pglCheckFramebufferStatus,  "glCheckFramebufferStatus",  PFNGLCHECKFRAMEBUFFERSTATUSPROC);
+   GETPROC(pglGenRenderbuffers,        "glGenRenderbuffers",        PFNGLGENRENDERBUFFERSPROC);
+   GETPROC(pglDeleteRenderbuffers,     "glDeleteRenderbuffers",     PFNGLDELETERENDERBUFFERSPROC);
+   GETPROC(pglBindRenderbuffer,        "glBindRenderbuffer",        PFNGLBINDRENDERBUFFERPROC);
+   GETPROC(pglRenderbufferStorage,     "glRenderbufferStorage",     PFNGLRENDERBUFFERSTORAGEPROC);
+
+   return procs_ok;
+}
+
+//
+// GL_compileShader
+//
+static GLuint GL_compileShader(GLenum type, const GLchar *source)
+{
+   GLuint shader = pglCreateShader(type);
+   GLint  status = 0;
+
+   pglShaderSource(shader, 1, &source, NULL);
+   pglCompileShader(shader);
+   pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+   if(!status)
+   {
+      pglDeleteShader(shader);
+      shader = 0;
+   }
+
+   return shader;
+}
+
+//
+// GL_buildProgram
+//
+// Compiles and links the world program and sets its samplers to their
+// texture units.
+//
+static bool GL_buildProgram()
+{
+   GLuint vs = GL_compileShader(GL_VERTEX_SHADER,   worldVertexSource);
+   GLuint fs = GL_compileShader(GL_FRAGMENT_SHADER, worldFragmentSource);
+   GLint  status = 0;
+
+   if(vs && fs)
+   {
+      worldprogram = pglCreateProgram();
+      pglAttachShader(worldprogram, vs);
+      pglAttachShader(worldprogram, fs);
+      pglBindAttribLocation(worldprogram, GLW_ATTR_POS,   "pos");
+      pglBindAttribLocation(worldprogram, GLW_ATTR_ST,    "st");
+      pglBindAttribLocation(worldprogram, GLW_ATTR_RECT,  "rect");
+      pglBindAttribLocation(worldprogram, GLW_ATTR_LIGHT, "light");
+      pglLinkProgram(worldprogram);
+      pglGetProgramiv(worldprogram, GL_LINK_STATUS, &status);
+
+      if(!status)
+      {
+         pglDeleteProgram(worldprogram);
+         worldprogram = 0;
+      }
+   }
+
+   // the program keeps the shaders alive for as long as it needs them
+   if(vs)
+      pglDeleteShader(vs);
+   if(fs)
+      pglDeleteShader(fs);
+
+   if(!worldprogram)
+      return false;
+
+   pglUseProgram(worldprogram);
+   pglUniform1i(pglGetUniformLocation(worldprogram, "atlas"),        GLW_UNIT_ATLAS);
+   pglUniform1i(pglGetUniformLocation(worldprogram, "colormaps"),    GLW_UNIT_COLORMAPS);
+   pglUniform1i(pglGetUniformLocation(worldprogram, "translations"), GLW_UNIT_TRANSLATIONS);
+   pglUniform1i(pglGetUniformLocation(worldprogram, "blendmap"),     GLW_UNIT_BLENDMAP);
+   pglUniform1i(pglGetUniformLocation(worldprogram, "behind"),       GLW_UNIT_BEHIND);
+
+   uniforms.view      = pglGetUniformLocation(worldprogram, "view");
+   uniforms.proj      = pglGetUniformLocation(worldprogram, "proj");
+   uniforms.atlassize = pglGetUniformLocation(worldprogram, "atlassize");
+   uniforms.viewsize  = pglGetUniformLocation(worldprogram, "viewsize");
+   uniforms.cmrows    = pglGetUniformLocation(worldprogram, "cmrows");
+   uniforms.transrows = pglGetUniformLocation(worldprogram, "transrows");
+   uniforms.planebias = pglGetUniformLocation(worldprogram, "planebias");
+   uniforms.blend     = pglGetUniformLocation(worldprogram, "blend");
+   uniforms.fuzzrow   = pglGetUniformLocation(worldprogram, "fuzzrow");
+   uniforms.fuzzseed  = pglGetUniformLocation(worldprogram, "fuzzseed");
+   uniforms.depthonly = pglGetUniformLocation(worldprogram, "depthonly");
+   pglUseProgram(0);
+
+   return true;
+}
+
+//
+// GL_makeTableTexture
+//
+// Makes an 8-bit texture on a texture unit, for looking indices up in.
+//
+static GLuint GL_makeTableTexture(int unit, int width, int height, const byte *data)
+{
+   GLuint name = 0;
+
+   pglActiveTexture(GL_TEXTURE0 + unit);
+   glGenTextures(1, &name);
+   glBindTexture(GL_TEXTURE_2D, name);
+
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, width, height, 0,
+                GL_LUMINANCE, GL_UNSIGNED_BYTE, data);
+
+   pglActiveTexture(GL_TEXTURE0);
+
+   return name;
+}
+
+//
+// GL_deleteTexture
+//
+static void GL_deleteTexture(GLuint &name)
+{
+   if(name)
+   {
+      glDeleteTextures(1, &name);
+      name = 0;
+   }
+}
+
+//
+// GL_setupTables
+//
+// Makes the colormap and translation textures, once the renderer's tables
+// are loaded. Sets of colormaps that don't fit in one texture fall back to
+// the first.
+//
+static void GL_setupTables()
+{
+   if(!cmaptex || cmapsets != numcolormaps)
+   {
+      byte *rows;
+
+      GL_deleteTexture(cmaptex);
+      efree(cmaprowbase);
+      cmaprowbase = ecalloc(int *, numcolormaps, sizeof(int));
+      cmapsets    = numcolormaps;
+      cmaprows    = 0;
+
+      for(int t = 0; t < numcolormaps; t++)
+      {
+         int count = colormaplengths[t] / 256;
+
+         if(cmaprows + count <= maxtexsize)
+         {
+            cmaprowbase[t] = cmaprows;
+            cmaprows += count;
+         }
+      }
+
+      rows = emalloc(byte *, cmaprows * 256);
+      for(int t = 0; t < numcolormaps; t++)
+      {
+         if(t == 0 || cmaprowbase[t])
+            memcpy(rows + cmaprowbase[t] * 256, colormaps[t], colormaplengths[t] / 256 * 256);
+      }
+
+      cmaptex = GL_makeTableTexture(GLW_UNIT_COLORMAPS, 256, cmaprows, rows);
+      efree(rows);
+   }
+
+   if(!transtex)
+   {
+      byte *rows;
+
+      transrows = numtranslations < maxtexsize ? numtranslations : maxtexsize;
+      if(transrows < 1)
+         transrows = 1;
+
+      rows = ecalloc(byte *, transrows, 256);
+      for(int i = 0; i < transrows && i < numtranslations; i++)
+         memcpy(rows + i * 256, translationtables[i], 256);
+
+      transtex = GL_makeTableTexture(GLW_UNIT_TRANSLATIONS, 256, transrows, rows);
+      efree(rows);
+   }
+}
+
+//
+// GL_freeTarget
+//
+static void GL_freeTarget()
+{
+   if(fbo)
+   {
+      pglDeleteFramebuffers(1, &fbo);
+      fbo = 0;
+   }
+   if(colorrb)
+   {
+      pglDeleteRenderbuffers(1, &colorrb);
+      colorrb = 0;
+   }
+   if(depthrb)
+   {
+      pglDeleteRenderbuffers(1, &depthrb);
+      depthrb = 0;
+   }
+   GL_deleteTexture(behindtex);
+   targetwidth = targetheight = 0;
+}
+
+//
+// GL_setupTarget
+//
+// Makes the offscreen framebuffer match the view window. Its color holds a
+// palette index in the red channel of each pixel.
+//
+static bool GL_setupTarget(int width, int height)
+{
+   if(fbo && targetwidth == width && targetheight == height)
+      return true;
+
+   GL_freeTarget();
+
+   pglGenRenderbuffers(1, &colorrb);
+   pglBindRenderbuffer(GL_RENDERBUFFER, colorrb);
+   pglRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+   pglGenRenderbuffers(1, &depthrb);
+   pglBindRenderbuffer(GL_RENDERBUFFER, depthrb);
+   pglRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+   pglBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+   pglGenFramebuffers(1, &fbo);
+   pglBindFramebuffer(GL_FRAMEBUFFER, fbo);
+   pglFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorrb);
+   pglFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_RENDERBUFFER, depthrb);
+
+   if(pglCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+   {
+      pglBindFramebuffer(GL_FRAMEBUFFER, 0);
+      GL_freeTarget();
+      return false;
+   }
+   pglBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+   pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_BEHIND);
+   glGenTextures(1, &behindtex);
+   glBindTexture(GL_TEXTURE_2D, behindtex);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+   pglActiveTexture(GL_TEXTURE0);
+
+   targetwidth  = width;
+   targetheight = height;
+   return true;
+}
+
+//=============================================================================
+//
+// Atlas
+//
+
+//
+// GL_growBuffer
+//
+// Makes sure a scratch buffer holds at least size bytes.
+//
+static byte *GL_growBuffer(byte *&buffer, size_t &cursize, size_t size)
+{
+   if(size > cursize)
+   {
+      buffer  = erealloc(byte *, buffer, size);
+      cursize = size;
+   }
+   return buffer;
+}
+
+//
+// GL_flushGraphics
+//
+// Empties the atlas and the blend map textures.
+//
+static void GL_flushGraphics()
+{
+   for(int i = 0; i < numpages; i++)
+      GL_deleteTexture(glpages[i].tex);
+   numpages   = 0;
+   sharedpage = -1;
+
+   for(int i = 0; i < GLW_NUMBLENDTEX; i++)
+   {
+      GL_deleteTexture(blendtextures[i].tex);
+      blendtextures[i].map = NULL;
+   }
+   nextblendtex = 0;
+
+   if(glgraphics)
+   {
+      efree(glgraphics);
+      glgraphics = NULL;
+      numglkeys  = 0;
+   }
+}
+
+//
+// GL_setupGraphics
+//
+// Allocates the per-key tables, if needed.
+//
+static void GL_setupGraphics()
+{
+   if(!glgraphics)
+   {
+      numglkeys  = texturecount + numspritelumps;
+      glgraphics = emalloc(glwgraphic_t *, numglkeys * sizeof(glwgraphic_t));
+      for(int i = 0; i < numglkeys; i++)
+         glgraphics[i].page = GLW_UNMADE;
+   }
+}
+
+//
+// GL_newPage
+//
+static int GL_newPage(int width, int height)
+{
+   glwpage_t *page;
+
+   if(numpages == maxpages)
+   {
+      maxpages = maxpages ? maxpages * 2 : 8;
+      glpages  = erealloc(glwpage_t *, glpages, maxpages * sizeof(glwpage_t));
+   }
+
+   page = &glpages[numpages];
+   page->width  = width;
+   page->height = height;
+   page->shelfx = page->shelfy = page->shelfh = 0;
+
+   glGenTextures(1, &page->tex);
+   glBindTexture(GL_TEXTURE_2D, page->tex);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8_ALPHA8, width, height, 0,
+                GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, NULL);
+
+   return numpages++;
+}
+
+//
+// GL_addGraphic
+//
+// Puts column-major 8-bit graphic data into the atlas. Pixels with a zero in
+// mask, if there is one, are transparent. Graphics bigger than a shared page
+// get a page of their own.
+//
+static void GL_addGraphic(glwgraphic_t &g, const byte *source, const byte *mask,
+                          int width, int height)
+{
+   int x = 0, y = 0;
+
+   if(width <= 0 || height <= 0 || width > maxtexsize || height > maxtexsize)
+   {
+      g.page = GLW_UNUSABLE;
+      return;
+   }
+
+   if(width > pagesize || height > pagesize)
+      g.page = GL_newPage(width, height);
+   else
+   {
+      glwpage_t *page = sharedpage >= 0 ? &glpages[sharedpage] : NULL;
+
+      if(page && page->shelfx + width > page->width)
+      {
+         page->shelfy += page->shelfh;
+         page->shelfx  = 0;
+         page->shelfh  = 0;
+      }
+      if(!page || page->shelfy + height > page->height)
+      {
+         sharedpage = GL_newPage(pagesize, pagesize);
+         page = &glpages[sharedpage];
+      }
+
+      x = page->shelfx;
+      y = page->shelfy;
+      page->shelfx += width;
+      if(height > page->shelfh)
+         page->shelfh = height;
+
+      g.page = sharedpage;
+   }
+
+   g.rect[0] = (GLfloat)x;
+   g.rect[1] = (GLfloat)y;
+   g.rect[2] = (GLfloat)width;
+   g.rect[3] = (GLfloat)height;
+
+   // rows of index and opacity pairs
+   byte *dest = GL_growBuffer(glpixels, glpixelsize, width * height * 2);
+
+   for(int col = 0; col < width; col++)
+   {
+      for(int row = 0; row < height; row++)
+      {
+         int ofs = col * height + row;
+
+         dest[(row * width + col) * 2    ] = source[ofs];
+         dest[(row * width + col) * 2 + 1] = (!mask || mask[ofs]) ? 0xff : 0;
+      }
+   }
+
+   glBindTexture(GL_TEXTURE_2D, glpages[g.page].tex);
+   glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_LUMINANCE_ALPHA,
+                   GL_UNSIGNED_BYTE, dest);
+   glPopClientAttrib();
+}
+
+//
+// GL_addWallGraphic
+//
+static void GL_addWallGraphic(glwgraphic_t &g, int texnum)
+{
+   texture_t *tex  = R_CacheTexture(texnum);
+   byte      *mask = NULL;
+
+   // masked textures are only opaque in their column runs
+   if(tex->flags & TF_MASKED)
+   {
+      mask = GL_growBuffer(glmask, glmasksize, tex->width * tex->height);
+      memset(mask, 0, tex->width * tex->height);
+
+      for(int x = 0; x < tex->width; x++)
+      {
+         for(const texcol_t *col = tex->columns[x]; col; col = col->next)
+            memset(mask + col->ptroff, 1, col->len);
+      }
+   }
+
+   GL_addGraphic(g, tex->buffer, mask, tex->width, tex->height);
+}
+
+//
+// GL_addSpriteGraphic
+//
+static void GL_addSpriteGraphic(glwgraphic_t &g, int lump)
+{
+   patch_t *patch  = PatchLoader::CacheNum(wGlobalDir, lump + firstspritelump, PU_CACHE);
+   int      width  = patch->width;
+   int      height = patch->height;
+   byte    *source = GL_growBuffer(glsource, glsourcesize, width * height);
+   byte    *mask   = GL_growBuffer(glmask,   glmasksize,   width * height);
+
+   memset(mask, 0, width * height);
+
+   for(int x = 0; x < width; x++)
+   {
+      const column_t *column =
+         (const column_t *)((const byte *)patch + patch->columnofs[x]);
+
+      while(column->topdelta != 0xff)
+      {
+         const byte *pixels = (const byte *)column + 3;
+
+         for(int i = 0; i < column->length && column->topdelta + i < height; i++)
+         {
+            source[x * height + column->topdelta + i] = pixels[i];
+            mask  [x * height + column->topdelta + i] = 1;
+         }
+
+         column = (const column_t *)((const byte *)column + column->length + 4);
+      }
+   }
+
+   GL_addGraphic(g, source, mask, width, height);
+}
+
+//
+// GL_getGraphic
+//
+// Returns where a key's graphic is in the atlas, putting it there first if
+// need be.
+//
+static const glwgraphic_t &GL_getGraphic(int key)
+{
+   glwgraphic_t &g = glgraphics[key];
+
+   if(g.page == GLW_UNMADE)
+   {
+      if(key < texturecount)
+         GL_addWallGraphic(g, key);
+      else
+         GL_addSpriteGraphic(g, key - texturecount);
+   }
+
+   return g;
+}
+
+//
+// GL_getBlendTexture
+//
+// Returns a texture of a 64K blend map on its unit, making it if need be.
+//
+static GLuint GL_getBlendTexture(const byte *map)
+{
+   glwblendtex_t *bt;
+
+   for(int i = 0; i < GLW_NUMBLENDTEX; i++)
+   {
+      if(blendtextures[i].map == map)
+         return blendtextures[i].tex;
+   }
+
+   bt = &blendtextures[nextblendtex];
+   nextblendtex = (nextblendtex + 1) % GLW_NUMBLENDTEX;
+
+   GL_deleteTexture(bt->tex);
+   bt->tex = GL_makeTableTexture(GLW_UNIT_BLENDMAP, 256, 256, map);
+   bt->map = map;
+
+   return bt->tex;
+}
+
+//=============================================================================
+//
+// Subsector Outlines
+//
+
+//
+// GL_clipPoly
+//
+// Cuts a convex outline by a line, keeping the part on its right side.
+// Outlines that have grown too big are passed through uncut.
+//
+static int GL_clipPoly(const glwpoint_t *in, int numin, glwpoint_t *out,
+                       double lx, double ly, double ldx, double ldy)
+{
+   double len = sqrt(ldx * ldx + ldy * ldy);
+   int    numout = 0;
+
+   if(len == 0.0 || numin >= MAXGLWPOINTS)
+   {
+      memcpy(out, in, numin * sizeof(glwpoint_t));
+      return numin;
+   }
+
+   for(int i = 0; i < numin; i++)
+   {
+      const glwpoint_t &a = in[i];
+      const glwpoint_t &b = in[(i + 1) % numin];
+      double da = ((a.x - lx) * ldy - (a.y - ly) * ldx) / len + GLW_EPSILON;
+      double db = ((b.x - lx) * ldy - (b.y - ly) * ldx) / len + GLW_EPSILON;
+
+      if(da >= 0.0)
+         out[numout++] = a;
+
+      if((da >= 0.0) != (db >= 0.0))
+      {
+         double frac = da / (da - db);
+
+         out[numout].x = a.x + (b.x - a.x) * frac;
+         out[numout].y = a.y + (b.y - a.y) * frac;
+         ++numout;
+      }
+   }
+
+   return numout;
+}
+
+//
+// GL_finishSubsectorPoly
+//
+// Cuts a subsector's outline down by its segs and stores it.
+//
+static void GL_finishSubsectorPoly(int num, const glwpoint_t *poly, int numpoints)
+{
+   glwpoint_t  cur[MAXGLWPOINTS], next[MAXGLWPOINTS];
+   subsector_t &ss = subsectors[num];
+
+   memcpy(cur, poly, numpoints * sizeof(glwpoint_t));
+
+   for(int i = 0; i < ss.numlines; i++)
+   {
+      const seg_t &seg = segs[ss.firstline + i];
+      int numnext = GL_clipPoly(cur, numpoints, next, seg.v1->fx, seg.v1->fy,
+                                seg.v2->fx - seg.v1->fx, seg.v2->fy - seg.v1->fy);
+
+      // a seg that would wipe the outline out is a nodebuilder error
+      if(numnext >= 3)
+      {
+         memcpy(cur, next, numnext * sizeof(glwpoint_t));
+         numpoints = numnext;
+      }
+   }
+
+   if(numpoints < 3)
+      return;
+
+   if(numbuildpoints + numpoints > maxbuildpoints)
+   {
+      maxbuildpoints = (maxbuildpoints + numpoints) * 2;
+      buildpoints = erealloc(float *, buildpoints, maxbuildpoints * 2 * sizeof(float));
+   }
+
+   subpolys[num].firstpoint = numbuildpoints;
+   subpolys[num].numpoints  = numpoints;
+
+   for(int i = 0; i < numpoints; i++)
+   {
+      buildpoints[numbuildpoints * 2    ] = (float)cur[i].x;
+      buildpoints[numbuildpoints * 2 + 1] = (float)cur[i].y;
+      ++numbuildpoints;
+   }
+}
+
+//
+// GL_buildNodePolys
+//
+// Splits an outline by a node's partition and passes each side on to that
+// child.
+//
+static void GL_buildNodePolys(int bspnum, const glwpoint_t *poly, int numpoints)
+{
+   glwpoint_t side[MAXGLWPOINTS];
+   int        numside;
+
+   if(numpoints < 3)
+      return;
+
+   if(bspnum & NF_SUBSECTOR)
+   {
+      GL_finishSubsectorPoly(bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR, poly, numpoints);
+      return;
+   }
+
+   const node_t &node = nodes[bspnum];
+   double x  = M_FixedToDouble(node.x);
+   double y  = M_FixedToDouble(node.y);
+   double dx = M_FixedToDouble(node.dx);
+   double dy = M_FixedToDouble(node.dy);
+
+   // the front child is on the right of the partition
+   numside = GL_clipPoly(poly, numpoints, side, x, y, dx, dy);
+   GL_buildNodePolys(node.children[0], side, numside);
+
+   numside = GL_clipPoly(poly, numpoints, side, x, y, -dx, -dy);
+   GL_buildNodePolys(node.children[1], side, numside);
+}
+
+//
+// GL_buildSubsectorPolys
+//
+static void GL_buildSubsectorPolys()
+{
+   glwpoint_t box[4];
+   double     minx = 0.0, miny = 0.0, maxx = 0.0, maxy = 0.0;
+
+   for(int i = 0; i < numvertexes; i++)
+   {
+      if(!i || vertexes[i].fx < minx)
+         minx = vertexes[i].fx;
+      if(!i || vertexes[i].fx > maxx)
+         maxx = vertexes[i].fx;
+      if(!i || vertexes[i].fy < miny)
+         miny = vertexes[i].fy;
+      if(!i || vertexes[i].fy > maxy)
+         maxy = vertexes[i].fy;
+   }
+
+   box[0].x = minx - 64.0; box[0].y = miny - 64.0;
+   box[1].x = minx - 64.0; box[1].y = maxy + 64.0;
+   box[2].x = maxx + 64.0; box[2].y = maxy + 64.0;
+   box[3].x = maxx + 64.0; box[3].y = miny - 64.0;
+
+   subpolys = ecalloctag(glwsubpoly_t *, numsubsectors, sizeof(glwsubpoly_t), PU_LEVEL,
+                         (void **)&subpolys);
+   numbuildpoints = 0;
+
+   GL_buildNodePolys(numnodes - 1, box, 4);
+
+   subpoints = emalloctag(float *, (numbuildpoints + 1) * 2 * sizeof(float), PU_LEVEL,
+                          (void **)&subpoints);
+   memcpy(subpoints, buildpoints, numbuildpoints * 2 * sizeof(float));
+}
+
+//=============================================================================
+//
+// Light
+//
+
+//
+// GL_sectorColormap
+//
+// Returns the colormap set a sector is drawn with, as R_SectorColormap
+// picks it.
+//
+static int GL_sectorColormap(const sector_t *s)
+{
+   int cm;
+
+   if(r_boomcolormaps)
+      s = view.sector;
+
+   // find which area the viewpoint is in
+   if(s->heightsec != -1 && view.sector->heightsec != -1)
+   {
+      const sector_t &hs = sectors[view.sector->heightsec];
+
+      if(viewz < hs.floorheight)
+         cm = s->bottommap;
+      else if(viewz > hs.ceilingheight)
+         cm = s->topmap;
+      else
+         cm = s->midmap;
+   }
+   else
+      cm = s->midmap;
+
+   return (cm >= 0 && cm < cmapsets) ? cm : 0;
+}
+
+//
+// GL_fixedLight
+//
+// Light of something drawn with one colormap row of its sector's set.
+//
+static glwlight_t GL_fixedLight(const sector_t *sec, int row)
+{
+   glwlight_t light;
+
+   light.start = (float)row;
+   light.kind  = GLW_LIGHTFIXED;
+   light.cmrow = cmaprowbase[GL_sectorColormap(sec)];
+   light.trans = -1;
+
+   return light;
+}
+
+//
+// GL_scaleLight
+//
+// Light of a wall or sprite, from a light number worked out the way the
+// software renderer does it.
+//
+static glwlight_t GL_scaleLight(const sector_t *sec, int lightnum)
+{
+   glwlight_t light;
+
+   if(fixedcolormap)
+      return GL_fixedLight(sec, viewplayer->fixedcolormap);
+
+   if(lightnum < 0)
+      lightnum = 0;
+   else if(lightnum >= LIGHTLEVELS)
+      lightnum = LIGHTLEVELS - 1;
+
+   light.start = (float)(((LIGHTLEVELS - LIGHTBRIGHT - lightnum) * 2) * NUMCOLORMAPS / LIGHTLEVELS);
+   light.kind  = GLW_LIGHTSCALE;
+   light.cmrow = cmaprowbase[GL_sectorColormap(sec)];
+   light.trans = -1;
+
+   return light;
+}
+
+//
+// GL_planeLight
+//
+// Light of a flat, as R_PlaneLight works it out.
+//
+static glwlight_t GL_planeLight(const sector_t *sec, int lightlevel)
+{
+   glwlight_t light;
+
+   if(fixedcolormap)
+      return GL_fixedLight(sec, viewplayer->fixedcolormap);
+
+   light.start = 2.0f * (30.0f - (lightlevel / 8.0f));
+   light.kind  = GLW_LIGHTPLANE;
+   light.cmrow = cmaprowbase[GL_sectorColormap(sec)];
+   light.trans = -1;
+
+   return light;
+}
+
+//=============================================================================
+//
+// Geometry
+//
+
+//
+// GL_newTriangles
+//
+// Returns room for count opaque triangles on an atlas page.
+//
+static glwvertex_t *GL_newTriangles(int page, int count)
+{
+   glwvertex_t *verts;
+
+   if(numtris + count > maxtris)
+   {
+      maxtris   = (maxtris + count) * 2;
+      triverts  = erealloc(glwvertex_t *, triverts,  maxtris * 3 * sizeof(glwvertex_t));
+      sortverts = erealloc(glwvertex_t *, sortverts, maxtris * 3 * sizeof(glwvertex_t));
+      trikeys   = erealloc(int *, trikeys, maxtris * sizeof(int));
+   }
+
+   for(int i = 0; i < count; i++)
+      trikeys[numtris + i] = page + 1;
+
+   verts = triverts + numtris * 3;
+   numtris += count;
+
+   return verts;
+}
+
+//
+// GL_newTransTriangles
+//
+// Returns room for count triangles laid over what's behind them.
+//
+static glwvertex_t *GL_newTransTriangles(int page, int count, int blend, const byte *map)
+{
+   glwtransitem_t *item;
+   glwvertex_t    *verts;
+
+   if(numtransverts + count * 3 > maxtransverts)
+   {
+      maxtransverts = (maxtransverts + count * 3) * 2;
+      transverts = erealloc(glwvertex_t *, transverts, maxtransverts * sizeof(glwvertex_t));
+   }
+   if(numtransitems == maxtransitems)
+   {
+      maxtransitems = maxtransitems ? maxtransitems * 2 : 64;
+      transitems = erealloc(glwtransitem_t *, transitems, maxtransitems * sizeof(glwtransitem_t));
+   }
+
+   item = &transitems[numtransitems++];
+   item->firstvert = numtransverts;
+   item->numverts  = count * 3;
+   item->page      = page;
+   item->blend     = blend;
+   item->map       = map;
+   item->depth     = 0.0f;
+
+   verts = transverts + numtransverts;
+   numtransverts += count * 3;
+
+   return verts;
+}
+
+//
+// GL_surfaceTriangles
+//
+// Returns room for a surface's triangles, in the opaque batches or among
+// the translucent ones as its blend says.
+//
+inline static glwvertex_t *GL_surfaceTriangles(const glwgraphic_t &g, int count,
+                                               int blend, const byte *map)
+{
+   if(blend == GLW_BLENDNONE)
+      return GL_newTriangles(g.page, count);
+   else
+      return GL_newTransTriangles(g.page, count, blend, map);
+}
+
+//
+// GL_setBase
+//
+// Fills in the parts of a vertex that are the same all over a surface.
+//
+static void GL_setBase(glwvertex_t &base, const glwgraphic_t &g, bool tile,
+                       const glwlight_t &light)
+{
+   base.tile = tile ? 1.0f : 0.0f;
+   memcpy(base.rect, g.rect, sizeof(base.rect));
+   base.light[0] = light.start;
+   base.light[1] = (GLfloat)light.kind;
+   base.light[2] = (GLfloat)light.cmrow;
+   base.light[3] = (GLfloat)light.trans;
+}
+
+//
+// GL_setVertex
+//
+inline static void GL_setVertex(glwvertex_t &v, const glwvertex_t &base,
+                                float x, float y, float z, float s, float t)
+{
+   v = base;
+   v.x = x;
+   v.y = y;
+   v.z = z;
+   v.s = s;
+   v.t = t;
+}
+
+//
+// GL_planeZ
+//
+inline static float GL_planeZ(const sector_t *sec, bool ceiling, float x, float y)
+{
+   pslope_t *slope = ceiling ? sec->c_slope : sec->f_slope;
+
+   if(slope)
+      return P_GetZAtf(slope, x, y);
+
+   return M_FixedToFloat(ceiling ? sec->ceilingheight : sec->floorheight);
+}
+
+//
+// GL_addWallPiece
+//
+// Adds the part of a seg between bottom and top at each end. texz is the
+// height the top of the texture would be at, before the row offset.
+//
+static void GL_addWallPiece(const seg_t *seg, int texnum, const float top[2],
+                            const float bottom[2], const float texz[2],
+                            const glwlight_t &light, int blend = GLW_BLENDNONE,
+                            const byte *map = NULL)
+{
+   const side_t *side = seg->sidedef;
+   float x[2] = { seg->v1->fx, seg->v2->fx };
+   float y[2] = { seg->v1->fy, seg->v2->fy };
+   float s[2], t[2][2];
+   glwvertex_t base;
+
+   if(top[0] <= bottom[0] && top[1] <= bottom[1])
+      return;
+
+   const glwgraphic_t &g = GL_getGraphic(texnum);
+   if(g.page < 0)
+      return;
+
+   // polyobject segs don't all have their length filled in
+   s[0] = seg->offset + M_FixedToFloat(side->textureoffset);
+   s[1] = s[0] + sqrtf((x[1] - x[0]) * (x[1] - x[0]) + (y[1] - y[0]) * (y[1] - y[0]));
+
+   for(int i = 0; i < 2; i++)
+   {
+      float rowofs = texz[i] + M_FixedToFloat(side->rowoffset);
+
+      t[i][0] = rowofs - top[i];
+      t[i][1] = rowofs - bottom[i];
+   }
+
+   GL_setBase(base, g, true, light);
+
+   // 0-3
+   // |\|
+   // 1-2
+   glwvertex_t *v = GL_surfaceTriangles(g, 2, blend, map);
+
+   GL_setVertex(v[0], base, x[0], y[0], top[0],    s[0], t[0][0]);
+   GL_setVertex(v[1], base, x[0], y[0], bottom[0], s[0], t[0][1]);
+   GL_setVertex(v[2], base, x[1], y[1], top[1],    s[1], t[1][0]);
+   v[3] = v[2];
+   v[4] = v[1];
+   GL_setVertex(v[5], base, x[1], y[1], bottom[1], s[1], t[1][1]);
+}
+
+//
+// GL_midTextureBlend
+//
+// Finds how a two-sided line's middle texture is laid over what's behind
+// it, as R_RenderMaskedSegRange does. Returns false if it isn't drawn.
+//
+static bool GL_midTextureBlend(const line_t *line, int &blend, const byte *&map)
+{
+   blend = GLW_BLENDNONE;
+   map   = NULL;
+
+   if(!general_translucency)
+      return true;
+
+   if(line->tranlump >= 0)
+   {
+      blend = GLW_BLENDMAP;
+      if(line->tranlump > 0)
+         map = (byte *)(wGlobalDir.cacheLumpNum(line->tranlump - 1, PU_STATIC));
+      else
+         map = main_tranmap;
+   }
+   else
+   {
+      if(line->alpha == 0.0f)
+         return false;
+
+      if(line->extflags & EX_ML_ADDITIVE)
+      {
+         blend = GLW_BLENDMAP;
+         map   = addblendmaps[V_BlendLevel(M_FloatToFixed(line->alpha))];
+      }
+      else if(line->alpha < 1.0f)
+      {
+         blend = GLW_BLENDMAP;
+         map   = flexblendmaps[V_BlendLevel(M_FloatToFixed(line->alpha))];
+      }
+   }
+
+   if(blend == GLW_BLENDMAP && !map)
+      blend = GLW_BLENDNONE;
+
+   return true;
+}
+
+//
+// GL_addSeg
+//
+static void GL_addSeg(const seg_t *seg)
+{
+   const line_t   *line  = seg->linedef;
+   const side_t   *side  = seg->sidedef;
+   const sector_t *front = seg->frontsector;
+   const sector_t *back  = seg->backsector;
+   float x[2] = { seg->v1->fx, seg->v2->fx };
+   float y[2] = { seg->v1->fy, seg->v2->fy };
+   float ff[2], fc[2], bf[2], bc[2], texz[2];
+   int   lightnum, texnum;
+   glwlight_t light;
+
+   if(!line || !side || !front)
+      return;
+
+   for(int i = 0; i < 2; i++)
+   {
+      ff[i] = GL_planeZ(front, false, x[i], y[i]);
+      fc[i] = GL_planeZ(front, true,  x[i], y[i]);
+   }
+
+   lightnum = (front->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT);
+
+   // fake contrast
+   if(LevelInfo.unevenLight)
+   {
+      if(line->v1->y == line->v2->y)
+         lightnum -= LIGHTBRIGHT;
+      else if(line->v1->x == line->v2->x)
+         lightnum += LIGHTBRIGHT;
+   }
+
+   light = GL_scaleLight(front, lightnum);
+
+   if(!back)
+   {
+      if(side->midtexture)
+      {
+         texnum = texturetranslation[side->midtexture];
+         for(int i = 0; i < 2; i++)
+            texz[i] = (line->flags & ML_DONTPEGBOTTOM) ? ff[i] + textures[texnum]->height : fc[i];
+         GL_addWallPiece(seg, texnum, fc, ff, texz, light);
+      }
+      return;
+   }
+
+   for(int i = 0; i < 2; i++)
+   {
+      bf[i] = GL_planeZ(back, false, x[i], y[i]);
+      bc[i] = GL_planeZ(back, true,  x[i], y[i]);
+   }
+
+   // upper texture; none between two skies
+   if(side->toptexture &&
+      !(R_IsSkyFlat(front->ceilingpic) && R_IsSkyFlat(back->ceilingpic)))
+   {
+      texnum = texturetranslation[side->toptexture];
+      for(int i = 0; i < 2; i++)
+         texz[i] = (line->flags & ML_DONTPEGTOP) ? fc[i] : bc[i] + textures[texnum]->height;
+      GL_addWallPiece(seg, texnum, fc, bc, texz, light);
+   }
+
+   // lower texture
+   if(side->bottomtexture)
+   {
+      texnum = texturetranslation[side->bottomtexture];
+      for(int i = 0; i < 2; i++)
+         texz[i] = (line->flags & ML_DONTPEGBOTTOM) ? fc[i] : bf[i];
+      GL_addWallPiece(seg, texnum, bf, ff, texz, light);
+   }
+
+   // masked middle texture, drawn once in the opening
+   int         blend;
+   const byte *map;
+
+   if(side->midtexture && GL_midTextureBlend(line, blend, map))
+   {
+      float top[2], bottom[2];
+      float rowoffset = M_FixedToFloat(side->rowoffset);
+
+      texnum = texturetranslation[side->midtexture];
+      for(int i = 0; i < 2; i++)
+      {
+         float opentop    = fc[i] < bc[i] ? fc[i] : bc[i];
+         float openbottom = ff[i] > bf[i] ? ff[i] : bf[i];
+         float textop;
+
+         texz[i] = (line->flags & ML_DONTPEGBOTTOM) ?
+            openbottom + textures[texnum]->height : opentop;
+         textop  = texz[i] + rowoffset;
+
+         top[i]    = textop < opentop ? textop : opentop;
+         bottom[i] = textop - textures[texnum]->height;
+         if(bottom[i] < openbottom)
+            bottom[i] = openbottom;
+      }
+      GL_addWallPiece(seg, texnum, top, bottom, texz, light, blend, map);
+   }
+}
+
+//
+// GL_addPolyobjSegs
+//
+// Adds the walls of the polyobject fragments in a subsector. The depth
+// buffer sorts them, so they needn't go through their own BSP.
+//
+static void GL_addPolyobjSegs(const subsector_t &ss)
+{
+   for(DLListItem<rpolyobj_t> *link = ss.polyList; link; link = link->dllNext)
+   {
+      for(dynaseg_t *ds = (*link)->dynaSegs; ds; ds = ds->subnext)
+         GL_addSeg(&ds->seg);
+   }
+}
+
+//
+// GL_addPlane
+//
+// Adds a subsector's floor or ceiling as a triangle fan.
+//
+static void GL_addPlane(const sector_t *sec, const glwsubpoly_t &poly, bool ceiling)
+{
+   const float *points = subpoints + poly.firstpoint * 2;
+   int          pic    = ceiling ? sec->ceilingpic : sec->floorpic;
+   float        xoffs  = M_FixedToFloat(ceiling ? sec->ceiling_xoffs : sec->floor_xoffs);
+   float        yoffs  = M_FixedToFloat(ceiling ? sec->ceiling_yoffs : sec->floor_yoffs);
+   int          lightsec = ceiling ? sec->ceilinglightsec : sec->floorlightsec;
+   glwvertex_t  base, *v;
+
+   if(R_IsSkyFlat(pic))
+   {
+      // only the depth matters
+      memset(&base, 0, sizeof(base));
+      v = GL_newTriangles(GLW_SKYKEY - 1, poly.numpoints - 2);
+   }
+   else
+   {
+      const glwgraphic_t &g = GL_getGraphic(texturetranslation[pic]);
+
+      if(g.page < 0)
+         return;
+
+      GL_setBase(base, g, true,
+                 GL_planeLight(sec, (lightsec != -1 ? &sectors[lightsec] : sec)->lightlevel));
+      v = GL_newTriangles(g.page, poly.numpoints - 2);
+   }
+
+   for(int i = 1; i < poly.numpoints - 1; i++)
+   {
+      const int corners[3] = { 0, i, i + 1 };
+
+      for(int j = 0; j < 3; j++)
+      {
+         float x = points[corners[j] * 2];
+         float y = points[corners[j] * 2 + 1];
+
+         GL_setVertex(*v++, base, x, y, GL_planeZ(sec, ceiling, x, y),
+                      x + xoffs, yoffs - y);
+      }
+   }
+}
+
+//
+// GL_spriteBlend
+//
+// Finds how a thing is laid over what's behind it, as R_ProjectSprite does.
+//
+static int GL_spriteBlend(const Mobj *thing, const byte *&map)
+{
+   map = NULL;
+
+   if(thing->flags & MF_SHADOW)
+      return GLW_BLENDFUZZ;
+
+   if(general_translucency)
+   {
+      if(thing->flags3 & MF3_TLSTYLEADD)
+         map = addblendmaps[V_BlendLevel(thing->translucency)];
+      else if(thing->flags4 & MF4_TLSTYLESUB)
+         map = main_submap;
+      else if(thing->translucency < FRACUNIT - 1)
+         map = flexblendmaps[V_BlendLevel(thing->translucency)];
+      else if(thing->flags & MF_TRANSLUCENT)
+         map = main_tranmap;
+   }
+
+   return map ? GLW_BLENDMAP : GLW_BLENDNONE;
+}
+
+//
+// GL_addSprite
+//
+static void GL_addSprite(Mobj *thing, const sector_t *sec, int lightnum)
+{
+   const spritedef_t   *sprdef;
+   const spriteframe_t *sprframe;
+   const byte *map;
+   fixed_t px, py, pz;
+   float   rotx, roty, tx, ty;
+   float   left, width, height, top, bottom;
+   float   x[2], y[2];
+   int     lump, blend;
+   bool    flip;
+   glwlight_t  light;
+   glwvertex_t base;
+
+   if((thing->flags2 & MF2_DONTDRAW) || !thing->translucency)
+      return;
+
+   if((unsigned int)thing->sprite >= (unsigned int)numsprites)
+      return;
+
+   sprdef = &sprites[thing->sprite];
+   if(!sprdef->spriteframes || (thing->frame & FF_FRAMEMASK) >= sprdef->numframes)
+      return;
+
+   if(view.lerp == FRACUNIT)
+   {
+      px = thing->x;
+      py = thing->y;
+      pz = thing->z;
+   }
+   else
+   {
+      px = lerpCoord(view.lerp, thing->prevpos.x, thing->x);
+      py = lerpCoord(view.lerp, thing->prevpos.y, thing->y);
+      pz = lerpCoord(view.lerp, thing->prevpos.z, thing->z);
+   }
+
+   tx   = M_FixedToFloat(px) - view.x;
+   ty   = M_FixedToFloat(py) - view.y;
+   roty = (ty * view.cos) + (tx * view.sin);
+
+   // behind the view, or the viewer itself
+   if(roty < 1.0f)
+      return;
+
+   rotx = (tx * view.cos) - (ty * view.sin);
+   if(rotx * view.xfoc > (view.width + 64.0f) * roty ||
+      -rotx * view.xfoc > (view.width + 64.0f) * roty)
+      return;
+
+   sprframe = &sprdef->spriteframes[thing->frame & FF_FRAMEMASK];
+
+   if(sprframe->rotate)
+   {
+      angle_t      ang = R_PointToAngle(px, py);
+      unsigned int rot = (ang - thing->angle + (unsigned int)(ANG45/2)*9) >> 29;
+      lump = sprframe->lump[rot];
+      flip = !!sprframe->flip[rot];
+   }
+   else
+   {
+      lump = sprframe->lump[0];
+      flip = !!sprframe->flip[0];
+   }
+
+   const glwgraphic_t &g = GL_getGraphic(texturecount + lump);
+   if(g.page < 0)
+      return;
+
+   width  = M_FixedToFloat(spritewidth[lump]);
+   height = (float)spriteheight[lump];
+   left   = flip ? width - M_FixedToFloat(spriteoffset[lump]) : M_FixedToFloat(spriteoffset[lump]);
+
+   // spread along the view's right vector
+   x[0] = M_FixedToFloat(px) - view.cos * left * thing->xscale;
+   y[0] = M_FixedToFloat(py) + view.sin * left * thing->xscale;
+   x[1] = x[0] + view.cos * width * thing->xscale;
+   y[1] = y[0] - view.sin * width * thing->xscale;
+
+   top    = M_FixedToFloat(pz - thing->floorclip) +
+            M_FixedToFloat(spritetopoffset[lump]) * thing->yscale;
+   bottom = top - height * thing->yscale;
+
+   // pick the colormap the way R_ProjectSprite does
+   if(fixedcolormap)
+      light = GL_fixedLight(sec, viewplayer->fixedcolormap);
+   else if(LevelInfo.useFullBright && (thing->frame & FF_FULLBRIGHT))
+      light = GL_fixedLight(sec, 0);
+   else
+      light = GL_scaleLight(sec, lightnum);
+
+   if(thing->colour && thing->colour - 1 < transrows)
+      light.trans = thing->colour - 1;
+
+   blend = GL_spriteBlend(thing, map);
+
+   GL_setBase(base, g, false, light);
+
+   glwvertex_t *v = GL_surfaceTriangles(g, 2, blend, map);
+   float s1 = flip ? width : 0.0f;
+   float s2 = flip ? 0.0f : width;
+
+   GL_setVertex(v[0], base, x[0], y[0], top,    s1, 0.0f);
+   GL_setVertex(v[1], base, x[0], y[0], bottom, s1, height);
+   GL_setVertex(v[2], base, x[1], y[1], top,    s2, 0.0f);
+   v[3] = v[2];
+   v[4] = v[1];
+   GL_setVertex(v[5], base, x[1], y[1], bottom, s2, height);
+}
+
+//
+// GL_addSubsector
+//
+static void GL_addSubsector(int num)
+{
+   const subsector_t &ss = subsectors[num];
+   sector_t          *sec = ss.sector;
+
+   if(pvssubsectors && !pvssubsectors[num])
+      return;
+
+   if(subpolys[num].numpoints >= 3)
+   {
+      GL_addPlane(sec, subpolys[num], false);
+      GL_addPlane(sec, subpolys[num], true);
+   }
+
+   if(ss.polyList)
+      GL_addPolyobjSegs(ss);
+
+   for(int i = 0; i < ss.numlines; i++)
+      GL_addSeg(&segs[ss.firstline + i]);
+
+   // things, once per sector
+   if(sec->validcount != validcount)
+   {
+      int lightnum = (sec->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT);
+
+      sec->validcount = validcount;
+      for(Mobj *thing = sec->thinglist; thing; thing = thing->snext)
+         GL_addSprite(thing, sec, lightnum);
+   }
+}
+
+//
+// GL_checkBBox
+//
+// Returns false if a box is entirely to one side of the view.
+//
+static bool GL_checkBBox(const fixed_t *bbox)
+{
+   bool inleft = false, inright = false;
+
+   for(int i = 0; i < 4; i++)
+   {
+      float tx   = M_FixedToFloat(bbox[(i & 1) ? BOXRIGHT : BOXLEFT]) - view.x;
+      float ty   = M_FixedToFloat(bbox[(i & 2) ? BOXTOP : BOXBOTTOM]) - view.y;
+      float rotx = (tx * view.cos) - (ty * view.sin);
+      float roty = (ty * view.cos) + (tx * view.sin);
+
+      if(rotx * view.xfoc + view.xcenter * roty >= 0.0f)
+         inleft = true;
+      if((view.width - view.xcenter) * roty - rotx * view.xfoc >= 0.0f)
+         inright = true;
+   }
+
+   return inleft && inright;
+}
+
+//
+// GL_walkNode
+//
+static void GL_walkNode(int bspnum)
+{
+   if(bspnum & NF_SUBSECTOR)
+   {
+      GL_addSubsector(bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR);
+      return;
+   }
+
+   if(pvsnodes && !pvsnodes[bspnum])
+      return;
+
+   const node_t &node = nodes[bspnum];
+
+   for(int i = 0; i < 2; i++)
+   {
+      if(GL_checkBBox(node.bbox[i]))
+         GL_walkNode(node.children[i]);
+   }
+}
+
+//
+// GL_addSky
+//
+// Makes the sky backdrop, in view window coordinates, mapped the way the
+// software renderer maps it.
+//
+static void GL_addSky()
+{
+   skyflat_t    *skyflat = R_SkyFlatForIndex(0);
+   skytexture_t *sky;
+   float         ystep = view.pspriteystep;
+   float         t1, t2;
+   double        an;
+   int           row;
+   glwvertex_t   base;
+
+   numskyverts = 0;
+
+   if(!skyflat || skyflat->texture < 0)
+      return;
+
+   const glwgraphic_t &g = GL_getGraphic(skyflat->texture);
+   if(g.page < 0)
+      return;
+
+   sky = R_GetSkyTexture(skyflat->texture);
+
+   if(demo_version >= 300 && sky->height < 200 && stretchsky)
+      ystep *= 0.5f;
+
+   t1 = M_FixedToFloat(sky->texturemid) - view.ycenter * ystep;
+   t2 = M_FixedToFloat(sky->texturemid) + (view.height - view.ycenter) * ystep;
+
+   // 1024 sky columns go around the view
+   an = (double)viewangle / (1 << ANGLETOSKYSHIFT) + (skyflat->columnoffset >> 16);
+
+   // sky is always drawn full bright
+   row = (!comp[comp_skymap] && fixedcolormap) ? viewplayer->fixedcolormap : 0;
+   GL_setBase(base, g, true, GL_fixedLight(view.sector, row));
+
+   for(int i = 0; i <= GLW_SKYSTRIPS; i++)
+   {
+      float  x   = view.width * i / GLW_SKYSTRIPS;
+      double col = an + atan2(view.xcenter - x, view.xfoc) * 512.0 / PI;
+
+      GL_setVertex(skyverts[numskyverts++], base, x, 0.0f,        0.0f, (float)col, t1);
+      GL_setVertex(skyverts[numskyverts++], base, x, view.height, 0.0f, (float)col, t2);
+   }
+}
+
+//=============================================================================
+//
+// Drawing
+//
+
+//
+// GL_frustum
+//
+// Makes a matrix like glFrustum's.
+//
+static void GL_frustum(GLfloat *m, double l, double r, double b, double t,
+                       double n, double f)
+{
+   memset(m, 0, 16 * sizeof(GLfloat));
+   m[ 0] = (GLfloat)(2.0 * n / (r - l));
+   m[ 5] = (GLfloat)(2.0 * n / (t - b));
+   m[ 8] = (GLfloat)((r + l) / (r - l));
+   m[ 9] = (GLfloat)((t + b) / (t - b));
+   m[10] = (GLfloat)(-(f + n) / (f - n));
+   m[11] = -1.0f;
+   m[14] = (GLfloat)(-2.0 * f * n / (f - n));
+}
+
+//
+// GL_setupView
+//
+// Makes a projection matching the software renderer's, including its
+// y-shearing for looking up and down. It's upside down, so that the first
+// row of the target is the top of the view window.
+//
+static void GL_setupView()
+{
+   GLfloat *m = viewmatrix;
+   double  xscale = GLW_ZNEAR / view.xfoc;
+   double  yscale = GLW_ZNEAR / view.yfoc;
+   float   fx = view.sin, fy = view.cos; // forward
+   float   rx = view.cos, ry = -view.sin; // right
+
+   GL_frustum(projmatrix, -view.xcenter * xscale, (view.width - view.xcenter) * xscale,
+              view.ycenter * yscale, -(view.height - view.ycenter) * yscale,
+              GLW_ZNEAR, GLW_ZFAR);
+
+   // rows are right, up, and backward
+   m[0] = rx;   m[4] = ry;   m[ 8] = 0.0f; m[12] = -(rx * view.x + ry * view.y);
+   m[1] = 0.0f; m[5] = 0.0f; m[ 9] = 1.0f; m[13] = -view.z;
+   m[2] = -fx;  m[6] = -fy;  m[10] = 0.0f; m[14] = fx * view.x + fy * view.y;
+   m[3] = 0.0f; m[7] = 0.0f; m[11] = 0.0f; m[15] = 1.0f;
+}
+
+//
+// GL_eyeDepth
+//
+inline static float GL_eyeDepth(const glwvertex_t &v)
+{
+   const GLfloat *m = viewmatrix;
+
+   return -(m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14]);
+}
+
+//
+// GL_screenBox
+//
+// Finds the part of the target some triangles cover, with a pixel to spare
+// all around. Anything reaching behind the near plane covers all of it.
+//
+static void GL_screenBox(const glwvertex_t *verts, int count, int box[4])
+{
+   float x1 = (float)targetwidth, y1 = (float)targetheight, x2 = 0.0f, y2 = 0.0f;
+
+   for(int i = 0; i < count; i++)
+   {
+      const glwvertex_t &v = verts[i];
+      float eye[3], cx, cy, w;
+
+      for(int j = 0; j < 3; j++)
+         eye[j] = viewmatrix[j] * v.x + viewmatrix[4 + j] * v.y + viewmatrix[8 + j] * v.z + viewmatrix[12 + j];
+
+      w = -eye[2];
+      if(w < GLW_ZNEAR)
+      {
+         x1 = y1 = 0.0f;
+         x2 = (float)targetwidth;
+         y2 = (float)targetheight;
+         break;
+      }
+
+      cx = projmatrix[0] * eye[0] + projmatrix[8] * eye[2];
+      cy = projmatrix[5] * eye[1] + projmatrix[9] * eye[2];
+      cx = (cx / w * 0.5f + 0.5f) * targetwidth;
+      cy = (cy / w * 0.5f + 0.5f) * targetheight;
+
+      x1 = cx < x1 ? cx : x1;
+      x2 = cx > x2 ? cx : x2;
+      y1 = cy < y1 ? cy : y1;
+      y2 = cy > y2 ? cy : y2;
+   }
+
+   box[0] = emax((int)floorf(x1) - 1, 0);
+   box[1] = emax((int)floorf(y1) - 1, 0);
+   box[2] = emin((int)ceilf(x2)  + 1, targetwidth);
+   box[3] = emin((int)ceilf(y2)  + 1, targetheight);
+}
+
+//
+// GL_setAttribs
+//
+// Points the program's attributes into the vertex buffer.
+//
+static void GL_setAttribs()
+{
+   const GLsizei stride = sizeof(glwvertex_t);
+
+   pglVertexAttribPointer(GLW_ATTR_POS,   3, GL_FLOAT, GL_FALSE, stride,
+                          (const GLvoid *)offsetof(glwvertex_t, x));
+   pglVertexAttribPointer(GLW_ATTR_ST,    3, GL_FLOAT, GL_FALSE, stride,
+                          (const GLvoid *)offsetof(glwvertex_t, s));
+   pglVertexAttribPointer(GLW_ATTR_RECT,  4, GL_FLOAT, GL_FALSE, stride,
+                          (const GLvoid *)offsetof(glwvertex_t, rect));
+   pglVertexAttribPointer(GLW_ATTR_LIGHT, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const GLvoid *)offsetof(glwvertex_t, light));
+
+   for(int i = GLW_ATTR_POS; i <= GLW_ATTR_LIGHT; i++)
+      pglEnableVertexAttribArray(i);
+}
+
+//
+// GL_bindPage
+//
+static void GL_bindPage(int page)
+{
+   glBindTexture(GL_TEXTURE_2D, glpages[page].tex);
+   pglUniform2f(uniforms.atlassize, (GLfloat)glpages[page].width,
+                (GLfloat)glpages[page].height);
+}
+
+//
+// GL_sortTriangles
+//
+// Groups the frame's opaque triangles by key with a counting sort. The sky
+// flats come first, so nothing behind them is drawn over the sky.
+//
+static void GL_sortTriangles()
+{
+   int start = 0;
+
+   if(maxkeys < numpages + 1)
+   {
+      maxkeys   = numpages + 1;
+      keycounts = erealloc(int *, keycounts, maxkeys * sizeof(int));
+      usedkeys  = erealloc(int *, usedkeys,  maxkeys * sizeof(int));
+   }
+   memset(keycounts, 0, maxkeys * sizeof(int));
+
+   numusedkeys = 1;
+   usedkeys[0] = GLW_SKYKEY;
+
+   for(int i = 0; i < numtris; i++)
+   {
+      int key = trikeys[i];
+
+      if(!keycounts[key]++ && key != GLW_SKYKEY)
+         usedkeys[numusedkeys++] = key;
+   }
+
+   // turn the counts into where each group starts
+   for(int i = 0; i < numusedkeys; i++)
+   {
+      int count = keycounts[usedkeys[i]];
+
+      keycounts[usedkeys[i]] = start;
+      start += count;
+   }
+
+   for(int i = 0; i < numtris; i++)
+      memcpy(sortverts + keycounts[trikeys[i]]++ * 3, triverts + i * 3, 3 * sizeof(glwvertex_t));
+}
+
+//
+// GL_drawBatches
+//
+// Draws each group of opaque triangles with one call. The sorted vertices
+// start at first in the vertex buffer.
+//
+static void GL_drawBatches(int first)
+{
+   int start = 0;
+
+   // each count is now where its group ends
+   for(int i = 0; i < numusedkeys; i++)
+   {
+      int key = usedkeys[i];
+      int end = keycounts[key];
+
+      if(end == start)
+         continue;
+
+      if(key == GLW_SKYKEY)
+      {
+         glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+         pglUniform1i(uniforms.depthonly, 1);
+         glDrawArrays(GL_TRIANGLES, first + start * 3, (end - start) * 3);
+         pglUniform1i(uniforms.depthonly, 0);
+         glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+      }
+      else
+      {
+         GL_bindPage(key - 1);
+         glDrawArrays(GL_TRIANGLES, first + start * 3, (end - start) * 3);
+      }
+
+      start = end;
+   }
+}
+
+//
+// GL_compareTransItems
+//
+// Far before near; things at the same depth in the order they were found.
+//
+static int GL_compareTransItems(const void *a, const void *b)
+{
+   const glwtransitem_t *ia = (const glwtransitem_t *)a;
+   const glwtransitem_t *ib = (const glwtransitem_t *)b;
+
+   if(ia->depth != ib->depth)
+      return ia->depth > ib->depth ? -1 : 1;
+
+   return ia->firstvert - ib->firstvert;
+}
+
+//
+// GL_drawTranslucent
+//
+// Draws the translucent triangles from far to near. Before each group, what
+// it covers of the target so far is copied where the shader can look it up.
+// The translucent vertices start at first in the vertex buffer.
+//
+static void GL_drawTranslucent(int first)
+{
+   int         lastblend = -1;
+   const byte *lastmap   = NULL;
+
+   for(int i = 0; i < numtransitems; i++)
+   {
+      glwtransitem_t &item = transitems[i];
+      float depth = 0.0f;
+
+      for(int j = 0; j < item.numverts; j++)
+         depth += GL_eyeDepth(transverts[item.firstvert + j]);
+      item.depth = depth / item.numverts;
+   }
+
+   qsort(transitems, numtransitems, sizeof(glwtransitem_t), GL_compareTransItems);
+
+   glDepthMask(GL_FALSE);
+   pglUniform1f(uniforms.fuzzrow, (GLfloat)(cmaprowbase[global_cmap_index < cmapsets ?
+                                                          global_cmap_index : 0] + 6));
+   pglUniform1f(uniforms.fuzzseed, (GLfloat)(frameseed & 0xff));
+
+   for(int i = 0; i < numtransitems; i++)
+   {
+      const glwtransitem_t &item = transitems[i];
+      int box[4];
+
+      GL_screenBox(transverts + item.firstvert, item.numverts, box);
+      if(box[2] <= box[0] || box[3] <= box[1])
+         continue;
+
+      // making the blend map's texture may change the active unit
+      if(item.blend == GLW_BLENDMAP && item.map != lastmap)
+      {
+         GLuint tex = GL_getBlendTexture(item.map);
+
+         pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_BLENDMAP);
+         glBindTexture(GL_TEXTURE_2D, tex);
+         lastmap = item.map;
+      }
+
+      pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_BEHIND);
+      glCopyTexSubImage2D(GL_TEXTURE_2D, 0, box[0], box[1], box[0], box[1],
+                          box[2] - box[0], box[3] - box[1]);
+      pglActiveTexture(GL_TEXTURE0);
+
+      if(item.blend != lastblend)
+      {
+         pglUniform1i(uniforms.blend, item.blend);
+         lastblend = item.blend;
+      }
+
+      GL_bindPage(item.page);
+      glDrawArrays(GL_TRIANGLES, first + item.firstvert, item.numverts);
+   }
+
+   pglUniform1i(uniforms.blend, GLW_BLENDNONE);
+   glDepthMask(GL_TRUE);
+}
+
+//
+// GL_uploadVertices
+//
+// Streams the frame's vertices into the vertex buffer: the sky, then the
+// opaque triangles by key, then the translucent ones.
+//
+static void GL_uploadVertices()
+{
+   const size_t vsize = sizeof(glwvertex_t);
+   size_t       ofs   = 0;
+
+   pglBindBuffer(GL_ARRAY_BUFFER, worldvbo);
+   pglBufferData(GL_ARRAY_BUFFER,
+                 (numskyverts + numtris * 3 + numtransverts) * vsize, NULL, GL_STREAM_DRAW);
+
+   pglBufferSubData(GL_ARRAY_BUFFER, ofs, numskyverts * vsize, skyverts);
+   ofs += numskyverts * vsize;
+   pglBufferSubData(GL_ARRAY_BUFFER, ofs, numtris * 3 * vsize, sortverts);
+   ofs += numtris * 3 * vsize;
+   pglBufferSubData(GL_ARRAY_BUFFER, ofs, numtransverts * vsize, transverts);
+}
+
+//
+// GL_readBack
+//
+// Copies the target into the view window of the screen.
+//
+static void GL_readBack()
+{
+   glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+   glPixelStorei(GL_PACK_ALIGNMENT, 1);
+   glPixelStorei(GL_PACK_ROW_LENGTH, vbscreen.pitch);
+   glReadPixels(0, 0, targetwidth, targetheight, GL_RED, GL_UNSIGNED_BYTE,
+                vbscreen.data + viewwindow.y * vbscreen.pitch + viewwindow.x);
+   glPopClientAttrib();
+}
+
+//=============================================================================
+//
+// Interface
+//
+
+//
+// GL_WorldActive
+//
+// True when the world is to be drawn through GL.
+//
+bool GL_WorldActive()
+{
+   return worldactive;
+}
+
+//
+// GL_InitWorld
+//
+// Called by the video driver once its GL context is up, with the means to
+// find GL functions. Needs OpenGL 2.0 and framebuffer objects; returns false
+// and leaves the renderer off if they can't be had.
+//
+bool GL_InitWorld(void *(*getproc)(const char *))
+{
+   const char *extensions;
+
+   worldactive = false;
+
+   GL_GetVersion();
+   extensions = (const char *)glGetString(GL_EXTENSIONS);
+
+   if(GL_version.majorversion < 2)
+      return false;
+   if(GL_version.majorversion < 3 &&
+      !(extensions && strstr(extensions, "GL_ARB_framebuffer_object")))
+      return false;
+
+   if(!GL_loadProcs(getproc) || !GL_buildProgram())
+      return false;
+
+   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxtexsize);
+   pagesize = maxtexsize < GLW_PAGESIZE ? maxtexsize : GLW_PAGESIZE;
+
+   pglGenBuffers(1, &worldvbo);
+
+   worldactive = true;
+   return true;
+}
+
+//
+// GL_ShutdownWorld
+//
+// Called by the video driver before its GL context goes away.
+//
+void GL_ShutdownWorld()
+{
+   if(!worldprogram)
+      return;
+
+   GL_flushGraphics();
+   GL_freeTarget();
+   GL_deleteTexture(cmaptex);
+   GL_deleteTexture(transtex);
+
+   pglDeleteBuffers(1, &worldvbo);
+   worldvbo = 0;
+   pglDeleteProgram(worldprogram);
+   worldprogram = 0;
+
+   GL_ClearBoundTexture();
+   worldactive = false;
+}
+
+//
+// GL_RenderWorld
+//
+// Draws the view set up by R_SetupFrame into the view window of the screen.
+// Returns false if the view couldn't be drawn, in which case the renderer
+// turns itself off. Puts back the GL state the video driver relies on.
+//
+bool GL_RenderWorld()
+{
+   int first;
+
+   if(!GL_setupTarget(viewwindow.width, viewwindow.height))
+   {
+      worldactive = false;
+      return false;
+   }
+
+   // the outlines went away with the last level
+   if(!subpolys)
+   {
+      GL_buildSubsectorPolys();
+      GL_flushGraphics();
+   }
+
+   GL_setupTables();
+   GL_setupGraphics();
+   GL_setupView();
+   ++frameseed;
+
+   // gather
+   numtris = numtransverts = numtransitems = 0;
+   R_PVSBeginView();
+   GL_walkNode(numnodes - 1);
+   R_PVSEndView();
+   GL_addSky();
+
+   GL_sortTriangles();
+
+   // the video driver's vertex arrays may share state with attribute 0, so
+   // they're put back as they were afterward
+   glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+   GL_uploadVertices();
+
+   // draw
+   pglBindFramebuffer(GL_FRAMEBUFFER, fbo);
+   glViewport(0, 0, targetwidth, targetheight);
+   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+   pglUseProgram(worldprogram);
+   GL_setAttribs();
+   pglUniform2f(uniforms.viewsize,  (GLfloat)targetwidth, (GLfloat)targetheight);
+   pglUniform1i(uniforms.depthonly, 0);
+   pglUniform1f(uniforms.cmrows,    (GLfloat)cmaprows);
+   pglUniform1f(uniforms.transrows, (GLfloat)transrows);
+   pglUniform1f(uniforms.planebias, (GLfloat)(1 - extralight * LIGHTBRIGHT));
+   pglUniform1i(uniforms.blend,     GLW_BLENDNONE);
+
+   pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_COLORMAPS);
+   glBindTexture(GL_TEXTURE_2D, cmaptex);
+   pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_TRANSLATIONS);
+   glBindTexture(GL_TEXTURE_2D, transtex);
+   pglActiveTexture(GL_TEXTURE0 + GLW_UNIT_BEHIND);
+   glBindTexture(GL_TEXTURE_2D, behindtex);
+   pglActiveTexture(GL_TEXTURE0);
+
+   // the sky, in view window coordinates, behind everything
+   if(numskyverts)
+   {
+      static const GLfloat identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+      GLfloat ortho[16];
+
+      memset(ortho, 0, sizeof(ortho));
+      ortho[ 0] = 2.0f / targetwidth;
+      ortho[ 5] = 2.0f / targetheight;
+      ortho[10] = -1.0f;
+      ortho[12] = ortho[13] = -1.0f;
+      ortho[15] = 1.0f;
+
+      pglUniformMatrix4fv(uniforms.view, 1, GL_FALSE, identity);
+      pglUniformMatrix4fv(uniforms.proj, 1, GL_FALSE, ortho);
+      GL_bindPage(glgraphics[R_SkyFlatForIndex(0)->texture].page);
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, numskyverts);
+   }
+
+   pglUniformMatrix4fv(uniforms.view, 1, GL_FALSE, viewmatrix);
+   pglUniformMatrix4fv(uniforms.proj, 1, GL_FALSE, projmatrix);
+   glEnable(GL_DEPTH_TEST);
+   glDepthFunc(GL_LEQUAL);
+
+   first = numskyverts;
+   if(numtris)
+      GL_drawBatches(first);
+
+   first += numtris * 3;
+   if(numtransitems)
+      GL_drawTranslucent(first);
+
+   glDisable(GL_DEPTH_TEST);
+
+   GL_readBack();
+
+   // put back what the video driver expects
+   for(int i = GLW_ATTR_POS; i <= GLW_ATTR_LIGHT; i++)
+      pglDisableVertexAttribArray(i);
+   pglBindBuffer(GL_ARRAY_BUFFER, 0);
+   glPopClientAttrib();
+   pglUseProgram(0);
+   pglBindFramebuffer(GL_FRAMEBUFFER, 0);
+   glViewport(0, 0, (GLsizei)video.width, (GLsizei)video.height);
+   GL_ClearBoundTexture();
+
+   return true;
+}
+
+#endif
+
+// EOF
+
@@ -25,6 +25,15 @@
 
 #include "i_platform.h"
 
+#if defined(EE_FEATURE_SSE2)
+#if EE_CURRENT_COMPILER == EE_COMPILER_MSVC
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 int ee_current_platform = EE_CURRENT_PLATFORM;
 int ee_current_compiler = EE_CURRENT_COMPILER;
 
@@ -37,5 +46,86 @@ int ee_platform_flags[EE_PLATFORM_MAX] =
    0              // Unknown
 };
 
+//
+// I_CPUHasSSE2
+//
+// Returns true if the processor supports SSE2 and the SSE2 code paths have
+// been compiled in.
+//
+bool I_CPUHasSSE2()
+{
+#if defined(EE_FEATURE_SSE2)
+   static int hassse2 = -1;
+
+   if(hassse2 < 0)
+   {
+#if defined(_M_X64) || defined(__x86_64__)
+      hassse2 = 1; // part of the x86-64 baseline
+#elif EE_CURRENT_COMPILER == EE_COMPILER_MSVC
+      int info[4];
+      __cpuid(info, 1);
+      hassse2 = !!(info[3] & (1 << 26));
+#else
+      unsigned int eax, ebx, ecx, edx;
+      hassse2 = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+#endif
+   }
+
+   return !!hassse2;
+#else
+   return false;
+#endif
+}
+
+//
+// I_CPUHasAVX2
+//
+// Returns true if the processor supports AVX2, the operating system saves
+// the YMM registers on a context switch, and the AVX2 code paths have been
+// compiled in.
+//
+bool I_CPUHasAVX2()
+{
+#if defined(EE_FEATURE_AVX2)
+   static int hasavx2 = -1;
+
+   if(hasavx2 < 0)
+   {
+      unsigned int regs[4];
+      unsigned long long xcr0 = 0;
+
+      hasavx2 = 0;
+
+#if EE_CURRENT_COMPILER == EE_COMPILER_MSVC
+      __cpuid((int *)regs, 0);
+      if(regs[0] < 7)
+         return false;
+      __cpuid((int *)regs, 1);
+      if(!(regs[2] & (1 << 27)) || !(regs[2] & (1 << 28))) // OSXSAVE, AVX
+         return false;
+      xcr0 = _xgetbv(0);
+      __cpuidex((int *)regs, 7, 0);
+#else
+      if(__get_cpuid_max(0, 0) < 7)
+         return false;
+      __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+      if(!(regs[2] & bit_OSXSAVE) || !(regs[2] & bit_AVX))
+         return false;
+      unsigned int lo, hi;
+      __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+      xcr0 = ((unsigned long long)hi << 32) | lo;
+      __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+      // the OS must preserve both the XMM and the YMM state
+      hasavx2 = (xcr0 & 6) == 6 && (regs[1] & (1 << 5));
+   }
+
+   return !!hasavx2;
+#else
+   return false;
+#endif
+}
+
 // EOF
 
@@ -95,6 +95,39 @@ extern int ee_platform_flags[EE_PLATFORM_MAX];
 #define EE_PLATFORM_TEST(flags) \
    ((ee_platform_flags[ee_current_platform] & (flags)) == (flags))
 
+//
+// Processor features
+//
+// EE_FEATURE_SSE2 is defined when the compiler can emit SSE2 intrinsics.
+// Whether the processor we are running on has them is a separate question,
+// answered by I_CPUHasSSE2.
+//
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#define EE_FEATURE_SSE2
+#endif
+
+bool I_CPUHasSSE2();
+
+//
+// EE_FEATURE_AVX2 is defined when AVX2 intrinsics can be used inside
+// functions marked EE_AVX2_TARGET without building the whole program for
+// AVX2. As with SSE2, I_CPUHasAVX2 says whether they can actually be run.
+//
+
+#if defined(EE_FEATURE_SSE2)
+#if defined(__clang__) || \
+    (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define EE_FEATURE_AVX2
+#define EE_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define EE_FEATURE_AVX2
+#define EE_AVX2_TARGET
+#endif
+#endif
+
+bool I_CPUHasAVX2();
+
 #endif
 
 // EOF
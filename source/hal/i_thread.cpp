@@ -0,0 +1,316 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Hardware Abstraction Layer for Threads, and the worker pool built on
+//    top of it.
+//
+//-----------------------------------------------------------------------------
+
+#include "../z_zone.h"
+#include "../d_main.h"
+
+#include "i_thread.h"
+
+// drivers
+#ifdef _SDL_VER
+#include "../sdl/i_sdlthread.h"
+#endif
+
+// Singleton instance of HALThreads
+HALThreads i_halthreads;
+
+//=============================================================================
+//
+// Driver Selection
+//
+
+typedef void (*HAL_ThreadsInitFunc)();
+
+//
+// HAL Thread Driver Struct
+//
+struct halthreaddriveritem_t
+{
+   int id;                    // HAL driver ID number
+   const char *name;          // name of driver
+   HAL_ThreadsInitFunc Init;  // pointer to driver init routine, if supported
+};
+
+static halthreaddriveritem_t halThreadDrivers[] =
+{
+   // SDL Thread Driver
+   {
+      0,
+      "SDL Threads",
+#ifdef _SDL_VER
+      I_SDLInitThreads
+#else
+      NULL
+#endif
+   },
+
+   // Dummy: leaves i_halthreads zeroed, so everything runs serially
+   {
+      1,
+      "No Threads",
+      NULL
+   }
+};
+
+//
+// I_InitHALThreads
+//
+// Initialize the thread subsystem.
+//
+void I_InitHALThreads()
+{
+   for(size_t i = 0; i < earrlen(halThreadDrivers); i++)
+   {
+      if(halThreadDrivers[i].Init)
+      {
+         halThreadDrivers[i].Init();
+         break;
+      }
+   }
+}
+
+//=============================================================================
+//
+// Worker Pool
+//
+// The calling thread always participates in running jobs, so a pool with N
+// workers executes up to N + 1 jobs at once. All pool state is protected by
+// a single mutex; jobs are expected to be coarse enough that handing them
+// out one at a time under the lock is not a bottleneck.
+//
+
+#define MAXWORKERS 64
+
+static halthread_t *workers[MAXWORKERS];
+static int          numworkers;
+
+static halmutex_t  *poolmutex;
+static halcond_t   *workcond;   // signalled when jobs are posted or on quit
+static halcond_t   *donecond;   // signalled when the last job finishes
+
+static I_JobFunc    jobfunc;
+static void        *jobdata;
+static int          numjobs;    // jobs in the current batch
+static int          nextjob;    // next job index to hand out
+static int          jobsleft;   // jobs not yet finished
+static bool         poolquit;
+
+//
+// I_GetNumCPUs
+//
+// Returns the number of logical processors, or 1 if it can't be determined.
+//
+int I_GetNumCPUs()
+{
+   int num = i_halthreads.GetNumCPUs ? i_halthreads.GetNumCPUs() : 1;
+
+   return num < 1 ? 1 : num;
+}
+
+//
+// I_GetWorkerThreads
+//
+// Returns the number of running worker threads.
+//
+int I_GetWorkerThreads()
+{
+   return numworkers;
+}
+
+//
+// I_takeJob
+//
+// Hands out the next job index of the current batch, or -1 if there are none
+// left. Must be called with the pool mutex held.
+//
+static int I_takeJob()
+{
+   return nextjob < numjobs ? nextjob++ : -1;
+}
+
+//
+// I_finishJob
+//
+// Marks a job finished. Must be called with the pool mutex held.
+//
+static void I_finishJob()
+{
+   if(--jobsleft == 0)
+      i_halthreads.CondSignal(donecond);
+}
+
+//
+// I_workerThread
+//
+// Main loop of each worker.
+//
+static int I_workerThread(void *)
+{
+   i_halthreads.LockMutex(poolmutex);
+
+   while(!poolquit)
+   {
+      int job = I_takeJob();
+
+      if(job < 0)
+      {
+         i_halthreads.CondWait(workcond, poolmutex);
+         continue;
+      }
+
+      I_JobFunc func = jobfunc;
+      void     *data = jobdata;
+
+      i_halthreads.UnlockMutex(poolmutex);
+      func(job, data);
+      i_halthreads.LockMutex(poolmutex);
+
+      I_finishJob();
+   }
+
+   i_halthreads.UnlockMutex(poolmutex);
+
+   return 0;
+}
+
+//
+// I_ShutdownWorkerThreads
+//
+// Stops and joins all worker threads.
+//
+void I_ShutdownWorkerThreads()
+{
+   if(!numworkers)
+      return;
+
+   i_halthreads.LockMutex(poolmutex);
+   poolquit = true;
+   i_halthreads.CondBroadcast(workcond);
+   i_halthreads.UnlockMutex(poolmutex);
+
+   for(int i = 0; i < numworkers; i++)
+   {
+      i_halthreads.WaitThread(workers[i]);
+      workers[i] = NULL;
+   }
+
+   numworkers = 0;
+   poolquit   = false;
+}
+
+//
+// I_SetWorkerThreads
+//
+// Resizes the pool to the given number of workers. A count of 0 shuts the
+// pool down, after which I_RunJobs executes everything on the caller.
+//
+void I_SetWorkerThreads(int count)
+{
+   if(!i_halthreads.StartThread)
+      count = 0;
+   if(count > MAXWORKERS)
+      count = MAXWORKERS;
+   if(count < 0)
+      count = 0;
+
+   if(count == numworkers)
+      return;
+
+   I_ShutdownWorkerThreads();
+
+   if(!count)
+      return;
+
+   if(!poolmutex)
+   {
+      poolmutex = i_halthreads.NewMutex();
+      workcond  = i_halthreads.NewCond();
+      donecond  = i_halthreads.NewCond();
+   }
+
+   while(numworkers < count)
+   {
+      halthread_t *thread = i_halthreads.StartThread(I_workerThread, NULL);
+
+      if(!thread)
+      {
+         usermsg("I_SetWorkerThreads: could only start %d of %d threads",
+                 numworkers, count);
+         break;
+      }
+
+      workers[numworkers++] = thread;
+   }
+}
+
+//
+// I_RunJobs
+//
+// Runs func(0..count-1, data) across the worker pool and the calling thread,
+// returning once every job has finished. Jobs may run in any order.
+//
+void I_RunJobs(int count, I_JobFunc func, void *data)
+{
+   if(count <= 0)
+      return;
+
+   if(!numworkers || count == 1)
+   {
+      for(int i = 0; i < count; i++)
+         func(i, data);
+      return;
+   }
+
+   i_halthreads.LockMutex(poolmutex);
+
+   jobfunc  = func;
+   jobdata  = data;
+   numjobs  = count;
+   nextjob  = 0;
+   jobsleft = count;
+   i_halthreads.CondBroadcast(workcond);
+
+   // help out until there's nothing left to hand out
+   int job;
+   while((job = I_takeJob()) >= 0)
+   {
+      i_halthreads.UnlockMutex(poolmutex);
+      func(job, data);
+      i_halthreads.LockMutex(poolmutex);
+
+      I_finishJob();
+   }
+
+   while(jobsleft > 0)
+      i_halthreads.CondWait(donecond, poolmutex);
+
+   numjobs = nextjob = 0;
+
+   i_halthreads.UnlockMutex(poolmutex);
+}
+
+// EOF
+
@@ -0,0 +1,98 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Hardware Abstraction Layer for Threads, and the worker pool built on
+//    top of it.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef I_THREAD_H__
+#define I_THREAD_H__
+
+// Opaque handles; each driver casts these to its native types.
+struct halthread_t;
+struct halmutex_t;
+struct halcond_t;
+
+typedef int           (*HAL_ThreadFunc)(void *);
+
+typedef halthread_t  *(*HAL_StartThreadFunc)(HAL_ThreadFunc, void *);
+typedef void          (*HAL_WaitThreadFunc)(halthread_t *);
+typedef halmutex_t   *(*HAL_NewMutexFunc)();
+typedef void          (*HAL_MutexFunc)(halmutex_t *);
+typedef halcond_t    *(*HAL_NewCondFunc)();
+typedef void          (*HAL_CondFunc)(halcond_t *);
+typedef void          (*HAL_CondWaitFunc)(halcond_t *, halmutex_t *);
+typedef int           (*HAL_GetNumCPUsFunc)();
+
+//
+// HALThreads
+//
+// Like HALTimer, this is a POD structure of function pointers filled in by
+// the implementing layer. If no driver is available, StartThread is NULL
+// and the worker pool runs all jobs on the calling thread.
+//
+struct HALThreads
+{
+   HAL_StartThreadFunc  StartThread;   // start a thread running a function
+   HAL_WaitThreadFunc   WaitThread;    // wait for a thread to exit
+   HAL_NewMutexFunc     NewMutex;      // create a mutex
+   HAL_MutexFunc        FreeMutex;     // destroy a mutex
+   HAL_MutexFunc        LockMutex;     // lock a mutex
+   HAL_MutexFunc        UnlockMutex;   // unlock a mutex
+   HAL_NewCondFunc      NewCond;       // create a condition variable
+   HAL_CondFunc         FreeCond;      // destroy a condition variable
+   HAL_CondFunc         CondSignal;    // wake one waiter
+   HAL_CondFunc         CondBroadcast; // wake all waiters
+   HAL_CondWaitFunc     CondWait;      // wait on a condition (mutex held)
+   HAL_GetNumCPUsFunc   GetNumCPUs;    // number of logical processors
+};
+
+extern HALThreads i_halthreads;
+
+void I_InitHALThreads();
+
+//
+// Worker pool
+//
+// Jobs run by I_RunJobs must not touch the zone heap, the console, or any
+// other non-reentrant engine state, and must not call I_Error.
+//
+
+typedef void (*I_JobFunc)(int jobnum, void *data);
+
+// Storage class for a static variable that each thread has its own copy of
+#if defined(_MSC_VER)
+#define I_THREADLOCAL __declspec(thread)
+#else
+#define I_THREADLOCAL __thread
+#endif
+
+int  I_GetNumCPUs();
+int  I_GetWorkerThreads();
+void I_SetWorkerThreads(int count);
+void I_ShutdownWorkerThreads();
+void I_RunJobs(int numjobs, I_JobFunc func, void *data);
+
+#endif
+
+// EOF
+
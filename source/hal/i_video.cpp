@@ -180,6 +180,12 @@ int i_softbitdepth;
 // haleyjd 03/30/14: support for letterboxing narrow resolutions
 bool i_letterbox;
 
+// render in 32-bit color (software backend only)
+bool i_truecolor;
+
+// render at a fraction of the window size and blow it up (software backend)
+int i_softscale;
+
 //
 // I_FinishUpdate
 //
@@ -204,6 +210,9 @@ void I_SetPalette(byte *palette)
 {
    if(in_graphics_mode)             // killough 8/11/98
       i_video_driver->SetPalette(palette);
+
+   // truecolor drawing expands palette indices itself
+   V_SetPalette32(palette);
 }
 
 void I_ShutdownGraphics()
@@ -610,5 +619,17 @@ CONSOLE_VARIABLE(i_letterbox, i_letterbox, cf_buffered)
    I_SetMode();
 }
 
+VARIABLE_TOGGLE(i_truecolor, NULL, yesno);
+CONSOLE_VARIABLE(i_truecolor, i_truecolor, cf_buffered)
+{
+   I_SetMode();
+}
+
+VARIABLE_INT(i_softscale, NULL, 1, 4, NULL);
+CONSOLE_VARIABLE(i_softscale, i_softscale, cf_buffered)
+{
+   I_SetMode();
+}
+
 // EOF
 
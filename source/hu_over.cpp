@@ -41,6 +41,7 @@
 #include "hu_frags.h"
 #include "hu_over.h"
 #include "hu_stuff.h"
+#include "m_profile.h"
 #include "m_qstr.h"
 #include "p_info.h"
 #include "p_map.h"
@@ -48,6 +49,7 @@
 #include "r_draw.h"
 #include "s_sound.h"
 #include "st_stuff.h"
+#include "v_block.h"
 #include "v_font.h"
 #include "v_misc.h"
 #include "v_video.h"
@@ -78,6 +80,7 @@ enum
    ol_ammo,
    ol_key,
    ol_frag,
+   ol_profile,
    NUMOVERLAY
 };
 
@@ -88,6 +91,7 @@ static void HU_drawWeapons(int x, int y);
 static void HU_drawAmmo   (int x, int y);
 static void HU_drawKeys   (int x, int y);
 static void HU_drawFrags  (int x, int y);
+static void HU_drawProfile(int x, int y);
 
 // all overlay modules
 static overlay_t overlay[NUMOVERLAY] =
@@ -99,6 +103,7 @@ static overlay_t overlay[NUMOVERLAY] =
    { 0, 0, HU_drawAmmo    }, // ol_ammo
    { 0, 0, HU_drawKeys    }, // ol_key
    { 0, 0, HU_drawFrags   }, // ol_frag
+   { 0, 0, HU_drawProfile }, // ol_profile
 };
 
 // HUD styles
@@ -492,6 +497,106 @@ static void HU_drawStatus(int x, int y)
    HU_WriteText(tempstr.constPtr(), x, y);
 }
 
+//
+// Frame Profiler
+//
+// A rolling graph of the time taken by each stage of the last frames, newest
+// on the right, with a legend of average times and the latest frame's
+// counters underneath.
+//
+
+#define PROFGRAPHW     128 // frames shown
+#define PROFGRAPHH     48  // graph height
+#define PROFGRAPHSCALE 500 // microseconds per unit of height
+#define PROFAVERAGE    32  // frames averaged for the legend
+
+// graph colors for each stage
+static const byte profcolors[PROF_NUMSTAGES][3] =
+{
+   { 255, 255, 255 }, // setupframe
+   {   0, 255,   0 }, // bsp
+   { 255,   0, 255 }, // portals
+   {   0, 128, 255 }, // planes
+   { 255, 128,   0 }, // postbsp
+   { 255, 255,   0 }, // hud
+   { 255,   0,   0 }, // finishupdate
+};
+
+//
+// HU_drawProfile
+//
+static void HU_drawProfile(int x, int y)
+{
+   byte *playpal = (byte *)(wGlobalDir.cacheLumpName("PLAYPAL", PU_CACHE));
+   byte  colors[PROF_NUMSTAGES];
+   int   numframes = M_ProfileNumFrames();
+   int   numaverage;
+   int   i, age;
+   qstring tempstr;
+   const profframe_t *latest;
+
+   for(i = 0; i < PROF_NUMSTAGES; i++)
+   {
+      colors[i] = V_FindBestColor(playpal, profcolors[i][0], profcolors[i][1], 
+                                  profcolors[i][2]);
+   }
+
+   V_ColorBlockScaled(&subscreen43, GameModeInfo->blackIndex, x, y, PROFGRAPHW, 
+                      PROFGRAPHH);
+
+   // stack the stages of each frame up from the bottom of the graph
+   for(age = 0; age < numframes && age < PROFGRAPHW; age++)
+   {
+      const profframe_t *frame = M_ProfileFrame(age);
+      int fx = x + PROFGRAPHW - 1 - age;
+      unsigned int total = 0;
+      int top, bottom = 0;
+
+      for(i = 0; i < PROF_NUMSTAGES && bottom < PROFGRAPHH; i++)
+      {
+         total += frame->stages[i];
+         if((top = int(total / PROFGRAPHSCALE)) > PROFGRAPHH)
+            top = PROFGRAPHH;
+         if(top > bottom)
+         {
+            V_ColorBlockScaled(&subscreen43, colors[i], fx, y + PROFGRAPHH - top, 
+                               1, top - bottom);
+            bottom = top;
+         }
+      }
+   }
+
+   y += PROFGRAPHH + 2;
+
+   if(!(latest = M_ProfileFrame(0)))
+      return;
+
+   numaverage = numframes < PROFAVERAGE ? numframes : PROFAVERAGE;
+
+   for(i = 0; i < PROF_NUMSTAGES; i++)
+   {
+      unsigned int sum = 0;
+
+      for(age = 0; age < numaverage; age++)
+         sum += M_ProfileFrame(age)->stages[i];
+
+      V_ColorBlockScaled(&subscreen43, colors[i], x, y + 2, 4, 4);
+
+      tempstr.Printf(64, HUDCOLOR "%s " FC_GREEN "%.2f", prof_stagenames[i], 
+                     sum / (numaverage * 1000.0));
+      HU_WriteText(tempstr.constPtr(), x + 6, y);
+      y += 8;
+   }
+
+   for(i = 0; i < PROF_NUMCOUNTERS; i++)
+   {
+      tempstr.Printf(64, HUDCOLOR "%s " FC_GREEN "%u", prof_counternames[i], 
+                     latest->counters[i]);
+      HU_WriteText(tempstr.constPtr(), x + 6, y);
+      y += 8;
+   }
+}
+
 //
 // HU_overlaySetup
 //
@@ -504,6 +609,9 @@ static void HU_overlaySetup()
    for(i = 0; i < NUMOVERLAY; i++)
       overlay[i].x = 1;       // turn em all on
 
+   // the profiler is placed on its own below
+   overlay[ol_profile].x = -1;
+
    // turn off status if we aren't using it
    if(hud_hidestatus)
       overlay[ol_status].x = -1;
@@ -576,6 +684,9 @@ static void HU_overlaySetup()
    default:
       break;
    }
+
+   if(m_profile)
+      setol(ol_profile, SCREENWIDTH - PROFGRAPHW - 2, 12);
 }
 
 //=============================================================================
@@ -617,14 +728,15 @@ void HU_DisableHUD()
 void HU_OverlayDraw()
 {
    // SoM 2-4-04: ANYRES
-   if(viewwindow.height != video.height || automapactive || !hud_enabled) 
-      return;  // fullscreen only
+   // fullscreen only, except for the profiler
+   bool fullscreen = 
+      (viewwindow.height == video.height && !automapactive && hud_enabled);
   
    HU_overlaySetup();
    
    for(int i = 0; i < NUMOVERLAY; i++)
    {
-      if(overlay[i].x != -1)
+      if(overlay[i].x != -1 && (fullscreen || i == ol_profile))
          overlay[i].drawer(overlay[i].x, overlay[i].y);
    }
 }
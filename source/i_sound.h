@@ -32,6 +32,7 @@ typedef struct i_sounddriver_s
 {
    int  (*InitSound)(void);
    void (*CacheSound)(sfxinfo_t *);
+   void (*PrecacheSounds)(sfxinfo_t *const *, int);
    void (*UpdateSound)(void);
    void (*SubmitSound)(void);
    void (*ShutdownSound)(void);
@@ -56,6 +57,9 @@ void I_ShutdownSound();
 // Cache sound data
 void I_CacheSound(sfxinfo_t *sound);
 
+// Load sound data ahead of time for a set of sounds about to be used
+void I_PrecacheSounds(sfxinfo_t *const *sounds, int numsounds);
+
 //
 //  SFX I/O
 //
@@ -83,6 +83,8 @@ extern char *i_default_videomode;
 extern int   i_videodriverid;
 extern int   i_softbitdepth;
 extern bool  i_letterbox;
+extern bool  i_truecolor;
+extern int   i_softscale;
 
 // Driver enumeration
 enum
@@ -67,9 +67,12 @@
 #include "p_enemy.h"
 #include "p_map.h"
 #include "p_partcl.h"
+#include "p_tickpar.h"
 #include "p_user.h"
 #include "r_draw.h"
+#include "r_drawlist.h"
 #include "r_main.h"
+#include "r_pvs.h"
 #include "r_sky.h"
 #include "r_things.h"
 #include "s_sound.h"
@@ -258,6 +261,9 @@ default_t defaults[] =
 
    DEFAULT_BOOL("p_pitchedflight", &default_pitchedflight, &pitchedflight, true, default_t::wad_yes, 
                 "1 to enable flying in the direction you are looking"),
+
+   DEFAULT_BOOL("p_parallelthink", &p_parallelthink, NULL, false, default_t::wad_no,
+                "decide monster sight checks on worker threads before thinking"),
    
    // no color changes on status bar
    DEFAULT_INT("sts_always_red", &sts_always_red, NULL, 1, 0, 1, default_t::wad_yes,
@@ -808,11 +814,26 @@ default_t defaults[] =
    
    DEFAULT_INT("r_columnengine",&r_column_engine_num, NULL, 
                1, 0, NUMCOLUMNENGINES - 1, default_t::wad_no, 
-               "0 = normal, 1 = optimized quad cache"),
+               "0 = normal, 1 = optimized quad cache, 2 = 16-column SSE2 cache"),
    
    DEFAULT_INT("r_spanengine",&r_span_engine_num, NULL,
                0, 0, NUMSPANENGINES - 1, default_t::wad_no, 
-               "0 = high precision, 1 = low precision"),
+               "0 = high precision, 1 = SSE2 (falls back to 0 if unsupported)"),
+
+   DEFAULT_INT("r_threads", &r_threads, NULL, 1, 0, 64, default_t::wad_no,
+               "number of renderer threads (0 = one per CPU, 1 = no threading)"),
+
+   DEFAULT_BOOL("r_drawlist", &r_drawlist, NULL, false, default_t::wad_no,
+                "record walls and flats and draw them in parallel strips afterward"),
+
+   DEFAULT_BOOL("r_occludesprites", &r_occludesprites, NULL, true, default_t::wad_no,
+                "skip sprites that solid walls hide completely"),
+
+   DEFAULT_INT("r_spriteradix", &r_spriteradix, NULL, 384, 0, 65536, default_t::wad_no,
+               "radix sort sprite ranges at least this long (0 = always merge sort)"),
+
+   DEFAULT_BOOL("r_pvs", &r_pvs, NULL, true, default_t::wad_no,
+                "skip parts of the map the view's sector can never see"),
 
    DEFAULT_INT("r_tlstyle", &r_tlstyle, NULL, 1, 0, R_TLSTYLE_NUM - 1, default_t::wad_yes,
                "Doom object translucency style (0 = none, 1 = Boom, 2 = new)"),
@@ -0,0 +1,201 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Frame profiler: per-stage timings and per-frame counters.
+//
+//    Stage times are accumulated between M_ProfileStart and M_ProfileStop,
+//    so a stage may be entered more than once in a frame. Stages are timed
+//    where R_RenderPlayerView and D_Display call them, never inside one
+//    another, so that the stages of a frame add up to no more than its
+//    length. M_ProfileEndFrame files the frame away in a ring of recent
+//    frames, which is drawn by the HUD overlay and written out by
+//    m_profiledump.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+
+#include "c_io.h"
+#include "c_runcmd.h"
+#include "hal/i_timer.h"
+#include "m_profile.h"
+#include "v_misc.h"
+
+bool m_profile;
+
+const char *const prof_stagenames[PROF_NUMSTAGES] =
+{
+   "setupframe",
+   "bsp",
+   "portals",
+   "planes",
+   "postbsp",
+   "hud",
+   "finishupdate",
+};
+
+const char *const prof_counternames[PROF_NUMCOUNTERS] =
+{
+   "drawsegs",
+   "visplanes",
+   "vissprites",
+   "portalwindows",
+   "occluded",
+   "pvsculled",
+};
+
+unsigned int prof_counters[PROF_NUMCOUNTERS];
+
+static uint64_t     prof_starts[PROF_NUMSTAGES]; // 0 if a stage isn't running
+static unsigned int prof_times[PROF_NUMSTAGES];  // this frame's totals so far
+
+static profframe_t prof_history[PROF_HISTORY];
+static int         prof_next;      // slot the next frame goes into
+static int         prof_numframes; // frames in the history
+
+//
+// M_ProfileStart
+//
+void M_ProfileStart(int stage)
+{
+   if(m_profile)
+      prof_starts[stage] = i_haltimer.GetMicroseconds();
+}
+
+//
+// M_ProfileStop
+//
+void M_ProfileStop(int stage)
+{
+   // the profiler may have been turned on partway through the stage
+   if(m_profile && prof_starts[stage])
+   {
+      prof_times[stage] +=
+         static_cast<unsigned int>(i_haltimer.GetMicroseconds() - prof_starts[stage]);
+   }
+   prof_starts[stage] = 0;
+}
+
+//
+// M_ProfileEndFrame
+//
+// Called once the frame is on screen. Records it and starts the next one.
+//
+void M_ProfileEndFrame()
+{
+   if(m_profile)
+   {
+      profframe_t &frame = prof_history[prof_next];
+
+      memcpy(frame.stages,   prof_times,    sizeof(frame.stages));
+      memcpy(frame.counters, prof_counters, sizeof(frame.counters));
+
+      prof_next = (prof_next + 1) % PROF_HISTORY;
+      if(prof_numframes < PROF_HISTORY)
+         ++prof_numframes;
+   }
+
+   memset(prof_times,    0, sizeof(prof_times));
+   memset(prof_counters, 0, sizeof(prof_counters));
+}
+
+//
+// M_ProfileNumFrames
+//
+int M_ProfileNumFrames()
+{
+   return prof_numframes;
+}
+
+//
+// M_ProfileFrame
+//
+// Returns a recorded frame; age 0 is the most recent.
+//
+const profframe_t *M_ProfileFrame(int age)
+{
+   if(age < 0 || age >= prof_numframes)
+      return NULL;
+
+   return &prof_history[(prof_next - 1 - age + PROF_HISTORY) % PROF_HISTORY];
+}
+
+//
+// M_dumpProfile
+//
+// Writes the recorded frames, oldest first, to a CSV file.
+//
+static void M_dumpProfile(const char *filename)
+{
+   FILE *f;
+
+   if(!prof_numframes)
+   {
+      C_Puts(FC_ERROR "No frames have been profiled; set m_profile 1");
+      return;
+   }
+
+   if(!(f = fopen(filename, "w")))
+   {
+      C_Printf(FC_ERROR "Could not open %s for writing\n", filename);
+      return;
+   }
+
+   fputs("frame", f);
+   for(int i = 0; i < PROF_NUMSTAGES; i++)
+      fprintf(f, ",%s_us", prof_stagenames[i]);
+   for(int i = 0; i < PROF_NUMCOUNTERS; i++)
+      fprintf(f, ",%s", prof_counternames[i]);
+   fputc('\n', f);
+
+   for(int age = prof_numframes - 1; age >= 0; age--)
+   {
+      const profframe_t *frame = M_ProfileFrame(age);
+
+      fprintf(f, "%d", prof_numframes - 1 - age);
+      for(int i = 0; i < PROF_NUMSTAGES; i++)
+         fprintf(f, ",%u", frame->stages[i]);
+      for(int i = 0; i < PROF_NUMCOUNTERS; i++)
+         fprintf(f, ",%u", frame->counters[i]);
+      fputc('\n', f);
+   }
+
+   fclose(f);
+   C_Printf("Wrote %d frames to %s\n", prof_numframes, filename);
+}
+
+VARIABLE_BOOLEAN(m_profile, NULL, onoff);
+CONSOLE_VARIABLE(m_profile, m_profile, 0)
+{
+   // start over, so the history doesn't span a gap
+   prof_next = prof_numframes = 0;
+}
+
+CONSOLE_COMMAND(m_profiledump, 0)
+{
+   if(!Console.argc)
+      C_Printf("usage: m_profiledump filename\n");
+   else
+      M_dumpProfile(Console.argv[0]->constPtr());
+}
+
+// EOF
+
@@ -0,0 +1,112 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Frame profiler: per-stage timings and per-frame counters.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef M_PROFILE_H__
+#define M_PROFILE_H__
+
+// Timed stages of a frame
+enum profstage_e
+{
+   PROF_SETUPFRAME,   // R_SetupFrame
+   PROF_BSP,          // R_RenderBSPNode
+   PROF_PORTALS,      // R_RenderPortals
+   PROF_PLANES,       // R_DrawPlanes
+   PROF_POSTBSP,      // R_DrawPostBSP
+   PROF_HUD,          // status bar, HUD, and overlays
+   PROF_FINISHUPDATE, // I_FinishUpdate
+   PROF_NUMSTAGES
+};
+
+// Things counted each frame
+enum profcounter_e
+{
+   PROF_DRAWSEGS,
+   PROF_VISPLANES,
+   PROF_VISSPRITES,
+   PROF_PORTALWINDOWS,
+   PROF_OCCLUDED,
+   PROF_PVSCULLED,
+   PROF_NUMCOUNTERS
+};
+
+// Number of frames kept for the graph and for dumping
+#define PROF_HISTORY 256
+
+struct profframe_t
+{
+   unsigned int stages[PROF_NUMSTAGES];     // microseconds spent in each stage
+   unsigned int counters[PROF_NUMCOUNTERS];
+};
+
+extern bool m_profile; // cvar: collect and show frame timings
+
+extern const char *const prof_stagenames[PROF_NUMSTAGES];
+extern const char *const prof_counternames[PROF_NUMCOUNTERS];
+
+extern unsigned int prof_counters[PROF_NUMCOUNTERS];
+
+void M_ProfileStart(int stage);
+void M_ProfileStop(int stage);
+void M_ProfileEndFrame();
+
+int                M_ProfileNumFrames();
+const profframe_t *M_ProfileFrame(int age);
+
+//
+// M_ProfileCount
+//
+// Counting is cheap enough to do whether or not the profiler is on.
+//
+inline void M_ProfileCount(int counter)
+{
+   ++prof_counters[counter];
+}
+
+//
+// AutoProfile
+//
+// Times a stage for the lifetime of the object.
+//
+class AutoProfile
+{
+protected:
+   int stage;
+
+public:
+   explicit AutoProfile(int pStage) : stage(pStage)
+   {
+      M_ProfileStart(stage);
+   }
+
+   ~AutoProfile()
+   {
+      M_ProfileStop(stage);
+   }
+};
+
+#endif
+
+// EOF
+
@@ -212,6 +212,12 @@ static default_t sysdefaults[] =
    DEFAULT_BOOL("i_letterbox", &i_letterbox, NULL, false, default_t::wad_no, 
                 "Letterbox video modes with aspect ratios narrower than 4:3"),
 
+   DEFAULT_BOOL("i_truecolor", &i_truecolor, NULL, false, default_t::wad_no,
+                "Render in 32-bit color with the software backend"),
+
+   DEFAULT_INT("i_softscale", &i_softscale, NULL, 1, 1, 4, default_t::wad_no,
+               "Software backend pixel scale; renders at 1/N of the window size"),
+
    DEFAULT_INT("use_vsync", &use_vsync, NULL, 1, 0, 1, default_t::wad_no,
                "1 to enable wait for vsync to avoid display tearing"),
 
@@ -227,6 +233,12 @@ static default_t sysdefaults[] =
    DEFAULT_BOOL("gl_arb_pixelbuffer", &cfg_gl_arb_pixelbuffer, NULL, false, default_t::wad_no,
                 "1 to enable use of GL ARB pixelbuffer object extension"),
 
+   DEFAULT_BOOL("gl_palette_shader", &cfg_gl_palette_shader, NULL, true, default_t::wad_no,
+                "1 to apply the palette in a fragment shader (needs OpenGL 2.0)"),
+
+   DEFAULT_BOOL("gl_world_renderer", &cfg_gl_world_renderer, NULL, false, default_t::wad_no,
+                "1 to draw the world through OpenGL (experimental; needs OpenGL 2.0)"),
+
    DEFAULT_INT("gl_colordepth", &cfg_gl_colordepth, NULL, 32, 16, 32, default_t::wad_no,
                "GL backend screen bitdepth (16, 24, or 32)"),
 
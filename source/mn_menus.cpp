@@ -2201,6 +2201,8 @@ static menuitem_t mn_vidadv_items[] =
    { it_info,     "Advanced"},
    { it_toggle,   "Video driver",             "i_videodriverid"    },
    { it_variable, "Software bitdepth",        "i_softbitdepth"     },
+   { it_toggle,   "Truecolor rendering",      "i_truecolor"        },
+   { it_variable, "Software pixel scale",     "i_softscale"        },
    { it_gap },
    { it_info,     "OpenGL"},
    { it_variable, "GL color depth",           "gl_colordepth"      },
@@ -2208,6 +2210,8 @@ static menuitem_t mn_vidadv_items[] =
    { it_toggle,   "Texture format",           "gl_texture_format"  },
    { it_toggle,   "Use extensions",           "gl_use_extensions"  },
    { it_toggle,   "Use ARB pixelbuffers",     "gl_arb_pixelbuffer" },
+   { it_toggle,   "Palette shader",           "gl_palette_shader"  },
+   { it_toggle,   "World renderer",           "gl_world_renderer"  },
    { it_end }
 };
 
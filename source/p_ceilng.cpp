@@ -99,6 +99,7 @@ void P_SetSectorCeilingPic(sector_t *sector, int pic)
 /////////////////////////////////////////////////////////////////
 
 IMPLEMENT_THINKER_TYPE(CeilingThinker)
+IMPLEMENT_THINKER_POOL(CeilingThinker)
 
 //
 // T_MoveCeiling
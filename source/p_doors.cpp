@@ -95,6 +95,7 @@ void P_DoorSequence(bool raise, bool turbo, bool bounced, sector_t *s)
 //
 
 IMPLEMENT_THINKER_TYPE(VerticalDoorThinker)
+IMPLEMENT_THINKER_POOL(VerticalDoorThinker)
 
 //
 // T_VerticalDoor
@@ -60,6 +60,7 @@ void P_FloorSequence(sector_t *s)
 }
 
 IMPLEMENT_THINKER_TYPE(FloorMoveThinker)
+IMPLEMENT_THINKER_POOL(FloorMoveThinker)
 
 //
 // T_MoveFloor()
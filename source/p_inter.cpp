@@ -1945,9 +1945,11 @@ bool P_CheckCorpseRaiseSpace(Mobj *corpse)
       corpse->height = P_ThingInfoHeight(corpse->info);
       corpse->radius = corpse->info->radius;
       corpse->flags |= MF_SOLID;
+      P_SyncBlockThing(corpse);
       check = P_CheckPosition(corpse,corpse->x,corpse->y);
       corpse->height = height; // restore
       corpse->radius = radius; // restore
+      P_SyncBlockThing(corpse);
       corpse->flags &= ~MF_SOLID;
    }
 
@@ -1979,6 +1981,7 @@ void P_RaiseCorpse(Mobj *corpse, const Mobj *raiser)
       // fix Ghost bug
       corpse->height = P_ThingInfoHeight(info);
       corpse->radius = info->radius;
+      P_SyncBlockThing(corpse);
    }                                                  // phares
 
    // killough 7/18/98: 
@@ -884,10 +884,6 @@ static bool PIT_CheckThing(Mobj *thing) // killough 3/26/98: make static
    fixed_t blockdist;
    int damage;
 
-   // EDF FIXME: haleyjd 07/13/03: these may be temporary fixes
-   int bruiserType = E_ThingNumForDEHNum(MT_BRUISER); 
-   int knightType  = E_ThingNumForDEHNum(MT_KNIGHT); 
-
    // killough 11/98: add touchy things
    if(!(thing->flags & (MF_SOLID|MF_SPECIAL|MF_SHOOTABLE|MF_TOUCHY)))
       return true;
@@ -898,6 +894,12 @@ static bool PIT_CheckThing(Mobj *thing) // killough 3/26/98: make static
       D_abs(thing->y - clip.y) >= blockdist)
       return true; // didn't hit it
 
+   // EDF FIXME: haleyjd 07/13/03: these may be temporary fixes
+   // Looked up only once the cheap tests above have been passed, since most
+   // things in a block are rejected by them.
+   int bruiserType = E_ThingNumForDEHNum(MT_BRUISER); 
+   int knightType  = E_ThingNumForDEHNum(MT_KNIGHT); 
+
    // killough 11/98:
    //
    // This test has less information content (it's almost always false), so it
@@ -1215,7 +1217,9 @@ bool P_CheckPosition(Mobj *thing, fixed_t x, fixed_t y)
    {
       for(by = yl; by <= yh; by++)
       {
-         if(!P_BlockThingsIterator(bx, by, PIT_CheckThing))
+         // things too far away to touch are passed over before PIT_CheckThing
+         if(!P_BlockThingsNearIterator(bx, by, x, y, thing->radius,
+                                       PIT_CheckThing))
             return false;
       }
    }
@@ -2437,6 +2441,7 @@ static bool PIT_ChangeSector(Mobj *thing)
       }
       thing->flags &= ~MF_SOLID;
       thing->height = thing->radius = 0;
+      P_SyncBlockThing(thing);
       return true;      // keep checking
    }
 
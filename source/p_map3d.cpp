@@ -1003,6 +1003,7 @@ static void P_DoCrunch(Mobj *thing)
       }
       thing->flags &= ~MF_SOLID;
       thing->height = thing->radius = 0;
+      P_SyncBlockThing(thing);
       return;
    }
 
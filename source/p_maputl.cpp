@@ -417,6 +417,107 @@ void P_LogThingPosition(Mobj *mo, const char *caller)
 #define P_LogThingPosition(a, b)
 #endif
 
+//
+// P_compactBlockThings
+//
+// Squeezes the holes left by unlinked things out of a block's packed array,
+// keeping the rest in chain order.
+//
+static void P_compactBlockThings(blockthings_t *block)
+{
+   int count = 0;
+
+   for(int i = 0; i < block->count; i++)
+   {
+      if(block->things[i].mo)
+      {
+         block->things[count] = block->things[i];
+         block->things[count].mo->bindex = count;
+         ++count;
+      }
+   }
+
+   block->count = count;
+   block->holes = 0;
+}
+
+//
+// P_packBlockThing
+//
+// Adds a thing that has just been linked at the head of a block's chain to the
+// block's packed array.
+//
+static void P_packBlockThing(Mobj *thing, blockthings_t *block)
+{
+   if(block->count == block->max)
+   {
+      // only grow the array if squeezing the holes out won't make enough room
+      if(block->holes > block->max / 4)
+         P_compactBlockThings(block);
+      else
+      {
+         block->max    = block->max ? block->max * 2 : 8;
+         block->things = static_cast<blockthing_t *>(Z_Realloc(block->things,
+                            block->max * sizeof(blockthing_t), PU_LEVEL, NULL));
+      }
+   }
+
+   blockthing_t &bt = block->things[block->count];
+
+   bt.mo     = thing;
+   bt.x      = thing->x;
+   bt.y      = thing->y;
+   bt.radius = thing->radius;
+
+   thing->bthings = block;
+   thing->bindex  = block->count++;
+   ++block->changes;
+}
+
+//
+// P_unpackBlockThing
+//
+// Empties the slot of a thing that has just been unlinked from its block.
+//
+static void P_unpackBlockThing(Mobj *thing)
+{
+   blockthings_t *block = thing->bthings;
+
+   if(!block)
+      return;
+
+   block->things[thing->bindex].mo = NULL;
+   ++block->holes;
+
+   // holes at the end can simply be dropped
+   while(block->count && !block->things[block->count - 1].mo)
+   {
+      --block->count;
+      --block->holes;
+   }
+
+   ++block->changes;
+   thing->bthings = NULL;
+}
+
+//
+// P_SyncBlockThing
+//
+// Refreshes the copies of a thing's position and radius in its block's packed
+// array, for code that changes them without relinking the thing.
+//
+void P_SyncBlockThing(Mobj *thing)
+{
+   if(thing->bthings)
+   {
+      blockthing_t &bt = thing->bthings->things[thing->bindex];
+
+      bt.x      = thing->x;
+      bt.y      = thing->y;
+      bt.radius = thing->radius;
+   }
+}
+
 //
 // P_UnsetThingPosition
 // Unlinks a thing from block map and sectors.
@@ -472,6 +573,8 @@ void P_UnsetThingPosition(Mobj *thing)
       Mobj *bnext, **bprev = thing->bprev;
       if(bprev && (*bprev = bnext = thing->bnext))  // unlink from block map
          bnext->bprev = bprev;
+
+      P_unpackBlockThing(thing);
    }
 }
 
@@ -543,6 +646,8 @@ void P_SetThingPosition(Mobj *thing)
             bnext->bprev = &thing->bnext;
          thing->bprev = link;
          *link = thing;
+
+         P_packBlockThing(thing, &blockthings[blocky*bmapwidth+blockx]);
       }
       else        // thing is off the map
          thing->bnext = NULL, thing->bprev = NULL;
@@ -678,19 +783,37 @@ bool P_BlockLinesIterator(int x, int y, bool func(line_t*, polyobj_t*), int grou
 }
 
 //
-// P_BlockThingsIterator
+// P_iterateBlockThings
 //
-// killough 5/3/98: reformatted, cleaned up
-// ioanch 20160108: variant with groupid
+// Calls func on the things in a block, in blocklinks chain order. If near is
+// given, as { x, y, radius }, things that are too far from that point to touch
+// a thing of that radius are skipped, using the copies packed into the block.
 //
-bool P_BlockThingsIterator(int x, int y, int groupid, bool (*func)(Mobj *))
+static bool P_iterateBlockThings(int x, int y, int groupid,
+                                 bool (*func)(Mobj *), const fixed_t *near)
 {
    if(!(x < 0 || y < 0 || x >= bmapwidth || y >= bmapheight))
    {
-      Mobj *mobj = blocklinks[y * bmapwidth + x];
+      const blockthings_t &block = blockthings[y * bmapwidth + x];
+      unsigned int changes = block.changes;
 
-      for(; mobj; mobj = mobj->bnext)
+      // Walk the packed array, which is the chain back to front. If func links
+      // or unlinks anything here, carry on down the chain from where we are,
+      // exactly as if we had been following bnext all along.
+      for(int i = block.count - 1; i >= 0; i--)
       {
+         const blockthing_t &bt = block.things[i];
+         Mobj *mobj = bt.mo;
+
+         if(!mobj)
+            continue;   // unlinked since the block was last compacted
+
+         if(near && (D_abs(bt.x - near[0]) >= bt.radius + near[2] ||
+                     D_abs(bt.y - near[1]) >= bt.radius + near[2]))
+         {
+            continue;
+         }
+
          // ioanch: if mismatching group id (in case it's declared), skip
          if(groupid != R_NOGROUP && mobj->groupid != R_NOGROUP && 
             groupid != mobj->groupid)
@@ -699,11 +822,53 @@ bool P_BlockThingsIterator(int x, int y, int groupid, bool (*func)(Mobj *))
          }
          if(!func(mobj))
             return false;
+
+         if(block.changes != changes)
+         {
+            for(mobj = mobj->bnext; mobj; mobj = mobj->bnext)
+            {
+               if(groupid != R_NOGROUP && mobj->groupid != R_NOGROUP && 
+                  groupid != mobj->groupid)
+               {
+                  continue;
+               }
+               if(!func(mobj))
+                  return false;
+            }
+            break;
+         }
       }
    }
    return true;
 }
 
+//
+// P_BlockThingsIterator
+//
+// killough 5/3/98: reformatted, cleaned up
+// ioanch 20160108: variant with groupid
+//
+bool P_BlockThingsIterator(int x, int y, int groupid, bool (*func)(Mobj *))
+{
+   return P_iterateBlockThings(x, y, groupid, func, NULL);
+}
+
+//
+// P_BlockThingsNearIterator
+//
+// As P_BlockThingsIterator, but only calls func on things close enough to
+// (px, py) to touch a thing of the given radius. This is the same box test
+// PIT_CheckThing starts with, made on the packed copies instead of the Mobjs,
+// so it must only be used with functions that reject such things untouched.
+//
+bool P_BlockThingsNearIterator(int x, int y, fixed_t px, fixed_t py,
+                               fixed_t radius, bool (*func)(Mobj *))
+{
+   const fixed_t near[3] = { px, py, radius };
+
+   return P_iterateBlockThings(x, y, R_NOGROUP, func, near);
+}
+
 //
 // P_PointToAngle
 //
@@ -113,6 +113,9 @@ inline static bool P_BlockThingsIterator(int x, int y, bool func(Mobj *))
    // ioanch 20160108: avoid code duplication
    return P_BlockThingsIterator(x, y, R_NOGROUP, func);
 }
+bool P_BlockThingsNearIterator(int x, int y, fixed_t px, fixed_t py,
+                               fixed_t radius, bool (*func)(Mobj *));
+void P_SyncBlockThing(Mobj *thing);
 bool ThingIsOnLine(const Mobj *t, const line_t *l);  // killough 3/15/98
 bool P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                     int flags, traverser_t trav);
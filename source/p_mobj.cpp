@@ -1212,6 +1212,7 @@ bool Mobj::shouldApplyTorque()
 
 // Mobj RTTI Proxy Type
 IMPLEMENT_THINKER_TYPE(Mobj)
+IMPLEMENT_THINKER_POOL(Mobj)
 
 //
 // P_MobjThinker
@@ -2669,6 +2670,7 @@ bool P_CheckMissileSpawn(Mobj* th)
    th->x += th->momx >> 1;
    th->y += th->momy >> 1;
    th->z += th->momz >> 1;
+   P_SyncBlockThing(th);
 
    // killough 8/12/98: for non-missile objects (e.g. grenades)
    if(!(th->flags & MF_MISSILE) && demo_version >= 203)
@@ -3195,6 +3197,7 @@ Mobj *P_FindMobjFromTID(int tid, Mobj *rover, Mobj *trigger)
 //
 
 IMPLEMENT_THINKER_TYPE(MobjFadeThinker)
+IMPLEMENT_THINKER_POOL(MobjFadeThinker)
 
 //
 // MobjFadeThinker::setTarget
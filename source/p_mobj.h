@@ -43,6 +43,7 @@
 #include "tables.h"
 #include "linkoffs.h"
 
+struct blockthings_t;
 struct msecnode_t;
 struct player_t;
 struct skin_t;
@@ -187,6 +188,47 @@ public:
 class Mobj : public PointThinker
 {
    DECLARE_THINKER_TYPE(Mobj, PointThinker)
+   DECLARE_THINKER_POOL()
+
+public:
+   // Data members: hot
+   //
+   // The blockmap iterators, PIT_CheckThing, and the movement code read these
+   // for every thing they look at, most of which are turned away after a test
+   // or two. They are kept together, right behind x, y, and z, so that a
+   // rejected thing costs a cache line or two instead of one per field.
+
+   // Interaction info, by BLOCKMAP.
+   // Links in blocks (if needed).
+   Mobj  *bnext;
+   Mobj **bprev; // killough 8/11/98: change to ptr-to-ptr
+   blockthings_t *bthings; // block the thing is packed into, if any
+   int            bindex;  // and its slot there
+
+   // For movement checking.
+   fixed_t radius;
+   fixed_t height; 
+
+   // Momentums, used to update position.
+   fixed_t momx;
+   fixed_t momy;
+   fixed_t momz;
+
+   unsigned int  flags;
+   unsigned int  flags2;    // haleyjd 04/09/99: I know, kill me now
+   unsigned int  flags3;    // haleyjd 11/03/02
+   unsigned int  flags4;    // haleyjd 09/13/09
+   int           intflags;  // killough 9/15/98: internal flags
+   int           health;
+
+   // The closest interval over all contacted Sectors.
+   fixed_t floorz;
+   fixed_t ceilingz;
+
+   // killough 11/98: the lowest floor over all contacted Sectors.
+   fixed_t dropoffz;
+
+   subsector_t *subsector;
 
 protected:
    // Data Members
@@ -217,7 +259,7 @@ public:
    void backupPosition();
    void copyPosition(const Mobj *other);
    
-   // Data members
+   // Data members: everything else
 
    // More list: links in sector (if needed)
    Mobj  *snext;
@@ -236,29 +278,6 @@ public:
    spritenum_t sprite; // used to find patch_t and flip value
    int         frame;  // might be ORed with FF_FULLBRIGHT
 
-   // Interaction info, by BLOCKMAP.
-   // Links in blocks (if needed).
-   Mobj  *bnext;
-   Mobj **bprev; // killough 8/11/98: change to ptr-to-ptr
-
-   subsector_t *subsector;
-
-   // The closest interval over all contacted Sectors.
-   fixed_t floorz;
-   fixed_t ceilingz;
-
-   // killough 11/98: the lowest floor over all contacted Sectors.
-   fixed_t dropoffz;
-
-   // For movement checking.
-   fixed_t radius;
-   fixed_t height; 
-
-   // Momentums, used to update position.
-   fixed_t momx;
-   fixed_t momy;
-   fixed_t momz;
-
    // If == validcount, already checked.
    int validcount;
 
@@ -275,12 +294,6 @@ public:
 
    int           tics;   // state tic counter
    state_t      *state;
-   unsigned int  flags;
-   unsigned int  flags2;    // haleyjd 04/09/99: I know, kill me now
-   unsigned int  flags3;    // haleyjd 11/03/02
-   unsigned int  flags4;    // haleyjd 09/13/09
-   int           intflags;  // killough 9/15/98: internal flags
-   int           health;
 
    // Movement direction, movement generation (zig-zagging).
    int16_t movedir;        // 0-7
@@ -385,6 +398,7 @@ public:
 class MobjFadeThinker : public Thinker
 {
    DECLARE_THINKER_TYPE(MobjFadeThinker, Thinker)
+   DECLARE_THINKER_POOL()
 
 protected:
    Mobj *target;
@@ -68,6 +68,7 @@ void P_PlatSequence(sector_t *s, const char *seqname)
 }
 
 IMPLEMENT_THINKER_TYPE(PlatThinker)
+IMPLEMENT_THINKER_POOL(PlatThinker)
 
 //
 // T_PlatRaise()
@@ -37,6 +37,7 @@
 #include "p_maputl.h"   // ioanch
 #include "p_portal.h"
 #include "p_setup.h"
+#include "p_tickpar.h"
 #include "p_user.h"
 #include "r_bsp.h"
 #include "r_draw.h"
@@ -891,6 +892,8 @@ static int P_GetPortalState(portal_t *portal, int sflags, bool obscured)
 void P_CheckCPortalState(sector_t *sec)
 {
    bool     obscured;
+
+   P_SightGeometryChanged();
    
    if(!sec->c_portal)
    {
@@ -907,6 +910,8 @@ void P_CheckCPortalState(sector_t *sec)
 void P_CheckFPortalState(sector_t *sec)
 {
    bool     obscured;
+
+   P_SightGeometryChanged();
    
    if(!sec->f_portal)
    {
@@ -922,6 +927,8 @@ void P_CheckFPortalState(sector_t *sec)
 
 void P_CheckLPortalState(line_t *line)
 {
+   P_SightGeometryChanged();
+
    if(!line->portal)
    {
       line->pflags = 0;
@@ -41,6 +41,7 @@
 #include "e_ttypes.h"
 #include "ev_specials.h"
 #include "g_game.h"
+#include "hal/i_timer.h"
 #include "hu_frags.h"
 #include "hu_stuff.h"
 #include "in_lude.h"
@@ -65,8 +66,10 @@
 #include "polyobj.h"
 #include "r_data.h"
 #include "r_defs.h"
+#include "r_drawlist.h"
 #include "r_dynseg.h"
 #include "r_main.h"
+#include "r_pvs.h"
 #include "r_sky.h"
 #include "r_things.h"
 #include "s_sndseq.h"
@@ -140,6 +143,7 @@ int       *blockmaplump;          // was short -- killough
 fixed_t   bmaporgx, bmaporgy;     // origin of block map
 
 Mobj    **blocklinks;             // for thing chains
+blockthings_t *blockthings;       // things in each block, packed
 
 byte     *portalmap;              // haleyjd: for portals
 // ioanch 20160106: more detailed info (list of groups for each block)
@@ -2115,6 +2119,8 @@ void P_LoadBlockMap(int lump)
    // clear out mobj chains
    count      = sizeof(*blocklinks) * bmapwidth * bmapheight;
    blocklinks = ecalloctag(Mobj **, 1, count, PU_LEVEL, NULL);
+   count       = sizeof(*blockthings) * bmapwidth * bmapheight;
+   blockthings = ecalloctag(blockthings_t *, 1, count, PU_LEVEL, NULL);
    blockmap   = blockmaplump + 4;
 
    // haleyjd 2/22/06: setup polyobject blockmap
@@ -2682,6 +2688,11 @@ static void P_PreZoneFreeLevel()
    // haleyjd 05/16/08: clear dynamic segs
    R_ClearDynaSegs();
 
+   // the next level builds its own texture atlas; the last frame's draw
+   // list refers into this one
+   R_ClearDrawList();
+   R_FreeTextureAtlas();
+
    //==============================================
    // Playsim
 
@@ -2816,6 +2827,7 @@ void P_SetupLevel(WadDirectory *dir, const char *mapname, int playermask,
 {
    lumpinfo_t **lumpinfo;
    int lumpnum, acslumpnum = -1;
+   unsigned int starttime = i_haltimer.GetTicks();
 
    // haleyjd 07/28/10: we are no longer in GS_LEVEL during the execution of
    // this routine.
@@ -2933,6 +2945,10 @@ void P_SetupLevel(WadDirectory *dir, const char *mapname, int playermask,
    P_GroupLines();
    P_LoadReject(lumpnum + ML_REJECT); // haleyjd 01/26/04
 
+   // work out which sectors can see each other, before slime trail removal
+   // moves any vertices
+   R_SetupPVS(*setupwad, lumpnum);
+
    // haleyjd 01/12/14: build sound environment zones
    P_CreateSoundZones();
 
@@ -2976,9 +2992,12 @@ void P_SetupLevel(WadDirectory *dir, const char *mapname, int playermask,
    // haleyjd
    P_InitLightning();
 
-   // preload graphics
+   // preload graphics and sounds
    if(precache)
+   {
       R_PrecacheLevel();
+      S_PrecacheLevel();
+   }
 
    R_SetViewSize(screenSize+3); //sf
 
@@ -3000,6 +3019,8 @@ void P_SetupLevel(WadDirectory *dir, const char *mapname, int playermask,
       acslumpnum = setupwad->checkNumForNameNSG(LevelInfo.acsScriptLump, lumpinfo_t::ns_acs);
 
    ACS_LoadLevelScript(dir, acslumpnum);
+
+   C_Printf("%s loaded in %u ms\n", mapname, i_haltimer.GetTicks() - starttime);
 }
 
 //
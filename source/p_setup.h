@@ -65,6 +65,41 @@ extern Mobj   **blocklinks;      // for thing chains
 extern byte    *portalmap;       // haleyjd: for fast linked portal checks
 extern int    **gBlockGroups;    // ioanch 20160106: for each block, prt. groups
 
+//
+// blockthing_t
+//
+// One thing packed into a block, with copies of the fields the clipping
+// prefilter reads so that it need not touch the Mobj. Code that moves a thing
+// or changes its radius without relinking it must call P_SyncBlockThing.
+//
+struct blockthing_t
+{
+   Mobj   *mo;     // NULL once unlinked, until the block is compacted
+   fixed_t x, y;
+   fixed_t radius;
+};
+
+//
+// blockthings_t
+//
+// The things linked into one block, kept in step with its blocklinks chain.
+// They are stored back to front, so the last live entry is the head of the
+// chain, and linking a thing appends to the array. Unlinking only empties the
+// thing's slot; the holes are squeezed out when the array next fills up. The
+// blockmap iterators walk this instead of following bnext from one thing to
+// the next.
+//
+struct blockthings_t
+{
+   blockthing_t *things;
+   int           count;   // slots used, holes included
+   int           max;
+   int           holes;
+   unsigned int  changes; // bumped whenever a thing is linked or unlinked
+};
+
+extern blockthings_t *blockthings;
+
 // haleyjd 05/17/13: portalmap flags
 enum
 {
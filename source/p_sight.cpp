@@ -32,6 +32,7 @@
 #include "m_bbox.h"
 #include "p_maputl.h"
 #include "p_setup.h"
+#include "p_tickpar.h"
 #include "r_dynseg.h"
 #include "r_main.h"
 #include "r_state.h"
@@ -342,6 +343,10 @@ bool P_CheckSight(Mobj *t1, Mobj *t2)
 {
    if(full_demo_version >= make_full_version(340, 24))
    {
+      int decided = P_DecidedSight(t1, t2);
+      if(decided != -1)
+         return !!decided;
+
       camsightparams_t camparams;
       camparams.prev = nullptr;
       camparams.setLookerMobj(t1);
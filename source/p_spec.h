@@ -819,6 +819,7 @@ public:
 class PlatThinker : public SectorThinker
 {
    DECLARE_THINKER_TYPE(PlatThinker, SectorThinker)
+   DECLARE_THINKER_POOL()
 
 public:
    // Enumerations
@@ -875,6 +876,7 @@ enum
 class VerticalDoorThinker : public SectorThinker
 {
    DECLARE_THINKER_TYPE(VerticalDoorThinker, SectorThinker)
+   DECLARE_THINKER_POOL()
 
 protected:
    void Think();
@@ -947,6 +949,7 @@ struct spectransfer_t
 class CeilingThinker : public SectorThinker
 {
    DECLARE_THINKER_TYPE(CeilingThinker, SectorThinker)
+   DECLARE_THINKER_POOL()
 
 protected:
    void Think();
@@ -1054,6 +1057,7 @@ struct crusherdata_t
 class FloorMoveThinker : public SectorThinker
 {
    DECLARE_THINKER_TYPE(FloorMoveThinker, SectorThinker)
+   DECLARE_THINKER_POOL()
 
 protected:
    void Think();
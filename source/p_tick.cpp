@@ -37,6 +37,7 @@
 #include "p_sector.h"
 #include "p_spec.h"
 #include "p_tick.h"
+#include "p_tickpar.h"
 #include "p_user.h"
 #include "p_partcl.h"
 #include "polyobj.h"
@@ -225,8 +226,15 @@ void Thinker::removeThinker()
 // Rewritten to delete nodes implicitly, by making currentthinker
 // external and using P_RemoveThinkerDelayed() implicitly.
 //
+// When p_parallelthink is on, sight checks for the things about to act are
+// decided on the worker threads first. A player moving spoils the decisions
+// made for anything chasing them, so they are made again for the rest of the
+// list after each player thinks.
+//
 void Thinker::RunThinkers(void)
 {
+   P_DecideThinkers(thinkercap.next);
+
    for(currentthinker = thinkercap.next; 
        currentthinker != &thinkercap;
        currentthinker = currentthinker->next)
@@ -234,8 +242,17 @@ void Thinker::RunThinkers(void)
       if(currentthinker->removed)
          currentthinker->removeDelayed();
       else
+      {
          currentthinker->Think();
+
+         Mobj *mo;
+         if(p_parallelthink && (mo = thinker_cast<Mobj *>(currentthinker)) &&
+            mo->player && currentthinker->next != &thinkercap)
+            P_DecideThinkers(currentthinker->next);
+      }
    }
+
+   P_ClearDecisions();
 }
 
 //
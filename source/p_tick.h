@@ -198,6 +198,27 @@ extern Thinker thinkerclasscap[];
 //
 #define IMPLEMENT_THINKER_TYPE(name) IMPLEMENT_RTTI_TYPE(name)
 
+//
+// DECLARE_THINKER_POOL
+//
+// Gives a Thinker subclass that is spawned and removed often an object pool
+// of its own. Put IMPLEMENT_THINKER_POOL beside its IMPLEMENT_THINKER_TYPE.
+//
+#define DECLARE_THINKER_POOL()        \
+public:                               \
+   void *operator new (size_t size);  \
+private:
+
+//
+// IMPLEMENT_THINKER_POOL
+//
+#define IMPLEMENT_THINKER_POOL(name)                      \
+static ZONEPOOL(name ## Pool, name);                      \
+void *name::operator new (size_t size)                    \
+{                                                         \
+   return ZoneObject::operator new(size, &name ## Pool);  \
+}
+
 #endif
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,298 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Parallel thinking: sight checks decided ahead of the thinkers.
+//
+//    Thinking is split in two. Before the thinkers run, the "decide" phase
+//    looks for monsters that are about to act and works out, on the worker
+//    threads, whether each can see what it is after. The thinkers then run
+//    one at a time in their usual order, as the "commit" phase, and
+//    P_CheckSight takes its answer from the decisions instead of tracing the
+//    line itself.
+//
+//    A sight check depends on nothing but the position, height, and portal
+//    group of the two things, and on the map's planes, polyobjects, and
+//    blocking lines. A decision is only used if both things are where they
+//    were when it was made and no geometry has changed since, so the answer
+//    is always the one the serial check would have given. Nothing random
+//    happens in the decide phase, and the commit phase draws from the RNG in
+//    the same order as ever, so demos stay in sync.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+
+#include "c_runcmd.h"
+#include "cam_sight.h"
+#include "d_player.h"
+#include "doomstat.h"
+#include "hal/i_thread.h"
+#include "p_mobj.h"
+#include "p_tick.h"
+#include "p_tickpar.h"
+
+bool p_parallelthink;
+
+unsigned int p_sightserial;
+
+// Fewer sight checks than this aren't worth waking the workers for
+#define MINDECISIONS 64
+
+struct sightdecision_t
+{
+   const Mobj      *t1;
+   const Mobj      *t2;
+   camsightparams_t params; // where the two things were when decided
+   int              result; // 1 or 0, or -1 if it couldn't be decided
+};
+
+static sightdecision_t *decisions;
+static int              numdecisions;
+static int              maxdecisions;
+
+// Open hash of indices into decisions; -1 marks an empty slot
+static int *decisionhash;
+static int  decisionhashmask;
+
+static bool         decided;       // true while the decisions can be used
+static unsigned int decidedserial; // p_sightserial they were made under
+
+static camsightscratch_t **jobscratch;
+static int                 numjobscratch;
+
+//
+// P_decisionHashKey
+//
+static unsigned int P_decisionHashKey(const Mobj *t1, const Mobj *t2)
+{
+   uintptr_t key = reinterpret_cast<uintptr_t>(t1) * 31 +
+                   reinterpret_cast<uintptr_t>(t2);
+
+   return static_cast<unsigned int>(key ^ (key >> 7) ^ (key >> 17));
+}
+
+//
+// P_addDecision
+//
+static void P_addDecision(const Mobj *t1, const Mobj *t2)
+{
+   if(numdecisions >= maxdecisions)
+   {
+      maxdecisions = maxdecisions ? maxdecisions * 2 : 1024;
+      decisions = erealloc(sightdecision_t *, decisions,
+                           maxdecisions * sizeof(sightdecision_t));
+   }
+
+   sightdecision_t &dec = decisions[numdecisions++];
+   dec.t1 = t1;
+   dec.t2 = t2;
+   dec.params.prev = nullptr;
+   dec.params.setLookerMobj(t1);
+   dec.params.setTargetMobj(t2);
+   dec.result = -1;
+}
+
+//
+// P_gatherDecisions
+//
+// Finds the things that will act on this tic: those whose state is about to
+// run out and move them on to their next action. Monsters with a target will
+// want to know if they can see it; those without will look for players.
+//
+static void P_gatherDecisions(Thinker *first)
+{
+   numdecisions = 0;
+
+   for(Thinker *th = first; th != &thinkercap; th = th->next)
+   {
+      Mobj *mo;
+
+      if(!(mo = thinker_cast<Mobj *>(th)))
+         continue;
+      if(mo->tics != 1 || mo->health <= 0 || mo->player)
+         continue;
+
+      if(mo->target)
+      {
+         if(mo->target->health > 0)
+            P_addDecision(mo, mo->target);
+      }
+      else if(mo->flags & MF_COUNTKILL)
+      {
+         for(int i = 0; i < MAXPLAYERS; i++)
+         {
+            if(playeringame[i] && players[i].mo && players[i].health > 0)
+               P_addDecision(mo, players[i].mo);
+         }
+      }
+   }
+}
+
+//
+// P_buildDecisionHash
+//
+static void P_buildDecisionHash()
+{
+   int size = 1;
+
+   while(size < numdecisions * 2)
+      size <<= 1;
+
+   if(size - 1 > decisionhashmask)
+   {
+      decisionhash     = erealloc(int *, decisionhash, size * sizeof(int));
+      decisionhashmask = size - 1;
+   }
+   memset(decisionhash, -1, (decisionhashmask + 1) * sizeof(int));
+
+   for(int i = 0; i < numdecisions; i++)
+   {
+      unsigned int slot = P_decisionHashKey(decisions[i].t1, decisions[i].t2);
+
+      while(decisionhash[slot & decisionhashmask] != -1)
+         ++slot;
+      decisionhash[slot & decisionhashmask] = i;
+   }
+}
+
+//
+// P_setupJobScratch
+//
+// Each job needs sight scratch storage made for the current map.
+//
+static void P_setupJobScratch(int numjobs)
+{
+   if(numjobs > numjobscratch)
+   {
+      jobscratch = erealloc(camsightscratch_t **, jobscratch,
+                            numjobs * sizeof(camsightscratch_t *));
+      for(int i = numjobscratch; i < numjobs; i++)
+         jobscratch[i] = nullptr;
+      numjobscratch = numjobs;
+   }
+
+   for(int i = 0; i < numjobs; i++)
+   {
+      if(jobscratch[i] && !CAM_SightScratchFits(jobscratch[i]))
+      {
+         CAM_FreeSightScratch(jobscratch[i]);
+         jobscratch[i] = nullptr;
+      }
+      if(!jobscratch[i])
+         jobscratch[i] = CAM_NewSightScratch();
+   }
+}
+
+//
+// P_decideJob
+//
+static void P_decideJob(int jobnum, void *data)
+{
+   int numjobs = *static_cast<int *>(data);
+   camsightscratch_t *scratch = jobscratch[jobnum];
+
+   for(int i = jobnum; i < numdecisions; i += numjobs)
+      decisions[i].result = CAM_CheckSightScratch(decisions[i].params, scratch);
+}
+
+//
+// P_DecideThinkers
+//
+// Runs the decide phase for the thinkers from first to the end of the list.
+// Called before they think, and again when something has happened that will
+// have spoiled most of the decisions, such as a player moving.
+//
+void P_DecideThinkers(Thinker *first)
+{
+   decided = false;
+
+   // the old sight check can't be run from more than one thread at once
+   if(!p_parallelthink || !I_GetWorkerThreads() ||
+      full_demo_version < make_full_version(340, 24))
+      return;
+
+   P_gatherDecisions(first);
+   if(numdecisions < MINDECISIONS)
+      return;
+
+   int numjobs = I_GetWorkerThreads() + 1;
+
+   P_setupJobScratch(numjobs);
+   I_RunJobs(numjobs, P_decideJob, &numjobs);
+   P_buildDecisionHash();
+
+   decided       = true;
+   decidedserial = p_sightserial;
+}
+
+//
+// P_ClearDecisions
+//
+// Called once the thinkers have run. Things may be freed after this, so the
+// decisions must not outlive the tic.
+//
+void P_ClearDecisions()
+{
+   decided = false;
+}
+
+//
+// P_DecidedSight
+//
+// Returns 1 or 0 if the sight check from t1 to t2 was decided ahead of time
+// and still holds, or -1 if it must be made now.
+//
+int P_DecidedSight(const Mobj *t1, const Mobj *t2)
+{
+   if(!decided || decidedserial != p_sightserial)
+      return -1;
+
+   unsigned int slot = P_decisionHashKey(t1, t2);
+   int index;
+
+   while((index = decisionhash[slot & decisionhashmask]) != -1)
+   {
+      const sightdecision_t &dec = decisions[index];
+
+      if(dec.t1 == t1 && dec.t2 == t2)
+      {
+         const camsightparams_t &p = dec.params;
+
+         // both things must still be where they were
+         if(p.cx != t1->x || p.cy != t1->y || p.cz != t1->z ||
+            p.cheight != t1->height || p.cgroupid != t1->groupid ||
+            p.tx != t2->x || p.ty != t2->y || p.tz != t2->z ||
+            p.theight != t2->height || p.tgroupid != t2->groupid)
+            return -1;
+
+         return dec.result;
+      }
+      ++slot;
+   }
+
+   return -1;
+}
+
+VARIABLE_BOOLEAN(p_parallelthink, NULL, onoff);
+CONSOLE_VARIABLE(p_parallelthink, p_parallelthink, 0) {}
+
+// EOF
+
@@ -0,0 +1,55 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Parallel thinking: sight checks decided ahead of the thinkers.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef P_TICKPAR_H__
+#define P_TICKPAR_H__
+
+class Mobj;
+class Thinker;
+
+extern bool p_parallelthink; // cvar: decide sight checks on worker threads
+
+// Bumped whenever the geometry a sight check looks at changes
+extern unsigned int p_sightserial;
+
+//
+// P_SightGeometryChanged
+//
+// Anything that moves a plane or a polyobject, or opens or blocks a line or
+// portal, must call this so that sight checks decided earlier are thrown out.
+//
+inline void P_SightGeometryChanged()
+{
+   ++p_sightserial;
+}
+
+void P_DecideThinkers(Thinker *first);
+void P_ClearDecisions();
+int  P_DecidedSight(const Mobj *t1, const Mobj *t2);
+
+#endif
+
+// EOF
+
@@ -44,6 +44,7 @@
 #include "p_saveg.h"
 #include "p_setup.h"
 #include "p_tick.h"
+#include "p_tickpar.h"
 #include "polyobj.h"
 #include "r_main.h"
 #include "r_state.h"
@@ -824,6 +825,8 @@ static bool Polyobj_moveXY(polyobj_t *po, fixed_t x, fixed_t y, bool onload = fa
    if(po->flags & POF_ISBAD)
       return false;
 
+   P_SightGeometryChanged();
+
    // translate vertices
    for(i = 0; i < po->numVertices; ++i)
       Polyobj_vecAdd(po->vertices[i], &vec);
@@ -957,6 +960,8 @@ static bool Polyobj_rotate(polyobj_t *po, angle_t delta, bool onload = false)
    if(po->flags & POF_ISBAD)
       return false;
 
+   P_SightGeometryChanged();
+
    angle = (po->angle + delta) >> ANGLETOFINESHIFT;
 
    // point about which to rotate is the spawn spot
@@ -0,0 +1,69 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    AVX2 helpers shared by the vectorized drawers. Callers must be marked
+//    EE_AVX2_TARGET and only run when I_CPUHasAVX2 says so.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef R_AVX2_H__
+#define R_AVX2_H__
+
+#include "doomtype.h"
+#include "hal/i_platform.h"
+
+#ifdef EE_FEATURE_AVX2
+
+#include <immintrin.h>
+
+//
+// R_AVX2Blend16
+//
+// Returns map[(d[i] << 8) + s[i]] for each of the sixteen pixels in d and s,
+// using two vpgatherdd's over the 64K blend map. A gather reads four bytes
+// at each index, so it is made from map - 3 and the top byte kept; every
+// tranmap and blend map is a zone block, or lies within one, so the bytes
+// before it are always readable, whereas those after a lump's data are not.
+//
+EE_AVX2_TARGET static inline __m128i R_AVX2Blend16(__m128i d, __m128i s,
+                                                   const byte *map)
+{
+   const int *base = (const int *)(map - 3);
+   __m256i idx = _mm256_or_si256(_mm256_slli_epi16(_mm256_cvtepu8_epi16(d), 8),
+                                 _mm256_cvtepu8_epi16(s));
+   __m256i lo  = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(idx));
+   __m256i hi  = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(idx, 1));
+
+   lo = _mm256_srli_epi32(_mm256_i32gather_epi32(base, lo, 1), 24);
+   hi = _mm256_srli_epi32(_mm256_i32gather_epi32(base, hi, 1), 24);
+
+   // packing works within 128-bit lanes, so put the halves back in order
+   __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+   return _mm_packus_epi16(_mm256_castsi256_si128(p),
+                           _mm256_extracti128_si256(p, 1));
+}
+
+#endif
+
+#endif
+
+// EOF
+
@@ -29,6 +29,7 @@
 #include "doomstat.h"
 #include "e_exdata.h"
 #include "m_bbox.h"
+#include "m_profile.h"
 #include "p_chase.h"
 #include "p_maputl.h"   // ioanch 20160125
 #include "p_portal.h"
@@ -41,6 +42,7 @@
 #include "r_dynseg.h"
 #include "r_dynabsp.h"
 #include "r_portal.h"
+#include "r_pvs.h"
 #include "r_segs.h"
 #include "r_sky.h"
 #include "r_state.h"
@@ -357,6 +359,8 @@ void R_ClearClipSegs()
    // haleyjd 09/22/07: must clear seg and segclip structures
    memset(&seg,     0, sizeof(cb_seg_t));
    memset(&segclip, 0, sizeof(cb_seg_t));
+
+   R_ClearSpriteCover();
 }
 
 //
@@ -2192,6 +2196,13 @@ static void R_Subsector(int num)
       I_Error("R_Subsector: ss %i with numss = %i\n", num, numsubsectors);
 #endif
 
+   // sectors the view can never see have nothing to draw
+   if(pvssubsectors && !pvssubsectors[num])
+   {
+      M_ProfileCount(PROF_PVSCULLED);
+      return;
+   }
+
    // haleyjd 09/22/07: clear seg structure
    memset(&seg, 0, sizeof(cb_seg_t));
 
@@ -2364,6 +2375,13 @@ void R_RenderBSPNode(int bspnum)
    while(!(bspnum & NF_SUBSECTOR))  // Found a subsector?
    {
       node_t *bsp = &nodes[bspnum];
+
+      // skip nodes with nothing beneath them in the view's PVS
+      if(pvsnodes && !pvsnodes[bspnum])
+      {
+         M_ProfileCount(PROF_PVSCULLED);
+         return;
+      }
       
       // Decide which side the view point is on.
       int side = R_PointOnSide(viewx, viewy, bsp);
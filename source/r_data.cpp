@@ -40,6 +40,7 @@
 #include "p_skin.h"
 #include "p_setup.h"
 #include "r_defs.h"
+#include "r_drawlist.h"
 #include "r_main.h"
 #include "r_patch.h"
 #include "r_sky.h"
@@ -154,16 +155,25 @@ void R_InitColormaps()
    colormaps    = emalloctag(lighttable_t **, numbytes, PU_RENDERER, 0);
    colormaps[0] = (lighttable_t *)(wGlobalDir.cacheLumpNum(cmlump, PU_RENDERER));
 
+   colormaplengths    = emalloctag(int *, sizeof(int) * numcolormaps, PU_RENDERER, 0);
+   colormaplengths[0] = wGlobalDir.lumpLength(cmlump);
+
    // colormaps[1] is FOGMAP, if it exists
    if(fogmap >= 0)
+   {
       colormaps[1] = (lighttable_t *)(wGlobalDir.cacheLumpNum(fogmap, PU_RENDERER));
+      colormaplengths[1] = wGlobalDir.lumpLength(fogmap);
+   }
 
    // load other colormaps from the colormaps namespace
    int i = r_numglobalmaps;
    WadNamespaceIterator nsi(wGlobalDir, lumpinfo_t::ns_colormaps);
   
    for(nsi.begin(); nsi.current(); nsi.next(), i++)
+   {
       colormaps[i] = (lighttable_t *)(wGlobalDir.cacheLumpNum((*nsi)->selfindex, PU_RENDERER));
+      colormaplengths[i] = wGlobalDir.lumpLength((*nsi)->selfindex);
+   }
 
    firstcolormaplump = ns.firstLump;
 }
@@ -551,7 +561,9 @@ void R_PrecacheLevel(void)
       ++sky;
    }
 
-   // Precache textures.
+   // Walls go into the atlas; anything else is cached on its own.
+   R_BuildTextureAtlas(hitlist);
+
    for(i = texturecount; --i >= 0; )
    {
       if(hitlist[i])
@@ -582,8 +594,11 @@ void R_PrecacheLevel(void)
          {
             int16_t *sflump = sprites[i].spriteframes[j].lump;
             int k = 7;
+
+            // cache as patches, so that PNG frames are converted now rather
+            // than when they are first drawn
             do
-               wGlobalDir.cacheLumpNum(firstspritelump + sflump[k], PU_CACHE);
+               PatchLoader::CacheNum(wGlobalDir, firstspritelump + sflump[k], PU_CACHE);
             while(--k >= 0);
          }
       }
@@ -599,6 +614,10 @@ void R_PrecacheLevel(void)
 //
 void R_FreeData(void)
 {
+   // the draw list holds on to textures
+   R_ClearDrawList();
+   R_FreeTextureAtlas();
+
    // haleyjd: let's harness the power of the zone heap and make this simple.
    Z_FreeTags(PU_RENDERER, PU_RENDERER);
 }
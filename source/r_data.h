@@ -77,6 +77,8 @@ typedef enum
    TF_ANIMATED  = 0x08u,
    // Set if texture width is non-power-of-two
    TF_WIDTHNP2  = 0x10u,
+   // Set if the texture's buffer is inside the level's texture atlas
+   TF_ATLAS     = 0x20u,
 } texflag_e;
 
 struct texture_t
@@ -129,6 +131,10 @@ byte *R_GetLinearBuffer(int tex);
 // Returns the texture for chaining.
 texture_t *R_CacheTexture(int num);
 
+// Composite the marked wall textures into one block for the level
+void R_BuildTextureAtlas(const byte *hitlist);
+void R_FreeTextureAtlas();
+
 // SoM: all textures/flats are now stored in a single array (textures)
 // Walls start from wallstart to (wallstop - 1) and flats go from flatstart 
 // to (flatstop - 1)
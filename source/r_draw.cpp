@@ -102,7 +102,7 @@ int fuzzpos = 0;
 //  be used. It has also been used with Wolfenstein 3D.
 // 
 
-void CB_DrawColumn_8()
+void CB_DrawColumn_8(const cb_column_t &column)
 {
    int count;
    byte *dest;
@@ -177,9 +177,16 @@ void CB_DrawColumn_8()
 // actual code differences are.
 
 #define SRCPIXEL \
-   tranmap[(*dest<<8)+colormap[source[(frac>>FRACBITS) & heightmask]]]
+   blendmap[(*dest<<8)+colormap[source[(frac>>FRACBITS) & heightmask]]]
 
-void CB_DrawTLColumn_8(void)
+//
+// CB_drawBlendColumn_8
+//
+// Draws a column through a 64K blend map indexed by [(dest << 8) + src].
+// BOOM translucency passes tranmap; the flex and additive drawers pass the
+// maps precomputed by V_InitFlexTranTable.
+//
+static void CB_drawBlendColumn_8(const cb_column_t &column, const byte *blendmap)
 {
    int count;
    byte *dest;
@@ -192,7 +199,7 @@ void CB_DrawTLColumn_8(void)
 #ifdef RANGECHECK 
    if(column.x  < 0 || column.x  >= video.width || 
       column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawTLColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);
+      I_Error("CB_drawBlendColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);
 #endif 
 
    dest = R_ADDRESS(column.x, column.y1);
@@ -218,7 +225,7 @@ void CB_DrawTLColumn_8(void)
 
          do
          {
-            *dest = tranmap[(*dest<<8) + colormap[source[frac>>FRACBITS]]]; // phares
+            *dest = blendmap[(*dest<<8) + colormap[source[frac>>FRACBITS]]]; // phares
             dest += linesize;          // killough 11/98
             if((frac += fracstep) >= heightmask)
                frac -= heightmask;
@@ -244,17 +251,25 @@ void CB_DrawTLColumn_8(void)
 
 #undef SRCPIXEL
 
+void CB_DrawTLColumn_8(const cb_column_t &column)
+{
+   CB_drawBlendColumn_8(column, tranmap);
+}
+
+
 #define SRCPIXEL \
-   tranmap[(*dest<<8) + colormap[column.translation[source[frac>>FRACBITS]]]]
+   blendmap[(*dest<<8) + colormap[column.translation[source[frac>>FRACBITS]]]]
 
 #define SRCPIXEL_MASK \
-   tranmap[(*dest<<8) + \
+   blendmap[(*dest<<8) + \
       colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]]
 
 //
-// haleyjd 02/08/05: BOOM TL/Tlated was neglected.
+// CB_drawBlendTRColumn_8
+//
+// As above, with translation.
 //
-void CB_DrawTLTRColumn_8(void)
+static void CB_drawBlendTRColumn_8(const cb_column_t &column, const byte *blendmap)
 {
    int count;
    byte *dest;
@@ -267,7 +282,7 @@ void CB_DrawTLTRColumn_8(void)
 #ifdef RANGECHECK 
    if(column.x  < 0 || column.x  >= video.width || 
       column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawTLTRColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
+      I_Error("CB_drawBlendTRColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
 #endif 
 
    dest = R_ADDRESS(column.x, column.y1);
@@ -319,6 +334,14 @@ void CB_DrawTLTRColumn_8(void)
 #undef SRCPIXEL
 #undef SRCPIXEL_MASK
 
+//
+// haleyjd 02/08/05: BOOM TL/Tlated was neglected.
+//
+void CB_DrawTLTRColumn_8(const cb_column_t &column)
+{
+   CB_drawBlendTRColumn_8(column, tranmap);
+}
+
 
 //
 // Spectre/Invisibility.
@@ -343,8 +366,9 @@ void CB_DrawTLTRColumn_8(void)
 #define SRCPIXEL \
    colormap[6*256+dest[fuzzoffset[fuzzpos] ? linesize : -linesize]]
 
-void CB_DrawFuzzColumn_8(void)
+void CB_DrawFuzzColumn_8(const cb_column_t &incolumn)
 {
+   cb_column_t column = incolumn; // borders are adjusted below
    int count;
    byte *dest;
 
@@ -410,7 +434,7 @@ int numtranslations = 0;
 #define SRCPIXEL \
    colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]
 
-void CB_DrawTRColumn_8(void)
+void CB_DrawTRColumn_8(const cb_column_t &column)
 {
    int count;
    byte *dest;
@@ -479,472 +503,42 @@ void CB_DrawTRColumn_8(void)
 //
 // haleyjd 09/01/02: zdoom-style translucency
 //
-void CB_DrawFlexColumn_8(void)
+void CB_DrawFlexColumn_8(const cb_column_t &column)
 {
-   int count;
-   byte *dest;
-   fixed_t frac;
-   fixed_t fracstep;
-   unsigned int *fg2rgb, *bg2rgb;
-   unsigned int fg, bg;
-
-   count = column.y2 - column.y1 + 1;
-   if(count <= 0) return;
-
-#ifdef RANGECHECK 
-   if(column.x  < 0 || column.x  >= video.width || 
-      column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawFlexColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
-#endif 
-
-   {
-      unsigned int fglevel, bglevel;
-      
-      fglevel = column.translevel & ~0x3ff;
-      bglevel = FRACUNIT - fglevel;
-      fg2rgb  = Col2RGB8[fglevel >> 10];
-      bg2rgb  = Col2RGB8[bglevel >> 10];
-   }
-
-   dest = R_ADDRESS(column.x, column.y1);
-   fracstep = column.step;
-   frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
-
-   {
-      byte *source = (byte *)(column.source);
-      lighttable_t *colormap = column.colormap;
-      int heightmask = column.texheight - 1;
-      
-      if (column.texheight & heightmask)   // not a power of 2 -- killough
-      {
-         heightmask++;
-         heightmask <<= FRACBITS;
-          
-         if (frac < 0)
-            while ((frac += heightmask) <  0);
-         else
-            while (frac >= (int)heightmask)
-               frac -= heightmask;          
-
-         do
-         {
-            fg = colormap[source[frac>>FRACBITS]];
-            bg = *dest;
-
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            
-            dest += linesize;          // killough 11/98
-            if((frac += fracstep) >= heightmask)
-               frac -= heightmask;
-         } 
-         while(--count);
-      }
-      else
-      {
-         while((count -= 2) >= 0)   // texture height is a power of 2 -- killough
-         {
-            fg = colormap[source[(frac>>FRACBITS) & heightmask]];
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-            
-            fg = colormap[source[(frac>>FRACBITS) & heightmask]];
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-         }
-         if(count & 1)
-         {
-            fg = colormap[source[(frac>>FRACBITS) & heightmask]];
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-         }
-      }
-   }
+   CB_drawBlendColumn_8(column, flexblendmaps[V_BlendLevel(column.translevel)]);
 }
 
-#define SRCPIXEL \
-   colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]
-
 //
 // R_DrawFlexTlatedColumn
 //
 // haleyjd 11/05/02: zdoom-style translucency w/translation, for
 // player sprites
 //
-void CB_DrawFlexTRColumn_8(void)
+void CB_DrawFlexTRColumn_8(const cb_column_t &column)
 {
-   int count;
-   byte *dest;
-   fixed_t frac;
-   fixed_t fracstep;
-   unsigned int *fg2rgb, *bg2rgb;
-   unsigned int fg, bg;
-
-   count = column.y2 - column.y1 + 1;
-   if(count <= 0) return;
-
-#ifdef RANGECHECK 
-   if(column.x  < 0 || column.x  >= video.width || 
-      column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawFlexTRColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
-#endif 
-
-   {
-      unsigned int fglevel, bglevel;
-      
-      fglevel = column.translevel & ~0x3ff;
-      bglevel = FRACUNIT - fglevel;
-      fg2rgb  = Col2RGB8[fglevel >> 10];
-      bg2rgb  = Col2RGB8[bglevel >> 10];
-   }
-
-   dest = R_ADDRESS(column.x, column.y1);
-   fracstep = column.step;
-   frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
-
-   {
-      byte *source = (byte *)(column.source);
-      lighttable_t *colormap = column.colormap;
-      int heightmask = column.texheight - 1;
-      
-      if(column.texheight & heightmask)
-      {
-         heightmask++;
-         heightmask <<= FRACBITS;
-          
-         if (frac < 0)
-            while ((frac += heightmask) <  0);
-         else
-            while (frac >= (int)heightmask)
-               frac -= heightmask;          
-
-         do
-         {
-            fg = colormap[column.translation[source[frac>>FRACBITS]]];
-            bg = *dest;
-
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            
-            dest += linesize;          // killough 11/98
-            if((frac += fracstep) >= heightmask)
-               frac -= heightmask;
-         } 
-         while(--count);
-      }
-      else
-      {
-         while((count -= 2) >= 0) // texture height is a power of 2 -- killough
-         {
-            fg = SRCPIXEL;
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-            
-            fg = SRCPIXEL;
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-         }
-         if(count & 1)
-         {
-            fg = SRCPIXEL;
-            bg = *dest;
-            fg = fg2rgb[fg];
-            bg = bg2rgb[bg];
-            fg = (fg+bg) | 0x1f07c1f;
-
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-         }
-      }
-   }
+   CB_drawBlendTRColumn_8(column, flexblendmaps[V_BlendLevel(column.translevel)]);
 }
 
-#undef SRCPIXEL
-
-#define SRCPIXEL \
-   fg2rgb[colormap[source[(frac>>FRACBITS) & heightmask]]]
-
 //
 // R_DrawAddColumn
 //
 // haleyjd 02/08/05: additive translucency
 //
-void CB_DrawAddColumn_8(void)
+void CB_DrawAddColumn_8(const cb_column_t &column)
 {
-   int count;
-   byte *dest;
-   fixed_t frac;
-   fixed_t fracstep;
-   unsigned int *fg2rgb, *bg2rgb;
-   unsigned int a, b;
-
-   count = column.y2 - column.y1 + 1;
-   if(count <= 0) return;
-
-#ifdef RANGECHECK 
-   if(column.x  < 0 || column.x  >= video.width || 
-      column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawAddColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
-#endif 
-
-   {
-      unsigned int fglevel, bglevel;
-      
-      fglevel = column.translevel & ~0x3ff;
-      bglevel = FRACUNIT;
-      fg2rgb  = Col2RGB8_LessPrecision[fglevel >> 10];
-      bg2rgb  = Col2RGB8_LessPrecision[bglevel >> 10];
-   }
-
-   dest = R_ADDRESS(column.x, column.y1);
-   fracstep = column.step;
-   frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
-
-   {
-      byte *source = (byte *)(column.source);
-      lighttable_t *colormap = column.colormap;
-      int heightmask = column.texheight - 1;
-      
-      if(column.texheight & heightmask)
-      {
-         heightmask++;
-         heightmask <<= FRACBITS;
-          
-         if (frac < 0)
-            while ((frac += heightmask) <  0);
-         else
-            while (frac >= (int)heightmask)
-               frac -= heightmask;          
-
-         do
-         {
-            // mask out LSBs in green and red to allow overflow
-            a = fg2rgb[colormap[source[frac>>FRACBITS]]] + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-                        
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            
-            dest += linesize;          // killough 11/98
-            if((frac += fracstep) >= heightmask)
-               frac -= heightmask;
-         } 
-         while(--count);
-      }
-      else
-      {
-         while((count -= 2) >= 0)   // texture height is a power of 2 -- killough
-         {
-            a = SRCPIXEL + bg2rgb[*dest];
-            b = a;
-
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;            
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-
-            a = SRCPIXEL + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;            
-         }
-         if(count & 1)
-         {
-            a = SRCPIXEL + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-         }
-      }
-   }
+   CB_drawBlendColumn_8(column, addblendmaps[V_BlendLevel(column.translevel)]);
 }
 
-#undef SRCPIXEL
-
-#define SRCPIXEL \
-   fg2rgb[colormap[column.translation[source[frac>>FRACBITS]]]]
-
-#define SRCPIXEL_MASK \
-   fg2rgb[colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]]
-
 //
 // R_DrawAddTlatedColumn
 //
 // haleyjd 02/08/05: additive translucency + translation
-// The slowest of all column drawers!
 //
-void CB_DrawAddTRColumn_8(void)
+void CB_DrawAddTRColumn_8(const cb_column_t &column)
 {
-   int count;
-   byte *dest;
-   fixed_t frac;
-   fixed_t fracstep;
-   unsigned int *fg2rgb, *bg2rgb;
-   unsigned int a, b;
-
-   count = column.y2 - column.y1 + 1;
-   if(count <= 0) return;
-
-#ifdef RANGECHECK 
-   if(column.x  < 0 || column.x  >= video.width || 
-      column.y1 < 0 || column.y2 >= video.height)
-      I_Error("CB_DrawAddTRColumn_8: %i to %i at %i\n", column.y1, column.y2, column.x);    
-#endif 
-
-   {
-      unsigned int fglevel, bglevel;
-      
-      fglevel = column.translevel & ~0x3ff;
-      bglevel = FRACUNIT;
-      fg2rgb  = Col2RGB8_LessPrecision[fglevel >> 10];
-      bg2rgb  = Col2RGB8_LessPrecision[bglevel >> 10];
-   }
-
-   dest = R_ADDRESS(column.x, column.y1);
-   fracstep = column.step;
-   frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
-
-   {
-      byte *source = (byte *)(column.source);
-      lighttable_t *colormap = column.colormap;
-      int heightmask = column.texheight - 1;
-      
-      if(column.texheight & heightmask)
-      {
-         heightmask++;
-         heightmask <<= FRACBITS;
-          
-         if (frac < 0)
-            while ((frac += heightmask) <  0);
-         else
-            while (frac >= (int)heightmask)
-               frac -= heightmask;          
-
-         do
-         {
-            // mask out LSBs in green and red to allow overflow
-            a = SRCPIXEL + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            
-            dest += linesize;          // killough 11/98
-            if((frac += fracstep) >= heightmask)
-               frac -= heightmask;
-         } 
-         while(--count);
-      }
-      else
-      {
-         while((count -= 2) >= 0) // texture height is a power of 2 -- killough
-         {
-            a = SRCPIXEL_MASK + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;
-
-            a = SRCPIXEL_MASK + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            dest += linesize;   // killough 11/98
-            frac += fracstep;            
-         }
-         if(count & 1)
-         {
-            a = SRCPIXEL_MASK + bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-         }
-      }
-   }
+   CB_drawBlendTRColumn_8(column, addblendmaps[V_BlendLevel(column.translevel)]);
 }
 
-#undef SRCPIXEL
-#undef SRCPIXEL_MASK
-
 //
 // Normal Column Drawer Object
 // haleyjd 09/04/06
@@ -1305,7 +899,7 @@ void R_DrawViewBorder()
 } 
 
 // haleyjd: experimental column drawer for masked sky textures
-void R_DrawNewSkyColumn() 
+void R_DrawNewSkyColumn(const cb_column_t &column) 
 { 
   int      count; 
   byte    *dest;            // killough
@@ -63,21 +63,26 @@ enum
 // multiple sets of column drawing functions (ie., normal, low detail, and
 // quad buffer optimized).
 //
+// The column is passed in rather than read from the global so that a
+// recorded column can be replayed from any thread.
+//
+struct cb_column_t;
+
 struct columndrawer_t
 {
-   void (*DrawColumn)();       // normal
-   void (*DrawTLColumn)();     // translucent
-   void (*DrawTRColumn)();     // translated
-   void (*DrawTLTRColumn)();   // translucent/translated
-   void (*DrawFuzzColumn)();   // spectre fuzz
-   void (*DrawFlexColumn)();   // flex translucent
-   void (*DrawFlexTRColumn)(); // flex translucent/translated
-   void (*DrawAddColumn)();    // additive flextran
-   void (*DrawAddTRColumn)();  // additive flextran/translated
-
-   void (*ResetBuffer)();      // reset function (may be null)
+   void (*DrawColumn)(const cb_column_t &);         // normal
+   void (*DrawTLColumn)(const cb_column_t &);       // translucent
+   void (*DrawTRColumn)(const cb_column_t &);       // translated
+   void (*DrawTLTRColumn)(const cb_column_t &);     // translucent/translated
+   void (*DrawFuzzColumn)(const cb_column_t &);     // spectre fuzz
+   void (*DrawFlexColumn)(const cb_column_t &);     // flex translucent
+   void (*DrawFlexTRColumn)(const cb_column_t &);   // flex translucent/translated
+   void (*DrawAddColumn)(const cb_column_t &);      // additive flextran
+   void (*DrawAddTRColumn)(const cb_column_t &);    // additive flextran/translated
+
+   void (*ResetBuffer)();                           // reset function (may be null)
    
-   void (*ByVisSpriteStyle[VS_NUMSTYLES][2])();
+   void (*ByVisSpriteStyle[VS_NUMSTYLES][2])(const cb_column_t &);
 };
 
 extern columndrawer_t r_normal_drawer;
@@ -92,6 +97,7 @@ void R_VideoEraseScaled(unsigned int x, unsigned int y, unsigned int w, unsigned
 
 // start of a 64*64 tile image
 extern byte **translationtables; // haleyjd 01/12/04: now ptr-to-ptr
+extern int    numtranslations;
 
 // haleyjd 06/22/08: Span styles enumeration
 enum
@@ -120,14 +126,18 @@ enum
 // multiple sets of span drawing functions (ie, low detail, low precision,
 // high precision, etc.)
 //
+struct cb_span_t;
+struct cb_slopespan_t;
+
 struct spandrawer_t
 {
-   void (*DrawSpan [SPAN_NUMSTYLES][FLAT_NUMSIZES])();
-   void (*DrawSlope[SPAN_NUMSTYLES][FLAT_NUMSIZES])();
+   void (*DrawSpan [SPAN_NUMSTYLES][FLAT_NUMSIZES])(const cb_span_t &);
+   void (*DrawSlope[SPAN_NUMSTYLES][FLAT_NUMSIZES])(const cb_slopespan_t &);
 };
 
 extern spandrawer_t r_lpspandrawer;  // low-precision
 extern spandrawer_t r_spandrawer;    // normal
+extern spandrawer_t r_ssespandrawer; // SSE2
 
 void R_InitBuffer(int width, int height);
 
@@ -153,6 +163,11 @@ extern byte  *main_submap;   // haleyjd 11/30/13
 #define R_ADDRESS(px, py) \
    (renderscreen + (viewwindow.y + (py)) * linesize + (viewwindow.x + (px)))
 
+// as above, for truecolor screens
+#define R_ADDRESS32(px, py) \
+   ((uint32_t *)(renderscreen + (viewwindow.y + (py)) * linesize) + \
+    (viewwindow.x + (px)))
+
 #define FUZZTABLE 50 
 #define FUZZOFF (SCREENWIDTH)
 
@@ -160,7 +175,7 @@ extern const int fuzzoffset[];
 extern int fuzzpos;
 
 // Cardboard
-typedef struct cb_column_s
+struct cb_column_t
 {
    int x, y1, y2;
 
@@ -175,7 +190,7 @@ typedef struct cb_column_s
    fixed_t translevel; // haleyjd: zdoom style trans level
 
    void *source;
-} cb_column_t;
+};
 
 
 extern cb_column_t column;
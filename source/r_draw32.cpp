@@ -0,0 +1,582 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Truecolor column and span drawers.
+//
+//    Textures and lighting stay paletted: every colormap is expanded once per
+//    palette change into 32-bit colors, and the drawers look texels up through
+//    those instead of the 8-bit colormaps. Translucency is real arithmetic on
+//    the destination pixel rather than a lookup through a 64K blend map, so
+//    these drawers ignore tranmap except to recognize the subtractive map.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+#include "i_system.h"
+#include "doomstat.h"
+#include "hal/i_thread.h"
+#include "r_draw.h"
+#include "r_draw32.h"
+#include "r_lighting.h"
+#include "r_main.h"
+#include "r_plane.h"
+#include "v_misc.h"
+#include "v_video.h"
+
+//==============================================================================
+//
+// 32-bit Colormaps
+//
+
+static uint32_t     **colormaps32;      // expanded copy of each colormap lump
+static lighttable_t **colormaps32src;   // the lumps they were expanded from
+static int           *colormaps32len;
+static int            numcolormaps32;
+static int            colormaps32serial = -1;
+static int            colormaps32gen;   // bumped whenever they are expanded
+
+//
+// Each thread remembers the colormap it last looked up, so that the columns
+// and spans drawn at any light level of that colormap don't search for it. A
+// table that isn't from a colormap lump is expanded into the thread's own
+// buffer, once.
+//
+struct colormap32cache_t
+{
+   const byte     *src;  // start of the 8-bit colormap
+   int             len;  // its length
+   const uint32_t *map;  // its expansion
+   int             gen;  // colormaps32gen when looked up
+   uint32_t        buffer[256];
+};
+
+static I_THREADLOCAL colormap32cache_t colormap32cache;
+
+//
+// R_UpdateColormaps32
+//
+// Re-expands the colormaps when the palette or the set of colormaps has
+// changed. Must be called on the main thread before anything is drawn.
+//
+void R_UpdateColormaps32()
+{
+   bool changed = (numcolormaps32 != numcolormaps);
+
+   for(int i = 0; i < numcolormaps32 && !changed; i++)
+   {
+      if(colormaps32src[i] != colormaps[i] || colormaps32len[i] != colormaplengths[i])
+         changed = true;
+   }
+
+   if(!changed && colormaps32serial == v_palette32serial)
+      return;
+
+   if(changed)
+   {
+      for(int i = 0; i < numcolormaps32; i++)
+         efree(colormaps32[i]);
+
+      numcolormaps32 = numcolormaps;
+      colormaps32    = erealloc(uint32_t **,     colormaps32,    numcolormaps * sizeof(uint32_t *));
+      colormaps32src = erealloc(lighttable_t **, colormaps32src, numcolormaps * sizeof(lighttable_t *));
+      colormaps32len = erealloc(int *,           colormaps32len, numcolormaps * sizeof(int));
+
+      for(int i = 0; i < numcolormaps; i++)
+      {
+         colormaps32src[i] = colormaps[i];
+         colormaps32len[i] = colormaplengths[i];
+         colormaps32[i]    = emalloc(uint32_t *, colormaplengths[i] * sizeof(uint32_t));
+      }
+   }
+
+   for(int i = 0; i < numcolormaps32; i++)
+   {
+      const lighttable_t *src = colormaps32src[i];
+      uint32_t           *dst = colormaps32[i];
+
+      for(int j = 0; j < colormaps32len[i]; j++)
+         dst[j] = Col2RGB32[src[j]];
+   }
+
+   colormaps32serial = v_palette32serial;
+   ++colormaps32gen;
+}
+
+//
+// R_Colormap32
+//
+// Returns the expanded version of a 256-entry lighting table. The pointer
+// stays good until the calling thread looks up another table. Only reads 
+// shared state, so is safe in span jobs.
+//
+const uint32_t *R_Colormap32(const byte *colormap)
+{
+   colormap32cache_t &cache = colormap32cache;
+   uintptr_t ofs = uintptr_t(colormap) - uintptr_t(cache.src);
+
+   if(cache.gen == colormaps32gen && ofs < uintptr_t(cache.len) && 
+      ofs + 256 <= uintptr_t(cache.len))
+      return cache.map + ofs;
+
+   cache.gen = colormaps32gen;
+
+   for(int i = 0; i < numcolormaps32; i++)
+   {
+      uintptr_t len = uintptr_t(colormaps32len[i]);
+
+      ofs = uintptr_t(colormap) - uintptr_t(colormaps32src[i]);
+
+      if(ofs < len && ofs + 256 <= len)
+      {
+         cache.src = colormaps32src[i];
+         cache.len = colormaps32len[i];
+         cache.map = colormaps32[i];
+         return cache.map + ofs;
+      }
+   }
+
+   for(int i = 0; i < 256; i++)
+      cache.buffer[i] = Col2RGB32[colormap[i]];
+
+   cache.src = colormap;
+   cache.len = 256;
+   cache.map = cache.buffer;
+   return cache.map;
+}
+
+//==============================================================================
+//
+// Blend Operations
+//
+// Each combines a lit source color with the pixel already in the buffer.
+//
+
+struct r_copy32_t
+{
+   uint32_t operator () (uint32_t src, uint32_t) const { return src; }
+};
+
+struct r_alpha32_t
+{
+   unsigned int alpha; // 0 to 256
+   uint32_t operator () (uint32_t src, uint32_t dest) const
+   {
+      return V_BlendRGB32(src, dest, alpha);
+   }
+};
+
+struct r_add32_t
+{
+   unsigned int alpha; // 0 to 256, applied to the source only
+   uint32_t operator () (uint32_t src, uint32_t dest) const
+   {
+      return V_AddRGB32(V_ScaleRGB32(src, alpha), dest);
+   }
+};
+
+struct r_sub32_t
+{
+   uint32_t operator () (uint32_t src, uint32_t dest) const
+   {
+      return V_SubRGB32(src, dest);
+   }
+};
+
+//
+// R_tranAlpha32
+//
+// BOOM translucency level as a 32-bit alpha.
+//
+static inline unsigned int R_tranAlpha32()
+{
+   return (unsigned int)(tran_filter_pct * 256 / 100);
+}
+
+//==============================================================================
+//
+// Column Drawers
+//
+
+//
+// CB_drawColumn_32
+//
+// The one column loop; the blend operation and whether the column is
+// translated are the only things that vary.
+//
+template<typename B, bool translated>
+static void CB_drawColumn_32(const cb_column_t &column, const B &blend)
+{
+   int count;
+   uint32_t *dest;
+   fixed_t frac;
+   fixed_t fracstep;
+
+   count = column.y2 - column.y1 + 1;
+   if(count <= 0) return;
+
+#ifdef RANGECHECK
+   if(column.x  < 0 || column.x  >= video.width ||
+      column.y1 < 0 || column.y2 >= video.height)
+      I_Error("CB_drawColumn_32: %i to %i at %i\n", column.y1, column.y2, column.x);
+#endif
+
+   const int pitch = linesize / 4;
+
+   dest = R_ADDRESS32(column.x, column.y1);
+   fracstep = column.step;
+   frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
+
+   {
+      const byte     *source      = (const byte *)(column.source);
+      const byte     *translation = column.translation;
+      const uint32_t *colormap    = R_Colormap32(column.colormap);
+      int heightmask = column.texheight - 1;
+
+      if(column.texheight & heightmask)
+      {
+         heightmask++;
+         heightmask <<= FRACBITS;
+
+         if(frac < 0)
+            while((frac += heightmask) <  0);
+         else
+            while(frac >= heightmask)
+               frac -= heightmask;
+
+         do
+         {
+            byte texel = source[frac >> FRACBITS];
+            if(translated)
+               texel = translation[texel];
+            *dest = blend(colormap[texel], *dest);
+            dest += pitch;
+            if((frac += fracstep) >= heightmask)
+               frac -= heightmask;
+         }
+         while(--count);
+      }
+      else
+      {
+         do
+         {
+            byte texel = source[(frac >> FRACBITS) & heightmask];
+            if(translated)
+               texel = translation[texel];
+            *dest = blend(colormap[texel], *dest);
+            dest += pitch;
+            frac += fracstep;
+         }
+         while(--count);
+      }
+   }
+}
+
+static void CB_DrawColumn_32(const cb_column_t &column)
+{
+   CB_drawColumn_32<r_copy32_t, false>(column, r_copy32_t());
+}
+
+static void CB_DrawTRColumn_32(const cb_column_t &column)
+{
+   CB_drawColumn_32<r_copy32_t, true>(column, r_copy32_t());
+}
+
+//
+// CB_DrawTLColumn_32
+//
+// BOOM translucency. The subtractive map is recognized and done for real;
+// any other tranmap becomes an alpha blend at the translucency percentage.
+//
+static void CB_DrawTLColumn_32(const cb_column_t &column)
+{
+   if(tranmap == main_submap)
+      CB_drawColumn_32<r_sub32_t, false>(column, r_sub32_t());
+   else
+   {
+      r_alpha32_t blend = { R_tranAlpha32() };
+      CB_drawColumn_32<r_alpha32_t, false>(column, blend);
+   }
+}
+
+static void CB_DrawTLTRColumn_32(const cb_column_t &column)
+{
+   if(tranmap == main_submap)
+      CB_drawColumn_32<r_sub32_t, true>(column, r_sub32_t());
+   else
+   {
+      r_alpha32_t blend = { R_tranAlpha32() };
+      CB_drawColumn_32<r_alpha32_t, true>(column, blend);
+   }
+}
+
+static void CB_DrawFlexColumn_32(const cb_column_t &column)
+{
+   r_alpha32_t blend = { (unsigned int)column.translevel >> 8 };
+   CB_drawColumn_32<r_alpha32_t, false>(column, blend);
+}
+
+static void CB_DrawFlexTRColumn_32(const cb_column_t &column)
+{
+   r_alpha32_t blend = { (unsigned int)column.translevel >> 8 };
+   CB_drawColumn_32<r_alpha32_t, true>(column, blend);
+}
+
+static void CB_DrawAddColumn_32(const cb_column_t &column)
+{
+   r_add32_t blend = { (unsigned int)column.translevel >> 8 };
+   CB_drawColumn_32<r_add32_t, false>(column, blend);
+}
+
+static void CB_DrawAddTRColumn_32(const cb_column_t &column)
+{
+   r_add32_t blend = { (unsigned int)column.translevel >> 8 };
+   CB_drawColumn_32<r_add32_t, true>(column, blend);
+}
+
+//
+// CB_DrawFuzzColumn_32
+//
+// Spectre fuzz. The 8-bit drawer remaps the neighboring pixel through light
+// level 6 of the colormap; here it is scaled by the same amount (26/32).
+//
+static void CB_DrawFuzzColumn_32(const cb_column_t &incolumn)
+{
+   cb_column_t column = incolumn; // borders are adjusted below
+   int count;
+   uint32_t *dest;
+
+   // Adjust borders. Low...
+   if(!column.y1)
+      column.y1 = 1;
+
+   // .. and high.
+   if(column.y2 == viewwindow.height - 1)
+      column.y2 = viewwindow.height - 2;
+
+   count = column.y2 - column.y1 + 1;
+   if(count <= 0) return;
+
+#ifdef RANGECHECK
+   if(column.x  < 0 || column.x  >= video.width ||
+      column.y1 < 0 || column.y2 >= video.height)
+      I_Error("CB_DrawFuzzColumn_32: %i to %i at %i\n", column.y1, column.y2, column.x);
+#endif
+
+   const int pitch = linesize / 4;
+
+   dest = R_ADDRESS32(column.x, column.y1);
+
+   do
+   {
+      *dest = V_ScaleRGB32(dest[fuzzoffset[fuzzpos] ? pitch : -pitch], 208);
+      if(++fuzzpos == FUZZTABLE) fuzzpos = 0;
+      dest += pitch;
+   }
+   while(--count);
+}
+
+//
+// Truecolor Column Drawer Object
+//
+columndrawer_t r_truecolor_drawer =
+{
+   CB_DrawColumn_32,
+   CB_DrawTLColumn_32,
+   CB_DrawTRColumn_32,
+   CB_DrawTLTRColumn_32,
+   CB_DrawFuzzColumn_32,
+   CB_DrawFlexColumn_32,
+   CB_DrawFlexTRColumn_32,
+   CB_DrawAddColumn_32,
+   CB_DrawAddTRColumn_32,
+
+   NULL,
+
+   {
+      // Normal               Translated
+      { CB_DrawColumn_32,     CB_DrawTRColumn_32     }, // NORMAL
+      { CB_DrawFuzzColumn_32, CB_DrawFuzzColumn_32   }, // SHADOW
+      { CB_DrawFlexColumn_32, CB_DrawFlexTRColumn_32 }, // ALPHA
+      { CB_DrawAddColumn_32,  CB_DrawAddTRColumn_32  }, // ADD
+      { CB_DrawTLColumn_32,   CB_DrawTLTRColumn_32   }, // SUB
+      { CB_DrawTLColumn_32,   CB_DrawTLTRColumn_32   }, // TRANMAP
+   },
+};
+
+//==============================================================================
+//
+// Orthogonal Span Drawers
+//
+// As in r_spansse.cpp, the shifts and masks come from the span, so one drawer
+// serves every flat size.
+//
+
+template<typename B>
+static void R_drawSpan_32(const cb_span_t &span, const B &blend)
+{
+   unsigned int xf = span.xfrac, xs = span.xstep;
+   unsigned int yf = span.yfrac, ys = span.ystep;
+   int count = span.x2 - span.x1 + 1;
+
+   const uint32_t *colormap = R_Colormap32(span.colormap);
+   const byte     *source   = (const byte *)span.source;
+   uint32_t       *dest     = R_ADDRESS32(span.x1, span.y);
+
+   unsigned int xshift = span.xshift;
+   unsigned int xmask  = span.xmask;
+   unsigned int yshift = span.yshift;
+
+   while(count-- > 0)
+   {
+      *dest = blend(colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]], *dest);
+      ++dest;
+      xf += xs;
+      yf += ys;
+   }
+}
+
+static void R_DrawSpanSolid_32(const cb_span_t &span)
+{
+   R_drawSpan_32(span, r_copy32_t());
+}
+
+static void R_DrawSpanTL_32(const cb_span_t &span)
+{
+   r_alpha32_t blend = { span.alpha };
+   R_drawSpan_32(span, blend);
+}
+
+static void R_DrawSpanAdd_32(const cb_span_t &span)
+{
+   r_add32_t blend = { span.alpha };
+   R_drawSpan_32(span, blend);
+}
+
+//==============================================================================
+//
+// Slope Span Drawer
+//
+// Same stepping as R_DrawSlope_8_GEN. Each pixel can have its own light
+// level, so the expanded colormap is only looked up again when it changes.
+//
+
+#define SPANJUMP 16
+#define INTERPSTEP (0.0625f)
+
+static void R_DrawSlope_32(const cb_slopespan_t &slopespan)
+{
+   double iu  = slopespan.iufrac, iv  = slopespan.ivfrac;
+   double ius = slopespan.iustep, ivs = slopespan.ivstep;
+   double id  = slopespan.idfrac, ids = slopespan.idstep;
+
+   int count;
+   int mapindex = 0;
+   const lighttable_t *lastmap  = NULL;
+   const uint32_t     *colormap = NULL;
+
+   if((count = slopespan.x2 - slopespan.x1 + 1) < 0)
+      return;
+
+   const byte *src  = (const byte *)slopespan.source;
+   uint32_t   *dest = R_ADDRESS32(slopespan.x1, slopespan.y);
+
+   unsigned int xshift = slopespan.xshift;
+   unsigned int xmask  = slopespan.xmask;
+   unsigned int ymask  = slopespan.ymask;
+
+   while(count > 0)
+   {
+      double ustart, uend;
+      double vstart, vend;
+      double mulstart, mulend;
+      unsigned int ustep, vstep, ufrac, vfrac;
+      int n = count >= SPANJUMP ? SPANJUMP : count;
+
+      mulstart = 65536.0f / id;
+      id += ids * n;
+      mulend = 65536.0f / id;
+
+      ufrac = (int)(ustart = iu * mulstart);
+      vfrac = (int)(vstart = iv * mulstart);
+      iu += ius * n;
+      iv += ivs * n;
+      uend = iu * mulend;
+      vend = iv * mulend;
+
+      if(n == SPANJUMP)
+      {
+         ustep = (int)((uend - ustart) * INTERPSTEP);
+         vstep = (int)((vend - vstart) * INTERPSTEP);
+      }
+      else
+      {
+         ustep = (int)((uend - ustart) / n);
+         vstep = (int)((vend - vstart) / n);
+      }
+
+      count -= n;
+      while(n--)
+      {
+         const lighttable_t *map = slopespan.colormap[mapindex++];
+
+         if(map != lastmap)
+            colormap = R_Colormap32(lastmap = map);
+
+         *dest++ = colormap[src[((vfrac >> xshift) & xmask) | ((ufrac >> 16) & ymask)]];
+         ufrac += ustep;
+         vfrac += vstep;
+      }
+   }
+}
+
+#undef SPANJUMP
+#undef INTERPSTEP
+
+//==============================================================================
+//
+// Span Engine Object
+//
+
+#define SPANS32(func) { func, func, func, func, func }
+
+// the truecolor span drawer; R_SetSpanEngine forces it for 32-bit screens
+spandrawer_t r_truecolorspandrawer =
+{
+   // Orthogonal span drawers
+   {
+      SPANS32(R_DrawSpanSolid_32), // Solid
+      SPANS32(R_DrawSpanTL_32),    // Translucent
+      SPANS32(R_DrawSpanAdd_32)    // Additive
+   },
+
+   // Sloped span drawers (translucent and additive are TODO, as in
+   // r_spandrawer)
+   {
+      SPANS32(R_DrawSlope_32),
+      SPANS32(R_DrawSlope_32),
+      SPANS32(R_DrawSlope_32)
+   }
+};
+
+#undef SPANS32
+
+// EOF
+
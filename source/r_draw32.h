@@ -0,0 +1,41 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Truecolor column and span drawers.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef R_DRAW32_H__
+#define R_DRAW32_H__
+
+struct columndrawer_t;
+struct spandrawer_t;
+
+extern columndrawer_t r_truecolor_drawer;
+extern spandrawer_t   r_truecolorspandrawer;
+
+void R_UpdateColormaps32();
+const uint32_t *R_Colormap32(const byte *colormap);
+
+#endif
+
+// EOF
+
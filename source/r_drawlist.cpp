@@ -0,0 +1,485 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Deferred wall and flat drawing.
+//
+//    With r_drawlist on, the wall columns found by the BSP walk and the sky
+//    columns and flat spans made by R_DrawPlanes are recorded instead of
+//    drawn. Once the solid geometry of the frame is known, the list is
+//    replayed in command order, one vertical strip of the view per job.
+//
+//    Strips rather than rectangles are used because the column drawers
+//    derive their texture position from y1 in floating point; a column that
+//    is drawn whole is exact, while one split across rows would not be.
+//    Orthogonal spans are split exactly at strip edges. Sloped spans are
+//    split too, but their perspective divide is redone at the edge, so they
+//    may differ from an immediate draw by a texel there.
+//
+//    The last frame's list is kept until the next one begins, along with the
+//    textures it uses, so that it can be replayed by r_drawlistbench.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+#include "i_system.h"
+
+#include "c_io.h"
+#include "c_runcmd.h"
+#include "doomstat.h"
+#include "hal/i_thread.h"
+#include "hal/i_timer.h"
+#include "m_collection.h"
+#include "r_data.h"
+#include "r_draw.h"
+#include "r_drawlist.h"
+#include "r_main.h"
+#include "r_plane.h"
+#include "r_state.h"
+#include "v_alloc.h"
+#include "v_misc.h"
+
+bool r_drawlist;
+bool r_drawlistactive;
+
+//==============================================================================
+//
+// Commands
+//
+
+enum
+{
+   DL_COLUMN,
+   DL_SPAN,
+   DL_SLOPE
+};
+
+//
+// One entry in the draw list. The extent lets a strip skip commands without
+// touching their parameters, which live in a separate array for each type.
+//
+struct dlcommand_t
+{
+   int16_t type;
+   int16_t x1, x2;  // columns of the view touched by the command
+   int32_t index;   // into dlcolumns, dlspans or dlslopes
+};
+
+struct dlcolumn_t
+{
+   void (*func)(const cb_column_t &);
+   cb_column_t column;
+};
+
+struct dlspan_t
+{
+   void (*func)(const cb_span_t &);
+   cb_span_t span;
+};
+
+struct dlslope_t
+{
+   void (*func)(const cb_slopespan_t &);
+   cb_slopespan_t slopespan;
+   size_t colormap; // first of the span's colormaps in dlslopecolormaps
+};
+
+static PODCollection<dlcommand_t>    dlcommands;
+static PODCollection<dlcolumn_t>     dlcolumns;
+static PODCollection<dlspan_t>       dlspans;
+static PODCollection<dlslope_t>      dlslopes;
+static PODCollection<lighttable_t *> dlslopecolormaps;
+static PODCollection<texture_t *>    dlpins;
+
+static size_t dlflushed;           // commands already drawn
+static int    dlwidth, dlheight;   // view size the list was recorded at
+static void (*dlreset)();          // column engine flush, if it buffers columns
+
+#define MAXDLSTRIPS 128
+
+//
+// R_ClearDrawList
+//
+// Drops the recorded list and lets the zone purge the textures it used.
+//
+void R_ClearDrawList()
+{
+   for(texture_t **itr = dlpins.begin(); itr != dlpins.end(); ++itr)
+   {
+      // may have been moved into the texture atlas since
+      if((*itr)->buffer && !((*itr)->flags & TF_ATLAS))
+         Z_ChangeTag((*itr)->buffer, PU_CACHE);
+   }
+
+   dlpins.resize(0);
+   dlcommands.resize(0);
+   dlcolumns.resize(0);
+   dlspans.resize(0);
+   dlslopes.resize(0);
+   dlslopecolormaps.resize(0);
+   dlflushed = 0;
+   r_drawlistactive = false;
+}
+
+VALLOCATION(drawlist)
+{
+   // recorded coordinates are meaningless at a new resolution
+   R_ClearDrawList();
+}
+
+//
+// R_DrawListHold
+//
+// Keeps a purgable texture at PU_STATIC until the list is cleared.
+//
+void R_DrawListHold(texture_t *tex)
+{
+   if(tex->buffer && !(tex->flags & TF_ATLAS) && Z_CheckTag(tex->buffer) == PU_CACHE)
+   {
+      Z_ChangeTag(tex->buffer, PU_STATIC);
+      dlpins.add(tex);
+   }
+}
+
+//
+// R_DrawListTexture
+//
+// Gets a texture ready to have its columns recorded. Swirling flats used as
+// textures all share one distortion buffer, so columns from those are not
+// recorded; false is returned once everything recorded so far has been
+// drawn, and the caller should draw its columns immediately.
+//
+bool R_DrawListTexture(int texnum)
+{
+   texture_t *tex = textures[texnum];
+
+   if(tex->flags & TF_SWIRLY && tex->flatsize == FLAT_64)
+   {
+      R_FlushDrawList();
+      return false;
+   }
+
+   if(!tex->buffer)
+      R_CacheTexture(texnum);
+
+   R_DrawListHold(tex);
+   return true;
+}
+
+//
+// R_DrawListColumn
+//
+void R_DrawListColumn(void (*func)(const cb_column_t &), const cb_column_t &column)
+{
+   dlcommand_t cmd =
+   {
+      DL_COLUMN, int16_t(column.x), int16_t(column.x), int32_t(dlcolumns.getLength())
+   };
+   dlcolumn_t dc = { func, column };
+
+   dlcolumns.add(dc);
+   dlcommands.add(cmd);
+}
+
+//
+// R_DrawListSpan
+//
+void R_DrawListSpan(void (*func)(const cb_span_t &), const cb_span_t &span)
+{
+   dlcommand_t cmd =
+   {
+      DL_SPAN, int16_t(span.x1), int16_t(span.x2), int32_t(dlspans.getLength())
+   };
+   dlspan_t ds = { func, span };
+
+   dlspans.add(ds);
+   dlcommands.add(cmd);
+}
+
+//
+// R_DrawListSlope
+//
+// The per-pixel colormaps of a sloped span are in a buffer that is reused by
+// the next span, so they are copied.
+//
+void R_DrawListSlope(void (*func)(const cb_slopespan_t &),
+                     const cb_slopespan_t &slopespan)
+{
+   int count = slopespan.x2 - slopespan.x1 + 1;
+
+   if(count <= 0)
+      return;
+
+   dlcommand_t cmd =
+   {
+      DL_SLOPE, int16_t(slopespan.x1), int16_t(slopespan.x2),
+      int32_t(dlslopes.getLength())
+   };
+   dlslope_t ds = { func, slopespan, dlslopecolormaps.getLength() };
+
+   for(int i = 0; i < count; i++)
+      dlslopecolormaps.add(slopespan.colormap[i]);
+
+   dlslopes.add(ds);
+   dlcommands.add(cmd);
+}
+
+//==============================================================================
+//
+// Replay
+//
+
+struct dlreplay_t
+{
+   size_t first, last; // range of commands to draw
+   int numstrips;
+};
+
+//
+// R_replayColumn
+//
+static void R_replayColumn(const dlcommand_t &cmd)
+{
+   const dlcolumn_t &dc = dlcolumns.begin()[cmd.index];
+
+   dc.func(dc.column);
+}
+
+//
+// R_replaySpan
+//
+// Spans step their texture position linearly, so the part of one within a
+// strip is found by stepping the start forward.
+//
+static void R_replaySpan(const dlcommand_t &cmd, int sx1, int sx2)
+{
+   const dlspan_t &ds = dlspans.begin()[cmd.index];
+
+   if(cmd.x1 >= sx1 && cmd.x2 <= sx2)
+   {
+      ds.func(ds.span);
+      return;
+   }
+
+   cb_span_t span = ds.span;
+
+   if(span.x1 < sx1)
+   {
+      unsigned int dx = sx1 - span.x1;
+
+      span.xfrac += dx * span.xstep;
+      span.yfrac += dx * span.ystep;
+      span.x1 = sx1;
+   }
+   if(span.x2 > sx2)
+      span.x2 = sx2;
+
+   ds.func(span);
+}
+
+//
+// R_replaySlope
+//
+static void R_replaySlope(const dlcommand_t &cmd, int sx1, int sx2)
+{
+   const dlslope_t &ds = dlslopes.begin()[cmd.index];
+   cb_slopespan_t slopespan = ds.slopespan;
+
+   slopespan.colormap = dlslopecolormaps.begin() + ds.colormap;
+
+   if(slopespan.x1 < sx1)
+   {
+      int dx = sx1 - slopespan.x1;
+
+      slopespan.iufrac   += dx * slopespan.iustep;
+      slopespan.ivfrac   += dx * slopespan.ivstep;
+      slopespan.idfrac   += dx * slopespan.idstep;
+      slopespan.colormap += dx;
+      slopespan.x1 = sx1;
+   }
+   if(slopespan.x2 > sx2)
+      slopespan.x2 = sx2;
+
+   ds.func(slopespan);
+}
+
+//
+// R_replayStrip
+//
+// Worker job: draws the part of each command that falls in one strip.
+//
+static void R_replayStrip(int jobnum, void *data)
+{
+   const dlreplay_t *replay = static_cast<dlreplay_t *>(data);
+   const dlcommand_t *cmds = dlcommands.begin();
+   int sx1 = dlwidth * jobnum / replay->numstrips;
+   int sx2 = dlwidth * (jobnum + 1) / replay->numstrips - 1;
+
+   for(size_t i = replay->first; i < replay->last; i++)
+   {
+      const dlcommand_t &cmd = cmds[i];
+
+      if(cmd.x2 < sx1 || cmd.x1 > sx2)
+         continue;
+
+      switch(cmd.type)
+      {
+      case DL_COLUMN:
+         R_replayColumn(cmd);
+         break;
+      case DL_SPAN:
+         R_replaySpan(cmd, sx1, sx2);
+         break;
+      case DL_SLOPE:
+         R_replaySlope(cmd, sx1, sx2);
+         break;
+      }
+   }
+}
+
+//
+// R_replayDrawList
+//
+static void R_replayDrawList(size_t first, size_t last)
+{
+   dlreplay_t replay;
+
+   if(first >= last)
+      return;
+
+   replay.first = first;
+   replay.last  = last;
+
+   // column engines that gather columns into a shared buffer can only be
+   // driven from one thread
+   if(I_GetWorkerThreads() > 0 && !dlreset)
+      replay.numstrips = (I_GetWorkerThreads() + 1) * 2;
+   else
+      replay.numstrips = 1;
+
+   if(replay.numstrips > MAXDLSTRIPS)
+      replay.numstrips = MAXDLSTRIPS;
+   if(replay.numstrips > dlwidth)
+      replay.numstrips = dlwidth;
+
+   I_RunJobs(replay.numstrips, R_replayStrip, &replay);
+}
+
+//
+// R_BeginDrawList
+//
+// Called at the start of each frame. Releases the previous frame's list and
+// starts recording a new one if r_drawlist is set.
+//
+void R_BeginDrawList()
+{
+   R_ClearDrawList();
+
+   if(!r_drawlist)
+      return;
+
+   r_drawlistactive = true;
+   dlwidth  = viewwindow.width;
+   dlheight = viewwindow.height;
+   dlreset  = r_column_engine->ResetBuffer;
+}
+
+//
+// R_FlushDrawList
+//
+// Draws everything recorded since the last flush.
+//
+void R_FlushDrawList()
+{
+   size_t numcmds = dlcommands.getLength();
+
+   R_replayDrawList(dlflushed, numcmds);
+   dlflushed = numcmds;
+}
+
+//
+// R_FinishDrawList
+//
+// Draws what is left of the list and stops recording; anything drawn after
+// this in the frame, such as sprites, goes straight to the screen.
+//
+void R_FinishDrawList()
+{
+   if(!r_drawlistactive)
+      return;
+
+   R_FlushDrawList();
+   r_drawlistactive = false;
+}
+
+//==============================================================================
+//
+// Console Commands
+//
+
+VARIABLE_BOOLEAN(r_drawlist, NULL, onoff);
+CONSOLE_VARIABLE(r_drawlist, r_drawlist, 0) {}
+
+//
+// r_drawlistbench
+//
+// Redraws the last frame's draw list a number of times and reports how long
+// it took.
+//
+CONSOLE_COMMAND(r_drawlistbench, 0)
+{
+   int count = 10;
+   int threads = dlreset ? 1 : I_GetWorkerThreads() + 1;
+   unsigned int starttime, endtime;
+
+   if(Console.argc >= 1)
+      count = Console.argv[0]->toInt();
+   if(count < 1)
+      count = 1;
+
+   if(gamestate != GS_LEVEL || dlcommands.isEmpty())
+   {
+      C_Puts(FC_ERROR "No draw list has been recorded; set r_drawlist 1");
+      return;
+   }
+   if(dlwidth != viewwindow.width || dlheight != viewwindow.height)
+   {
+      C_Puts(FC_ERROR "The view has changed size since the list was recorded");
+      return;
+   }
+
+   starttime = i_haltimer.GetTicks();
+   for(int i = 0; i < count; i++)
+   {
+      R_replayDrawList(0, dlcommands.getLength());
+      if(dlreset)
+         dlreset();
+   }
+   endtime = i_haltimer.GetTicks();
+
+   C_Printf("%d columns, %d spans, %d sloped spans\n",
+            int(dlcolumns.getLength()), int(dlspans.getLength()),
+            int(dlslopes.getLength()));
+   C_Printf("%d replays in %u ms (%.2f ms each, %d threads)\n", count,
+            endtime - starttime, double(endtime - starttime) / count, threads);
+}
+
+// EOF
+
@@ -0,0 +1,53 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Deferred wall and flat drawing.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef R_DRAWLIST_H__
+#define R_DRAWLIST_H__
+
+struct cb_column_t;
+struct cb_span_t;
+struct cb_slopespan_t;
+struct texture_t;
+
+extern bool r_drawlist;       // cvar: record walls and flats, draw them later
+extern bool r_drawlistactive; // a draw list is being recorded this frame
+
+void R_BeginDrawList();
+void R_FinishDrawList();
+void R_FlushDrawList();
+void R_ClearDrawList();
+
+bool R_DrawListTexture(int texnum);
+void R_DrawListHold(texture_t *tex);
+
+void R_DrawListColumn(void (*func)(const cb_column_t &), const cb_column_t &column);
+void R_DrawListSpan(void (*func)(const cb_span_t &), const cb_span_t &span);
+void R_DrawListSlope(void (*func)(const cb_slopespan_t &),
+                     const cb_slopespan_t &slopespan);
+
+#endif
+
+// EOF
+
@@ -29,6 +29,8 @@
 #include "i_system.h"
 
 #include "doomstat.h"
+#include "hal/i_platform.h"
+#include "r_avx2.h"
 #include "r_draw.h"
 #include "r_main.h"
 #include "v_alloc.h"
@@ -36,8 +38,15 @@
 #include "v_video.h"
 #include "w_wad.h"
 
+#ifdef EE_FEATURE_SSE2
+#include <emmintrin.h>
+#endif
+
 extern int *columnofs; 
 
+// Most columns any engine here buffers before flushing
+#define QMAXCOLS 16
+
 // SoM: OPTIMIZE for ANYRES
 typedef enum
 {
@@ -50,22 +59,18 @@ typedef enum
 } columntype_e;
 
 static int    temp_x = 0;
-static int    tempyl[4], tempyh[4];
+static int    tempyl[QMAXCOLS], tempyh[QMAXCOLS];
 static int    startx = 0;
 static int    temptype = COL_NONE;
 static int    commontop, commonbot;
 static byte   *temptranmap = NULL;
-static fixed_t temptranslevel;
-// haleyjd 09/12/04: optimization -- precalculate flex tran lookups
-static unsigned int *temp_fg2rgb;
-static unsigned int *temp_bg2rgb;
 // SoM 7-28-04: Fix the fuzz problem.
 static byte   *tempfuzzmap;
 static byte   *tempbuf;
 
 VALLOCATION(tempbuf)
 {
-   tempbuf = ecalloctag(byte *, h*4, sizeof(byte), PU_VALLOC, NULL);
+   tempbuf = ecalloctag(byte *, h*QMAXCOLS, sizeof(byte), PU_VALLOC, NULL);
 }
 
 //
@@ -92,6 +97,7 @@ static void R_QuadFlushNil(void)
 // This is used when a quad flush isn't possible.
 // Opaque version -- no remapping whatsoever.
 //
+template<int N>
 static void R_FlushWholeOpaque()
 {
    byte *source;
@@ -101,14 +107,14 @@ static void R_FlushWholeOpaque()
    while(--temp_x >= 0)
    {
       yl     = tempyl[temp_x];
-      source = tempbuf + temp_x + (yl << 2);
+      source = tempbuf + temp_x + (yl * N);
       dest   = R_ADDRESS(startx + temp_x, yl);
       count  = tempyh[temp_x] - yl + 1;
       
       while(--count >= 0)
       {
          *dest = *source;
-         source += 4;
+         source += N;
          dest += linesize;
       }
    }
@@ -121,14 +127,15 @@ static void R_FlushWholeOpaque()
 // preparation for a quad flush.
 // Opaque version -- no remapping whatsoever.
 //
-static void R_FlushHTOpaque(void)
+template<int N>
+static void R_FlushHTOpaque()
 {
    byte *source;
    byte *dest;
    int count, colnum = 0;
    int yl, yh;
 
-   while(colnum < 4)
+   while(colnum < N)
    {
       yl = tempyl[colnum];
       yh = tempyh[colnum];
@@ -136,14 +143,14 @@ static void R_FlushHTOpaque(void)
       // flush column head
       if(yl < commontop)
       {
-         source = tempbuf + colnum + (yl << 2);
+         source = tempbuf + colnum + (yl * N);
          dest   = R_ADDRESS(startx + colnum, yl);
          count  = commontop - yl;
          
          while(--count >= 0)
          {
             *dest = *source;
-            source += 4;
+            source += N;
             dest += linesize;
          }
       }
@@ -151,14 +158,14 @@ static void R_FlushHTOpaque(void)
       // flush column tail
       if(yh > commonbot)
       {
-         source = tempbuf + colnum + ((commonbot + 1) << 2);
+         source = tempbuf + colnum + ((commonbot + 1) * N);
          dest   = R_ADDRESS(startx + colnum, commonbot + 1);
          count  = yh - commonbot;
          
          while(--count >= 0)
          {
             *dest = *source;
-            source += 4;
+            source += N;
             dest += linesize;
          }
       }         
@@ -166,6 +173,7 @@ static void R_FlushHTOpaque(void)
    }
 }
 
+template<int N>
 static void R_FlushWholeTL()
 {
    byte *source;
@@ -175,7 +183,7 @@ static void R_FlushWholeTL()
    while(--temp_x >= 0)
    {
       yl     = tempyl[temp_x];
-      source = tempbuf + temp_x + (yl << 2);
+      source = tempbuf + temp_x + (yl * N);
       dest   = R_ADDRESS(startx + temp_x, yl);
       count  = tempyh[temp_x] - yl + 1;
 
@@ -183,12 +191,13 @@ static void R_FlushWholeTL()
       {
          // haleyjd 09/11/04: use temptranmap here
          *dest = temptranmap[(*dest<<8) + *source];
-         source += 4;
+         source += N;
          dest += linesize;
       }
    }
 }
 
+template<int N>
 static void R_FlushHTTL()
 {
    byte *source;
@@ -196,7 +205,7 @@ static void R_FlushHTTL()
    int count;
    int colnum = 0, yl, yh;
 
-   while(colnum < 4)
+   while(colnum < N)
    {
       yl = tempyl[colnum];
       yh = tempyh[colnum];
@@ -204,7 +213,7 @@ static void R_FlushHTTL()
       // flush column head
       if(yl < commontop)
       {
-         source = tempbuf + colnum + (yl << 2);
+         source = tempbuf + colnum + (yl * N);
          dest   = R_ADDRESS(startx + colnum, yl);
          count  = commontop - yl;
 
@@ -212,7 +221,7 @@ static void R_FlushHTTL()
          {
             // haleyjd 09/11/04: use temptranmap here
             *dest = temptranmap[(*dest<<8) + *source];
-            source += 4;
+            source += N;
             dest += linesize;
          }
       }
@@ -220,7 +229,7 @@ static void R_FlushHTTL()
       // flush column tail
       if(yh > commonbot)
       {
-         source = tempbuf + colnum + ((commonbot + 1) << 2);
+         source = tempbuf + colnum + ((commonbot + 1) * N);
          dest   = R_ADDRESS(startx + colnum, commonbot + 1);
          count  = yh - commonbot;
 
@@ -228,7 +237,7 @@ static void R_FlushHTTL()
          {
             // haleyjd 09/11/04: use temptranmap here
             *dest = temptranmap[(*dest<<8) + *source];
-            source += 4;
+            source += N;
             dest += linesize;
          }
       }
@@ -240,6 +249,7 @@ static void R_FlushHTTL()
 #define SRCPIXEL \
    tempfuzzmap[6*256+dest[fuzzoffset[fuzzpos] ? video.pitch: -video.pitch]]
 
+template<int N>
 static void R_FlushWholeFuzz()
 {
    byte *source;
@@ -249,7 +259,7 @@ static void R_FlushWholeFuzz()
    while(--temp_x >= 0)
    {
       yl     = tempyl[temp_x];
-      source = tempbuf + temp_x + (yl << 2);
+      source = tempbuf + temp_x + (yl * N);
       dest   = R_ADDRESS(startx + temp_x, yl);
       count  = tempyh[temp_x] - yl + 1;
 
@@ -262,7 +272,7 @@ static void R_FlushWholeFuzz()
          if(++fuzzpos == FUZZTABLE) 
             fuzzpos = 0;
          
-         source += 4;
+         source += N;
          dest += linesize;
       }
    }
@@ -330,229 +340,92 @@ static void R_FlushHTFuzz()
 
 #undef SRCPIXEL
 
-static void R_FlushWholeFlex()
-{
-   byte *source;
-   byte *dest;
-   int  count, yl;
-   unsigned int fg, bg;
-
-   while(--temp_x >= 0)
-   {
-      yl     = tempyl[temp_x];
-      source = tempbuf + temp_x + (yl << 2);
-      dest   = R_ADDRESS(startx + temp_x, yl);
-      count  = tempyh[temp_x] - yl + 1;
+static void (*R_FlushWholeColumns)() = R_FlushWholeNil;
+static void (*R_FlushHTColumns)()    = R_FlushHTNil;
 
-      while(--count >= 0)
-      {
-         // haleyjd 09/12/04: use precalculated lookups
-         fg = temp_fg2rgb[*source];
-         bg = temp_bg2rgb[*dest];
-         fg = (fg+bg) | 0x1f07c1f;
-         *dest = RGB32k[0][0][fg & (fg>>15)];
-         
-         source += 4;
-         dest += linesize;
-      }
-   }
-}
+// Begin: Quad column flushing functions.
 
-static void R_FlushHTFlex()
+//
+// R_QCopyRow
+//
+// Copies one row of N buffered opaque pixels to the screen.
+//
+template<int N>
+static inline void R_QCopyRow(byte *dest, const byte *source)
 {
-   byte *source;
-   byte *dest;
-   int count;
-   int colnum = 0, yl, yh;
-   unsigned int fg, bg;
-
-   while(colnum < 4)
-   {
-      yl = tempyl[colnum];
-      yh = tempyh[colnum];
-
-      // flush column head
-      if(yl < commontop)
-      {
-         source = tempbuf + colnum + (yl << 2);
-         dest   = R_ADDRESS(startx + colnum, yl);
-         count  = commontop - yl;
-
-         while(--count >= 0)
-         {
-            // haleyjd 09/12/04: use precalculated lookups
-            fg = temp_fg2rgb[*source];
-            bg = temp_bg2rgb[*dest];
-            fg = (fg+bg) | 0x1f07c1f;
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            
-            source += 4;
-            dest += linesize;
-         }
-      }
-
-      // flush column tail
-      if(yh > commonbot)
-      {
-         source = tempbuf + colnum + ((commonbot + 1) << 2);
-         dest   = R_ADDRESS(startx + colnum, commonbot + 1);
-         count  = yh - commonbot;
-
-         while(--count >= 0)
-         {
-            // haleyjd 09/12/04: use precalculated lookups
-            fg = temp_fg2rgb[*source];
-            bg = temp_bg2rgb[*dest];
-            fg = (fg+bg) | 0x1f07c1f;
-            *dest = RGB32k[0][0][fg & (fg>>15)];
-            
-            source += 4;
-            dest += linesize;
-         }
-      }
-      
-      ++colnum;
-   }
+   memcpy(dest, source, N);
 }
 
-static void R_FlushWholeFlexAdd()
+#ifdef EE_FEATURE_SSE2
+template<>
+inline void R_QCopyRow<16>(byte *dest, const byte *source)
 {
-   byte *source;
-   byte *dest;
-   int  count, yl;
-   unsigned int a, b;
-
-   while(--temp_x >= 0)
-   {
-      yl     = tempyl[temp_x];
-      source = tempbuf + temp_x + (yl << 2);
-      dest   = R_ADDRESS(startx + temp_x, yl);
-      count  = tempyh[temp_x] - yl + 1;
-
-      while(--count >= 0)
-      {
-         // mask out LSBs in green and red to allow overflow
-         a = temp_fg2rgb[*source] + temp_bg2rgb[*dest];
-         b = a;
-         
-         a |= 0x01f07c1f;
-         b &= 0x40100400;
-         a &= 0x3fffffff;
-         b  = b - (b >> 5);
-         a |= b;
-         
-         *dest = RGB32k[0][0][a & (a >> 15)];
-         
-         source += 4;
-         dest += linesize;
-      }
-   }
+   _mm_storeu_si128((__m128i *)dest, _mm_loadu_si128((const __m128i *)source));
 }
+#endif
 
-static void R_FlushHTFlexAdd()
+template<int N>
+static void R_FlushQuadOpaque()
 {
-   byte *source;
-   byte *dest;
+   byte *source = tempbuf + (commontop * N);
+   byte *dest   = R_ADDRESS(startx, commontop);
    int count;
-   int colnum = 0, yl, yh;
-   unsigned int a, b;
-
-   while(colnum < 4)
-   {
-      yl = tempyl[colnum];
-      yh = tempyh[colnum];
-
-      // flush column head
-      if(yl < commontop)
-      {
-         source = tempbuf + colnum + (yl << 2);
-         dest   = R_ADDRESS(startx + colnum, yl);
-         count  = commontop - yl;
-
-         while(--count >= 0)
-         {
-            // mask out LSBs in green and red to allow overflow
-            a = temp_fg2rgb[*source] + temp_bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            
-            source += 4;
-            dest += linesize;
-         }
-      }
 
-      // flush column tail
-      if(yh > commonbot)
-      {
-         source = tempbuf + colnum + ((commonbot + 1) << 2);
-         dest   = R_ADDRESS(startx + colnum, commonbot + 1);
-         count  = yh - commonbot;
+   count = commonbot - commontop + 1;
 
-         while(--count >= 0)
-         {
-            // mask out LSBs in green and red to allow overflow
-            a = temp_fg2rgb[*source] + temp_bg2rgb[*dest];
-            b = a;
-            
-            a |= 0x01f07c1f;
-            b &= 0x40100400;
-            a &= 0x3fffffff;
-            b  = b - (b >> 5);
-            a |= b;
-            
-            *dest = RGB32k[0][0][a & (a >> 15)];
-            
-            source += 4;
-            dest += linesize;
-         }
-      }
-      
-      ++colnum;
+   while(--count >= 0)
+   {
+      R_QCopyRow<N>(dest, source);
+      source += N;
+      dest += linesize;
    }
 }
 
-static void (*R_FlushWholeColumns)() = R_FlushWholeNil;
-static void (*R_FlushHTColumns)()    = R_FlushHTNil;
-
-// Begin: Quad column flushing functions.
-static void R_FlushQuadOpaque()
+#ifdef EE_FEATURE_AVX2
+//
+// R_QBlendRowsAVX2
+//
+// Blends count rows of 16 buffered pixels with gathers from temptranmap.
+//
+EE_AVX2_TARGET static void R_QBlendRowsAVX2(byte *dest, const byte *source,
+                                            int count)
 {
-   int *source = (int *)(tempbuf + (commontop << 2));
-   int *dest   = (int *)(R_ADDRESS(startx, commontop));
-   int count;
-   int deststep = linesize / 4;
-
-   count = commonbot - commontop + 1;
-
    while(--count >= 0)
    {
-      *dest = *source++;
-      dest += deststep;
+      __m128i d = _mm_loadu_si128((const __m128i *)dest);
+      __m128i s = _mm_loadu_si128((const __m128i *)source);
+
+      _mm_storeu_si128((__m128i *)dest, R_AVX2Blend16(d, s, temptranmap));
+      source += 16;
+      dest += linesize;
    }
 }
+#endif
 
+template<int N>
 static void R_FlushQuadTL()
 {
-   byte *source = tempbuf + (commontop << 2);
+   byte *source = tempbuf + (commontop * N);
    byte *dest   = R_ADDRESS(startx, commontop);
    int count;
 
    count = commonbot - commontop + 1;
 
+#ifdef EE_FEATURE_AVX2
+   static const bool useavx2 = I_CPUHasAVX2();
+
+   if(N == 16 && useavx2)
+   {
+      R_QBlendRowsAVX2(dest, source, count);
+      return;
+   }
+#endif
+
    while(--count >= 0)
    {
-      *dest   = temptranmap[(*dest<<8) + *source];
-      dest[1] = temptranmap[(dest[1]<<8) + source[1]];
-      dest[2] = temptranmap[(dest[2]<<8) + source[2]];
-      dest[3] = temptranmap[(dest[3]<<8) + source[3]];
-      source += 4;
+      for(int i = 0; i < N; i++)
+         dest[i] = temptranmap[(dest[i]<<8) + source[i]];
+      source += N;
       dest += linesize;
    }
 }
@@ -600,101 +473,12 @@ static void R_FlushQuadFuzz()
 #undef SRCPIXEL
 */
 
-static void R_FlushQuadFlex()
-{
-   byte *source = tempbuf + (commontop << 2);
-   byte *dest   = R_ADDRESS(startx, commontop);
-   int count;
-   unsigned int fg, bg;
-
-   count = commonbot - commontop + 1;
-
-   while(--count >= 0)
-   {
-      // haleyjd 09/12/04: use precalculated lookups
-      fg = temp_fg2rgb[*source];
-      bg = temp_bg2rgb[*dest];
-      fg = (fg+bg) | 0x1f07c1f;
-      *dest = RGB32k[0][0][fg & (fg>>15)];
-
-      fg = temp_fg2rgb[source[1]];
-      bg = temp_bg2rgb[dest[1]];
-      fg = (fg+bg) | 0x1f07c1f;
-      dest[1] = RGB32k[0][0][fg & (fg>>15)];
-
-      fg = temp_fg2rgb[source[2]];
-      bg = temp_bg2rgb[dest[2]];
-      fg = (fg+bg) | 0x1f07c1f;
-      dest[2] = RGB32k[0][0][fg & (fg>>15)];
-
-      fg = temp_fg2rgb[source[3]];
-      bg = temp_bg2rgb[dest[3]];
-      fg = (fg+bg) | 0x1f07c1f;
-      dest[3] = RGB32k[0][0][fg & (fg>>15)];
-
-      source += 4;
-      dest += linesize;
-   }
-}
-
-static void R_FlushQuadFlexAdd()
-{
-   byte *source = tempbuf + (commontop << 2);
-   byte *dest   = R_ADDRESS(startx, commontop);
-   int count;
-   unsigned int a, b;
-
-   count = commonbot - commontop + 1;
-
-   while(--count >= 0)
-   {
-      // haleyjd 02/08/05: this is NOT gonna be very fast.
-      a = temp_fg2rgb[*source] + temp_bg2rgb[*dest];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      *dest = RGB32k[0][0][a & (a >> 15)];
-
-      a = temp_fg2rgb[source[1]] + temp_bg2rgb[dest[1]];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      dest[1] = RGB32k[0][0][a & (a >> 15)];
-
-      a = temp_fg2rgb[source[2]] + temp_bg2rgb[dest[2]];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      dest[2] = RGB32k[0][0][a & (a >> 15)];
-
-      a = temp_fg2rgb[source[3]] + temp_bg2rgb[dest[3]];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      dest[3] = RGB32k[0][0][a & (a >> 15)];
-
-      source += 4;
-      dest += linesize;
-   }
-}
-
 static void (*R_FlushQuadColumn)(void) = R_QuadFlushNil;
 
-static void R_FlushColumns(void)
+template<int N>
+static void R_FlushColumns()
 {
-   if(temp_x != 4 || commontop >= commonbot || temptype == COL_FUZZ)
+   if(temp_x != N || commontop >= commonbot || temptype == COL_FUZZ)
       R_FlushWholeColumns();
    else
    {
@@ -711,11 +495,12 @@ static void R_FlushColumns(void)
 // which gets rid of the unnecessary reset of various variables during
 // column drawing.
 //
-static void R_QResetColumnBuffer(void)
+template<int N>
+static void R_QResetColumnBuffer()
 {
    // haleyjd 10/06/05: this must not be done if temp_x == 0!
    if(temp_x)
-      R_FlushColumns();
+      R_FlushColumns<N>();
    temptype = COL_NONE;
    R_FlushWholeColumns = R_FlushWholeNil;
    R_FlushHTColumns    = R_FlushHTNil;
@@ -726,12 +511,13 @@ static void R_QResetColumnBuffer(void)
 // functions to minimize the number of branches and take advantage
 // of as much precalculated information as possible.
 
-static byte *R_GetBufferOpaque(void)
+template<int N>
+static byte *R_GetBufferOpaque(const cb_column_t &column)
 {
    // haleyjd: reordered predicates
-   if(temp_x == 4 ||
+   if(temp_x == N ||
       (temp_x && (temptype != COL_OPAQUE || temp_x + startx != column.x)))
-      R_FlushColumns();
+      R_FlushColumns<N>();
 
    if(!temp_x)
    {
@@ -740,10 +526,10 @@ static byte *R_GetBufferOpaque(void)
       *tempyl = commontop = column.y1;
       *tempyh = commonbot = column.y2;
       temptype = COL_OPAQUE;
-      R_FlushWholeColumns = R_FlushWholeOpaque;
-      R_FlushHTColumns    = R_FlushHTOpaque;
-      R_FlushQuadColumn   = R_FlushQuadOpaque;
-      return tempbuf + (column.y1 << 2);
+      R_FlushWholeColumns = R_FlushWholeOpaque<N>;
+      R_FlushHTColumns    = R_FlushHTOpaque<N>;
+      R_FlushQuadColumn   = R_FlushQuadOpaque<N>;
+      return tempbuf + (column.y1 * N);
    }
 
    tempyl[temp_x] = column.y1;
@@ -754,15 +540,16 @@ static byte *R_GetBufferOpaque(void)
    if(column.y2 < commonbot)
       commonbot = column.y2;
       
-   return tempbuf + (column.y1 << 2) + temp_x++;
+   return tempbuf + (column.y1 * N) + temp_x++;
 }
 
-static byte *R_GetBufferTrans(void)
+template<int N>
+static byte *R_GetBufferTrans(const cb_column_t &column)
 {
    // haleyjd: reordered predicates
-   if(temp_x == 4 || tranmap != temptranmap ||
+   if(temp_x == N || tranmap != temptranmap ||
       (temp_x && (temptype != COL_TRANS || temp_x + startx != column.x)))
-      R_FlushColumns();
+      R_FlushColumns<N>();
 
    if(!temp_x)
    {
@@ -772,10 +559,10 @@ static byte *R_GetBufferTrans(void)
       *tempyh = commonbot = column.y2;
       temptype = COL_TRANS;
       temptranmap = tranmap;
-      R_FlushWholeColumns = R_FlushWholeTL;
-      R_FlushHTColumns    = R_FlushHTTL;
-      R_FlushQuadColumn   = R_FlushQuadTL;
-      return tempbuf + (column.y1 << 2);
+      R_FlushWholeColumns = R_FlushWholeTL<N>;
+      R_FlushHTColumns    = R_FlushHTTL<N>;
+      R_FlushQuadColumn   = R_FlushQuadTL<N>;
+      return tempbuf + (column.y1 * N);
    }
 
    tempyl[temp_x] = column.y1;
@@ -786,15 +573,20 @@ static byte *R_GetBufferTrans(void)
    if(column.y2 < commonbot)
       commonbot = column.y2;
       
-   return tempbuf + (column.y1 << 2) + temp_x++;
+   return tempbuf + (column.y1 * N) + temp_x++;
 }
 
-static byte *R_GetBufferFlexTrans(void)
+template<int N>
+static byte *R_GetBufferFlexTrans(const cb_column_t &column)
 {
+   // haleyjd 09/12/04: optimization -- the blend map is looked up here
+   // instead of every time a column is flushed.
+   byte *blendmap = flexblendmaps[V_BlendLevel(column.translevel)];
+
    // haleyjd: reordered predicates
-   if(temp_x == 4 || temptranslevel != column.translevel ||
+   if(temp_x == N || blendmap != temptranmap ||
       (temp_x && (temptype != COL_FLEXTRANS || temp_x + startx != column.x)))
-      R_FlushColumns();
+      R_FlushColumns<N>();
 
    if(!temp_x)
    {
@@ -803,23 +595,11 @@ static byte *R_GetBufferFlexTrans(void)
       *tempyl = commontop = column.y1;
       *tempyh = commonbot = column.y2;
       temptype = COL_FLEXTRANS;
-      temptranslevel = column.translevel;
-      
-      // haleyjd 09/12/04: optimization -- calculate flex tran lookups
-      // here instead of every time a column is flushed.
-      {
-         unsigned int fglevel, bglevel;
-         
-         fglevel = temptranslevel & ~0x3ff;
-         bglevel = FRACUNIT - fglevel;
-         temp_fg2rgb  = Col2RGB8[fglevel >> 10];
-         temp_bg2rgb  = Col2RGB8[bglevel >> 10];
-      }
-
-      R_FlushWholeColumns = R_FlushWholeFlex;
-      R_FlushHTColumns    = R_FlushHTFlex;
-      R_FlushQuadColumn   = R_FlushQuadFlex;
-      return tempbuf + (column.y1 << 2);
+      temptranmap = blendmap;
+      R_FlushWholeColumns = R_FlushWholeTL<N>;
+      R_FlushHTColumns    = R_FlushHTTL<N>;
+      R_FlushQuadColumn   = R_FlushQuadTL<N>;
+      return tempbuf + (column.y1 * N);
    }
 
    tempyl[temp_x] = column.y1;
@@ -830,15 +610,20 @@ static byte *R_GetBufferFlexTrans(void)
    if(column.y2 < commonbot)
       commonbot = column.y2;
       
-   return tempbuf + (column.y1 << 2) + temp_x++;
+   return tempbuf + (column.y1 * N) + temp_x++;
 }
 
-static byte *R_GetBufferFlexAdd(void)
+template<int N>
+static byte *R_GetBufferFlexAdd(const cb_column_t &column)
 {
+   // haleyjd 09/12/04: optimization -- the blend map is looked up here
+   // instead of every time a column is flushed.
+   byte *blendmap = addblendmaps[V_BlendLevel(column.translevel)];
+
    // haleyjd: reordered predicates
-   if(temp_x == 4 || temptranslevel != column.translevel ||
+   if(temp_x == N || blendmap != temptranmap ||
       (temp_x && (temptype != COL_FLEXADD || temp_x + startx != column.x)))
-      R_FlushColumns();
+      R_FlushColumns<N>();
 
    if(!temp_x)
    {
@@ -847,21 +632,11 @@ static byte *R_GetBufferFlexAdd(void)
       *tempyl = commontop = column.y1;
       *tempyh = commonbot = column.y2;
       temptype = COL_FLEXADD;
-      temptranslevel = column.translevel;
-      
-      {
-         unsigned int fglevel, bglevel;
-         
-         fglevel = temptranslevel & ~0x3ff;
-         bglevel = FRACUNIT;
-         temp_fg2rgb  = Col2RGB8_LessPrecision[fglevel >> 10];
-         temp_bg2rgb  = Col2RGB8_LessPrecision[bglevel >> 10];
-      }
-
-      R_FlushWholeColumns = R_FlushWholeFlexAdd;
-      R_FlushHTColumns    = R_FlushHTFlexAdd;
-      R_FlushQuadColumn   = R_FlushQuadFlexAdd;
-      return tempbuf + (column.y1 << 2);
+      temptranmap = blendmap;
+      R_FlushWholeColumns = R_FlushWholeTL<N>;
+      R_FlushHTColumns    = R_FlushHTTL<N>;
+      R_FlushQuadColumn   = R_FlushQuadTL<N>;
+      return tempbuf + (column.y1 * N);
    }
 
    tempyl[temp_x] = column.y1;
@@ -872,15 +647,16 @@ static byte *R_GetBufferFlexAdd(void)
    if(column.y2 < commonbot)
       commonbot = column.y2;
       
-   return tempbuf + (column.y1 << 2) + temp_x++;
+   return tempbuf + (column.y1 * N) + temp_x++;
 }
 
-static byte *R_GetBufferFuzz(void)
+template<int N>
+static byte *R_GetBufferFuzz(const cb_column_t &column)
 {
    // haleyjd: reordered predicates
-   if(temp_x == 4 ||
+   if(temp_x == N ||
       (temp_x && (temptype != COL_FUZZ || temp_x + startx != column.x)))
-      R_FlushColumns();
+      R_FlushColumns<N>();
 
    if(!temp_x)
    {
@@ -890,10 +666,10 @@ static byte *R_GetBufferFuzz(void)
       *tempyh = commonbot = column.y2;
       temptype = COL_FUZZ;
       tempfuzzmap = column.colormap; // SoM 7-28-04: Fix the fuzz problem.
-      R_FlushWholeColumns = R_FlushWholeFuzz;
+      R_FlushWholeColumns = R_FlushWholeFuzz<N>;
       R_FlushHTColumns    = R_FlushHTNil;
       R_FlushQuadColumn   = R_QuadFlushNil;
-      return tempbuf + (column.y1 << 2);
+      return tempbuf + (column.y1 * N);
    }
 
    tempyl[temp_x] = column.y1;
@@ -904,10 +680,11 @@ static byte *R_GetBufferFuzz(void)
    if(column.y2 < commonbot)
       commonbot = column.y2;
       
-   return tempbuf + (column.y1 << 2) + temp_x++;
+   return tempbuf + (column.y1 * N) + temp_x++;
 }
 
-static void R_QDrawColumn() 
+template<int N>
+static void R_QDrawColumn(const cb_column_t &column)
 { 
    int      count; 
    byte    *dest;            // killough
@@ -927,7 +704,7 @@ static void R_QDrawColumn()
 
    // Framebuffer destination address.
    // SoM: MAGIC
-   dest = R_GetBufferOpaque();
+   dest = R_GetBufferOpaque<N>(column);
 
    // Determine scaling, which is the only mapping to be done.
 
@@ -964,7 +741,7 @@ static void R_QDrawColumn()
             // heightmask is the Tutti-Frutti fix -- killough
             
             *dest = colormap[source[frac>>FRACBITS]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -975,10 +752,10 @@ static void R_QDrawColumn()
          while((count -= 2) >= 0)   // texture height is a power of 2 -- killough
          {
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -987,7 +764,8 @@ static void R_QDrawColumn()
    }
 } 
 
-static void R_QDrawTLColumn()                                           
+template<int N>
+static void R_QDrawTLColumn(const cb_column_t &column)                                           
 { 
    int      count; 
    byte    *dest;           // killough
@@ -1007,7 +785,7 @@ static void R_QDrawTLColumn()
 #endif 
    
    // SoM: MAGIC
-   dest = R_GetBufferTrans();
+   dest = R_GetBufferTrans<N>(column);
       
    fracstep = column.step; 
    frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
@@ -1035,7 +813,7 @@ static void R_QDrawTLColumn()
          do
          {
             *dest = colormap[source[frac>>FRACBITS]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1046,10 +824,10 @@ static void R_QDrawTLColumn()
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1062,7 +840,8 @@ static void R_QDrawTLColumn()
 #define SRCPIXEL \
    colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]
 
-static void R_QDrawTLTRColumn()
+template<int N>
+static void R_QDrawTLTRColumn(const cb_column_t &column)
 { 
    int      count; 
    byte    *dest;           // killough
@@ -1082,7 +861,7 @@ static void R_QDrawTLTRColumn()
 #endif 
 
    // SoM: MAGIC
-   dest = R_GetBufferTrans();
+   dest = R_GetBufferTrans<N>(column);
    
    fracstep = column.step; 
    frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
@@ -1106,7 +885,7 @@ static void R_QDrawTLTRColumn()
          do
          {
             *dest = colormap[column.translation[source[frac>>FRACBITS]]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1117,10 +896,10 @@ static void R_QDrawTLTRColumn()
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = SRCPIXEL;
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = SRCPIXEL;
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1135,8 +914,11 @@ static void R_QDrawTLTRColumn()
 // Spectre/Invisibility.
 //
 
-static void R_QDrawFuzzColumn(void) 
+template<int N>
+static void R_QDrawFuzzColumn(const cb_column_t &incolumn) 
 { 
+   cb_column_t column = incolumn; // borders are adjusted below
+
    // Adjust borders. Low...
    if(!column.y1) 
       column.y1 = 1;
@@ -1158,7 +940,7 @@ static void R_QDrawFuzzColumn(void)
 #endif
 
    // SoM: MAGIC
-   R_GetBufferFuzz();
+   R_GetBufferFuzz<N>(column);
    
    // REAL MAGIC... you ready for this?
    return; // DONE
@@ -1167,7 +949,8 @@ static void R_QDrawFuzzColumn(void)
 #define SRCPIXEL \
    colormap[column.translation[source[(frac>>FRACBITS) & heightmask]]]
 
-static void R_QDrawTRColumn(void) 
+template<int N>
+static void R_QDrawTRColumn(const cb_column_t &column) 
 { 
    int      count; 
    byte     *dest; 
@@ -1185,7 +968,7 @@ static void R_QDrawTRColumn(void)
 #endif 
 
    // SoM: MAGIC
-   dest = R_GetBufferOpaque();
+   dest = R_GetBufferOpaque<N>(column);
    
    // Looks familiar.
    fracstep = column.step; 
@@ -1213,7 +996,7 @@ static void R_QDrawTRColumn(void)
          do
          {
             *dest = colormap[column.translation[source[frac>>FRACBITS]]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1224,10 +1007,10 @@ static void R_QDrawTRColumn(void)
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = SRCPIXEL;
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = SRCPIXEL;
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1243,7 +1026,8 @@ static void R_QDrawTRColumn(void)
 //
 // haleyjd 09/01/02: zdoom-style translucency
 //
-static void R_QDrawFlexColumn()
+template<int N>
+static void R_QDrawFlexColumn(const cb_column_t &column)
 { 
    int      count; 
    byte    *dest;            // killough
@@ -1263,7 +1047,7 @@ static void R_QDrawFlexColumn()
 #endif 
    
    // SoM: MAGIC
-   dest = R_GetBufferFlexTrans();
+   dest = R_GetBufferFlexTrans<N>(column);
   
    fracstep = column.step; 
    frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
@@ -1287,7 +1071,7 @@ static void R_QDrawFlexColumn()
          do
          {
             *dest = colormap[source[frac>>FRACBITS]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1298,10 +1082,10 @@ static void R_QDrawFlexColumn()
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1319,7 +1103,8 @@ static void R_QDrawFlexColumn()
 // haleyjd 11/05/02: zdoom-style translucency w/translation, for
 // player sprites
 //
-static void R_QDrawFlexTRColumn(void) 
+template<int N>
+static void R_QDrawFlexTRColumn(const cb_column_t &column) 
 { 
    int      count; 
    byte     *dest; 
@@ -1337,7 +1122,7 @@ static void R_QDrawFlexTRColumn(void)
 #endif 
 
    // MAGIC
-   dest = R_GetBufferFlexTrans();
+   dest = R_GetBufferFlexTrans<N>(column);
    
    // Looks familiar.
    fracstep = column.step; 
@@ -1365,7 +1150,7 @@ static void R_QDrawFlexTRColumn(void)
          do
          {
             *dest = colormap[column.translation[source[frac>>FRACBITS]]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1376,10 +1161,10 @@ static void R_QDrawFlexTRColumn(void)
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = SRCPIXEL;
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = SRCPIXEL;
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1395,7 +1180,8 @@ static void R_QDrawFlexTRColumn(void)
 //
 // haleyjd 02/08/05: additive translucency
 //
-static void R_QDrawAddColumn()
+template<int N>
+static void R_QDrawAddColumn(const cb_column_t &column)
 { 
    int      count; 
    byte    *dest;           // killough
@@ -1415,7 +1201,7 @@ static void R_QDrawAddColumn()
 #endif 
    
    // SoM: MAGIC
-   dest = R_GetBufferFlexAdd();
+   dest = R_GetBufferFlexAdd<N>(column);
   
    fracstep = column.step; 
    frac = column.texmid + (int)((column.y1 - view.ycenter + 1) * fracstep);
@@ -1439,7 +1225,7 @@ static void R_QDrawAddColumn()
          do
          {            
             *dest = colormap[source[frac>>FRACBITS]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1450,10 +1236,10 @@ static void R_QDrawAddColumn()
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = colormap[source[(frac>>FRACBITS) & heightmask]];
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1470,7 +1256,8 @@ static void R_QDrawAddColumn()
 //
 // haleyjd 02/08/05: additive translucency + translation
 //
-static void R_QDrawAddTRColumn(void) 
+template<int N>
+static void R_QDrawAddTRColumn(const cb_column_t &column) 
 { 
    int      count; 
    byte     *dest; 
@@ -1488,7 +1275,7 @@ static void R_QDrawAddTRColumn(void)
 #endif 
 
    // MAGIC
-   dest = R_GetBufferFlexAdd();
+   dest = R_GetBufferFlexAdd<N>(column);
    
    // Looks familiar.
    fracstep = column.step;
@@ -1516,7 +1303,7 @@ static void R_QDrawAddTRColumn(void)
          do
          {
             *dest = colormap[column.translation[source[frac>>FRACBITS]]];
-            dest += 4; //SoM: Oh, Oh it's MAGIC! You know...
+            dest += N; //SoM: Oh, Oh it's MAGIC! You know...
             if((frac += fracstep) >= (int)heightmask)
                frac -= heightmask;
          } 
@@ -1527,10 +1314,10 @@ static void R_QDrawAddTRColumn(void)
          while((count -= 2) >= 0) // texture height is a power of 2 -- killough
          {
             *dest = SRCPIXEL;
-            dest += 4; //SoM: MAGIC 
+            dest += N; //SoM: MAGIC 
             frac += fracstep;
             *dest = SRCPIXEL;
-            dest += 4;
+            dest += N;
             frac += fracstep;
          }
          if(count & 1)
@@ -1546,26 +1333,58 @@ static void R_QDrawAddTRColumn(void)
 //
 columndrawer_t r_quad_drawer =
 {
-   R_QDrawColumn,
-   R_QDrawTLColumn,
-   R_QDrawTRColumn,
-   R_QDrawTLTRColumn,
-   R_QDrawFuzzColumn,
-   R_QDrawFlexColumn,
-   R_QDrawFlexTRColumn,
-   R_QDrawAddColumn,
-   R_QDrawAddTRColumn,
-
-   R_QResetColumnBuffer,
+   R_QDrawColumn<4>,
+   R_QDrawTLColumn<4>,
+   R_QDrawTRColumn<4>,
+   R_QDrawTLTRColumn<4>,
+   R_QDrawFuzzColumn<4>,
+   R_QDrawFlexColumn<4>,
+   R_QDrawFlexTRColumn<4>,
+   R_QDrawAddColumn<4>,
+   R_QDrawAddTRColumn<4>,
+
+   R_QResetColumnBuffer<4>,
+
+   {
+      // Normal               Translated
+      { R_QDrawColumn<4>,     R_QDrawTRColumn<4>     }, // NORMAL
+      { R_QDrawFuzzColumn<4>, R_QDrawFuzzColumn<4>   }, // SHADOW
+      { R_QDrawFlexColumn<4>, R_QDrawFlexTRColumn<4> }, // ALPHA
+      { R_QDrawAddColumn<4>,  R_QDrawAddTRColumn<4>  }, // ADD
+      { R_QDrawTLColumn<4>,   R_QDrawTLTRColumn<4>   }, // SUB
+      { R_QDrawTLColumn<4>,   R_QDrawTLTRColumn<4>   }, // TRANMAP
+   },
+};
+
+//
+// Wide Column Drawer Object
+//
+// Same buffering as the quad engine, but sixteen columns wide so that a
+// whole row of the buffer can be flushed with one SSE2 store. Wall runs
+// share more of their span, so more of each column goes out that way.
+//
+columndrawer_t r_wide_drawer =
+{
+   R_QDrawColumn<QMAXCOLS>,
+   R_QDrawTLColumn<QMAXCOLS>,
+   R_QDrawTRColumn<QMAXCOLS>,
+   R_QDrawTLTRColumn<QMAXCOLS>,
+   R_QDrawFuzzColumn<QMAXCOLS>,
+   R_QDrawFlexColumn<QMAXCOLS>,
+   R_QDrawFlexTRColumn<QMAXCOLS>,
+   R_QDrawAddColumn<QMAXCOLS>,
+   R_QDrawAddTRColumn<QMAXCOLS>,
+
+   R_QResetColumnBuffer<QMAXCOLS>,
 
    {
-      // Normal            Translated
-      { R_QDrawColumn,     R_QDrawTRColumn     }, // NORMAL
-      { R_QDrawFuzzColumn, R_QDrawFuzzColumn   }, // SHADOW
-      { R_QDrawFlexColumn, R_QDrawFlexTRColumn }, // ALPHA
-      { R_QDrawAddColumn,  R_QDrawAddTRColumn  }, // ADD
-      { R_QDrawTLColumn,   R_QDrawTLTRColumn   }, // SUB
-      { R_QDrawTLColumn,   R_QDrawTLTRColumn   }, // TRANMAP
+      // Normal                      Translated
+      { R_QDrawColumn<QMAXCOLS>,     R_QDrawTRColumn<QMAXCOLS>     }, // NORMAL
+      { R_QDrawFuzzColumn<QMAXCOLS>, R_QDrawFuzzColumn<QMAXCOLS>   }, // SHADOW
+      { R_QDrawFlexColumn<QMAXCOLS>, R_QDrawFlexTRColumn<QMAXCOLS> }, // ALPHA
+      { R_QDrawAddColumn<QMAXCOLS>,  R_QDrawAddTRColumn<QMAXCOLS>  }, // ADD
+      { R_QDrawTLColumn<QMAXCOLS>,   R_QDrawTLTRColumn<QMAXCOLS>   }, // SUB
+      { R_QDrawTLColumn<QMAXCOLS>,   R_QDrawTLTRColumn<QMAXCOLS>   }, // TRANMAP
    },
 };
 
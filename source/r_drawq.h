@@ -29,6 +29,7 @@
 #define R_DRAWQ_H__
 
 extern columndrawer_t r_quad_drawer;
+extern columndrawer_t r_wide_drawer;
 
 #endif
 
@@ -80,6 +80,7 @@ extern lighttable_t *(*zlight)[MAXLIGHTZ];
 extern lighttable_t *fullcolormap;
 extern int numcolormaps;    // killough 4/4/98: dynamic number of maps
 extern lighttable_t **colormaps;
+extern int            *colormaplengths; // size in bytes of each colormap lump
 // killough 3/20/98, 4/4/98: end dynamic colormaps
 
 extern int           extralight;
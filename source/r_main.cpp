@@ -36,11 +36,14 @@
 #include "doomstat.h"
 #include "e_things.h"
 #include "g_game.h"
+#include "gl/gl_world.h"
 #include "hal/i_platform.h"
+#include "hal/i_thread.h"
 #include "hal/i_timer.h"
 #include "hu_over.h"
 #include "i_video.h"
 #include "m_bbox.h"
+#include "m_profile.h"
 #include "m_random.h"
 #include "mn_engin.h"
 #include "p_chase.h"
@@ -48,12 +51,15 @@
 #include "p_xenemy.h"
 #include "r_bsp.h"
 #include "r_draw.h"
+#include "r_draw32.h"
+#include "r_drawlist.h"
 #include "r_drawq.h"
 #include "r_dynseg.h"
 #include "r_interpolate.h"
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_portal.h"
+#include "r_pvs.h"
 #include "r_ripple.h"
 #include "r_things.h"
 #include "r_sky.h"
@@ -138,12 +144,13 @@ lighttable_t *(*scalelight)[MAXLIGHTSCALE];
 lighttable_t *(*zlight)[MAXLIGHTZ];
 lighttable_t *fullcolormap;
 lighttable_t **colormaps;
+int            *colormaplengths;
 
 // killough 3/20/98, 4/4/98: end dynamic colormaps
 
 int extralight;                           // bumped light from gun blasts
 
-void (*colfunc)(void);                    // current column draw function
+void (*colfunc)(const cb_column_t &);   // current column draw function
 
 // haleyjd 09/04/06: column drawing engines
 columndrawer_t *r_column_engine;
@@ -153,6 +160,7 @@ static columndrawer_t *r_column_engines[NUMCOLUMNENGINES] =
 {
    &r_normal_drawer, // normal engine
    &r_quad_drawer,   // quad cache engine
+   &r_wide_drawer,   // 16-column cache engine
 };
 
 //
@@ -163,6 +171,14 @@ static columndrawer_t *r_column_engines[NUMCOLUMNENGINES] =
 void R_SetColumnEngine()
 {
    r_column_engine = r_column_engines[r_column_engine_num];
+
+   // the wide engine's flushes are built around SSE2
+   if(r_column_engine == &r_wide_drawer && !I_CPUHasSSE2())
+      r_column_engine = &r_quad_drawer;
+
+   // the other engines all draw paletted pixels
+   if(video.bitdepth == 32)
+      r_column_engine = &r_truecolor_drawer;
 }
 
 // haleyjd 09/10/06: span drawing engines
@@ -172,6 +188,7 @@ int r_span_engine_num;
 static spandrawer_t *r_span_engines[NUMSPANENGINES] =
 {
    &r_spandrawer,    // normal engine
+   &r_ssespandrawer, // SSE2 engine
 };
 
 //
@@ -182,6 +199,36 @@ static spandrawer_t *r_span_engines[NUMSPANENGINES] =
 void R_SetSpanEngine(void)
 {
    r_span_engine = r_span_engines[r_span_engine_num];
+
+   // fall back to the normal drawers on processors without SSE2
+   if(r_span_engine == &r_ssespandrawer && !I_CPUHasSSE2())
+      r_span_engine = &r_spandrawer;
+
+   if(video.bitdepth == 32)
+      r_span_engine = &r_truecolorspandrawer;
+}
+
+// renderer threads: 0 = one per CPU, 1 = render on the main thread only
+int r_threads = 1;
+
+//
+// R_SetThreads
+//
+// Starts or stops worker threads when r_threads has changed.
+//
+void R_SetThreads()
+{
+   static int lastthreads = 1;
+   int want;
+
+   if(r_threads == lastthreads)
+      return;
+
+   lastthreads = r_threads;
+   want = r_threads ? r_threads : I_GetNumCPUs();
+
+   // the main thread is always one of the renderer threads
+   I_SetWorkerThreads(want - 1);
 }
 
 //
@@ -885,6 +932,11 @@ static void R_SetupFrame(player_t *player, camera_t *camera)
    // haleyjd 09/10/06: set or change span drawing engine
    R_SetColumnEngine();
    R_SetSpanEngine();
+   R_SetThreads();
+
+   // palette changes reach truecolor drawing through the expanded colormaps
+   if(video.bitdepth == 32)
+      R_UpdateColormaps32();
    R_IncrementFrameid(); // Cardboard
    
    viewplayer = player;
@@ -1054,6 +1106,60 @@ static int render_ticker = 0;
 // haleyjd: temporary debug
 extern void R_UntaintPortals();
 
+#ifdef EE_FEATURE_OPENGL
+//
+// R_renderGLPlayerView
+//
+// The world is drawn through GL into the view window of the screen, and the
+// player sprites are drawn over it in software. Returns false if GL couldn't
+// draw the view, in which case the software renderer has to.
+//
+static bool R_renderGLPlayerView(player_t *player, camera_t *camerapoint)
+{
+   bool quake = false, drawn;
+   unsigned int savedflags = 0;
+
+   // haleyjd 01/21/07: earthquakes -- make player invisible to himself
+   if(player->quake && !camerapoint)
+   {
+      quake = true;
+      savedflags = player->mo->flags2;
+      player->mo->flags2 |= MF2_DONTDRAW;
+   }
+
+   M_ProfileStart(PROF_BSP);
+   drawn = GL_RenderWorld();
+   M_ProfileStop(PROF_BSP);
+
+   if(quake)
+      player->mo->flags2 = savedflags;
+
+   if(!drawn)
+      return false;
+
+   M_ProfileStart(PROF_POSTBSP);
+   if(!viewangleoffset)
+      R_DrawPlayerSprites();
+   M_ProfileStop(PROF_POSTBSP);
+
+   if(r_column_engine->ResetBuffer)
+      r_column_engine->ResetBuffer();
+
+   // haleyjd: remove sector interpolations
+   if(view.lerp != FRACUNIT)
+      R_setSectorInterpolationState(SEC_NORMAL);
+
+   if(!paused && !menuactive)
+   {
+      V_MarkDirty(&vbscreen, viewwindow.x, viewwindow.y, 
+                  viewwindow.width, viewwindow.height);
+   }
+
+   render_ticker++;
+   return true;
+}
+#endif
+
 //
 // R_RenderPlayerView
 //
@@ -1064,7 +1170,16 @@ void R_RenderPlayerView(player_t* player, camera_t *camerapoint)
    bool quake = false;
    unsigned int savedflags = 0;
 
+   M_ProfileStart(PROF_SETUPFRAME);
    R_SetupFrame(player, camerapoint);
+   M_ProfileStop(PROF_SETUPFRAME);
+
+#ifdef EE_FEATURE_OPENGL
+   if(GL_WorldActive() && R_renderGLPlayerView(player, camerapoint))
+      return;
+#endif
+
+   R_BeginDrawList();
    
    // haleyjd: untaint portals
    R_UntaintPortals();
@@ -1091,7 +1206,11 @@ void R_RenderPlayerView(player_t* player, camera_t *camerapoint)
    }
 
    // The head node is the last node output.
+   M_ProfileStart(PROF_BSP);
+   R_PVSBeginView();
    R_RenderBSPNode(numnodes - 1);
+   R_PVSEndView();
+   M_ProfileStop(PROF_BSP);
 
    if(quake)
       player->mo->flags2 = savedflags;
@@ -1105,16 +1224,26 @@ void R_RenderPlayerView(player_t* player, camera_t *camerapoint)
    R_PushPost(true, NULL);
    
    // SoM 12/9/03: render the portals.
+   M_ProfileStart(PROF_PORTALS);
    R_RenderPortals();
+   M_ProfileStop(PROF_PORTALS);
 
+   // deferred walls are drawn with the flats
+   M_ProfileStart(PROF_PLANES);
    R_DrawPlanes(NULL);
+
+   // walls and flats are all known now; draw them if they were deferred
+   R_FinishDrawList();
+   M_ProfileStop(PROF_PLANES);
    
    // Check for new console commands.
    NetUpdate();
 
    // Draw Post-BSP elements such as sprites, masked textures, and portal 
    // overlays
+   M_ProfileStart(PROF_POSTBSP);
    R_DrawPostBSP();
+   M_ProfileStop(PROF_POSTBSP);
    
    // haleyjd 09/04/06: handle through column engine
    if(r_column_engine->ResetBuffer)
@@ -1123,6 +1252,15 @@ void R_RenderPlayerView(player_t* player, camera_t *camerapoint)
    // haleyjd: remove sector interpolations
    if(view.lerp != FRACUNIT)
       R_setSectorInterpolationState(SEC_NORMAL);
+
+   // While the game runs, the view is new every frame and needn't be compared
+   // with the last one to find out; when it's stopped, let the comparison
+   // spare the video driver from presenting the same picture again.
+   if(!paused && !menuactive)
+   {
+      V_MarkDirty(&vbscreen, viewwindow.x, viewwindow.y, 
+                  viewwindow.width, viewwindow.height);
+   }
    
    // Check for new console commands.
    NetUpdate();
@@ -1299,14 +1437,15 @@ void R_DoomTLStyle()
 
 static const char *handedstr[]  = { "right", "left" };
 static const char *ptranstr[]   = { "none", "smooth", "general" };
-static const char *coleng[]     = { "normal", "quad" };
-static const char *spaneng[]    = { "highprecision" };
+static const char *coleng[]     = { "normal", "quad", "wide" };
+static const char *spaneng[]    = { "highprecision", "sse2" };
 static const char *tlstylestr[] = { "none", "boom", "new" };
 
 VARIABLE_BOOLEAN(lefthanded, NULL,                  handedstr);
 VARIABLE_BOOLEAN(r_blockmap, NULL,                  onoff);
 VARIABLE_BOOLEAN(flashing_hom, NULL,                onoff);
 VARIABLE_BOOLEAN(r_precache, NULL,                  onoff);
+VARIABLE_BOOLEAN(r_occludesprites, NULL,            onoff);
 VARIABLE_TOGGLE(showpsprites,  NULL,                yesno);
 VARIABLE_BOOLEAN(stretchsky, NULL,                  onoff);
 VARIABLE_BOOLEAN(r_swirl, NULL,                     onoff);
@@ -1327,6 +1466,7 @@ VARIABLE_INT(particle_trans,      NULL, 0, 2,                    ptranstr);
 VARIABLE_INT(r_column_engine_num, NULL, 0, NUMCOLUMNENGINES - 1, coleng);
 VARIABLE_INT(r_span_engine_num,   NULL, 0, NUMSPANENGINES - 1,   spaneng);
 VARIABLE_INT(r_tlstyle,           NULL, 0, R_TLSTYLE_NUM - 1,    tlstylestr);
+VARIABLE_INT(r_threads,           NULL, 0, 64,                   NULL);
 
 CONSOLE_VARIABLE(r_fov, fov, 0)
 {
@@ -1371,6 +1511,7 @@ CONSOLE_VARIABLE(gamma, usegamma, 0)
 CONSOLE_VARIABLE(lefthanded, lefthanded, 0) {}
 CONSOLE_VARIABLE(r_blockmap, r_blockmap, 0) {}
 CONSOLE_VARIABLE(r_homflash, flashing_hom, 0) {}
+CONSOLE_VARIABLE(r_occludesprites, r_occludesprites, 0) {}
 CONSOLE_VARIABLE(r_precache, r_precache, 0) {}
 CONSOLE_VARIABLE(r_showgun, showpsprites, 0) {}
 
@@ -1421,6 +1562,7 @@ CONSOLE_VARIABLE(r_ptcltrans, particle_trans, 0) {}
 
 CONSOLE_VARIABLE(r_columnengine, r_column_engine_num, 0) {}
 CONSOLE_VARIABLE(r_spanengine,   r_span_engine_num,   0) {}
+CONSOLE_VARIABLE(r_threads,      r_threads,           0) {}
 
 CONSOLE_COMMAND(p_dumphubs, 0)
 {
@@ -32,6 +32,7 @@
 #include "r_lighting.h"
 
 struct pwindow_t;
+struct cb_column_t;
 struct columndrawer_t;
 struct spandrawer_t;
 
@@ -73,7 +74,7 @@ void R_ResetTrans();
 // Function pointer to switch refresh/drawing functions.
 //
 
-extern void (*colfunc)();
+extern void (*colfunc)(const cb_column_t &);
 
 //
 // Utility functions.
@@ -131,15 +132,17 @@ angle_t R_WadToAngle(int wadangle);
 extern int viewdir;
 
 // haleyjd 09/04/06
-#define NUMCOLUMNENGINES 2
-#define NUMSPANENGINES 1
+#define NUMCOLUMNENGINES 3
+#define NUMSPANENGINES 2
 extern int r_column_engine_num;
 extern int r_span_engine_num;
 extern columndrawer_t *r_column_engine;
 extern spandrawer_t *r_span_engine;
+extern int r_threads;
 
 void R_SetColumnEngine();
 void R_SetSpanEngine();
+void R_SetThreads();
 
 // haleyjd 09/19/07: missing extern!
 extern const float PI;
@@ -43,11 +43,14 @@
 #include "d_gi.h"
 #include "doomstat.h"
 #include "ev_specials.h"
+#include "hal/i_thread.h"
+#include "m_profile.h"
 #include "p_anim.h"
 #include "p_info.h"
 #include "p_slopes.h"
 #include "p_user.h"
 #include "r_draw.h"
+#include "r_drawlist.h"
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_portal.h"
@@ -133,45 +136,53 @@ VALLOCATION(overlayfclip)
    overlaycclip = buffer + w;
 }
 
-// spanstart holds the start of a plane span; initialized to 0 at start
-static int *spanstart;
-
-VALLOCATION(spanstart)
-{
-   spanstart = ecalloctag(int *, h, sizeof(int), PU_VALLOC, NULL);
-}
-
 //
-// texture mapping
+// Plane drawing contexts
+//
+// Flat visplanes are rasterized one band of screen rows at a time so that the
+// bands can be handed out to worker threads. Each band owns its own span start
+// table and slope lighting buffer; everything else it reads was set up on the
+// main thread beforehand and is left alone until all bands are finished.
 //
+struct planecontext_t
+{
+   int y1, y2;                    // rows covered by this band
+   int *spanstart;                // start of the open span on each row
+   lighttable_t **slopecolormap;  // per-pixel colormaps for slope spans
+};
+
+#define MAXPLANECONTEXTS 128
 
-cb_span_t      span;
-cb_plane_t     plane;
-cb_slopespan_t slopespan;
+static planecontext_t planecontexts[MAXPLANECONTEXTS];
 
-VALLOCATION(slopespan)
+VALLOCATION(planecontexts)
 {
-   size_t size = sizeof(lighttable_t *) * w;
-   slopespan.colormap = ecalloctag(lighttable_t **, 1, size, PU_VALLOC, NULL);
+   // buffers were PU_VALLOC; they are reallocated on demand
+   memset(planecontexts, 0, sizeof(planecontexts));
 }
 
-float slopevis; // SoM: used in slope lighting
-
-// BIG FLATS
-void R_Throw()
+//
+// Flat visplanes waiting to be rasterized by R_flushPlaneDraws
+//
+struct planedraw_t
 {
-   I_Error("R_Throw called.\n");
-}
+   visplane_t *pl;     // plane to draw
+   texture_t  *cached; // PU_CACHE texture held at PU_STATIC until drawn
+   int ymin, ymax;     // rows touched by the plane
+   cb_plane_t  plane;  // span setup for the plane
+};
 
-void (*flatfunc)()  = R_Throw;
-void (*slopefunc)() = R_Throw;
+static planedraw_t *planedraws;
+static int numplanedraws, numplanedrawsalloc;
+
+float slopevis; // SoM: used in slope lighting
 
 //
 // R_SpanLight
 //
 // Returns a colormap index from the given distance and lightlevel info
 //
-static int R_SpanLight(float dist)
+static int R_SpanLight(const cb_plane_t &plane, float dist)
 {
    int map = 
       (int)(plane.startmap - (1280.0f / dist)) + 1 - (extralight * LIGHTBRIGHT);
@@ -184,7 +195,7 @@ static int R_SpanLight(float dist)
 //
 // Sets up the internal light level barriers inside the plane struct
 //
-static void R_PlaneLight()
+static void R_PlaneLight(cb_plane_t &plane)
 {
    // This formula was taken (almost) directly from r_main.c where the zlight
    // table is generated.
@@ -243,9 +254,11 @@ static uint32_t R_doubleToUint32(double d)
 //
 // BASIC PRIMITIVE
 //
-static void R_MapPlane(int y, int x1, int x2)
+static void R_MapPlane(const planecontext_t &, const cb_plane_t &plane,
+                       int y, int x1, int x2)
 {
    float dy, xstep, ystep, realy, slope;
+   cb_span_t span;
 
 #ifdef RANGECHECK
    if(x2 < x1 || x1 < 0 || x2 >= viewwindow.width || y < 0 || y >= viewwindow.height)
@@ -329,15 +342,24 @@ static void R_MapPlane(int y, int x1, int x2)
 
    // killough 2/28/98: Add offsets
    if((span.colormap = plane.fixedcolormap) == NULL) // haleyjd 10/16/06
-      span.colormap = plane.colormap + R_SpanLight(realy) * 256;
+      span.colormap = plane.colormap + R_SpanLight(plane, realy) * 256;
    
    span.y  = y;
    span.x1 = x1;
    span.x2 = x2;
    span.source = plane.source;
+   span.blendmap = plane.blendmap;
+   span.alpha    = plane.alpha;
+   span.xshift = plane.xshift;
+   span.xmask  = plane.xmask;
+   span.yshift = plane.yshift;
+   span.ymask  = plane.ymask;
    
    // BIG FLATS
-   flatfunc();
+   if(r_drawlistactive)
+      R_DrawListSpan(plane.flatfunc, span);
+   else
+      plane.flatfunc(span);
 }
 
 // haleyjd: NOTE: This version below has scaling implemented. Don't delete it!
@@ -399,7 +421,8 @@ static void R_MapPlane(int y, int x1, int x2)
 //
 // R_SlopeLights
 //
-static void R_SlopeLights(int len, double startcmap, double endcmap)
+static void R_SlopeLights(const cb_plane_t &plane, lighttable_t **colormap, int len,
+                          double startcmap, double endcmap)
 {
    int i;
    fixed_t map, map2, step;
@@ -412,7 +435,7 @@ static void R_SlopeLights(int len, double startcmap, double endcmap)
    if(plane.fixedcolormap)
    {
       for(i = 0; i < len; i++)
-         slopespan.colormap[i] = plane.fixedcolormap;
+         colormap[i] = plane.fixedcolormap;
       return;
    }
 
@@ -431,11 +454,11 @@ static void R_SlopeLights(int len, double startcmap, double endcmap)
       index -= (extralight * LIGHTBRIGHT);
 
       if(index < 0)
-         slopespan.colormap[i] = (byte *)(plane.colormap);
+         colormap[i] = (byte *)(plane.colormap);
       else if(index >= NUMCOLORMAPS)
-         slopespan.colormap[i] = (byte *)(plane.colormap + ((NUMCOLORMAPS - 1) * 256));
+         colormap[i] = (byte *)(plane.colormap + ((NUMCOLORMAPS - 1) * 256));
       else
-         slopespan.colormap[i] = (byte *)(plane.colormap + (index * 256));
+         colormap[i] = (byte *)(plane.colormap + (index * 256));
 
       map += step;
    }
@@ -444,12 +467,14 @@ static void R_SlopeLights(int len, double startcmap, double endcmap)
 //
 // R_MapSlope
 //
-static void R_MapSlope(int y, int x1, int x2)
+static void R_MapSlope(const planecontext_t &ctx, const cb_plane_t &plane,
+                       int y, int x1, int x2)
 {
    rslope_t *slope = plane.slope;
    int count = x2 - x1;
    v3double_t s;
    double map1, map2;
+   cb_slopespan_t slopespan;
 
    s.x = x1 - view.xcenter;
    s.y = y - view.ycenter + 1;
@@ -467,6 +492,10 @@ static void R_MapSlope(int y, int x1, int x2)
    slopespan.x1 = x1;
    slopespan.x2 = x2;
    slopespan.y = y;
+   slopespan.colormap = ctx.slopecolormap;
+   slopespan.xshift = plane.xshift;
+   slopespan.xmask  = plane.xmask;
+   slopespan.ymask  = plane.ymask;
 
    // Setup lighting
 
@@ -479,9 +508,13 @@ static void R_MapSlope(int y, int x1, int x2)
    else
       map2 = map1;
 
-   R_SlopeLights(x2 - x1 + 1, (256.0 - map1), (256.0 - map2));
+   R_SlopeLights(plane, slopespan.colormap, x2 - x1 + 1, 
+                 (256.0 - map1), (256.0 - map2));
  
-   slopefunc();
+   if(r_drawlistactive)
+      R_DrawListSlope(plane.slopefunc, slopespan);
+   else
+      plane.slopefunc(slopespan);
 }
 
 #define CompFloats(x, y) (fabs(x - y) < 0.001f)
@@ -679,6 +712,8 @@ static visplane_t *new_visplane(unsigned hash, planehash_t *table)
 {
    visplane_t *check = freetail;
 
+   M_ProfileCount(PROF_VISPLANES);
+
    if(!check)
       check = ecalloctag(visplane_t *, 1, sizeof *check, PU_VALLOC, NULL);
    else 
@@ -827,33 +862,100 @@ visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel,
    return check;
 }
 
+//
+// R_SamePlane
+//
+// True if two visplanes would be drawn identically, so that the columns of
+// one could just as well belong to the other. This is everything R_FindPlane
+// matches on, plus the values derived from the view when a plane is made.
+//
+static bool R_SamePlane(const visplane_t *a, const visplane_t *b)
+{
+   return a->height == b->height &&
+          a->picnum == b->picnum &&
+          a->lightlevel == b->lightlevel &&
+          a->xoffs == b->xoffs &&
+          a->yoffs == b->yoffs &&
+          a->angle == b->angle &&
+          a->colormap == b->colormap &&
+          a->fixedcolormap == b->fixedcolormap &&
+          a->fullcolormap == b->fullcolormap &&
+          a->viewx == b->viewx &&
+          a->viewy == b->viewy &&
+          a->viewz == b->viewz &&
+          a->viewsin == b->viewsin &&
+          a->viewcos == b->viewcos &&
+          a->bflags == b->bflags &&
+          a->opacity == b->opacity &&
+          R_CompareSlopes(a->pslope, b->pslope);
+}
+
+//
+// R_PlaneColumnsFree
+//
+// True if none of the columns from start to stop have been marked in pl.
+// Columns outside of minx and maxx are never marked.
+//
+static bool R_PlaneColumnsFree(const visplane_t *pl, int start, int stop)
+{
+   int x1 = start > pl->minx ? start : pl->minx;
+   int x2 = stop  < pl->maxx ? stop  : pl->maxx;
+
+   for(int x = x1; x <= x2; x++)
+   {
+      if(pl->top[x] != 0x7FFFFFFF)
+         return false;
+   }
+
+   return true;
+}
+
+//
+// R_FindFreePlane
+//
+// Returns pl if the columns from start to stop are free in it, or else
+// another plane like it in the same chain where they are free, which an
+// earlier split will have made. Returns NULL if there is none.
+//
+static visplane_t *R_FindFreePlane(visplane_t *pl, unsigned hash, int start, int stop)
+{
+   if(R_PlaneColumnsFree(pl, start, stop))
+      return pl;
+
+   for(visplane_t *check = pl->table->chains[hash]; check; check = check->next)
+   {
+      if(check != pl && R_SamePlane(check, pl) && R_PlaneColumnsFree(check, start, stop))
+         return check;
+   }
+
+   return NULL;
+}
+
 //
 // R_CheckPlane
 //
+// Returns a visplane like pl into which the columns from start to stop can
+// be marked, making a new one only if no existing plane has room for them.
+//
 visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
 {
-   int intrl, intrh, unionl, unionh, x;
-   
    planehash_t *table = pl->table;
+   visplane_t  *check;
    
-   if(start < pl->minx)
-      intrl   = pl->minx, unionl = start;
-   else
-      unionl  = pl->minx,  intrl = start;
-   
-   if(stop  > pl->maxx)
-      intrh   = pl->maxx, unionh = stop;
-   else
-      unionh  = pl->maxx, intrh  = stop;
-
-   for(x = intrl; x <= intrh && pl->top[x] == 0x7FFFFFFF; ++x)
-      ;
+   // splits go into the same chain as the plane R_FindPlane made
+   unsigned hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height >> 16, 
+                                 table->chaincount);
 
-   if(x > intrh)
-      pl->minx = unionl, pl->maxx = unionh;
+   if((check = R_FindFreePlane(pl, hash, start, stop)))
+   {
+      pl = check;
+      if(start < pl->minx)
+         pl->minx = start;
+      if(stop > pl->maxx)
+         pl->maxx = stop;
+   }
    else
    {
-      unsigned hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height, table->chaincount);
       visplane_t *new_pl = new_visplane(hash, table);
       
       new_pl->height = pl->height;
@@ -905,8 +1007,13 @@ visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
 //
 // R_MakeSpans
 //
-static void R_MakeSpans(int x, int t1, int b1, int t2, int b2)
+typedef void (*R_MapFunc)(const planecontext_t &, const cb_plane_t &, int, int, int);
+
+static void R_MakeSpans(const planecontext_t &ctx, const cb_plane_t &plane, 
+                        R_MapFunc mapfunc, int x, int t1, int b1, int t2, int b2)
 {
+   int *spanstart = ctx.spanstart;
+
 #ifdef RANGECHECK
    // haleyjd: do not allow this loop to trash the BSS data
    if(b2 >= video.height)
@@ -914,16 +1021,128 @@ static void R_MakeSpans(int x, int t1, int b1, int t2, int b2)
 #endif
 
    for(; t2 > t1 && t1 <= b1; t1++)
-      plane.MapFunc(t1, spanstart[t1], x - 1);
+      mapfunc(ctx, plane, t1, spanstart[t1], x - 1);
    for(; b2 < b1 && t1 <= b1; b1--)
-      plane.MapFunc(b1, spanstart[b1], x - 1);
+      mapfunc(ctx, plane, b1, spanstart[b1], x - 1);
    while(t2 < t1 && t2 <= b2)
       spanstart[t2++] = x;
    while(b2 > b1 && t2 <= b2)
       spanstart[b2--] = x;
 }
 
-extern void R_DrawNewSkyColumn();
+//
+// R_drawPlaneRows
+//
+// Rasterizes the part of a queued flat that lies within the context's band of
+// rows. Clipping the column extents to the band leaves every span on the rows
+// inside it exactly as it would be for the whole plane.
+//
+static void R_drawPlaneRows(const planecontext_t &ctx, const planedraw_t &pd)
+{
+   const visplane_t *pl  = pd.pl;
+   const cb_plane_t &plane = pd.plane;
+   R_MapFunc mapfunc = (plane.slope == NULL ? R_MapPlane : R_MapSlope);
+   int y1 = ctx.y1, y2 = ctx.y2;
+   int stop = pl->maxx + 1;
+   int t1, b1, t2, b2;
+
+   if(pd.ymax < y1 || pd.ymin > y2)
+      return;
+
+   t1 = pl->top[pl->minx - 1];
+   b1 = pl->bottom[pl->minx - 1];
+   if(t1 < y1) t1 = y1;
+   if(b1 > y2) b1 = y2;
+
+   for(int x = pl->minx; x <= stop; x++)
+   {
+      t2 = pl->top[x];
+      b2 = pl->bottom[x];
+      if(t2 < y1) t2 = y1;
+      if(b2 > y2) b2 = y2;
+
+      R_MakeSpans(ctx, plane, mapfunc, x, t1, b1, t2, b2);
+
+      t1 = t2;
+      b1 = b2;
+   }
+}
+
+//
+// R_drawPlaneBand
+//
+// Worker job: draws every queued flat within one band of rows.
+//
+static void R_drawPlaneBand(int jobnum, void *data)
+{
+   const planecontext_t &ctx = planecontexts[jobnum];
+
+   for(int i = 0; i < numplanedraws; i++)
+      R_drawPlaneRows(ctx, planedraws[i]);
+}
+
+//
+// R_flushPlaneDraws
+//
+// Draws all queued flats, splitting the screen into bands of rows that are
+// handed out to the worker pool. Anything the bands need is set up here, on
+// the main thread.
+//
+static void R_flushPlaneDraws()
+{
+   int numbands, height = viewwindow.height;
+
+   if(!numplanedraws)
+      return;
+
+   // a few more bands than threads evens out uneven plane coverage; spans
+   // going into a draw list are made on this thread and split up later
+   if(I_GetWorkerThreads() > 0 && !r_drawlistactive)
+      numbands = (I_GetWorkerThreads() + 1) * 2;
+   else
+      numbands = 1;
+
+   if(numbands > MAXPLANECONTEXTS)
+      numbands = MAXPLANECONTEXTS;
+   if(numbands > height)
+      numbands = height;
+
+   for(int i = 0; i < numbands; i++)
+   {
+      planecontext_t &ctx = planecontexts[i];
+
+      if(!ctx.spanstart)
+      {
+         ctx.spanstart = 
+            ecalloctag(int *, video.height, sizeof(int), PU_VALLOC, NULL);
+         ctx.slopecolormap =
+            ecalloctag(lighttable_t **, video.width, sizeof(lighttable_t *), 
+                       PU_VALLOC, NULL);
+      }
+
+      ctx.y1 = height * i / numbands;
+      ctx.y2 = height * (i + 1) / numbands - 1;
+   }
+
+   I_RunJobs(numbands, R_drawPlaneBand, NULL);
+
+   // let the zone purge the flats again
+   for(int i = 0; i < numplanedraws; i++)
+   {
+      if(planedraws[i].cached)
+      {
+         Z_ChangeTag(planedraws[i].cached->buffer, PU_CACHE);
+
+         // recorded spans still need it
+         if(r_drawlistactive)
+            R_DrawListHold(planedraws[i].cached);
+      }
+   }
+
+   numplanedraws = 0;
+}
+
+extern void R_DrawNewSkyColumn(const cb_column_t &column);
 
 // haleyjd: moved here from r_newsky.c
 void do_draw_newsky(visplane_t *pl)
@@ -949,6 +1168,9 @@ void do_draw_newsky(visplane_t *pl)
 
    sky1 = R_GetSkyTexture(skyTexture);
    sky2 = R_GetSkyTexture(skyTexture2);
+
+   bool record = r_drawlistactive &&
+                 R_DrawListTexture(skyTexture2) && R_DrawListTexture(skyTexture);
       
    if(comp[comp_skymap] || !(column.colormap = fixedcolormap))
       column.colormap = fullcolormap;
@@ -971,7 +1193,10 @@ void do_draw_newsky(visplane_t *pl)
             R_GetRawColumn(skyTexture2,
                (((an + xtoviewangle[x])) >> (ANGLETOSKYSHIFT))+offset2);
             
-         colfunc();
+         if(record)
+            R_DrawListColumn(colfunc, column);
+         else
+            colfunc(column);
       }
    }
       
@@ -993,7 +1218,10 @@ void do_draw_newsky(visplane_t *pl)
             R_GetRawColumn(skyTexture,
                (((an + xtoviewangle[x])) >> (ANGLETOSKYSHIFT))+offset);
             
-         colfunc();
+         if(record)
+            R_DrawListColumn(colfunc, column);
+         else
+            colfunc(column);
       }
    }
 }
@@ -1021,6 +1249,7 @@ static void do_draw_plane(visplane_t *pl)
    // haleyjd: hexen-style skies
    if(LevelInfo.doubleSky)
    {
+      R_flushPlaneDraws();
       do_draw_newsky(pl);
       return;
    }
@@ -1033,6 +1262,9 @@ static void do_draw_plane(visplane_t *pl)
       int offset = 0;
       angle_t an, flip;
       skytexture_t *sky;
+
+      // skies are drawn as columns; get queued flats under them first
+      R_flushPlaneDraws();
       
       // killough 10/98: allow skies to come from sidedefs.
       // Allows scrolling and/or animated skies, as well as
@@ -1102,6 +1334,8 @@ static void do_draw_plane(visplane_t *pl)
       else
          column.step = M_FloatToFixed(view.pspriteystep);
 
+      bool record = r_drawlistactive && R_DrawListTexture(texture);
+
       // killough 10/98: Use sky scrolling offset, and possibly flip picture
       for(x = pl->minx; x <= pl->maxx; x++)
       {
@@ -1115,7 +1349,10 @@ static void do_draw_plane(visplane_t *pl)
             column.source = R_GetRawColumn(texture,
                (((an + xtoviewangle[x])^flip) >> ANGLETOSKYSHIFT) + offset);
             
-            colfunc();
+            if(record)
+               R_DrawListColumn(colfunc, column);
+            else
+               colfunc(column);
          }
       }
    }
@@ -1124,22 +1361,51 @@ static void do_draw_plane(visplane_t *pl)
       texture_t *tex;
       int        stop, light;
       int        stylenum;
+      bool       distorted = false;
 
       int picnum = texturetranslation[pl->picnum];
 
+      if(numplanedraws >= numplanedrawsalloc)
+      {
+         numplanedrawsalloc = numplanedrawsalloc ? numplanedrawsalloc * 2 : 128;
+         planedraws = erealloc(planedraw_t *, planedraws, 
+                               numplanedrawsalloc * sizeof(planedraw_t));
+      }
+
+      planedraw_t &pd    = planedraws[numplanedraws++];
+      cb_plane_t  &plane = pd.plane;
+
+      pd.pl     = pl;
+      pd.cached = NULL;
+
       // haleyjd 05/19/06: rewritten to avoid crashes
       if(((r_swirl && textures[pl->picnum]->flags & TF_ANIMATED)
          || textures[pl->picnum]->flags & TF_SWIRLY)
          && textures[pl->picnum]->flatsize == FLAT_64)
       {
+         // recorded spans may still be reading the last distorted flat
+         if(r_drawlistactive)
+            R_FlushDrawList();
+
          plane.source = R_DistortedFlat(pl->picnum);
          tex = plane.tex = textures[pl->picnum];
+         distorted = true;
       }
       else
       {
          // SoM: Handled outside
          tex = plane.tex = R_CacheTexture(picnum);
          plane.source = tex->buffer;
+
+         // caching later flats must not purge this one before it's drawn;
+         // only purgable ones need holding, and they go back to PU_CACHE
+         // once drawn. Others, like badtex, keep whatever tag they have, and
+         // textures in the atlas can't be purged.
+         if(!(tex->flags & TF_ATLAS) && Z_CheckTag(tex->buffer) == PU_CACHE)
+         {
+            Z_ChangeTag(tex->buffer, PU_STATIC);
+            pd.cached = tex;
+         }
       }
 
       // haleyjd: TODO: feed pl->drawstyle to the first dimension to enable
@@ -1149,25 +1415,16 @@ static void do_draw_plane(visplane_t *pl)
                  (pl->bflags & PS_OVERLAY)  ? SPAN_STYLE_TL :
                  SPAN_STYLE_NORMAL;
                 
-      flatfunc  = r_span_engine->DrawSpan[stylenum][tex->flatsize];
-      slopefunc = r_span_engine->DrawSlope[stylenum][tex->flatsize];
+      plane.flatfunc  = r_span_engine->DrawSpan[stylenum][tex->flatsize];
+      plane.slopefunc = r_span_engine->DrawSlope[stylenum][tex->flatsize];
       
       if(stylenum == SPAN_STYLE_TL)
-      {
-         int level = (pl->opacity + 1) >> 2;
-         
-         span.fg2rgb = Col2RGB8[level];
-         span.bg2rgb = Col2RGB8[64 - level];
-      }
+         plane.blendmap = flexblendmaps[(pl->opacity + 1) >> 2];
       else if(stylenum == SPAN_STYLE_ADD)
-      {
-         int level = (pl->opacity + 1) >> 2;
-         
-         span.fg2rgb = Col2RGB8_LessPrecision[level];
-         span.bg2rgb = Col2RGB8_LessPrecision[64];
-      }
+         plane.blendmap = addblendmaps[(pl->opacity + 1) >> 2];
       else
-         span.fg2rgb = span.bg2rgb = NULL;
+         plane.blendmap = NULL;
+      plane.alpha = pl->opacity + 1;
 
       if(pl->pslope)
          plane.slope = &pl->rslope;
@@ -1182,20 +1439,20 @@ static void do_draw_plane(visplane_t *pl)
 
          if(plane.slope)
          {
-            span.ymask = tex->height - 1;
+            plane.ymask = tex->height - 1;
             
-            span.xshift = 16 - rh;
-            span.xmask = (tex->width - 1) << (16 - span.xshift);
+            plane.xshift = 16 - rh;
+            plane.xmask = (tex->width - 1) << (16 - plane.xshift);
          }
          else
          {
-            span.yshift = 32 - rh;
+            plane.yshift = 32 - rh;
             
-            span.xshift = span.yshift - rw;
-            span.xmask = (tex->width - 1) << (32 - rw - span.xshift);
+            plane.xshift = plane.yshift - rw;
+            plane.xmask = (tex->width - 1) << (32 - rw - plane.xshift);
             
             plane.fixedunitx = (float)(1 << (32 - rw));
-            plane.fixedunity = (float)(1 << span.yshift);
+            plane.fixedunity = (float)(1 << plane.yshift);
          }
       }
        
@@ -1230,12 +1487,94 @@ static void do_draw_plane(visplane_t *pl)
       plane.fixedcolormap = pl->fixedcolormap; // haleyjd 10/16/06
       plane.lightlevel    = pl->lightlevel;
 
-      R_PlaneLight();
+      R_PlaneLight(plane);
 
-      plane.MapFunc = (plane.slope == NULL ? R_MapPlane : R_MapSlope);
+      // find the rows the plane touches so bands can skip it quickly
+      pd.ymin = viewwindow.height;
+      pd.ymax = -1;
+      for(x = pl->minx; x < stop; x++)
+      {
+         if(pl->top[x] > pl->bottom[x])
+            continue;
+         if(pl->top[x] < pd.ymin)
+            pd.ymin = pl->top[x];
+         if(pl->bottom[x] > pd.ymax)
+            pd.ymax = pl->bottom[x];
+      }
 
-      for(x = pl->minx ; x <= stop ; x++)
-         R_MakeSpans(x, pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
+      // the distorted flat buffer is reused by the next swirling flat
+      if(distorted)
+         R_flushPlaneDraws();
+   }
+}
+
+//
+// R_PlanesDisjoint
+//
+// True if no column is marked in both planes.
+//
+static bool R_PlanesDisjoint(const visplane_t *a, const visplane_t *b)
+{
+   int x1 = a->minx > b->minx ? a->minx : b->minx;
+   int x2 = a->maxx < b->maxx ? a->maxx : b->maxx;
+
+   for(int x = x1; x <= x2; x++)
+   {
+      if(a->top[x] != 0x7FFFFFFF && b->top[x] != 0x7FFFFFFF)
+         return false;
+   }
+
+   return true;
+}
+
+//
+// R_MergePlanes
+//
+// Folds together planes in each chain that would be drawn identically and
+// mark no columns in common. R_CheckPlane must split a plane when a range it
+// is asked for overlaps marked columns, but segs do not always mark every
+// column of their range, so the pieces often turn out to fit together. Each
+// merged plane is drawn in one pass, which joins spans that ran across the
+// split into single spans and sets the flat up only once.
+//
+static void R_MergePlanes(planehash_t *table)
+{
+   for(int i = 0; i < table->chaincount; i++)
+   {
+      for(visplane_t *pl = table->chains[i]; pl; pl = pl->next)
+      {
+         visplane_t **prev = &pl->next;
+         visplane_t *other;
+
+         while((other = *prev))
+         {
+            if(!R_SamePlane(pl, other) || !R_PlanesDisjoint(pl, other))
+            {
+               prev = &other->next;
+               continue;
+            }
+
+            for(int x = other->minx; x <= other->maxx; x++)
+            {
+               if(other->top[x] != 0x7FFFFFFF)
+               {
+                  pl->top[x]    = other->top[x];
+                  pl->bottom[x] = other->bottom[x];
+               }
+            }
+
+            if(other->minx < pl->minx)
+               pl->minx = other->minx;
+            if(other->maxx > pl->maxx)
+               pl->maxx = other->maxx;
+
+            // unlink it and put it on the free stack
+            *prev = other->next;
+            other->next = NULL;
+            *freehead = other;
+            freehead = &other->next;
+         }
+      }
    }
 }
 
@@ -1252,12 +1591,16 @@ void R_DrawPlanes(planehash_t *table)
    
    if(!table)
       table = &mainhash;
+
+   R_MergePlanes(table);
    
    for(i = 0; i < table->chaincount; ++i)
    {
       for(pl = table->chains[i]; pl; pl = pl->next)
          do_draw_plane(pl);
    }
+
+   R_flushPlaneDraws();
 }
 
 //----------------------------------------------------------------------------
@@ -74,12 +74,35 @@ struct cb_span_t
    unsigned xfrac, yfrac, xstep, ystep;
    void *source;
    lighttable_t *colormap;
-   unsigned int *fg2rgb, *bg2rgb; // haleyjd 06/20/08: tl lookups
+   byte *blendmap; // haleyjd 06/20/08: tl lookups
+   unsigned int alpha; // same level as blendmap, 1 to 256, for truecolor
 
    // SoM: some values for the generalizede span drawers
    unsigned int xshift, xmask, yshift, ymask;
 };
 
+struct cb_slopespan_t
+{
+   int y, x1, x2;
+
+   double iufrac, ivfrac, idfrac;
+   double iustep, ivstep, idstep;
+
+   void *source;
+
+   lighttable_t **colormap;
+
+   // values for the generalized slope drawer
+   unsigned int xshift, xmask, ymask;
+};
+
+//
+// cb_plane_t
+//
+// Everything needed to rasterize one flat visplane. This is set up once per
+// plane on the main thread and then only read while spans are drawn, so it
+// can be shared by all row bands of R_DrawPlanes.
+//
 struct cb_plane_t
 {
    float xoffset, yoffset;
@@ -103,27 +126,14 @@ struct cb_plane_t
    // SoM: slopes.
    rslope_t *slope;
 
-   void (*MapFunc)(int, int, int);
-};
-
-struct cb_slopespan_t
-{
-   int y, x1, x2;
-
-   double iufrac, ivfrac, idfrac;
-   double iustep, ivstep, idstep;
-
-   void *source;
-
-   lighttable_t **colormap;
+   // span drawers and their setup values
+   void (*flatfunc)(const cb_span_t &);
+   void (*slopefunc)(const cb_slopespan_t &);
+   byte *blendmap;
+   unsigned int alpha;
+   unsigned int xshift, xmask, yshift, ymask;
 };
 
-
-extern cb_span_t  span;
-extern cb_plane_t plane;
-
-extern cb_slopespan_t slopespan;
-
 #endif
 
 //----------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 #include "i_system.h"
 
 #include "c_io.h"
+#include "m_profile.h"
 #include "r_bsp.h"
 #include "r_draw.h"
 #include "r_main.h"
@@ -40,6 +41,7 @@
 #include "r_things.h"
 #include "v_alloc.h"
 #include "v_misc.h"
+#include "v_video.h"
 
 //=============================================================================
 //
@@ -49,6 +51,15 @@
 static portal_t *portals = NULL, *last = NULL;
 static pwindow_t *unusedhead = NULL, *windowhead = NULL, *windowlast = NULL;
 
+//
+// R_forgetPortalWindows
+//
+static void R_forgetPortalWindows(portal_t *portal)
+{
+   portal->fwindow = portal->cwindow = portal->lwindow = NULL;
+   portal->lwindowline = NULL;
+}
+
 //
 // VALLOCATION(portals)
 //
@@ -66,6 +77,9 @@ VALLOCATION(portals)
          for(int i = 0; i < hash->chaincount; i++)
             hash->chains[i] = NULL;
       }
+
+      // the windows are about to be freed
+      R_forgetPortalWindows(p);
    }
 
    // free portal window structures on the main list
@@ -142,6 +156,8 @@ static pwindow_t *newPortalWindow()
 {
    pwindow_t *ret;
 
+   M_ProfileCount(PROF_PORTALWINDOWS);
+
    if(unusedhead)
    {
       ret = unusedhead;
@@ -836,6 +852,15 @@ static void R_ShowTainted(pwindow_t *window)
       if(count <= 0)
          continue;
 
+      if(video.pixelsize == 4)
+      {
+         uint32_t *dest32 = R_ADDRESS32(i, y1);
+
+         for(; count > 0; count--, dest32 += video.pitch / 4)
+            *dest32 = Col2RGB32[taintcolor];
+         continue;
+      }
+
       dest = R_ADDRESS(i, y1);
 
       while(count > 0)
@@ -1103,55 +1128,52 @@ static void R_SetPortalFunction(pwindow_t *window)
 //
 // functions return a portal window based on the given parameters.
 //
+// A portal has at most one floor and one ceiling window waiting at a time,
+// and the portal remembers them, so those are found without a search. Line
+// windows remember the last line asked for; segs of one linedef come in a row.
+//
 pwindow_t *R_GetFloorPortalWindow(portal_t *portal)
 {
-   pwindow_t *rover = windowhead;
+   // SoM: TODO: There could be the possibility of multiple portals
+   // being able to share a single window set.
+   if(!portal->fwindow)
+      portal->fwindow = R_NewPortalWindow(portal, NULL, pw_floor);
 
-   while(rover)
-   {
-      // SoM: TODO: There could be the possibility of multiple portals
-      // being able to share a single window set.
-      if(rover->portal == portal && rover->type == pw_floor)
-         return rover;
-   
-      rover = rover->next;
-   }
-
-   // not found, so make it
-   return R_NewPortalWindow(portal, NULL, pw_floor);
+   return portal->fwindow;
 }
 
 pwindow_t *R_GetCeilingPortalWindow(portal_t *portal)
 {
-   pwindow_t *rover = windowhead;
-
-   while(rover)
-   {
-      if(rover->portal == portal && rover->type == pw_ceiling)
-         return rover;
+   if(!portal->cwindow)
+      portal->cwindow = R_NewPortalWindow(portal, NULL, pw_ceiling);
 
-      rover = rover->next;
-   }
-
-   // not found, so make it
-   return R_NewPortalWindow(portal, NULL, pw_ceiling);
+   return portal->cwindow;
 }
 
 pwindow_t *R_GetLinePortalWindow(portal_t *portal, line_t *line)
 {
    pwindow_t *rover = windowhead;
 
+   if(portal->lwindow && portal->lwindowline == line)
+      return portal->lwindow;
+
    while(rover)
    {
       if(rover->portal == portal && rover->type == pw_line && 
          rover->line == line)
-         return rover;
+         break;
 
       rover = rover->next;
    }
 
    // not found, so make it
-   return R_NewPortalWindow(portal, line, pw_line);
+   if(!rover)
+      rover = R_NewPortalWindow(portal, line, pw_line);
+
+   portal->lwindow     = rover;
+   portal->lwindowline = line;
+
+   return rover;
 }
 
 //
@@ -1166,6 +1188,7 @@ void R_ClearPortals()
    while(r)
    {
       R_ClearPlaneHash(r->poverlay);
+      R_forgetPortalWindows(r);
       r = r->next;
    }
 }
@@ -1196,6 +1219,15 @@ void R_RenderPortals()
       portalrender.overlay = NULL;
       portalrender.curwindow = nullptr;   // ioanch 20160123: reset it
 
+      // the portal's next window for this frame will be a new one
+      portal_t *portal = windowhead->portal;
+      if(portal->fwindow == windowhead)
+         portal->fwindow = NULL;
+      if(portal->cwindow == windowhead)
+         portal->cwindow = NULL;
+      if(portal->lwindow == windowhead)
+         portal->lwindow = NULL;
+
       // free the window structs
       w = windowhead->child;
       while(w)
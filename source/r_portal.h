@@ -174,6 +174,11 @@ struct portal_t
 
    // haleyjd: temporary debug
    int16_t tainted;
+
+   // Windows of this portal waiting to be drawn this frame, if any, so that
+   // segs don't have to search the window list for them
+   pwindow_t *fwindow, *cwindow, *lwindow;
+   line_t    *lwindowline;
 };
 
 portal_t *R_GetSkyBoxPortal(Mobj *camera);
@@ -0,0 +1,724 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Potentially visible sets between sectors.
+//
+//    A sector can see another only along a sight line that passes through
+//    a chain of two-sided lines, crossing each from the sector it is in to
+//    the one beyond. For every sector, the builder walks all such chains
+//    that don't revisit a sector, keeping the set of 2D lines that could
+//    still pass through the whole chain so far. A line y = mx + q (or
+//    x = my + q, for steep ones) is a point (m, q), and passing a line's
+//    endpoints on the proper sides is a half-plane in that space, so the
+//    set is a convex polygon for each of the four directions of travel.
+//    A chain ends when all four polygons are empty. Heights, doors, and
+//    REJECT are ignored, so the result is only ever too generous.
+//
+//    Sectors whose lines don't describe their area (deep water and other
+//    self-referencing tricks) can see and be seen from everywhere, and a
+//    map with a sector that isn't closed gets no PVS at all. Results are
+//    cached in the user directory, keyed by the checksums of the map
+//    lumps.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+
+#include "c_runcmd.h"
+#include "doomdata.h"
+#include "doomstat.h"
+#include "hal/i_thread.h"
+#include "m_compare.h"
+#include "m_hash.h"
+#include "m_misc.h"
+#include "m_profile.h"
+#include "m_qstr.h"
+#include "m_swap.h"
+#include "r_defs.h"
+#include "r_main.h"
+#include "r_pvs.h"
+#include "r_state.h"
+#include "w_wad.h"
+
+bool r_pvs = true;
+
+const byte *pvsnodes;
+const byte *pvssubsectors;
+
+// Maps with more sectors than this are not worth the memory
+#define MAXPVSSECTORS 16384
+
+// Chains longer than this, or sources that take more steps than this, are
+// given up on, and the source sector sees everything
+#define MAXPVSDEPTH   256
+#define PVSWORKLIMIT  16384
+
+// Sight line polygons stop being clipped once they have this many sides
+#define MAXPVSVERTS   16
+
+// Slack given to every half-plane, in map units, so that lines grazing a
+// vertex are kept
+#define PVSEPSILON    (1.0 / 64)
+
+#define PVSMAGIC      "EEPVS001"
+#define PVSHEADERLEN  16
+
+static byte     *pvsmatrix;     // a row of numsectors bits for each sector
+static int       pvsrowbytes;
+static byte     *pvsnodevis;    // per node, for the current view sector
+static byte     *pvsssvis;      // per subsector, for the current view sector
+static int       pvsviewsector; // sector the above were worked out for
+static uint32_t  pvskey;        // checksum of the level's lumps
+static bool      pvsfailed;     // this level can't have a PVS
+
+struct pvsline_t
+{
+   double x1, y1, x2, y2;
+   int    front, back;
+};
+
+struct pvspoly_t
+{
+   int    numverts;
+   double m[MAXPVSVERTS];
+   double q[MAXPVSVERTS];
+};
+
+struct pvsframe_t
+{
+   int       sector;   // sector the chain has reached
+   int       next;     // next entry in pvsadj to try leaving it by
+   pvspoly_t polys[4]; // sight lines through the chain, for each direction
+};
+
+struct pvsbuild_t
+{
+   int         numjobs;
+   pvsline_t  *lines;
+   int        *adjstart;  // first entry in adjlines for each sector
+   int        *adjlines;  // two-sided lines around each sector
+   double      qmax;      // bound on the intercept of any line in the map
+   pvsframe_t *frames;    // MAXPVSDEPTH for each job
+   byte       *onpath;    // numsectors for each job
+};
+
+//
+// R_pointInSector
+//
+// Tests whether a point is inside the area bounded by a sector's lines.
+//
+static bool R_pointInSector(const sector_t *sec, double x, double y)
+{
+   bool inside = false;
+
+   for(int i = 0; i < sec->linecount; i++)
+   {
+      const line_t *line = sec->lines[i];
+
+      if(line->frontsector == line->backsector)
+         continue;
+
+      double x1 = M_FixedToDouble(line->v1->x), y1 = M_FixedToDouble(line->v1->y);
+      double x2 = M_FixedToDouble(line->v2->x), y2 = M_FixedToDouble(line->v2->y);
+
+      if((y1 > y) != (y2 > y) && x < x1 + (y - y1) * (x2 - x1) / (y2 - y1))
+         inside = !inside;
+   }
+
+   return inside;
+}
+
+//
+// R_comparePVSPoints
+//
+static int R_comparePVSPoints(const void *a, const void *b)
+{
+   const fixed_t *pa = static_cast<const fixed_t *>(a);
+   const fixed_t *pb = static_cast<const fixed_t *>(b);
+
+   if(pa[0] != pb[0])
+      return pa[0] < pb[0] ? -1 : 1;
+   if(pa[1] != pb[1])
+      return pa[1] < pb[1] ? -1 : 1;
+   return 0;
+}
+
+//
+// R_sectorsClosed
+//
+// Every vertex of a closed sector joins an even number of its lines.
+// Vertices are compared by position, since maps often repeat them.
+//
+static bool R_sectorsClosed()
+{
+   int      maxlines = 0;
+   fixed_t *points;
+   bool     closed = true;
+
+   for(int i = 0; i < numsectors; i++)
+   {
+      if(sectors[i].linecount > maxlines)
+         maxlines = sectors[i].linecount;
+   }
+
+   points = emalloc(fixed_t *, maxlines * 4 * sizeof(fixed_t) + sizeof(fixed_t));
+
+   for(int i = 0; i < numsectors && closed; i++)
+   {
+      const sector_t *sec = &sectors[i];
+      int numpoints = 0;
+
+      for(int j = 0; j < sec->linecount; j++)
+      {
+         const line_t *line = sec->lines[j];
+
+         if(line->frontsector == line->backsector)
+            continue;
+
+         points[numpoints * 2    ] = line->v1->x;
+         points[numpoints * 2 + 1] = line->v1->y;
+         ++numpoints;
+         points[numpoints * 2    ] = line->v2->x;
+         points[numpoints * 2 + 1] = line->v2->y;
+         ++numpoints;
+      }
+
+      qsort(points, numpoints, 2 * sizeof(fixed_t), R_comparePVSPoints);
+
+      for(int j = 0; j < numpoints; )
+      {
+         int k = j + 1;
+
+         while(k < numpoints && !R_comparePVSPoints(&points[j * 2], &points[k * 2]))
+            ++k;
+         if((k - j) & 1)
+         {
+            closed = false;
+            break;
+         }
+         j = k;
+      }
+   }
+
+   efree(points);
+   return closed;
+}
+
+//
+// R_findWildSectors
+//
+// Flags sectors whose subsectors lie outside the area their lines bound.
+//
+static void R_findWildSectors(byte *wild)
+{
+   for(int i = 0; i < numsubsectors; i++)
+   {
+      const subsector_t *ss = &subsectors[i];
+      double x = 0.0, y = 0.0;
+
+      if(ss->numlines < 3)
+         continue; // no area to test
+
+      for(int j = 0; j < ss->numlines; j++)
+      {
+         const seg_t *seg = &segs[ss->firstline + j];
+
+         x += M_FixedToDouble(seg->v1->x);
+         y += M_FixedToDouble(seg->v1->y);
+      }
+      x /= ss->numlines;
+      y /= ss->numlines;
+
+      if(!R_pointInSector(ss->sector, x, y))
+         wild[ss->sector - sectors] = 1;
+   }
+}
+
+//
+// R_clipPVSPoly
+//
+// Keeps the part of a polygon where a * m + b * q + c >= 0, give or take
+// PVSEPSILON. Polygons that are already detailed are passed through whole,
+// which can only let more sight lines through.
+//
+static void R_clipPVSPoly(const pvspoly_t &in, pvspoly_t &out, double a, double b, double c)
+{
+   if(in.numverts >= MAXPVSVERTS)
+   {
+      out = in;
+      return;
+   }
+
+   out.numverts = 0;
+   for(int i = 0; i < in.numverts; i++)
+   {
+      int    j  = (i + 1) % in.numverts;
+      double fi = a * in.m[i] + b * in.q[i] + c + PVSEPSILON;
+      double fj = a * in.m[j] + b * in.q[j] + c + PVSEPSILON;
+
+      if(fi >= 0.0)
+      {
+         out.m[out.numverts] = in.m[i];
+         out.q[out.numverts] = in.q[i];
+         ++out.numverts;
+      }
+      if((fi >= 0.0) != (fj >= 0.0))
+      {
+         double t = fi / (fi - fj);
+
+         out.m[out.numverts] = in.m[i] + t * (in.m[j] - in.m[i]);
+         out.q[out.numverts] = in.q[i] + t * (in.q[j] - in.q[i]);
+         ++out.numverts;
+      }
+   }
+}
+
+//
+// R_clipPVSSide
+//
+// Keeps the sight lines that pass the point (x, y) on their left, or on
+// their right if sign is negative. Directions 0 and 1 are y = mx + q
+// travelling toward +x and -x; 2 and 3 are x = my + q toward +y and -y.
+//
+static void R_clipPVSSide(const pvspoly_t &in, pvspoly_t &out, int dir,
+                          double x, double y, double sign)
+{
+   static const double dirsigns[4] = { -1.0, 1.0, 1.0, -1.0 };
+   double s = dirsigns[dir] * sign;
+
+   if(dir < 2)
+      R_clipPVSPoly(in, out, s * x, s, -s * y);
+   else
+      R_clipPVSPoly(in, out, s * y, s, -s * x);
+}
+
+//
+// R_buildPVSRow
+//
+// Walks every chain of sectors leading away from src and marks the ends
+// of those that a straight line can still pass through.
+//
+static void R_buildPVSRow(pvsbuild_t &build, int jobnum, int src)
+{
+   byte       *row    = pvsmatrix + src * pvsrowbytes;
+   pvsframe_t *stack  = build.frames + jobnum * MAXPVSDEPTH;
+   byte       *onpath = build.onpath + jobnum * numsectors;
+   int         depth  = 0;
+   int         work   = 0;
+
+   row[src >> 3] |= 1 << (src & 7);
+
+   stack[0].sector = src;
+   stack[0].next   = build.adjstart[src];
+   for(int k = 0; k < 4; k++)
+   {
+      pvspoly_t &poly = stack[0].polys[k];
+
+      poly.numverts = 4;
+      poly.m[0] = -1.0; poly.q[0] = -build.qmax;
+      poly.m[1] =  1.0; poly.q[1] = -build.qmax;
+      poly.m[2] =  1.0; poly.q[2] =  build.qmax;
+      poly.m[3] = -1.0; poly.q[3] =  build.qmax;
+   }
+   onpath[src] = 1;
+
+   while(depth >= 0)
+   {
+      pvsframe_t &frame = stack[depth];
+
+      if(frame.next == build.adjstart[frame.sector + 1])
+      {
+         onpath[frame.sector] = 0;
+         --depth;
+         continue;
+      }
+
+      const pvsline_t &line = build.lines[build.adjlines[frame.next++]];
+      bool forward = (line.front == frame.sector);
+      int  to      = forward ? line.back : line.front;
+
+      if(onpath[to])
+         continue;
+
+      if(++work > PVSWORKLIMIT || depth + 1 == MAXPVSDEPTH)
+      {
+         // too much to look through; assume it all can be seen
+         memset(row, 0xff, pvsrowbytes);
+         for(int i = 0; i <= depth; i++)
+            onpath[stack[i].sector] = 0;
+         return;
+      }
+
+      // crossing front to back, v1 passes on the left and v2 on the right
+      double lx = forward ? line.x1 : line.x2, ly = forward ? line.y1 : line.y2;
+      double rx = forward ? line.x2 : line.x1, ry = forward ? line.y2 : line.y1;
+
+      pvsframe_t &next = stack[depth + 1];
+      bool open = false;
+
+      for(int k = 0; k < 4; k++)
+      {
+         pvspoly_t temp;
+
+         R_clipPVSSide(frame.polys[k], temp, k, lx, ly, 1.0);
+         R_clipPVSSide(temp, next.polys[k], k, rx, ry, -1.0);
+         if(next.polys[k].numverts)
+            open = true;
+      }
+
+      if(!open)
+         continue;
+
+      row[to >> 3] |= 1 << (to & 7);
+
+      next.sector = to;
+      next.next   = build.adjstart[to];
+      onpath[to]  = 1;
+      ++depth;
+   }
+}
+
+//
+// R_buildPVSJob
+//
+static void R_buildPVSJob(int jobnum, void *data)
+{
+   pvsbuild_t &build = *static_cast<pvsbuild_t *>(data);
+
+   for(int i = jobnum; i < numsectors; i += build.numjobs)
+      R_buildPVSRow(build, jobnum, i);
+}
+
+//
+// R_computePVS
+//
+// Builds the matrix from scratch. Returns false if the level is unsuitable.
+//
+static bool R_computePVS()
+{
+   pvsbuild_t build;
+   byte      *wild;
+   double     maxcoord = 0.0;
+   int        numadj   = 0;
+
+   if(!R_sectorsClosed())
+      return false;
+
+   build.lines    = emalloc(pvsline_t *, numlines * sizeof(pvsline_t));
+   build.adjstart = ecalloc(int *, numsectors + 1, sizeof(int));
+   wild           = ecalloc(byte *, numsectors, 1);
+
+   for(int i = 0; i < numlines; i++)
+   {
+      const line_t *line = &lines[i];
+      pvsline_t    &pl   = build.lines[i];
+
+      pl.x1    = M_FixedToDouble(line->v1->x);
+      pl.y1    = M_FixedToDouble(line->v1->y);
+      pl.x2    = M_FixedToDouble(line->v2->x);
+      pl.y2    = M_FixedToDouble(line->v2->y);
+      pl.front = line->frontsector ? int(line->frontsector - sectors) : -1;
+      pl.back  = line->backsector  ? int(line->backsector  - sectors) : -1;
+
+      maxcoord = emax(maxcoord, emax(fabs(pl.x1), fabs(pl.y1)));
+      maxcoord = emax(maxcoord, emax(fabs(pl.x2), fabs(pl.y2)));
+   }
+
+   // list the lines that can be crossed out of each sector
+   for(int i = 0; i < numsectors; i++)
+   {
+      const sector_t *sec = &sectors[i];
+
+      build.adjstart[i] = numadj;
+      for(int j = 0; j < sec->linecount; j++)
+      {
+         const line_t *line = sec->lines[j];
+
+         if(line->frontsector && line->backsector &&
+            line->frontsector != line->backsector)
+            ++numadj;
+      }
+   }
+   build.adjstart[numsectors] = numadj;
+
+   build.adjlines = emalloc(int *, (numadj + 1) * sizeof(int));
+   for(int i = 0; i < numsectors; i++)
+   {
+      const sector_t *sec = &sectors[i];
+      int n = build.adjstart[i];
+
+      for(int j = 0; j < sec->linecount; j++)
+      {
+         const line_t *line = sec->lines[j];
+
+         if(line->frontsector && line->backsector &&
+            line->frontsector != line->backsector)
+            build.adjlines[n++] = int(line - lines);
+      }
+   }
+
+   // |q| = |y - mx| <= |x| + |y| for any line through the map
+   build.qmax    = 2.0 * maxcoord + 1.0;
+   build.numjobs = I_GetWorkerThreads() + 1;
+   build.frames  = emalloc(pvsframe_t *,
+                           build.numjobs * MAXPVSDEPTH * sizeof(pvsframe_t));
+   build.onpath  = ecalloc(byte *, build.numjobs, numsectors);
+
+   I_RunJobs(build.numjobs, R_buildPVSJob, &build);
+
+   // sectors that don't bound their own area see and are seen by everything
+   R_findWildSectors(wild);
+   for(int i = 0; i < numsectors; i++)
+   {
+      if(!wild[i])
+         continue;
+
+      memset(pvsmatrix + i * pvsrowbytes, 0xff, pvsrowbytes);
+      for(int j = 0; j < numsectors; j++)
+         pvsmatrix[j * pvsrowbytes + (i >> 3)] |= 1 << (i & 7);
+   }
+
+   efree(build.onpath);
+   efree(build.frames);
+   efree(build.adjlines);
+   efree(wild);
+   efree(build.adjstart);
+   efree(build.lines);
+
+   return true;
+}
+
+//
+// R_pvsFileName
+//
+static void R_pvsFileName(qstring &filename)
+{
+   qstring name;
+
+   name.Printf(0, "%08x.pvs", pvskey);
+   filename = usergamepath;
+   filename.pathConcatenate(name.constPtr());
+}
+
+//
+// R_loadPVS
+//
+static bool R_loadPVS()
+{
+   qstring filename;
+   byte   *buffer = NULL;
+   int     size   = numsectors * pvsrowbytes;
+   int     length;
+   bool    loaded = false;
+
+   R_pvsFileName(filename);
+
+   if((length = M_ReadFile(filename.constPtr(), &buffer)) < 0)
+      return false;
+
+   if(length == PVSHEADERLEN + size && !memcmp(buffer, PVSMAGIC, 8))
+   {
+      uint32_t key, count;
+
+      memcpy(&key,   buffer +  8, sizeof(key));
+      memcpy(&count, buffer + 12, sizeof(count));
+
+      if(SwapULong(key) == pvskey && SwapULong(count) == uint32_t(numsectors))
+      {
+         memcpy(pvsmatrix, buffer + PVSHEADERLEN, size);
+         loaded = true;
+      }
+   }
+
+   efree(buffer);
+   return loaded;
+}
+
+//
+// R_savePVS
+//
+static void R_savePVS()
+{
+   qstring  filename;
+   int      size   = numsectors * pvsrowbytes;
+   byte    *buffer = emalloc(byte *, PVSHEADERLEN + size);
+   uint32_t key    = SwapULong(pvskey);
+   uint32_t count  = SwapULong(uint32_t(numsectors));
+
+   memcpy(buffer,      PVSMAGIC, 8);
+   memcpy(buffer +  8, &key,     sizeof(key));
+   memcpy(buffer + 12, &count,   sizeof(count));
+   memcpy(buffer + PVSHEADERLEN, pvsmatrix, size);
+
+   R_pvsFileName(filename);
+   M_WriteFile(filename.constPtr(), buffer, PVSHEADERLEN + size);
+
+   efree(buffer);
+}
+
+//
+// R_buildPVS
+//
+// Loads or builds the PVS for the current level if it hasn't been yet.
+//
+static void R_buildPVS()
+{
+   if(pvsmatrix || pvsfailed)
+      return;
+
+   if(!numnodes || numsectors > MAXPVSSECTORS)
+   {
+      pvsfailed = true;
+      return;
+   }
+
+   pvsrowbytes = (numsectors + 7) >> 3;
+   pvsmatrix   = ecalloctag(byte *, numsectors, pvsrowbytes, PU_LEVEL,
+                            (void **)&pvsmatrix);
+
+   if(!R_loadPVS())
+   {
+      if(!R_computePVS())
+      {
+         Z_Free(pvsmatrix);
+         pvsfailed = true;
+         return;
+      }
+      R_savePVS();
+   }
+
+   pvsnodevis    = ecalloctag(byte *, numnodes, 1, PU_LEVEL, (void **)&pvsnodevis);
+   pvsssvis      = ecalloctag(byte *, numsubsectors, 1, PU_LEVEL, (void **)&pvsssvis);
+   pvsviewsector = -1;
+}
+
+//
+// R_SetupPVS
+//
+// Called from P_SetupLevel once the level's lines are grouped into sectors.
+//
+void R_SetupPVS(WadDirectory &dir, int lumpnum)
+{
+   static const int maplumps[] =
+   {
+      ML_LINEDEFS, ML_SIDEDEFS, ML_VERTEXES, ML_SEGS, ML_SSECTORS, ML_NODES, ML_SECTORS
+   };
+   uint32_t sums[earrlen(maplumps)];
+
+   for(size_t i = 0; i < earrlen(maplumps); i++)
+   {
+      int lump = lumpnum + maplumps[i];
+
+      sums[i] = dir.lumpLength(lump) ? W_LumpCheckSum(dir, lump) : 0;
+   }
+
+   pvskey = HashData(HashData::CRC32, reinterpret_cast<const uint8_t *>(sums),
+                     uint32_t(sizeof(sums))).getDigestPart(0);
+
+   // the old level's tables went with PU_LEVEL
+   pvsmatrix     = NULL;
+   pvsnodevis    = NULL;
+   pvsssvis      = NULL;
+   pvsnodes      = NULL;
+   pvssubsectors = NULL;
+   pvsfailed     = false;
+
+   if(r_pvs)
+      R_buildPVS();
+}
+
+//
+// R_markPVSNode
+//
+// Marks nodes with any visible subsector beneath them.
+//
+static bool R_markPVSNode(int bspnum)
+{
+   if(bspnum & NF_SUBSECTOR)
+      return !!pvsssvis[bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR];
+
+   const node_t *bsp = &nodes[bspnum];
+   bool visible = R_markPVSNode(bsp->children[0]);
+
+   if(R_markPVSNode(bsp->children[1]))
+      visible = true;
+
+   pvsnodevis[bspnum] = visible;
+   return visible;
+}
+
+//
+// R_PVSBeginView
+//
+// Called before the main view's BSP walk. The PVS only holds for a view
+// point inside its sector, so the walk isn't culled when, for example,
+// the camera has no clipping and has left the map.
+//
+void R_PVSBeginView()
+{
+   pvsnodes = pvssubsectors = NULL;
+
+   if(!r_pvs || !pvsmatrix)
+      return;
+
+   if(!R_pointInSector(view.sector, M_FixedToDouble(viewx), M_FixedToDouble(viewy)))
+      return;
+
+   int secnum = int(view.sector - sectors);
+
+   if(secnum != pvsviewsector)
+   {
+      const byte *row = pvsmatrix + secnum * pvsrowbytes;
+
+      for(int i = 0; i < numsubsectors; i++)
+      {
+         int other = int(subsectors[i].sector - sectors);
+
+         pvsssvis[i] = (row[other >> 3] >> (other & 7)) & 1;
+      }
+      R_markPVSNode(numnodes - 1);
+
+      pvsviewsector = secnum;
+   }
+
+   pvsnodes      = pvsnodevis;
+   pvssubsectors = pvsssvis;
+}
+
+//
+// R_PVSEndView
+//
+// Portal views start elsewhere, so they walk the whole tree.
+//
+void R_PVSEndView()
+{
+   pvsnodes = pvssubsectors = NULL;
+}
+
+VARIABLE_BOOLEAN(r_pvs, NULL, onoff);
+CONSOLE_VARIABLE(r_pvs, r_pvs, 0)
+{
+   if(r_pvs && gamestate == GS_LEVEL)
+      R_buildPVS();
+}
+
+// EOF
+
@@ -0,0 +1,45 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Potentially visible sets between sectors.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef R_PVS_H__
+#define R_PVS_H__
+
+class WadDirectory;
+
+extern bool r_pvs; // cvar: skip BSP nodes the view sector can never see
+
+// Visibility of each node and subsector from the view, or NULL when the
+// current BSP walk isn't culled
+extern const byte *pvsnodes;
+extern const byte *pvssubsectors;
+
+void R_SetupPVS(WadDirectory &dir, int lumpnum);
+void R_PVSBeginView();
+void R_PVSEndView();
+
+#endif
+
+// EOF
+
@@ -30,9 +30,11 @@
 
 #include "doomstat.h"
 #include "e_exdata.h"
+#include "m_profile.h"
 #include "p_info.h"
 #include "p_user.h"
 #include "r_draw.h"
+#include "r_drawlist.h"
 #include "r_bsp.h"
 #include "r_data.h"
 #include "r_main.h"
@@ -219,6 +221,22 @@ void R_RenderMaskedSegRange(drawseg_t *ds, int x1, int x2)
 
 
 
+//
+// R_recordSegColumns
+//
+// Returns true if the current seg's columns should go into the draw list
+// rather than to the screen.
+//
+static bool R_recordSegColumns()
+{
+   if(!r_drawlistactive || !segclip.segtextured)
+      return false;
+
+   return (!segclip.toptex    || R_DrawListTexture(segclip.toptex)) &&
+          (!segclip.midtex    || R_DrawListTexture(segclip.midtex)) &&
+          (!segclip.bottomtex || R_DrawListTexture(segclip.bottomtex));
+}
+
 //
 // R_RenderSegLoop
 //
@@ -233,6 +251,7 @@ static void R_RenderSegLoop(void)
    int i;
    float texx;
    float basescale;
+   bool  record = R_recordSegColumns();
 
 #ifdef RANGECHECK
    if(segclip.x1 < 0 || segclip.x2 >= viewwindow.width || segclip.x1 > segclip.x2)
@@ -385,7 +404,10 @@ static void R_RenderSegLoop(void)
                column.source = R_GetRawColumn(segclip.midtex, (int)texx);
                column.texheight = segclip.midtexh;
 
-               colfunc();
+               if(record)
+                  R_DrawListColumn(colfunc, column);
+               else
+                  colfunc(column);
 
                ceilingclip[i] = view.height - 1.0f;
                floorclip[i] = 0.0f;
@@ -405,7 +427,10 @@ static void R_RenderSegLoop(void)
                   column.source = R_GetRawColumn(segclip.toptex, (int)texx);
                   column.texheight = segclip.toptexh;
 
-                  colfunc();
+                  if(record)
+                     R_DrawListColumn(colfunc, column);
+                  else
+                     colfunc(column);
 
                   ceilingclip[i] = (float)(column.y2 + 1);
                }
@@ -430,7 +455,10 @@ static void R_RenderSegLoop(void)
                   column.source = R_GetRawColumn(segclip.bottomtex, (int)texx);
                   column.texheight = segclip.bottomtexh;
 
-                  colfunc();
+                  if(record)
+                     R_DrawListColumn(colfunc, column);
+                  else
+                     colfunc(column);
 
                   floorclip[i] = (float)(column.y1 - 1);
                }
@@ -480,6 +508,9 @@ static void R_RenderSegLoop(void)
 //
 static void R_CheckDSAlloc(void)
 {
+   // called once for every drawseg that is started
+   M_ProfileCount(PROF_DRAWSEGS);
+
    // drawsegs need to be taken care of here
    if(ds_p == drawsegs + maxdrawsegs)
    {
@@ -541,6 +572,7 @@ static void R_DetectClosedColumns()
       // Mark the closed area.
       R_CloseDSP();
       R_MarkSolidSeg(startx, i - 1);
+      R_MarkSpriteCover(segclip.line, startx, i - 1, model.dist1, model.diststep);
 
       // End closed
       if(i == stop)
@@ -589,6 +621,9 @@ static void R_DetectClosedColumns()
       // modify the drawseg created before this function was called to only be 
       // open where the seg has not created a solid seg.
       R_MarkSolidSeg(startx, i-1);
+      R_MarkSpriteCover(segclip.line, startx, i - 1, 
+                        model.dist1 + model.diststep * (startx - model.x1), 
+                        model.diststep);
 
       // End closed
       if(i == stop)
@@ -834,6 +869,10 @@ void R_StoreWallRange(const int start, const int stop)
       R_RenderSegLoop();
    else
       R_StoreTextureColumns();
+
+   if(segclip.clipsolid)
+      R_MarkSpriteCover(segclip.line, ds_p->x1, ds_p->x2, ds_p->dist1, 
+                        ds_p->diststep);
    
    // store clipping arrays
    if((ds_p->silhouette & SIL_TOP || segclip.maskedtex) && !ds_p->sprtopclip)
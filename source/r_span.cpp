@@ -99,7 +99,7 @@ struct slopevalues
 // is now FASTER than doom's original span renderer. Whodathunkit?
 
 template<int xshift, int yshift, int xmask>
-static void R_DrawSpanSolid_8()
+static void R_DrawSpanSolid_8(const cb_span_t &span)
 {
    unsigned int xf = span.xfrac, xs = span.xstep; 
    unsigned int yf = span.yfrac, ys = span.ystep; 
@@ -134,7 +134,7 @@ static void R_DrawSpanSolid_8()
    }
 }
 
-static void R_DrawSpanSolid_8_GEN()
+static void R_DrawSpanSolid_8_GEN(const cb_span_t &span)
 {
    unsigned int xf = span.xfrac, xs = span.xstep; 
    unsigned int yf = span.yfrac, ys = span.ystep; 
@@ -238,65 +238,17 @@ static void R_DrawSpan_OLD()
 // haleyjd 06/21/08: TL span drawers are needed for double flats and for portal
 // visplane layering.
 //
+// Translucent and additive spans differ only in the blend map the plane
+// supplies, so the same drawers serve both styles.
+//
 
 template<int xshift, int yshift, int xmask>
-static void R_DrawSpanTL_8()
-{
-   unsigned int t;
-   unsigned int xf = span.xfrac, xs = span.xstep;
-   unsigned int yf = span.yfrac, ys = span.ystep;
-   lighttable_t *colormap = span.colormap;
-   int count = span.x2 - span.x1 + 1;
-
-   byte *source = (byte *)span.source;
-   byte *dest   = R_ADDRESS(span.x1, span.y);
-
-   while(count-- > 0)
-   {
-      t = span.bg2rgb[*dest] +
-          span.fg2rgb[colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
-      t |= 0x01f07c1f;
-      *dest++ = RGB32k[0][0][t & (t >> 15)];
-      xf += xs;
-      yf += ys;
-   }
-}
-
-static void R_DrawSpanTL_8_GEN()
-{
-   unsigned int t;
-   unsigned int xf = span.xfrac, xs = span.xstep;
-   unsigned int yf = span.yfrac, ys = span.ystep;
-   lighttable_t *colormap = span.colormap;
-   int count = span.x2 - span.x1 + 1;
-
-   byte *source = (byte *)span.source;
-   byte *dest   = R_ADDRESS(span.x1, span.y);
-
-   unsigned int xshift = span.xshift;
-   unsigned int xmask  = span.xmask;
-   unsigned int yshift = span.yshift;
-
-   while(count-- > 0)
-   {
-      t = span.bg2rgb[*dest] +
-          span.fg2rgb[colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
-      t |= 0x01f07c1f;
-      *dest++ = RGB32k[0][0][t & (t >> 15)];
-      xf += xs;
-      yf += ys;
-   }
-}
-
-// Additive blending
-
-template<int xshift, int yshift, int xmask>
-static void R_DrawSpanAdd_8()
+static void R_DrawSpanTL_8(const cb_span_t &span)
 {
-   unsigned int a, b;
    unsigned int xf = span.xfrac, xs = span.xstep;
    unsigned int yf = span.yfrac, ys = span.ystep;
    lighttable_t *colormap = span.colormap;
+   const byte   *blendmap = span.blendmap;
    int count = span.x2 - span.x1 + 1;
 
    byte *source = (byte *)span.source;
@@ -304,26 +256,20 @@ static void R_DrawSpanAdd_8()
 
    while(count-- > 0)
    {
-      a = span.bg2rgb[*dest] +
-          span.fg2rgb[colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      *dest++ = RGB32k[0][0][a & (a >> 15)];
+      *dest = blendmap[(*dest << 8) +
+                       colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
+      dest++;
       xf += xs;
       yf += ys;
    }
 }
 
-static void R_DrawSpanAdd_8_GEN()
+static void R_DrawSpanTL_8_GEN(const cb_span_t &span)
 {
-   unsigned int a, b;
    unsigned int xf = span.xfrac, xs = span.xstep;
    unsigned int yf = span.yfrac, ys = span.ystep;
    lighttable_t *colormap = span.colormap;
+   const byte   *blendmap = span.blendmap;
    int count = span.x2 - span.x1 + 1;
 
    byte *source = (byte *)span.source;
@@ -335,21 +281,14 @@ static void R_DrawSpanAdd_8_GEN()
 
    while(count-- > 0)
    {
-      a = span.bg2rgb[*dest] +
-          span.fg2rgb[colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
-      b = a;
-      a |= 0x01f07c1f;
-      b &= 0x40100400;
-      a &= 0x3fffffff;
-      b  = b - (b >> 5);
-      a |= b;
-      *dest++ = RGB32k[0][0][a & (a >> 15)];
+      *dest = blendmap[(*dest << 8) +
+                       colormap[source[((xf >> xshift) & xmask) | (yf >> yshift)]]];
+      dest++;
       xf += xs;
       yf += ys;
    }
 }
 
-
 //==============================================================================
 //
 // Slope span drawers
@@ -378,7 +317,7 @@ static void R_DrawSpanAdd_8_GEN()
 #define INTERPSTEP (0.0625f)
 
 template<int xshift, int xmask, int ymask>
-static void R_DrawSlope_8()
+static void R_DrawSlope_8(const cb_slopespan_t &slopespan)
 {
    double iu  = slopespan.iufrac, iv  = slopespan.ivfrac;
    double ius = slopespan.iustep, ivs = slopespan.ivstep;
@@ -460,7 +399,7 @@ static void R_DrawSlope_8()
    }
 }
 
-static void R_DrawSlope_8_GEN()
+static void R_DrawSlope_8_GEN(const cb_slopespan_t &slopespan)
 {
    double iu  = slopespan.iufrac, iv  = slopespan.ivfrac;
    double ius = slopespan.iustep, ivs = slopespan.ivstep;
@@ -476,9 +415,9 @@ static void R_DrawSlope_8_GEN()
    byte *src  = (byte *)slopespan.source;
    byte *dest = R_ADDRESS(slopespan.x1, slopespan.y);
 
-   unsigned int xshift = span.xshift;
-   unsigned int xmask  = span.xmask;
-   unsigned int ymask  = span.ymask;
+   unsigned int xshift = slopespan.xshift;
+   unsigned int xmask  = slopespan.xmask;
+   unsigned int ymask  = slopespan.ymask;
 
    while(count >= SPANJUMP)
    {
@@ -577,11 +516,11 @@ spandrawer_t r_spandrawer =
       },
       // Additive
       { 
-         R_DrawSpanAdd_8<20, 26, 0x00FC0>,   // 64x64
-         R_DrawSpanAdd_8<18, 25, 0x03F80>,   // 128x128
-         R_DrawSpanAdd_8<16, 24, 0x0FF00>,   // 256x256
-         R_DrawSpanAdd_8<14, 23, 0x3FE00>,   // 512x512
-         R_DrawSpanAdd_8_GEN                 // General
+         R_DrawSpanTL_8<20, 26, 0x00FC0>,    // 64x64
+         R_DrawSpanTL_8<18, 25, 0x03F80>,    // 128x128
+         R_DrawSpanTL_8<16, 24, 0x0FF00>,    // 256x256
+         R_DrawSpanTL_8<14, 23, 0x3FE00>,    // 512x512
+         R_DrawSpanTL_8_GEN                  // General
       }
    },
 
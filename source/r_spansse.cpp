@@ -0,0 +1,375 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    SSE2 span drawers.
+//
+//    These produce exactly the same pixels as the drawers in r_span.cpp, but
+//    step the texture coordinates and build texel offsets eight pixels at a
+//    time. SSE2 has no gather, so the texel, colormap and blend map fetches
+//    are still made one at a time from the computed offsets, except that
+//    blend map reads are gathered on processors with AVX2.
+//
+//    Since the shifts and masks are taken from the span rather than from
+//    template arguments, one drawer serves every flat size.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+#include "hal/i_platform.h"
+#include "r_avx2.h"
+#include "r_draw.h"
+#include "r_main.h"
+#include "r_plane.h"
+#include "v_video.h"
+
+#ifdef EE_FEATURE_SSE2
+
+#include <emmintrin.h>
+
+//==============================================================================
+//
+// Texel Offsets
+//
+
+//
+// Vector state for stepping an orthogonal span
+//
+struct ssespan_t
+{
+   __m128i xf, yf;        // positions of the next four pixels
+   __m128i xs, ys;        // four pixels' worth of step
+   __m128i xshift, yshift;
+   __m128i xmask;
+};
+
+//
+// R_sseSetupSpan
+//
+static void R_sseSetupSpan(ssespan_t &ss, const cb_span_t &span)
+{
+   unsigned int xf = span.xfrac, xs = span.xstep;
+   unsigned int yf = span.yfrac, ys = span.ystep;
+
+   ss.xf = _mm_setr_epi32(int(xf), int(xf + xs), int(xf + 2*xs), int(xf + 3*xs));
+   ss.yf = _mm_setr_epi32(int(yf), int(yf + ys), int(yf + 2*ys), int(yf + 3*ys));
+   ss.xs = _mm_set1_epi32(int(xs * 4));
+   ss.ys = _mm_set1_epi32(int(ys * 4));
+
+   ss.xshift = _mm_cvtsi32_si128(int(span.xshift));
+   ss.yshift = _mm_cvtsi32_si128(int(span.yshift));
+   ss.xmask  = _mm_set1_epi32(int(span.xmask));
+}
+
+//
+// R_sseSpanOffsets
+//
+// Writes the texel offsets of the next eight pixels of the span to ofs.
+//
+static inline void R_sseSpanOffsets(ssespan_t &ss, unsigned int *ofs)
+{
+   __m128i o;
+
+   o = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(ss.xf, ss.xshift), ss.xmask),
+                    _mm_srl_epi32(ss.yf, ss.yshift));
+   _mm_storeu_si128((__m128i *)ofs, o);
+   ss.xf = _mm_add_epi32(ss.xf, ss.xs);
+   ss.yf = _mm_add_epi32(ss.yf, ss.ys);
+
+   o = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(ss.xf, ss.xshift), ss.xmask),
+                    _mm_srl_epi32(ss.yf, ss.yshift));
+   _mm_storeu_si128((__m128i *)(ofs + 4), o);
+   ss.xf = _mm_add_epi32(ss.xf, ss.xs);
+   ss.yf = _mm_add_epi32(ss.yf, ss.ys);
+}
+
+//
+// R_sseSpanOffsetsTail
+//
+// Writes the texel offsets of the last count (< 8) pixels of the span.
+//
+static inline void R_sseSpanOffsetsTail(ssespan_t &ss, unsigned int *ofs, int count)
+{
+   unsigned int tmp[8];
+
+   R_sseSpanOffsets(ss, tmp);
+   for(int i = 0; i < count; i++)
+      ofs[i] = tmp[i];
+}
+
+//==============================================================================
+//
+// Orthogonal Span Drawers
+//
+
+static void R_DrawSpanSolid_SSE2(const cb_span_t &span)
+{
+   ssespan_t ss;
+   unsigned int ofs[8];
+   lighttable_t *colormap = span.colormap;
+   int count = span.x2 - span.x1 + 1;
+
+   byte *source = (byte *)span.source;
+   byte *dest   = R_ADDRESS(span.x1, span.y);
+
+   R_sseSetupSpan(ss, span);
+
+   while(count >= 8)
+   {
+      R_sseSpanOffsets(ss, ofs);
+      dest[0] = colormap[source[ofs[0]]];
+      dest[1] = colormap[source[ofs[1]]];
+      dest[2] = colormap[source[ofs[2]]];
+      dest[3] = colormap[source[ofs[3]]];
+      dest[4] = colormap[source[ofs[4]]];
+      dest[5] = colormap[source[ofs[5]]];
+      dest[6] = colormap[source[ofs[6]]];
+      dest[7] = colormap[source[ofs[7]]];
+      dest  += 8;
+      count -= 8;
+   }
+   if(count > 0)
+   {
+      R_sseSpanOffsetsTail(ss, ofs, count);
+      for(int i = 0; i < count; i++)
+         dest[i] = colormap[source[ofs[i]]];
+   }
+}
+
+#ifdef EE_FEATURE_AVX2
+//
+// R_sseSpanTLAVX2
+//
+// Draws count pixels (a multiple of 16) of a translucent span, gathering
+// the blend map reads sixteen at a time.
+//
+EE_AVX2_TARGET static void R_sseSpanTLAVX2(ssespan_t &ss, byte *dest,
+                                           const byte *source,
+                                           const lighttable_t *colormap,
+                                           const byte *blendmap, int count)
+{
+   unsigned int ofs[16];
+   byte texels[16];
+
+   for(; count > 0; count -= 16)
+   {
+      R_sseSpanOffsets(ss, ofs);
+      R_sseSpanOffsets(ss, ofs + 8);
+      for(int i = 0; i < 16; i++)
+         texels[i] = colormap[source[ofs[i]]];
+
+      __m128i d = _mm_loadu_si128((const __m128i *)dest);
+      __m128i s = _mm_loadu_si128((const __m128i *)texels);
+      _mm_storeu_si128((__m128i *)dest, R_AVX2Blend16(d, s, blendmap));
+      dest += 16;
+   }
+}
+#endif
+
+//
+// R_DrawSpanTL_SSE2
+//
+// Translucent and additive spans; the plane supplies the blend map.
+//
+static void R_DrawSpanTL_SSE2(const cb_span_t &span)
+{
+   ssespan_t ss;
+   unsigned int ofs[8];
+   lighttable_t *colormap = span.colormap;
+   const byte   *blendmap = span.blendmap;
+   int count = span.x2 - span.x1 + 1;
+
+   byte *source = (byte *)span.source;
+   byte *dest   = R_ADDRESS(span.x1, span.y);
+
+   R_sseSetupSpan(ss, span);
+
+#ifdef EE_FEATURE_AVX2
+   static const bool useavx2 = I_CPUHasAVX2();
+
+   if(useavx2 && count >= 16)
+   {
+      int n = count & ~15;
+
+      R_sseSpanTLAVX2(ss, dest, source, colormap, blendmap, n);
+      dest  += n;
+      count -= n;
+   }
+#endif
+
+   while(count > 0)
+   {
+      int n = count < 8 ? count : 8;
+
+      if(n == 8)
+         R_sseSpanOffsets(ss, ofs);
+      else
+         R_sseSpanOffsetsTail(ss, ofs, n);
+
+      for(int i = 0; i < n; i++)
+         dest[i] = blendmap[(dest[i] << 8) + colormap[source[ofs[i]]]];
+
+      dest  += n;
+      count -= n;
+   }
+}
+
+//==============================================================================
+//
+// Slope Span Drawer
+//
+// The perspective divide is still done every SPANJUMP pixels in double
+// precision, exactly as in R_DrawSlope_8; only the affine stepping between
+// divides is vectorized.
+//
+
+#define SPANJUMP 16
+#define INTERPSTEP (0.0625f)
+
+//
+// R_sseSlopeRun
+//
+// Draws count (<= SPANJUMP) pixels of a slope span with linear stepping.
+//
+static void R_sseSlopeRun(byte *dest, const byte *src, lighttable_t **colormaps,
+                          unsigned int ufrac, unsigned int vfrac,
+                          unsigned int ustep, unsigned int vstep, int count,
+                          __m128i xshift, __m128i xmask, __m128i ymask)
+{
+   unsigned int ofs[SPANJUMP];
+   __m128i uf = _mm_setr_epi32(int(ufrac), int(ufrac + ustep),
+                               int(ufrac + 2*ustep), int(ufrac + 3*ustep));
+   __m128i vf = _mm_setr_epi32(int(vfrac), int(vfrac + vstep),
+                               int(vfrac + 2*vstep), int(vfrac + 3*vstep));
+   __m128i us = _mm_set1_epi32(int(ustep * 4));
+   __m128i vs = _mm_set1_epi32(int(vstep * 4));
+
+   for(int i = 0; i < count; i += 4)
+   {
+      __m128i o =
+         _mm_or_si128(_mm_and_si128(_mm_srl_epi32(vf, xshift), xmask),
+                      _mm_and_si128(_mm_srli_epi32(uf, 16), ymask));
+      _mm_storeu_si128((__m128i *)(ofs + i), o);
+      uf = _mm_add_epi32(uf, us);
+      vf = _mm_add_epi32(vf, vs);
+   }
+
+   for(int i = 0; i < count; i++)
+      dest[i] = colormaps[i][src[ofs[i]]];
+}
+
+static void R_DrawSlope_SSE2(const cb_slopespan_t &slopespan)
+{
+   double iu  = slopespan.iufrac, iv  = slopespan.ivfrac;
+   double ius = slopespan.iustep, ivs = slopespan.ivstep;
+   double id  = slopespan.idfrac, ids = slopespan.idstep;
+
+   int count;
+   lighttable_t **colormaps = slopespan.colormap;
+
+   if((count = slopespan.x2 - slopespan.x1 + 1) < 0)
+      return;
+
+   byte *src  = (byte *)slopespan.source;
+   byte *dest = R_ADDRESS(slopespan.x1, slopespan.y);
+
+   __m128i xshift = _mm_cvtsi32_si128(int(slopespan.xshift));
+   __m128i xmask  = _mm_set1_epi32(int(slopespan.xmask));
+   __m128i ymask  = _mm_set1_epi32(int(slopespan.ymask));
+
+   while(count > 0)
+   {
+      double ustart, uend;
+      double vstart, vend;
+      double mulstart, mulend;
+      unsigned int ustep, vstep, ufrac, vfrac;
+      int n = count >= SPANJUMP ? SPANJUMP : count;
+
+      mulstart = 65536.0f / id;
+      id += ids * n;
+      mulend = 65536.0f / id;
+
+      ufrac = (int)(ustart = iu * mulstart);
+      vfrac = (int)(vstart = iv * mulstart);
+      iu += ius * n;
+      iv += ivs * n;
+      uend = iu * mulend;
+      vend = iv * mulend;
+
+      if(n == SPANJUMP)
+      {
+         ustep = (int)((uend - ustart) * INTERPSTEP);
+         vstep = (int)((vend - vstart) * INTERPSTEP);
+      }
+      else
+      {
+         ustep = (int)((uend - ustart) / n);
+         vstep = (int)((vend - vstart) / n);
+      }
+
+      R_sseSlopeRun(dest, src, colormaps, ufrac, vfrac, ustep, vstep, n,
+                    xshift, xmask, ymask);
+
+      dest      += n;
+      colormaps += n;
+      count     -= n;
+   }
+}
+
+#undef SPANJUMP
+#undef INTERPSTEP
+
+//==============================================================================
+//
+// Span Engine Object
+//
+
+#define SSE2SPANS(func) { func, func, func, func, func }
+
+// the SSE2 span drawer; R_SetSpanEngine won't select it unless I_CPUHasSSE2
+spandrawer_t r_ssespandrawer =
+{
+   // Orthogonal span drawers
+   {
+      SSE2SPANS(R_DrawSpanSolid_SSE2), // Solid
+      SSE2SPANS(R_DrawSpanTL_SSE2),    // Translucent
+      SSE2SPANS(R_DrawSpanTL_SSE2)     // Additive
+   },
+
+   // Sloped span drawers (translucent and additive are TODO, as in
+   // r_spandrawer)
+   {
+      SSE2SPANS(R_DrawSlope_SSE2),
+      SSE2SPANS(R_DrawSlope_SSE2),
+      SSE2SPANS(R_DrawSlope_SSE2)
+   }
+};
+
+#undef SSE2SPANS
+
+#else
+
+// not compiled in; R_SetSpanEngine falls back to r_spandrawer
+spandrawer_t r_ssespandrawer;
+
+#endif
+
+// EOF
+
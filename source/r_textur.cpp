@@ -32,6 +32,8 @@
 #include "d_io.h"
 #include "d_main.h"
 #include "e_hash.h"
+#include "hal/i_thread.h"
+#include "m_collection.h"
 #include "m_compare.h"
 #include "m_swap.h"
 #include "p_setup.h"
@@ -627,26 +629,25 @@ struct tempmask_s
 //
 // AddTexColumn
 //
-// Copies from src to the tex buffer and optionally marks the temporary mask
+// Copies from src to the tex buffer and marks the mask buffer, if there is one
 //
-static void AddTexColumn(texture_t *tex, const byte *src, int srcstep, 
+static void AddTexColumn(texture_t *tex, byte *mask, const byte *src, int srcstep, 
                          int ptroff, int len)
 {
    byte *dest = tex->buffer + ptroff;
    
 #ifdef RANGECHECK
-   if(ptroff < 0 || ptroff + len > tex->width * tex->height ||
-      ptroff + len > tempmask.buffermax)
+   if(ptroff < 0 || ptroff + len > tex->width * tex->height)
    {
-      I_Error("AddTexColumn(%s) invalid ptroff: %i / (%i, %i)\n", 
+      I_Error("AddTexColumn(%s) invalid ptroff: %i / %i\n", 
               (const char *)(tex->name), 
-              ptroff + len, tex->width * tex->height, tempmask.buffermax);
+              ptroff + len, tex->width * tex->height);
    }
 #endif
 
-   if(tempmask.mask && tex == tempmask.tex)
+   if(mask)
    {
-      byte *mask = tempmask.buffer + ptroff;
+      mask += ptroff;
       
       while(len > 0)
       {
@@ -673,9 +674,9 @@ static void AddTexColumn(texture_t *tex, const byte *src, int srcstep,
 // 
 // Paints the given flat-based component to the texture and marks mask info
 //
-static void AddTexFlat(texture_t *tex, tcomponent_t *component)
+static void AddTexFlat(texture_t *tex, byte *mask, const tcomponent_t *component,
+                       const byte *src)
 {
-   byte      *src = (byte *)(wGlobalDir.cacheLumpNum(component->lump, PU_CACHE));
    int       destoff, srcoff, deststep, srcxstep, srcystep;
    int       xstart, ystart, xstop, ystop;
    int       width, height, wcount, hcount;
@@ -735,7 +736,7 @@ static void AddTexFlat(texture_t *tex, tcomponent_t *component)
          I_Error("AddTexFlat(%s): Invalid srcoff %i / %i\n", 
                  (const char *)(tex->name), srcoff, tex->width * tex->height);
 #endif
-      AddTexColumn(tex, src + srcoff, srcystep, destoff, hcount);
+      AddTexColumn(tex, mask, src + srcoff, srcystep, destoff, hcount);
       srcoff += srcxstep;
       destoff += deststep;
       wcount--;
@@ -747,9 +748,9 @@ static void AddTexFlat(texture_t *tex, tcomponent_t *component)
 // 
 // Paints the given flat-based component to the texture and marks mask info
 //
-static void AddTexPatch(texture_t *tex, tcomponent_t *component)
+static void AddTexPatch(texture_t *tex, byte *mask, const tcomponent_t *component,
+                        const patch_t *patch)
 {
-   patch_t *patch = PatchLoader::CacheNum(wGlobalDir, component->lump, PU_CACHE);
    int      destoff;
    int      xstart, ystart, xstop;
    int      colindex, colstep;
@@ -827,20 +828,65 @@ static void AddTexPatch(texture_t *tex, tcomponent_t *component)
 #endif
             
          if(y2 - y1 > 0)
-            AddTexColumn(tex, src + srcoff, 1, destoff, y2 - y1);
+            AddTexColumn(tex, mask, src + srcoff, 1, destoff, y2 - y1);
             
          column = (const column_t *)(src + column->length + 1);
       }
    }
 }
 
+//
+// R_componentSource
+//
+// Caches the lump a component is drawn from: raw for flats, as a patch_t
+// for patches. A lump of -1 has no source.
+//
+static void *R_componentSource(const tcomponent_t *component, int tag)
+{
+   if(component->lump == -1)
+      return NULL;
+
+   if(component->type == TC_PATCH)
+      return PatchLoader::CacheNum(wGlobalDir, component->lump, tag);
+   else
+      return wGlobalDir.cacheLumpNum(component->lump, tag);
+}
+
+//
+// AddTexComponent
+//
+// Paints a component to the texture from its cached source. Only writes to
+// the texture's buffer and the mask, so distinct textures may be built at
+// the same time.
+//
+static void AddTexComponent(texture_t *tex, byte *mask, 
+                            const tcomponent_t *component, const void *src)
+{
+   // SoM: Do NOT add lumps with a -1 lumpnum
+   if(!src)
+      return;
+
+   switch(component->type)
+   {
+   case TC_FLAT:
+      AddTexFlat(tex, mask, component, static_cast<const byte *>(src));
+      break;
+   case TC_PATCH:
+      AddTexPatch(tex, mask, component, static_cast<const patch_t *>(src));
+      break;
+   default:
+      break;
+   }
+}
+
 //
 // StartTexture
 //
 // Allocates the texture buffer, as well as managing the temporary structs and
-// the mask buffer.
+// the mask buffer. If dest is given, the texture is built there instead; it
+// must be zeroed and large enough.
 //
-static void StartTexture(texture_t *tex, bool mask)
+static void StartTexture(texture_t *tex, bool mask, byte *dest)
 {
    // haleyjd 11/18/12: We *must* allocate some pad space in the texture buffer.
    // Due to intermixed use of float and fixed_t in Cardboard, it is impossible
@@ -850,8 +896,13 @@ static void StartTexture(texture_t *tex, bool mask)
 
    int bufferlen = tex->width * tex->height + 4;
    
-   // Static for now
-   tex->buffer = ecalloctag(byte *, 1, bufferlen, PU_STATIC, (void **)&tex->buffer);
+   if(dest)
+   {
+      tex->buffer = dest;
+      tex->flags |= TF_ATLAS;
+   }
+   else // Static for now
+      tex->buffer = ecalloctag(byte *, 1, bufferlen, PU_STATIC, (void **)&tex->buffer);
    
    if((tempmask.mask = mask))
    {
@@ -891,33 +942,22 @@ static texcol_t *NextTempCol(texcol_t *current)
 }
 
 //
-// FinishTexture
+// BuildTexColumns
 //
-// Called after R_CacheTexture is finished drawing a texture. This function
-// builds the columns (if needed) of a texture from the temporary mask buffer.
+// Builds the columns of a texture from a mask buffer filled in while it was
+// drawn.
 //
-static void FinishTexture(texture_t *tex)
+static void BuildTexColumns(texture_t *tex, const byte *mask)
 {
    int        x, y, i, colcount;
    texcol_t   *col, *tcol;
-   byte       *maskp;
+   const byte *maskp;
 
-   Z_ChangeTag(tex->buffer, PU_CACHE);
-   
-   if(!tempmask.mask)
-      return;
-      
-   if(tempmask.tex != tex)
-   {
-      // SoM: ERROR?
-      return;
-   }
-   
    // Allocate column pointers
    tex->columns = ecalloctag(texcol_t **, sizeof(texcol_t **), tex->width, PU_RENDERER, NULL);
    
    // Build the columns based on mask info
-   maskp = tempmask.buffer;
+   maskp = mask;
 
    for(x = 0; x < tex->width; x++)
    {
@@ -941,7 +981,7 @@ static void FinishTexture(texture_t *tex)
             col = NextTempCol(col);
             
             col->yoff = y;
-            col->ptroff = maskp - tempmask.buffer;
+            col->ptroff = maskp - mask;
             
             while(y < tex->height && *maskp > 0)
             {
@@ -975,24 +1015,38 @@ static void FinishTexture(texture_t *tex)
 }
 
 //
-// R_CacheTexture
-// 
-// Caches a texture in memory, building it from component parts.
+// FinishTexture
 //
-texture_t *R_CacheTexture(int num)
+// Called after R_CacheTexture is finished drawing a texture. This function
+// builds the columns (if needed) of a texture from the temporary mask buffer.
+//
+static void FinishTexture(texture_t *tex)
 {
-   texture_t  *tex;
-   int        i;
+   if(!(tex->flags & TF_ATLAS))
+      Z_ChangeTag(tex->buffer, PU_CACHE);
    
-#ifdef RANGECHECK
-   if(num < 0 || num >= texturecount)
-      I_Error("R_CacheTexture: invalid texture num %i\n", num);
-#endif
+   if(!tempmask.mask)
+      return;
+      
+   if(tempmask.tex != tex)
+   {
+      // SoM: ERROR?
+      return;
+   }
+
+   BuildTexColumns(tex, tempmask.buffer);
+}
+
+//
+// R_buildTexture
+//
+// Builds a texture's buffer from its component parts, into dest if it is
+// given or else into a new zone block.
+//
+static void R_buildTexture(texture_t *tex, byte *dest)
+{
+   int i;
 
-   tex = textures[num];
-   if(tex->buffer)
-      return tex;
-   
    // SoM: This situation would most certainly require an abort.
    if(tex->ccount == 0)
    {
@@ -1008,35 +1062,248 @@ texture_t *R_CacheTexture(int num)
    //    This case means we only have to rebuilt the buffer.
 
    // Start the texture. Check the size of the mask buffer if needed.   
-   StartTexture(tex, tex->columns == NULL);
+   StartTexture(tex, tex->columns == NULL, dest);
    
    // Add the components to the buffer/mask
    for(i = 0; i < tex->ccount; i++)
    {
       tcomponent_t *component = tex->components + i;
-      
-      // SoM: Do NOT add lumps with a -1 lumpnum
-      if(component->lump == -1)
-         continue;
-         
-      switch(component->type)
-      {
-      case TC_FLAT:
-         AddTexFlat(tex, component);
-         break;
-      case TC_PATCH:
-         AddTexPatch(tex, component);
-         break;
-      default:
-         break;
-      }
+
+      AddTexComponent(tex, tempmask.mask ? tempmask.buffer : NULL, component,
+                      R_componentSource(component, PU_CACHE));
    }
 
    // Finish texture
    FinishTexture(tex);
+}
+
+//
+// R_CacheTexture
+// 
+// Caches a texture in memory, building it from component parts.
+//
+texture_t *R_CacheTexture(int num)
+{
+   texture_t *tex;
+   
+#ifdef RANGECHECK
+   if(num < 0 || num >= texturecount)
+      I_Error("R_CacheTexture: invalid texture num %i\n", num);
+#endif
+
+   tex = textures[num];
+   if(!tex->buffer)
+      R_buildTexture(tex, NULL);
+
    return tex;
 }
 
+//=============================================================================
+//
+// Texture Atlas
+//
+// When a level is precached, the wall textures it uses are composited into
+// one block instead of a zone block each. Every texture starts on a cache
+// line inside it and keeps its own buffer pointer, so column lookups are
+// unchanged, but the columns the drawers read are packed into far fewer
+// pages and no longer fragment the zone heap.
+//
+// Compositing is done by the worker pool. All lump caching (including PNG
+// conversion) and zone allocation happens first on the main thread, and the
+// lumps are held at PU_STATIC until the workers have finished with them.
+//
+
+#define ATLASALIGN 64
+
+static byte       *atlasblock;       // zone block holding the atlas
+static texture_t **atlastextures;    // textures built into it
+static int         numatlastextures;
+
+//
+// R_atlasTextureSize
+//
+// Space taken by a texture in the atlas: the padded length StartTexture
+// would allocate, rounded up to a whole cache line.
+//
+static size_t R_atlasTextureSize(const texture_t *tex)
+{
+   size_t len = size_t(tex->width) * tex->height + 4;
+
+   return (len + ATLASALIGN - 1) & ~size_t(ATLASALIGN - 1);
+}
+
+//
+// R_FreeTextureAtlas
+//
+// Frees the atlas. Textures that were in it are rebuilt by R_CacheTexture
+// the next time they are needed.
+//
+void R_FreeTextureAtlas()
+{
+   if(!atlasblock)
+      return;
+
+   for(int i = 0; i < numatlastextures; i++)
+   {
+      atlastextures[i]->buffer = NULL;
+      atlastextures[i]->flags &= ~TF_ATLAS;
+   }
+
+   efree(atlastextures);
+   efree(atlasblock);
+   atlastextures    = NULL;
+   atlasblock       = NULL;
+   numatlastextures = 0;
+}
+
+// One texture to be built into the atlas
+struct atlasbuild_t
+{
+   texture_t *tex;
+   byte      *mask;    // mask buffer, if its columns must be built
+   int        sources; // index of its first component in atlassources
+};
+
+// A lump held at PU_STATIC for the workers, and the tag to put it back to
+struct atlaspin_t
+{
+   void *data;
+   int   tag;
+};
+
+static PODCollection<atlasbuild_t> atlasbuilds;
+static PODCollection<void *>       atlassources;
+static PODCollection<atlaspin_t>   atlaspins;
+
+//
+// R_pinComponentSource
+//
+// Caches a component's lump and holds it at PU_STATIC until the atlas is
+// built. Lumps already at a non-purgable tag are left alone.
+//
+static void *R_pinComponentSource(const tcomponent_t *component)
+{
+   void *src = R_componentSource(component, PU_CACHE);
+   int   tag;
+
+   if(src && (tag = Z_CheckTag(src)) >= PU_PURGELEVEL)
+   {
+      atlaspin_t &pin = atlaspins.addNew();
+      pin.data = src;
+      pin.tag  = tag;
+      Z_ChangeTag(src, PU_STATIC);
+   }
+
+   return src;
+}
+
+//
+// R_compositeAtlasTexture
+//
+// Worker job: paints all the components of one atlas texture.
+//
+static void R_compositeAtlasTexture(int jobnum, void *data)
+{
+   const atlasbuild_t &build = atlasbuilds.begin()[jobnum];
+   texture_t *tex = build.tex;
+   void **sources = atlassources.begin() + build.sources;
+
+   for(int i = 0; i < tex->ccount; i++)
+      AddTexComponent(tex, build.mask, tex->components + i, sources[i]);
+}
+
+//
+// R_BuildTextureAtlas
+//
+// Composites every wall texture marked in hitlist into a new atlas,
+// replacing any buffer it had already been cached into.
+//
+void R_BuildTextureAtlas(const byte *hitlist)
+{
+   size_t total = 0, masktotal = 0;
+   int    count = 0;
+   byte  *dest, *maskblock, *mask;
+
+   R_FreeTextureAtlas();
+
+   for(int i = wallstart; i < wallstop; i++)
+   {
+      // generated textures have no components to build from
+      if(hitlist[i] && textures[i]->ccount > 0)
+      {
+         total += R_atlasTextureSize(textures[i]);
+         if(!textures[i]->columns)
+            masktotal += R_atlasTextureSize(textures[i]);
+         ++count;
+      }
+   }
+
+   if(!count)
+      return;
+
+   atlasblock    = ecalloctag(byte *, 1, total + ATLASALIGN - 1, PU_STATIC, NULL);
+   atlastextures = ecalloctag(texture_t **, count, sizeof(texture_t *), PU_STATIC, NULL);
+   maskblock     = masktotal ? ecalloc(byte *, 1, masktotal) : NULL;
+
+   dest = (byte *)((uintptr_t(atlasblock) + ATLASALIGN - 1) & ~uintptr_t(ATLASALIGN - 1));
+   mask = maskblock;
+
+   atlasbuilds.resize(0);
+   atlassources.resize(0);
+   atlaspins.resize(0);
+
+   // Everything that touches the zone heap is done here, up front
+   for(int i = wallstart; i < wallstop; i++)
+   {
+      texture_t *tex = textures[i];
+
+      if(!hitlist[i] || tex->ccount <= 0)
+         continue;
+
+      if(tex->buffer)
+         Z_Free(tex->buffer);
+
+      tex->buffer = dest;
+      tex->flags |= TF_ATLAS;
+      atlastextures[numatlastextures++] = tex;
+      dest += R_atlasTextureSize(tex);
+
+      atlasbuild_t &build = atlasbuilds.addNew();
+      build.tex     = tex;
+      build.mask    = NULL;
+      build.sources = int(atlassources.getLength());
+
+      if(!tex->columns)
+      {
+         build.mask = mask;
+         mask += R_atlasTextureSize(tex);
+      }
+
+      for(int c = 0; c < tex->ccount; c++)
+         atlassources.add(R_pinComponentSource(tex->components + c));
+   }
+
+#ifdef RANGECHECK
+   // the compositors may I_Error, which workers must not do
+   for(int i = 0; i < count; i++)
+      R_compositeAtlasTexture(i, NULL);
+#else
+   I_RunJobs(count, R_compositeAtlasTexture, NULL);
+#endif
+
+   for(size_t i = 0; i < atlaspins.getLength(); i++)
+      Z_ChangeTag(atlaspins[i].data, atlaspins[i].tag);
+
+   for(size_t i = 0; i < atlasbuilds.getLength(); i++)
+   {
+      if(atlasbuilds[i].mask)
+         BuildTexColumns(atlasbuilds[i].tex, atlasbuilds[i].mask);
+   }
+
+   if(maskblock)
+      efree(maskblock);
+}
+
 //
 // R_checkerBoardTexture
 //
@@ -30,12 +30,15 @@
 #include "i_system.h"
 
 #include "c_io.h"
+#include "c_runcmd.h"
 #include "d_main.h"
 #include "doomstat.h"
 #include "e_edf.h"
 #include "g_game.h"
+#include "hal/i_timer.h"
 #include "m_argv.h"
 #include "m_compare.h"
+#include "m_profile.h"
 #include "m_swap.h"
 #include "p_chase.h"
 #include "p_info.h"
@@ -167,6 +170,7 @@ struct vissprite_t
 
   int    sector; // SoM: sector the sprite is in.
 
+  bool   occludable; // may be rejected by R_spriteOccluded; not particles
 };
 
 // haleyjd 04/25/10: drawsegs optimization
@@ -221,6 +225,12 @@ static int numParticles;
 static vissprite_t *vissprites, **vissprite_ptrs;  // killough
 static size_t num_vissprite, num_vissprite_alloc, num_vissprite_ptrs;
 
+// radix sort keys, allocated with and indexed like vissprite_ptrs
+static uint32_t *vissprite_keys;
+
+// ranges with at least this many sprites are radix sorted (0 = never)
+int r_spriteradix = 384;
+
 // SoM 12/13/03: the post-BSP stack
 static poststack_t   *pstack       = NULL;
 static int            pstacksize   = 0;
@@ -237,6 +247,7 @@ VALLOCATION(pstack)
          if(pstack[i].masked)
          {
             efree(pstack[i].masked->ceilingclip);
+            efree(pstack[i].masked->spritecover);
             efree(pstack[i].masked);
          }
       }
@@ -251,6 +262,7 @@ VALLOCATION(pstack)
    {
       maskedrange_t *next = mr->next;
       efree(mr->ceilingclip);
+      efree(mr->spritecover);
       efree(mr);
       mr = next;
    }
@@ -272,6 +284,36 @@ VALLOCATION(clipbot)
    cliptop = buffer + w;
 }
 
+//
+// Sprite occlusion
+//
+// spritecover holds, for each column, the wall that closed the column during
+// the current BSP walk. spritecoverblock holds the farthest distance of those
+// walls over each run of SPRCOVERBLOCK columns, or 0 if any column in it is
+// open, so a sprite behind solid walls is usually rejected after looking at a
+// few blocks instead of clipping it against every drawseg.
+//
+#define SPRCOVERSHIFT 4
+#define SPRCOVERBLOCK (1 << SPRCOVERSHIFT)
+
+bool r_occludesprites = true;
+
+static sprcover_t *spritecover;
+static float      *spritecoverblock;
+static int         numcoverblocks;
+
+// cover of the masked range being drawn
+static sprcover_t *pcover;
+static float      *pcoverblock;
+
+VALLOCATION(spritecover)
+{
+   numcoverblocks = (w + SPRCOVERBLOCK - 1) >> SPRCOVERSHIFT;
+
+   spritecover      = ecalloctag(sprcover_t *, w, sizeof(sprcover_t), PU_VALLOC, NULL);
+   spritecoverblock = ecalloctag(float *, numcoverblocks, sizeof(float), PU_VALLOC, NULL);
+}
+
 //=============================================================================
 //
 // Functions
@@ -565,9 +607,12 @@ void R_PushPost(bool pushmasked, planehash_t *overlay)
       {
          post->masked = estructalloc(maskedrange_t, 1);
        
-         float *buf = emalloc(float *, 2 * video.width * sizeof(float));
-         post->masked->ceilingclip = buf;
-         post->masked->floorclip   = buf + video.width;
+         float *buf = emalloc(float *, (2 * video.width + numcoverblocks) * sizeof(float));
+         post->masked->ceilingclip      = buf;
+         post->masked->floorclip        = buf + video.width;
+         post->masked->spritecoverblock = buf + 2 * video.width;
+         post->masked->spritecover      = 
+            emalloc(sprcover_t *, video.width * sizeof(sprcover_t));
       }
          
       for(i = pstacksize - 1; i >= 0; i--)
@@ -589,6 +634,10 @@ void R_PushPost(bool pushmasked, planehash_t *overlay)
       
       memcpy(post->masked->ceilingclip, portaltop,    sizeof(*portaltop)    * video.width);
       memcpy(post->masked->floorclip,   portalbottom, sizeof(*portalbottom) * video.width);
+      memcpy(post->masked->spritecover, spritecover, 
+             sizeof(*spritecover) * video.width);
+      memcpy(post->masked->spritecoverblock, spritecoverblock, 
+             sizeof(*spritecoverblock) * numcoverblocks);
    }
    else
       post->masked = NULL;
@@ -596,6 +645,110 @@ void R_PushPost(bool pushmasked, planehash_t *overlay)
    pstacksize++;
 }
 
+//
+// R_ClearSpriteCover
+//
+// Opens every column at the start of a BSP walk.
+//
+void R_ClearSpriteCover()
+{
+   memset(spritecover,      0, sizeof(*spritecover)      * video.width);
+   memset(spritecoverblock, 0, sizeof(*spritecoverblock) * numcoverblocks);
+}
+
+//
+// R_MarkSpriteCover
+//
+// Called when seg closes columns x1 through x2. dist is the wall's distance
+// at x1, and changes by diststep per column; the drawseg left covering those
+// columns has the same span.
+//
+void R_MarkSpriteCover(seg_t *seg, int x1, int x2, float dist, float diststep)
+{
+   float dist2    = dist + diststep * (x2 - x1);
+   float neardist = dist > dist2 ? dist : dist2;
+   float fardist  = dist > dist2 ? dist2 : dist;
+   int   x, b;
+
+   for(x = x1; x <= x2; x++)
+   {
+      sprcover_t &cover = spritecover[x];
+
+      // walls arrive front to back, so keep the first one to close a column
+      if(!cover.neardist)
+      {
+         cover.seg      = seg;
+         cover.neardist = neardist;
+         cover.fardist  = fardist;
+      }
+   }
+
+   // recompute the blocks that the range touched
+   for(b = x1 >> SPRCOVERSHIFT; b <= x2 >> SPRCOVERSHIFT; b++)
+   {
+      int   stop    = (b + 1) << SPRCOVERSHIFT;
+      float fardist = FLT_MAX;
+
+      if(stop > video.width)
+         stop = video.width;
+
+      for(x = b << SPRCOVERSHIFT; x < stop && fardist > 0.0f; x++)
+      {
+         // an open column has a fardist of 0
+         if(spritecover[x].fardist < fardist)
+            fardist = spritecover[x].fardist;
+      }
+
+      spritecoverblock[b] = fardist;
+   }
+}
+
+//
+// R_spriteOccluded
+//
+// Returns true if every column from x1 to x2 was closed by a wall that
+// R_DrawSprite would clip the sprite against, by the same test it uses: the
+// wall is not wholly farther than the sprite's distance, dist, and if it
+// straddles that distance, the sprite's origin, gx, gy, is behind its line.
+// Such a sprite cannot show anywhere.
+//
+static bool R_spriteOccluded(const sprcover_t *cover, const float *coverblock, 
+                             int x1, int x2, float dist, fixed_t gx, fixed_t gy)
+{
+   const seg_t *behind = NULL; // last seg the sprite was found to be behind
+   int x = x1;
+
+   while(x <= x2)
+   {
+      int b = x >> SPRCOVERSHIFT;
+
+      // the whole block is closed by walls in front of the sprite
+      if(coverblock[b] >= dist)
+      {
+         x = (b + 1) << SPRCOVERSHIFT;
+         continue;
+      }
+
+      const sprcover_t &c = cover[x];
+
+      // open, or closed by a wall wholly behind the sprite
+      if(c.neardist < dist)
+         return false;
+
+      // the wall straddles the sprite; it only hides the sprite from behind
+      if(c.fardist < dist && c.seg != behind)
+      {
+         if(!R_PointOnSegSide(gx, gy, c.seg))
+            return false;
+         behind = c.seg;
+      }
+
+      ++x;
+   }
+
+   return true;
+}
+
 //
 // R_NewVisSprite
 //
@@ -603,6 +756,8 @@ void R_PushPost(bool pushmasked, planehash_t *overlay)
 //
 static vissprite_t *R_NewVisSprite()
 {
+   M_ProfileCount(PROF_VISSPRITES);
+
    if(num_vissprite >= num_vissprite_alloc)             // killough
    {
       num_vissprite_alloc = num_vissprite_alloc ? num_vissprite_alloc*2 : 128;
@@ -641,7 +796,7 @@ static void R_DrawMaskedColumn(column_t *tcolumn)
          column.source = (byte *)tcolumn + 3;
          column.texmid = basetexturemid - (tcolumn->topdelta << FRACBITS);
 
-         colfunc();
+         colfunc(column);
       }
 
       tcolumn = (column_t *)((byte *)tcolumn + tcolumn->length + 4);
@@ -677,7 +832,7 @@ void R_DrawNewMaskedColumn(texture_t *tex, texcol_t *tcol)
 
          // Drawn by either R_DrawColumn
          //  or (SHADOW) R_DrawFuzzColumn.
-         colfunc();
+         colfunc(column);
       }
 
       tcol = tcol->next;
@@ -996,6 +1151,16 @@ static void R_ProjectSprite(Mobj *thing, v3fixed_t *delta = nullptr)
          return;
    }
 
+   // Reject sprites that walls in front of them have already covered
+   if(r_occludesprites &&
+      R_spriteOccluded(spritecover, spritecoverblock, x1 < 0.0f ? 0 : intx1,
+                       x2 >= view.width ? viewwindow.width - 1 : intx2, idist,
+                       spritepos.x, spritepos.y))
+   {
+      M_ProfileCount(PROF_OCCLUDED);
+      return;
+   }
+
    // store information in a vissprite
    vis = R_NewVisSprite();
    
@@ -1017,6 +1182,7 @@ static void R_ProjectSprite(Mobj *thing, v3fixed_t *delta = nullptr)
 
    vis->dist = idist;
    vis->scale = distyscale * thing->yscale;
+   vis->occludable = true;
 
    vis->ytop = y1;
    vis->ybottom = y2;
@@ -1282,7 +1448,7 @@ static void R_DrawPSprite(pspdef_t *psp)
 //
 // R_DrawPlayerSprites
 //
-static void R_DrawPlayerSprites()
+void R_DrawPlayerSprites()
 {
    int i, lightnum;
    pspdef_t *psp;
@@ -1363,6 +1529,121 @@ static void msort(vissprite_t **s, vissprite_t **t, int n)
    }
 }
 
+//
+// R_msortTieOrder
+//
+// Copies n vissprites from s to d in the order msort leaves sprites that are
+// at the same distance. Its merge takes from the second half on a tie, and its
+// insertion sort keeps order, so equal sprites come out by the runs msort
+// splits them into, last run first, and in order within a run. Returns the
+// end of the copy.
+//
+static vissprite_t **R_msortTieOrder(vissprite_t **s, vissprite_t **d, int n)
+{
+   if(n >= 16)
+   {
+      int n1 = n/2;
+
+      d = R_msortTieOrder(s + n1, d, n - n1);
+      return R_msortTieOrder(s, d, n1);
+   }
+
+   bcopyp(d, s, n);
+   return d + n;
+}
+
+//
+// R_radixSortVisSprites
+//
+// Sorts n vissprites nearest first, as msort does, with an LSD radix sort on
+// their distances. The bits of a positive float order the same way as its
+// value, so the distances are used as keys without quantizing them. The sort
+// is stable, so sprites are first put in msort's order for ties, and those at
+// the same distance come out exactly as msort would leave them. t, keys, and
+// tkeys are scratch space for n entries each.
+//
+static void R_radixSortVisSprites(vissprite_t **s, vissprite_t **t, 
+                                  uint32_t *keys, uint32_t *tkeys, int n)
+{
+   unsigned int counts[4][256];
+   vissprite_t **dest = s;
+   int i, pass;
+
+   memset(counts, 0, sizeof(counts));
+
+   R_msortTieOrder(s, t, n);
+   s = t;
+   t = dest;
+
+   // inverting the keys puts the largest distance, the nearest sprite, first
+   for(i = 0; i < n; i++)
+   {
+      uint32_t key;
+
+      memcpy(&key, &s[i]->dist, sizeof(key));
+      keys[i] = key = ~key;
+
+      ++counts[0][key & 0xff];
+      ++counts[1][(key >> 8) & 0xff];
+      ++counts[2][(key >> 16) & 0xff];
+      ++counts[3][key >> 24];
+   }
+
+   for(pass = 0; pass < 4; pass++)
+   {
+      unsigned int *count = counts[pass];
+      unsigned int  total = 0;
+      int           shift = pass * 8;
+
+      // skip digits every key shares, such as most of the exponent
+      if(count[(keys[0] >> shift) & 0xff] == (unsigned int)n)
+         continue;
+
+      for(i = 0; i < 256; i++)
+      {
+         unsigned int c = count[i];
+         count[i] = total;
+         total += c;
+      }
+
+      for(i = 0; i < n; i++)
+      {
+         unsigned int d = count[(keys[i] >> shift) & 0xff]++;
+         t[d]     = s[i];
+         tkeys[d] = keys[i];
+      }
+
+      // the output becomes the next pass's input
+      vissprite_t **tmp     = s;
+      uint32_t     *tmpkeys = keys;
+      s     = t;
+      keys  = tkeys;
+      t     = tmp;
+      tkeys = tmpkeys;
+   }
+
+   if(s != dest)
+      bcopyp(dest, s, n);
+}
+
+//
+// R_sortVisSpritePtrs
+//
+// Picks the faster sort for the number of sprites. The merge sort does well
+// on short runs, which BSP order leaves nearly sorted already; the radix sort
+// wins once there are a few hundred sprites. r_spritesortbench measures where.
+//
+static void R_sortVisSpritePtrs(int n)
+{
+   if(r_spriteradix && n >= r_spriteradix)
+   {
+      R_radixSortVisSprites(vissprite_ptrs, vissprite_ptrs + n, 
+                            vissprite_keys, vissprite_keys + n, n);
+   }
+   else
+      msort(vissprite_ptrs, vissprite_ptrs + n, n);
+}
+
 #if 0
 //
 // R_SortVisSprites
@@ -1419,9 +1700,12 @@ static void R_SortVisSpriteRange(int first, int last)
       if(num_vissprite_ptrs < numsprites*2)
       {
          efree(vissprite_ptrs);  // better than realloc -- no preserving needed
+         efree(vissprite_keys);
          num_vissprite_ptrs = num_vissprite_alloc * 2;
          vissprite_ptrs = emalloc(vissprite_t **, 
                                   num_vissprite_ptrs * sizeof *vissprite_ptrs);
+         vissprite_keys = emalloc(uint32_t *, 
+                                  num_vissprite_ptrs * sizeof *vissprite_keys);
       }
 
       while(--i >= 0)
@@ -1430,7 +1714,7 @@ static void R_SortVisSpriteRange(int first, int last)
       // killough 9/22/98: replace qsort with merge sort, since the keys
       // are roughly in order to begin with, due to BSP rendering.
       
-      msort(vissprite_ptrs, vissprite_ptrs + numsprites, numsprites);
+      R_sortVisSpritePtrs(numsprites);
    }
 }
 
@@ -1448,6 +1732,15 @@ static void R_DrawSpriteInDSRange(vissprite_t *spr, int firstds, int lastds)
    float      dist;
    float      fardist;
 
+   // walls that closed the range after the sprite was projected may hide it
+   if(spr->occludable && r_occludesprites &&
+      R_spriteOccluded(pcover, pcoverblock, spr->x1, spr->x2, spr->dist, 
+                       spr->gx, spr->gy))
+   {
+      M_ProfileCount(PROF_OCCLUDED);
+      return;
+   }
+
    for(x = spr->x1; x <= spr->x2; x++)
       clipbot[x] = cliptop[x] = -2;
 
@@ -1744,8 +2037,10 @@ void R_DrawPostBSP()
                drawsegs_xrange[drawsegs_xrange_count].user = NULL;
             }
 
-            ptop    = masked->ceilingclip;
-            pbottom = masked->floorclip;
+            ptop        = masked->ceilingclip;
+            pbottom     = masked->floorclip;
+            pcover      = masked->spritecover;
+            pcoverblock = masked->spritecoverblock;
 
             for(int i = lastsprite - firstsprite; --i >= 0; )
                R_DrawSpriteInDSRange(vissprite_ptrs[i], firstds, lastds);         // killough
@@ -2140,6 +2435,7 @@ static void R_ProjectParticle(particle_t *particle)
    vis->x2 = x2 >= viewwindow.width ? viewwindow.width-1 : x2;
    vis->colour = particle->color;
    vis->patch = -1;
+   vis->occludable = false;
    vis->translucency = static_cast<uint16_t>(particle->trans - 1);
    // Cardboard
    vis->dist = idist;
@@ -2192,6 +2488,42 @@ static void R_ProjectParticle(particle_t *particle)
 
 //
 // R_DrawParticle
+//
+// R_drawParticle32
+//
+// Fills a particle's rectangle on a truecolor screen.
+//
+static void R_drawParticle32(int x1, int x2, int yl, int yh, byte color,
+                             int translucency)
+{
+   uint32_t fg = Col2RGB32[color];
+   int pitch   = linesize / 4;
+
+   if(yh < yl)
+      return;
+
+   uint32_t *dest = R_ADDRESS32(x1, yl);
+
+   if(general_translucency && particle_trans)
+   {
+      unsigned int alpha = ((unsigned int)translucency + 1) >> 8;
+
+      for(int y = yl; y <= yh; y++, dest += pitch)
+      {
+         for(int x = 0; x <= x2 - x1; x++)
+            dest[x] = V_BlendRGB32(fg, dest[x], alpha);
+      }
+   }
+   else
+   {
+      for(int y = yl; y <= yh; y++, dest += pitch)
+      {
+         for(int x = 0; x <= x2 - x1; x++)
+            dest[x] = fg;
+      }
+   }
+}
+
 //
 // haleyjd: this function had to be mostly rewritten
 //
@@ -2227,6 +2559,12 @@ static void R_DrawParticle(vissprite_t *vis)
 
    color = vis->colormap[vis->colour];
 
+   if(video.pixelsize == 4)
+   {
+      R_drawParticle32(x1, x2, yl, yh, color, vis->translucency);
+      return;
+   }
+
    {
       int xcount, ycount, spacing;
       byte *dest;
@@ -2286,6 +2624,83 @@ static void R_DrawParticle(vissprite_t *vis)
    } // end local block
 }
 
+//=============================================================================
+//
+// Console Commands
+//
+
+VARIABLE_INT(r_spriteradix, NULL, 0, 65536, NULL);
+CONSOLE_VARIABLE(r_spriteradix, r_spriteradix, 0) {}
+
+//
+// r_spritesortbench
+//
+// Times both vissprite sorts on ranges of increasing size, and sets
+// r_spriteradix to the smallest size from which the radix sort stays ahead.
+// The distances imitate BSP order: near to far, with some noise.
+//
+CONSOLE_COMMAND(r_spritesortbench, 0)
+{
+   const int     maxsprites = 16384;
+   vissprite_t  *sprites    = ecalloc(vissprite_t *, maxsprites, sizeof(vissprite_t));
+   vissprite_t **input      = emalloc(vissprite_t **, maxsprites * sizeof(vissprite_t *));
+   vissprite_t **ptrs       = emalloc(vissprite_t **, 2 * maxsprites * sizeof(vissprite_t *));
+   uint32_t     *keys       = emalloc(uint32_t *, 2 * maxsprites * sizeof(uint32_t));
+   unsigned int  seed       = 1;
+   int           crossover  = 0;
+
+   for(int i = 0; i < maxsprites; i++)
+   {
+      seed = seed * 1103515245 + 12345;
+      sprites[i].dist = 1.0f / (64.0f + i * 4.0f + (seed >> 16) % 512);
+      input[i] = &sprites[i];
+   }
+
+   C_Printf("sprites   merge us   radix us\n");
+
+   for(int n = 16; n <= maxsprites; n *= 2)
+   {
+      int      reps = 1000000 / n + 1;
+      uint64_t start, mergetime, radixtime;
+
+      start = i_haltimer.GetMicroseconds();
+      for(int r = 0; r < reps; r++)
+      {
+         bcopyp(ptrs, input, n);
+         msort(ptrs, ptrs + n, n);
+      }
+      mergetime = i_haltimer.GetMicroseconds() - start;
+
+      start = i_haltimer.GetMicroseconds();
+      for(int r = 0; r < reps; r++)
+      {
+         bcopyp(ptrs, input, n);
+         R_radixSortVisSprites(ptrs, ptrs + n, keys, keys + n, n);
+      }
+      radixtime = i_haltimer.GetMicroseconds() - start;
+
+      C_Printf("%7d %10.2f %10.2f\n", n, double(mergetime) / reps, 
+               double(radixtime) / reps);
+
+      if(radixtime >= mergetime)
+         crossover = 0;
+      else if(!crossover)
+         crossover = n;
+   }
+
+   efree(keys);
+   efree(ptrs);
+   efree(input);
+   efree(sprites);
+
+   r_spriteradix = crossover;
+
+   if(crossover)
+      C_Printf("r_spriteradix set to %d\n", crossover);
+   else
+      C_Printf("The merge sort was faster at every size; r_spriteradix set to 0\n");
+}
+
 //----------------------------------------------------------------------------
 //
 // $Log: r_things.c,v $
@@ -29,6 +29,7 @@
 struct sector_t;
 struct particle_t;
 struct planehash_t;
+struct seg_t;
 
 // Constant arrays used for psprite clipping and initializing clipping.
 
@@ -39,6 +40,21 @@ extern float *screenheightarray;
 
 extern float *mfloorclip, *mceilingclip;
 
+//
+// sprcover_t
+//
+// The solid wall that closed a column during a BSP walk, for sprite occlusion.
+// neardist and fardist are the distances (1/z) at the ends of the wall's
+// closed drawseg, which R_DrawSprite compares against the sprite; neardist is
+// 0 while the column is open.
+//
+struct sprcover_t
+{
+   seg_t *seg;
+   float  neardist;
+   float  fardist;
+};
+
 // SoM 12/13/03: the stack for use with portals
 struct maskedrange_t
 {
@@ -48,6 +64,10 @@ struct maskedrange_t
    // SoM: Cardboard
    float *floorclip;
    float *ceilingclip;
+
+   // sprite occlusion, copied from the BSP walk that filled the range
+   sprcover_t *spritecover;
+   float      *spritecoverblock;
    
    // for unused head
    struct maskedrange_t *next;
@@ -61,6 +81,14 @@ struct poststack_t
 
 void R_PushPost(bool pushmasked, planehash_t *overlay);
 
+extern int r_spriteradix; // sort ranges of this many vissprites by radix
+
+// Sprite occlusion
+extern bool r_occludesprites;
+
+void R_ClearSpriteCover();
+void R_MarkSpriteCover(seg_t *seg, int x1, int x2, float dist, float diststep);
+
 // SoM: Cardboard
 void R_SetMaskedSilhouette(float *top, float *bottom);
 
@@ -74,6 +102,7 @@ void R_DrawSprites(void);
 void R_InitSprites(char **namelist);
 void R_ClearSprites(void);
 void R_DrawPostBSP(void);
+void R_DrawPlayerSprites();
 void R_ClearParticles(void);
 void R_InitParticles(void);
 particle_t *newParticle(void);
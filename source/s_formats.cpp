@@ -30,7 +30,9 @@
 
 #include "doomtype.h"
 #include "d_gi.h"
+#include "hal/i_thread.h"
 #include "m_binary.h"
+#include "m_collection.h"
 #include "m_compare.h"
 #include "m_swap.h"
 #include "s_sound.h"
@@ -314,15 +316,23 @@ static unsigned int S_alenForSample(const sounddata_t &sd)
 }
 
 //
-// S_convertPCMU8
+// S_allocSample
 //
-// Convert unsigned 8-bit PCM to double precision floating point.
+// Allocate the converted sample buffer for a digital sound effect.
 //
-static void S_convertPCMU8(sfxinfo_t *sfx, const sounddata_t &sd)
+static void S_allocSample(sfxinfo_t *sfx, const sounddata_t &sd)
 {
    sfx->alen = S_alenForSample(sd);
    sfx->data = Z_Malloc(sfx->alen*sizeof(float), PU_STATIC, &sfx->data);
+}
 
+//
+// S_convertPCMU8
+//
+// Convert unsigned 8-bit PCM to double precision floating point.
+//
+static void S_convertPCMU8(sfxinfo_t *sfx, const sounddata_t &sd)
+{
    // haleyjd 12/18/13: Convert sound to target samplerate and into floating
    // point samples.
    if(sfx->alen != sd.samplecount)
@@ -369,9 +379,6 @@ static void S_convertPCMU8(sfxinfo_t *sfx, const sounddata_t &sd)
 //
 static void S_convertPCM16(sfxinfo_t *sfx, const sounddata_t &sd)
 {
-   sfx->alen = S_alenForSample(sd);
-   sfx->data = Z_Malloc(sfx->alen*sizeof(float), PU_STATIC, &sfx->data);
-
    // haleyjd 12/18/13: Convert sound to target samplerate and into floating
    // point samples.
    if(sfx->alen != sd.samplecount)
@@ -478,10 +485,12 @@ bool S_LoadDigitalSoundEffect(sfxinfo_t *sfx)
          switch(sd.fmt)
          {
          case S_FMT_U8:
+            S_allocSample(sfx, sd);
             S_convertPCMU8(sfx, sd);
             res = true;
             break;
          case S_FMT_16:
+            S_allocSample(sfx, sd);
             S_convertPCM16(sfx, sd);
             res = true;
             break;
@@ -518,5 +527,81 @@ void S_CacheDigitalSoundLump(sfxinfo_t *sfx)
    wGlobalDir.cacheLumpNum(lump, PU_CACHE);
 }
 
+// A sound effect waiting to be converted by S_PrecacheDigitalSounds
+struct sfxconvert_t
+{
+   sfxinfo_t  *sfx;
+   sounddata_t sd;
+   void       *lumpdata;
+};
+
+static PODCollection<sfxconvert_t> sfxconverts;
+
+//
+// S_convertSoundJob
+//
+// Worker job: converts one sound into the buffer allocated for it.
+//
+static void S_convertSoundJob(int jobnum, void *data)
+{
+   const sfxconvert_t &sc = sfxconverts.begin()[jobnum];
+
+   if(sc.sd.fmt == S_FMT_U8)
+      S_convertPCMU8(sc.sfx, sc.sd);
+   else
+      S_convertPCM16(sc.sfx, sc.sd);
+}
+
+//
+// S_PrecacheDigitalSounds
+//
+// Loads a set of sound effects ahead of time, as S_LoadDigitalSoundEffect
+// would when they are first played. The lumps are read and the sample
+// buffers allocated here; the conversions are run by the worker pool.
+//
+void S_PrecacheDigitalSounds(sfxinfo_t *const *sounds, int numsounds)
+{
+   sfxconverts.resize(0);
+
+   for(int i = 0; i < numsounds; i++)
+   {
+      sfxinfo_t *sfx = sounds[i];
+      int lump;
+
+      // already loaded (or listed twice)
+      if(sfx->data)
+         continue;
+
+      // replace missing sounds with a reasonable default
+      if((lump = S_getSfxLumpNum(sfx)) == -1)
+         lump = wGlobalDir.getNumForNameNSG(GameModeInfo->defSoundName, lumpinfo_t::ns_sounds);
+
+      size_t lumplen = (size_t)wGlobalDir.lumpLength(lump);
+      if(!lumplen)
+         continue;
+
+      edefstructvar(sounddata_t, sd);
+      byte *lumpdata = (byte *)wGlobalDir.cacheLumpNum(lump, PU_STATIC);
+
+      if(S_detectSoundFormat(sd, lumpdata, lumplen) &&
+         (sd.fmt == S_FMT_U8 || sd.fmt == S_FMT_16))
+      {
+         sfxconvert_t &sc = sfxconverts.addNew();
+         sc.sfx      = sfx;
+         sc.sd       = sd;
+         sc.lumpdata = lumpdata;
+         S_allocSample(sfx, sd);
+      }
+      else
+         Z_ChangeTag(lumpdata, PU_CACHE);
+   }
+
+   I_RunJobs(int(sfxconverts.getLength()), S_convertSoundJob, NULL);
+
+   // as in S_LoadDigitalSoundEffect, the lump data is no longer needed
+   for(size_t i = 0; i < sfxconverts.getLength(); i++)
+      Z_ChangeTag(sfxconverts[i].lumpdata, PU_CACHE);
+}
+
 // EOF
 
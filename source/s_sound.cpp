@@ -39,6 +39,7 @@
 #include "e_sound.h"
 #include "i_sound.h"
 #include "i_system.h"
+#include "m_collection.h"
 #include "m_compare.h"
 #include "m_random.h"
 #include "m_queue.h"
@@ -1314,6 +1315,77 @@ int S_MusicForMapHtic()
    return H_Mus_Matrix[gep - 1][gmp - 1];
 }
 
+//
+// S_addPrecacheSound
+//
+// Adds a sound to a precache list, following aliases, random sounds, and
+// links through to the sounds that actually get played.
+//
+static void S_addPrecacheSound(PODCollection<sfxinfo_t *> &sounds, sfxinfo_t *sfx,
+                               int depth = 0)
+{
+   // guard against redirection loops
+   if(!sfx || depth > 16)
+      return;
+
+   if(sfx->alias)
+      S_addPrecacheSound(sounds, sfx->alias, depth + 1);
+   else if(sfx->randomsounds)
+   {
+      for(int i = 0; i < sfx->numrandomsounds; i++)
+         S_addPrecacheSound(sounds, sfx->randomsounds[i], depth + 1);
+   }
+   else
+   {
+      while(sfx->link)
+         sfx = sfx->link;
+      sounds.add(sfx);
+   }
+}
+
+//
+// S_PrecacheLevel
+//
+// Has the sound driver load the sounds of every kind of thing on the level
+// before the first tic, rather than each one the first time it is heard.
+//
+void S_PrecacheLevel()
+{
+   PODCollection<sfxinfo_t *> sounds;
+   byte *hitlist;
+
+   // as with graphics, leave demo timing alone
+   if(!s_precache || demoplayback || !snd_card || nosfxparm)
+      return;
+
+   hitlist = ecalloc(byte *, NUMMOBJTYPES, 1);
+
+   for(Thinker *th = thinkercap.next; th != &thinkercap; th = th->next)
+   {
+      Mobj *mo;
+      mobjinfo_t *info;
+
+      if(!(mo = thinker_cast<Mobj *>(th)) || hitlist[mo->type])
+         continue;
+
+      hitlist[mo->type] = 1;
+      info = mo->info;
+
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->seesound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->attacksound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->painsound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->deathsound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->activesound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->activatesound));
+      S_addPrecacheSound(sounds, E_SoundForDEHNum(info->deactivatesound));
+   }
+
+   efree(hitlist);
+
+   if(!sounds.isEmpty())
+      I_PrecacheSounds(sounds.begin(), int(sounds.getLength()));
+}
+
 //
 // S_Start
 //
@@ -63,6 +63,9 @@ void S_Init(int sfxVolume, int musicVolume);
 //
 void S_Start();
 
+// Per level sound precaching, after things have been spawned.
+void S_PrecacheLevel();
+
 // haleyjd 05/30/06: sound attenuation types
 enum
 {
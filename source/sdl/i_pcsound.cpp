@@ -466,6 +466,7 @@ i_sounddriver_t i_pcsound_driver =
 {
    I_PCSInitSound,         // InitSound
    I_PCSCacheSound,        // CacheSound
+   NULL,                   // PrecacheSounds
    I_PCSUpdateSound,       // UpdateSound
    I_PCSSubmitSound,       // SubmitSound
    I_PCSShutdownSound,     // ShutdownSound
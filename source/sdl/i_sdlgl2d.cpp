@@ -34,6 +34,7 @@
 #include "../z_zone.h"
 #include "../d_main.h"
 #include "../i_system.h"
+#include "../m_compare.h"
 #include "../v_misc.h"
 #include "../v_video.h"
 #include "../version.h"
@@ -47,6 +48,7 @@
 #include "../gl/gl_projection.h"
 #include "../gl/gl_texture.h"
 #include "../gl/gl_vars.h"
+#include "../gl/gl_world.h"
 
 //=============================================================================
 //
@@ -83,6 +85,7 @@ static GLfloat texcoord_tmax;
 
 // GL texture names
 static GLuint textureid;
+static GLuint paltextureid; // 256x1 palette for the shader, on texture unit 1
 
 // Framebuffer texture data
 static Uint32 *framebuffer;
@@ -90,9 +93,32 @@ static Uint32 *framebuffer;
 // Bump amount used to avoid cache misses on power-of-two-sized screens
 static int bump;
 
+// Number of pixel buffer objects the frames rotate through
+#define NUMPBOS 3
+
 // Options
-static bool   use_arb_pbo; // If true, use ARB pixel buffer object extension
-static GLuint pboIDs[2];   // IDs of pixel buffer objects
+static bool   use_arb_pbo;     // If true, use ARB pixel buffer object extension
+static bool   use_palshader;   // If true, the palette is applied by a shader
+static GLuint pboIDs[NUMPBOS]; // IDs of pixel buffer objects
+static int    pboindex;        // PBO the last frame went into
+
+// Only the rows of the screen that changed are uploaded to the texture
+#define MAXDIRTYRECTS 32
+
+static vdirtyrect_t dirtyrects[MAXDIRTYRECTS];
+static bool    fullupload; // the texture's colors are stale everywhere
+
+// Fragment shader that looks the 8-bit screen up in the palette
+static GLuint palprogram;
+
+static const GLchar *palShaderSource =
+   "uniform sampler2D screen;\n"
+   "uniform sampler2D palette;\n"
+   "void main()\n"
+   "{\n"
+   "   float index = texture2D(screen, gl_TexCoord[0].st).r;\n"
+   "   gl_FragColor = texture2D(palette, vec2(index * (255.0 / 256.0) + (0.5 / 256.0), 0.5));\n"
+   "}\n";
 
 // PBO extension function pointers
 static PFNGLGENBUFFERSARBPROC    pglGenBuffersARB    = NULL;
@@ -102,6 +128,22 @@ static PFNGLBUFFERDATAARBPROC    pglBufferDataARB    = NULL;
 static PFNGLMAPBUFFERARBPROC     pglMapBufferARB     = NULL;
 static PFNGLUNMAPBUFFERARBPROC   pglUnmapBufferARB   = NULL;
 
+// Shader function pointers (OpenGL 2.0)
+static PFNGLACTIVETEXTUREPROC      pglActiveTexture      = NULL;
+static PFNGLCREATESHADERPROC       pglCreateShader       = NULL;
+static PFNGLSHADERSOURCEPROC       pglShaderSource       = NULL;
+static PFNGLCOMPILESHADERPROC      pglCompileShader      = NULL;
+static PFNGLGETSHADERIVPROC        pglGetShaderiv        = NULL;
+static PFNGLDELETESHADERPROC       pglDeleteShader       = NULL;
+static PFNGLCREATEPROGRAMPROC      pglCreateProgram      = NULL;
+static PFNGLATTACHSHADERPROC       pglAttachShader       = NULL;
+static PFNGLLINKPROGRAMPROC        pglLinkProgram        = NULL;
+static PFNGLGETPROGRAMIVPROC       pglGetProgramiv       = NULL;
+static PFNGLDELETEPROGRAMPROC      pglDeleteProgram      = NULL;
+static PFNGLUSEPROGRAMPROC         pglUseProgram         = NULL;
+static PFNGLGETUNIFORMLOCATIONPROC pglGetUniformLocation = NULL;
+static PFNGLUNIFORM1IPROC          pglUniform1i          = NULL;
+
 // Data for vertex binding
 static GLfloat screenVertices[4*2];
 static GLfloat screenTexCoords[4*2];
@@ -152,16 +194,18 @@ static void GL2D_setupVertexArray(GLfloat x, GLfloat y, GLfloat w, GLfloat h,
 //
 // SDLGL2DVideoDriver::DrawPixels
 //
-// Protected method.
+// Protected method. Converts rows y1 to y2 - 1 of the screen, putting the
+// first of them at the start of buffer.
 //
-void SDLGL2DVideoDriver::DrawPixels(void *buffer, unsigned int destwidth)
+void SDLGL2DVideoDriver::DrawPixels(void *buffer, unsigned int destwidth, 
+                                    int y1, int y2)
 {
    Uint32 *fb = (Uint32 *)buffer;
 
-   for(int y = 0; y < screen->h; y++)
+   for(int y = y1; y < y2; y++)
    {
       byte   *src  = (byte *)screen->pixels + y * screen->pitch;
-      Uint32 *dest = fb + y * destwidth;
+      Uint32 *dest = fb + (y - y1) * destwidth;
 
       for(int x = 0; x < screen->w - bump; x++)
       {
@@ -186,52 +230,99 @@ void SDLGL2DVideoDriver::FinishUpdate()
    if(!(SDL_GetAppState() & SDL_APPACTIVE))
       return;
 
-   if(!use_arb_pbo)
-   {
-      // Convert the game's 8-bit output to the 32-bit texture buffer
-      DrawPixels(framebuffer, (unsigned int)video.width);
+   // bind the framebuffer texture if necessary
+   GL_BindTextureIfNeeded(textureid);
 
-      // bind the framebuffer texture if necessary
-      GL_BindTextureIfNeeded(textureid);
+   // Find the band of rows that changed since the last frame. Without the
+   // shader, a new palette changes the colors of every row.
+   int y1 = 0, y2 = video.height;
 
-      // update the texture data
-      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-                      (GLsizei)video.width, (GLsizei)video.height, 
-                      GL_BGRA, GL_UNSIGNED_BYTE, (GLvoid *)framebuffer);
-   }
-   else
+   if(vbscreen.data == (byte *)screen->pixels)
    {
-      static int pboindex  = 0;
-      int        nextindex = 0;
-      GLvoid    *ptr       = NULL;
-
-      // use the two pixel buffers in a rotation
-      pboindex  = (pboindex + 1) % 2;
-      nextindex = (pboindex + 1) % 2;
+      int numrects = V_CollectDirtyRects(&vbscreen, dirtyrects, MAXDIRTYRECTS);
 
-      // bind the framebuffer texture if necessary
-      GL_BindTextureIfNeeded(textureid);
+      if(!fullupload)
+      {
+         y1 = video.height;
+         y2 = 0;
+         for(int i = 0; i < numrects; i++)
+         {
+            y1 = emin(y1, dirtyrects[i].y);
+            y2 = emax(y2, dirtyrects[i].y + dirtyrects[i].h);
+         }
+      }
+   }
+   fullupload = false;
 
-      // bind the primary PBO
-      pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[pboindex]);
+   const int rows = y2 - y1;
 
-      // copy primary PBO to texture, using offset
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)framebuffer_umax,
-                   (GLsizei)framebuffer_vmax, 0, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+   if(rows <= 0)
+   {
+      // nothing changed; the texture still holds the last frame
+   }
+   else if(!use_arb_pbo)
+   {
+      if(use_palshader)
+      {
+         // The shader applies the palette, so the 8-bit screen goes up as is
+         glPixelStorei(GL_UNPACK_ROW_LENGTH, screen->pitch);
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y1,
+                         (GLsizei)video.width, (GLsizei)rows,
+                         GL_LUMINANCE, GL_UNSIGNED_BYTE, 
+                         (byte *)screen->pixels + y1 * screen->pitch);
+         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+      }
+      else
+      {
+         Uint32 *fbrows = framebuffer + y1 * video.width;
 
-      // bind the secondary PBO
-      pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[nextindex]);
+         // Convert the game's 8-bit output to the 32-bit texture buffer
+         DrawPixels(fbrows, (unsigned int)video.width, y1, y2);
 
-      // map the PBO into client memory in such a way as to avoid stalls
-      pglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, texturesize, 0, GL_STREAM_DRAW_ARB);
+         // update the texture data
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y1, 
+                         (GLsizei)video.width, (GLsizei)rows, 
+                         GL_BGRA, GL_UNSIGNED_BYTE, (GLvoid *)fbrows);
+      }
+   }
+   else
+   {
+      GLvoid *ptr  = NULL;
+      int     size = use_palshader ? screen->pitch * rows : video.width * rows * 4;
+
+      // Fill the next pixel buffer in the ring. Its old storage is orphaned
+      // first, so mapping it never waits on the GPU, and the upload from it
+      // is queued and returns at once; the CPU goes on to the next frame
+      // while earlier ones are still on their way to the texture.
+      pboindex = (pboindex + 1) % NUMPBOS;
+      pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[pboindex]);
+      pglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, 0, GL_STREAM_DRAW_ARB);
 
       if((ptr = pglMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB)))
       {
-         // draw directly into video memory
-         DrawPixels(ptr, framebuffer_umax);
+         if(use_palshader)
+            memcpy(ptr, (byte *)screen->pixels + y1 * screen->pitch, size);
+         else
+            DrawPixels(ptr, (unsigned int)video.width, y1, y2);
 
          // release pointer
          pglUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+
+         // copy the PBO to the texture, using offset
+         if(use_palshader)
+         {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, screen->pitch);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y1,
+                            (GLsizei)video.width, (GLsizei)rows,
+                            GL_LUMINANCE, GL_UNSIGNED_BYTE, 0);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+         }
+         else
+         {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y1,
+                            (GLsizei)video.width, (GLsizei)rows,
+                            GL_BGRA, GL_UNSIGNED_BYTE, 0);
+         }
       }
 
       // Unbind all PBOs
@@ -239,7 +330,11 @@ void SDLGL2DVideoDriver::FinishUpdate()
    }
 
    // draw vertex array
+   if(use_palshader)
+      pglUseProgram(palprogram);
    glDrawElements(GL_TRIANGLES, 3*2, GL_UNSIGNED_BYTE, screenVtxOrder);
+   if(use_palshader)
+      pglUseProgram(0);
 
    // push the frame
    SDL_GL_SwapBuffers();
@@ -293,6 +388,18 @@ void SDLGL2DVideoDriver::SetPalette(byte *pal)
       
       temppal += 3;
    }
+
+   // With the palette shader, the palette itself is all that has to change;
+   // otherwise every pixel in the texture has to be converted again
+   if(!use_palshader)
+      fullupload = true;
+   else if(paltextureid)
+   {
+      pglActiveTexture(GL_TEXTURE1);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1, GL_BGRA, GL_UNSIGNED_BYTE,
+                      (GLvoid *)RGB8to32);
+      pglActiveTexture(GL_TEXTURE0);
+   }
 }
 
 //
@@ -352,6 +459,9 @@ void SDLGL2DVideoDriver::ShutdownGraphicsPartway()
 
    // Code to allow changing resolutions in OpenGL.
    // Must shutdown everything.
+
+   // Release the world renderer's objects while the context is still around
+   GL_ShutdownWorld();
    
    // Delete textures and clear names 
    if(textureid)
@@ -360,10 +470,23 @@ void SDLGL2DVideoDriver::ShutdownGraphicsPartway()
       textureid = 0;
    }
 
+   if(paltextureid)
+   {
+      glDeleteTextures(1, &paltextureid);
+      paltextureid = 0;
+   }
+
+   // Destroy the palette shader
+   if(palprogram)
+   {
+      pglDeleteProgram(palprogram);
+      palprogram = 0;
+   }
+
    // Destroy any PBOs
    if(pboIDs[0])
    {
-      pglDeleteBuffersARB(2, pboIDs);
+      pglDeleteBuffersARB(NUMPBOS, pboIDs);
       memset(pboIDs, 0, sizeof(pboIDs));
    }
 
@@ -431,6 +554,118 @@ void SDLGL2DVideoDriver::LoadPBOExtension()
    firsttime = false;
 }
 
+//
+// SDLGL2DVideoDriver::LoadPaletteShader
+//
+// Build the fragment shader that applies the palette to the 8-bit screen if
+// so specified and supported. This needs OpenGL 2.0.
+//
+void SDLGL2DVideoDriver::LoadPaletteShader()
+{
+   static bool firsttime = true;
+   bool extension_ok = true;
+   const char *version = (const char *)glGetString(GL_VERSION);
+   bool want_palshader = cfg_gl_palette_shader;
+   bool have_palshader = (version && atoi(version) >= 2);
+
+   use_palshader = false;
+
+   if(want_palshader && have_palshader)
+   {
+      GETPROC(pglActiveTexture,      "glActiveTexture",      PFNGLACTIVETEXTUREPROC);
+      GETPROC(pglCreateShader,       "glCreateShader",       PFNGLCREATESHADERPROC);
+      GETPROC(pglShaderSource,       "glShaderSource",       PFNGLSHADERSOURCEPROC);
+      GETPROC(pglCompileShader,      "glCompileShader",      PFNGLCOMPILESHADERPROC);
+      GETPROC(pglGetShaderiv,        "glGetShaderiv",        PFNGLGETSHADERIVPROC);
+      GETPROC(pglDeleteShader,       "glDeleteShader",       PFNGLDELETESHADERPROC);
+      GETPROC(pglCreateProgram,      "glCreateProgram",      PFNGLCREATEPROGRAMPROC);
+      GETPROC(pglAttachShader,       "glAttachShader",       PFNGLATTACHSHADERPROC);
+      GETPROC(pglLinkProgram,        "glLinkProgram",        PFNGLLINKPROGRAMPROC);
+      GETPROC(pglGetProgramiv,       "glGetProgramiv",       PFNGLGETPROGRAMIVPROC);
+      GETPROC(pglDeleteProgram,      "glDeleteProgram",      PFNGLDELETEPROGRAMPROC);
+      GETPROC(pglUseProgram,         "glUseProgram",         PFNGLUSEPROGRAMPROC);
+      GETPROC(pglGetUniformLocation, "glGetUniformLocation", PFNGLGETUNIFORMLOCATIONPROC);
+      GETPROC(pglUniform1i,          "glUniform1i",          PFNGLUNIFORM1IPROC);
+
+      if(extension_ok)
+      {
+         GLuint shader = pglCreateShader(GL_FRAGMENT_SHADER);
+         GLint  status = 0;
+
+         pglShaderSource(shader, 1, &palShaderSource, NULL);
+         pglCompileShader(shader);
+         pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+         if(status)
+         {
+            palprogram = pglCreateProgram();
+            pglAttachShader(palprogram, shader);
+            pglLinkProgram(palprogram);
+            pglGetProgramiv(palprogram, GL_LINK_STATUS, &status);
+
+            if(!status)
+            {
+               pglDeleteProgram(palprogram);
+               palprogram = 0;
+            }
+         }
+
+         // the program keeps the shader alive for as long as it needs it
+         pglDeleteShader(shader);
+
+         if(palprogram)
+         {
+            // the screen is on texture unit 0 and the palette on unit 1
+            pglUseProgram(palprogram);
+            pglUniform1i(pglGetUniformLocation(palprogram, "screen"),  0);
+            pglUniform1i(pglGetUniformLocation(palprogram, "palette"), 1);
+            pglUseProgram(0);
+
+            use_palshader = true;
+         }
+      }
+
+      if(firsttime && use_palshader)
+         usermsg(" Loaded palette shader");
+   }
+
+   // If wanted, but not enabled, warn
+   if(firsttime && want_palshader && !use_palshader)
+      usermsg(" Could not enable palette shader");
+
+   // Don't print messages in this routine more than once
+   firsttime = false;
+}
+
+//
+// SDLGL2DVideoDriver::LoadWorldRenderer
+//
+// Set up drawing the world through GL if so specified and supported. The
+// renderer draws into a framebuffer object of its own, so the window needs
+// no depth buffer.
+//
+void SDLGL2DVideoDriver::LoadWorldRenderer()
+{
+   static bool firsttime = true;
+   bool want_world = cfg_gl_world_renderer;
+   bool use_world  = false;
+
+   if(want_world)
+   {
+      use_world = GL_InitWorld(SDL_GL_GetProcAddress);
+
+      if(firsttime && use_world)
+         usermsg(" Loaded world renderer");
+   }
+
+   // If wanted, but not enabled, warn
+   if(firsttime && want_world && !use_world)
+      usermsg(" Could not enable world renderer");
+
+   // Don't print messages in this routine more than once
+   firsttime = false;
+}
+
 // Config-to-GL enumeration lookups
 
 // Configurable internal texture formats
@@ -536,6 +771,21 @@ bool SDLGL2DVideoDriver::InitGraphicsMode()
    // Try loading the ARB PBO extension
    LoadPBOExtension();
 
+   // Try building the palette shader
+   LoadPaletteShader();
+
+   // The screen texture then holds palette indices, which must not be
+   // blended together; its rows are packed one byte per pixel.
+   if(use_palshader)
+   {
+      texformat     = GL_LUMINANCE8;
+      texfiltertype = GL_NEAREST;
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   }
+
+   // Try setting up the world renderer
+   LoadWorldRenderer();
+
    // Enable two-dimensional texture mapping
    glEnable(GL_TEXTURE_2D);
 
@@ -576,16 +826,38 @@ bool SDLGL2DVideoDriver::InitGraphicsMode()
                 tempbuffer);
    efree(tempbuffer);
 
+   // Create the palette texture on unit 1, where it stays bound
+   if(use_palshader)
+   {
+      pglActiveTexture(GL_TEXTURE1);
+      glGenTextures(1, &paltextureid);
+      glBindTexture(GL_TEXTURE_2D, paltextureid);
+
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+      glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, 1, 0, GL_BGRA, GL_UNSIGNED_BYTE,
+                   (GLvoid *)RGB8to32);
+      pglActiveTexture(GL_TEXTURE0);
+   }
+
    // Allocate framebuffer data, or PBOs
    if(!use_arb_pbo)
-      framebuffer = ecalloc(Uint32 *, v_w * 4, v_h);
+   {
+      // only needed when the palette is applied on the CPU
+      if(!use_palshader)
+         framebuffer = ecalloc(Uint32 *, v_w * 4, v_h);
+   }
    else
    {
-      pglGenBuffersARB(2, pboIDs);
-      pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[0]);
-      pglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, texturesize, 0, GL_STREAM_DRAW_ARB);
-      pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[1]);
-      pglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, texturesize, 0, GL_STREAM_DRAW_ARB);
+      pglGenBuffersARB(NUMPBOS, pboIDs);
+      for(int i = 0; i < NUMPBOS; i++)
+      {
+         pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboIDs[i]);
+         pglBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, texturesize, 0, GL_STREAM_DRAW_ARB);
+      }
       pglBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
    }
 
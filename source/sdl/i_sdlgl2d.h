@@ -41,8 +41,10 @@ class SDLGL2DVideoDriver : public HALVideoDriver
 protected:
    int colordepth;
 
-   void DrawPixels(void *buffer, unsigned int width);
+   void DrawPixels(void *buffer, unsigned int width, int y1, int y2);
    void LoadPBOExtension();
+   void LoadPaletteShader();
+   void LoadWorldRenderer();
 
    virtual void SetPrimaryBuffer();
    virtual void UnsetPrimaryBuffer();
@@ -746,6 +746,16 @@ static void I_SDLCacheSound(sfxinfo_t *sound)
    S_CacheDigitalSoundLump(sound);
 }
 
+//
+// I_SDLPrecacheSounds
+//
+// Converts the sounds to floating point PCM now, on the worker pool.
+//
+static void I_SDLPrecacheSounds(sfxinfo_t *const *sounds, int numsounds)
+{
+   S_PrecacheDigitalSounds(sounds, numsounds);
+}
+
 static void I_SDLDummyCallback(void *, Uint8 *, int) {} 
 
 //
@@ -825,6 +835,7 @@ i_sounddriver_t i_sdlsound_driver =
 {
    I_SDLInitSound,         // InitSound
    I_SDLCacheSound,        // CacheSound
+   I_SDLPrecacheSounds,    // PrecacheSounds
    I_SDLUpdateSound,       // UpdateSound
    I_SDLSubmitSound,       // SubmitSound
    I_SDLShutdownSound,     // ShutdownSound
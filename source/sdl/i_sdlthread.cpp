@@ -0,0 +1,175 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    SDL Thread Implementation
+//
+//-----------------------------------------------------------------------------
+
+#include "../hal/i_platform.h"
+
+#if EE_CURRENT_PLATFORM == EE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+#include "../z_zone.h"
+
+// Need thread HAL
+#include "../hal/i_thread.h"
+
+//
+// I_SDLStartThread
+//
+static halthread_t *I_SDLStartThread(HAL_ThreadFunc func, void *data)
+{
+   return reinterpret_cast<halthread_t *>(SDL_CreateThread(func, data));
+}
+
+//
+// I_SDLWaitThread
+//
+static void I_SDLWaitThread(halthread_t *thread)
+{
+   SDL_WaitThread(reinterpret_cast<SDL_Thread *>(thread), NULL);
+}
+
+//
+// I_SDLNewMutex
+//
+static halmutex_t *I_SDLNewMutex()
+{
+   return reinterpret_cast<halmutex_t *>(SDL_CreateMutex());
+}
+
+//
+// I_SDLFreeMutex
+//
+static void I_SDLFreeMutex(halmutex_t *mutex)
+{
+   SDL_DestroyMutex(reinterpret_cast<SDL_mutex *>(mutex));
+}
+
+//
+// I_SDLLockMutex
+//
+static void I_SDLLockMutex(halmutex_t *mutex)
+{
+   SDL_mutexP(reinterpret_cast<SDL_mutex *>(mutex));
+}
+
+//
+// I_SDLUnlockMutex
+//
+static void I_SDLUnlockMutex(halmutex_t *mutex)
+{
+   SDL_mutexV(reinterpret_cast<SDL_mutex *>(mutex));
+}
+
+//
+// I_SDLNewCond
+//
+static halcond_t *I_SDLNewCond()
+{
+   return reinterpret_cast<halcond_t *>(SDL_CreateCond());
+}
+
+//
+// I_SDLFreeCond
+//
+static void I_SDLFreeCond(halcond_t *cond)
+{
+   SDL_DestroyCond(reinterpret_cast<SDL_cond *>(cond));
+}
+
+//
+// I_SDLCondSignal
+//
+static void I_SDLCondSignal(halcond_t *cond)
+{
+   SDL_CondSignal(reinterpret_cast<SDL_cond *>(cond));
+}
+
+//
+// I_SDLCondBroadcast
+//
+static void I_SDLCondBroadcast(halcond_t *cond)
+{
+   SDL_CondBroadcast(reinterpret_cast<SDL_cond *>(cond));
+}
+
+//
+// I_SDLCondWait
+//
+static void I_SDLCondWait(halcond_t *cond, halmutex_t *mutex)
+{
+   SDL_CondWait(reinterpret_cast<SDL_cond *>(cond), 
+                reinterpret_cast<SDL_mutex *>(mutex));
+}
+
+//
+// I_SDLGetNumCPUs
+//
+// SDL 1.2 has no CPU count query, so ask the OS.
+//
+static int I_SDLGetNumCPUs()
+{
+#if EE_CURRENT_PLATFORM == EE_PLATFORM_WINDOWS
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+   return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+   return 1;
+#endif
+}
+
+//=============================================================================
+//
+// Global Interface
+//
+
+//
+// I_SDLInitThreads
+//
+void I_SDLInitThreads()
+{
+   i_halthreads.StartThread   = I_SDLStartThread;
+   i_halthreads.WaitThread    = I_SDLWaitThread;
+   i_halthreads.NewMutex      = I_SDLNewMutex;
+   i_halthreads.FreeMutex     = I_SDLFreeMutex;
+   i_halthreads.LockMutex     = I_SDLLockMutex;
+   i_halthreads.UnlockMutex   = I_SDLUnlockMutex;
+   i_halthreads.NewCond       = I_SDLNewCond;
+   i_halthreads.FreeCond      = I_SDLFreeCond;
+   i_halthreads.CondSignal    = I_SDLCondSignal;
+   i_halthreads.CondBroadcast = I_SDLCondBroadcast;
+   i_halthreads.CondWait      = I_SDLCondWait;
+   i_halthreads.GetNumCPUs    = I_SDLGetNumCPUs;
+}
+
+// EOF
+
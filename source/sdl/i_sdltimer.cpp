@@ -23,6 +23,15 @@
 //
 //-----------------------------------------------------------------------------
 
+#include "../hal/i_platform.h"
+
+#if EE_CURRENT_PLATFORM == EE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 #include "SDL.h"
 
 #include "../z_zone.h"
@@ -40,21 +49,69 @@
 // Most of the following has been rewritten by Lee Killough
 //
 
-static Uint32 basetime = 0;
+static uint64_t basetime = 0;
 
 //
-// I_SDLGetTime_RealTime
+// I_SDLGetMicroseconds
 //
-static int I_SDLGetTime_RealTime()
+// SDL 1.2 has no timer finer than a millisecond, so ask the system for its
+// monotonic clock.
+//
+#if EE_CURRENT_PLATFORM == EE_PLATFORM_WINDOWS
+static uint64_t I_SDLGetMicroseconds()
 {
-   Uint32 t = SDL_GetTicks();
+   static LARGE_INTEGER freq;
+   LARGE_INTEGER count;
+
+   if(!freq.QuadPart)
+      QueryPerformanceFrequency(&freq);
+   QueryPerformanceCounter(&count);
 
+   // split up so that the multiply can't overflow
+   uint64_t c = static_cast<uint64_t>(count.QuadPart);
+   uint64_t f = static_cast<uint64_t>(freq.QuadPart);
+
+   return (c / f) * 1000000 + (c % f) * 1000000 / f;
+}
+#else
+static uint64_t I_SDLGetMicroseconds()
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+#endif
+
+//
+// I_SDLGetElapsed
+//
+// Microseconds from the first call to us, sped up or slowed down by
+// realtic_clock_rate if scaled is set. Both the tic count and the 
+// interpolation timeline below are taken from this, so that tics fall 
+// exactly where the timeline expects them.
+//
+static uint64_t I_SDLGetElapsed(uint64_t us, bool scaled)
+{
    // e6y: removing startup delay
    if(!basetime)
-      basetime = t;
+      basetime = us;
+
+   uint64_t t = us - basetime;
+
+   if(scaled && I_GetTime_Scale != CLOCK_UNIT)
+      t = (t * (uint64_t)I_GetTime_Scale) >> CLOCK_BITS;
 
-   // milliseconds since SDL initialization
-   return (int)(((t - basetime) * TICRATE) / 1000);
+   return t;
+}
+
+//
+// I_SDLGetTime_RealTime
+//
+static int I_SDLGetTime_RealTime()
+{
+   return (int)((I_SDLGetElapsed(I_SDLGetMicroseconds(), false) * TICRATE) / 1000000);
 }
 
 //
@@ -62,7 +119,7 @@ static int I_SDLGetTime_RealTime()
 //
 static int I_SDLGetTime_Scaled()
 {
-   return (int)(((int64_t)I_SDLGetTime_RealTime() * I_GetTime_Scale) >> CLOCK_BITS);
+   return (int)((I_SDLGetElapsed(I_SDLGetMicroseconds(), true) * TICRATE) / 1000000);
 }
 
 //
@@ -99,39 +156,38 @@ static void I_SDLSleep(int ms)
 // Interpolation
 //
 
-static unsigned int start_displaytime;
-static unsigned int displaytime;
+static uint64_t start_displaytime;
+static uint64_t displaytime;
 
-static unsigned int rendertic_start;
-static unsigned int rendertic_step;
-static unsigned int rendertic_next;
-static float        rendertic_msec;
+static int64_t  rendertic_start; // tic the last gametic was run in, in fixed point
 
 //
-// I_SDLSetMSec
+// I_SDLGetFixedTime
 //
-// Module private.
-// Set the value for milliseconds per render frame.
+// Time in fractional gametics on the tic timeline. Its whole part is always
+// the tic GetTime returns for the same moment.
 //
-static void I_SDLSetMSec()
+static int64_t I_SDLGetFixedTime(uint64_t us)
 {
-   rendertic_msec = (float)realtic_clock_rate * TICRATE / 100000.0f;
+   return (int64_t)(I_SDLGetElapsed(us, true) * (TICRATE << FRACBITS) / 1000000);
 }
 
 //
 // I_SDLGetTimeFrac
 //
 // Calculate the fractional multiplier for interpolating the current frame.
+// This is how far the time the frame will be shown at is past the tic the
+// last gametic ran in. A gametic that runs late therefore doesn't restart
+// the interpolation, and motion stays even however frames and tics line up.
 //
 static fixed_t I_SDLGetTimeFrac()
 {
    fixed_t frac = FRACUNIT;
 
-   if(!singletics && rendertic_step != 0)
+   if(!singletics)
    {
-      unsigned int now = SDL_GetTicks();
-      frac = (fixed_t)((now - rendertic_start + displaytime) * FRACUNIT / rendertic_step);
-      frac = eclamp(frac, 0, FRACUNIT);
+      int64_t now = I_SDLGetFixedTime(I_SDLGetMicroseconds() + displaytime);
+      frac = (fixed_t)eclamp<int64_t>(now - rendertic_start, 0, FRACUNIT);
    }
 
    return frac;
@@ -144,7 +200,7 @@ static fixed_t I_SDLGetTimeFrac()
 //
 static void I_SDLStartDisplay()
 {
-   start_displaytime = SDL_GetTicks();
+   start_displaytime = I_SDLGetMicroseconds();
 }
 
 //
@@ -154,7 +210,7 @@ static void I_SDLStartDisplay()
 //
 static void I_SDLEndDisplay()
 {
-   displaytime = SDL_GetTicks() - start_displaytime;
+   displaytime = I_SDLGetMicroseconds() - start_displaytime;
 }
 
 //
@@ -164,9 +220,9 @@ static void I_SDLEndDisplay()
 //
 static void I_SDLSaveMS()
 {
-   rendertic_start = SDL_GetTicks();
-   rendertic_next  = (unsigned int)((rendertic_start * rendertic_msec + 1.0f) / rendertic_msec);
-   rendertic_step  = rendertic_next - rendertic_start;
+   int64_t now = I_SDLGetFixedTime(I_SDLGetMicroseconds());
+
+   rendertic_start = now & ~(int64_t)(FRACUNIT - 1);
 }
 
 //=============================================================================
@@ -193,11 +249,10 @@ void I_SDLInitTimer()
          i_haltimer.GetTime = I_SDLGetTime_RealTime;
    }
 
-   I_SDLSetMSec();
-
    // initialize constant methods
    i_haltimer.GetRealTime  = I_SDLGetTime_RealTime;
    i_haltimer.GetTicks     = I_SDLGetTicks;
+   i_haltimer.GetMicroseconds = I_SDLGetMicroseconds;
    i_haltimer.Sleep        = I_SDLSleep;
    i_haltimer.StartDisplay = I_SDLStartDisplay;
    i_haltimer.EndDisplay   = I_SDLEndDisplay;
@@ -219,8 +274,6 @@ void I_SDLChangeClockRate()
       i_haltimer.GetTime = I_SDLGetTime_Scaled;
    else
       i_haltimer.GetTime = I_SDLGetTime_RealTime;
-
-   I_SDLSetMSec();
 }
 
 // EOF
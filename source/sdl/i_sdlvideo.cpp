@@ -33,6 +33,7 @@
 #include "../d_main.h"
 #include "../i_system.h"
 #include "../m_argv.h"
+#include "../v_blit.h"
 #include "../v_misc.h"
 #include "../v_patchfmt.h"
 #include "../v_video.h"
@@ -77,6 +78,84 @@ extern char *i_videomode;
 // haleyjd 12/03/07: 8-on-32 graphics support
 static bool crossbitdepth;
 
+// the engine draws into a 32-bit primary surface (i_truecolor)
+static bool truecolor;
+
+// The video surface is 0x00RRGGBB, so frames go through the engine's own
+// blitters instead of SDL_BlitSurface, scaled up by softscale on the way.
+static bool fastblit;
+static int  softscale = 1;
+static int  blitx, blity; // where the scaled frame starts on the video surface
+
+// Regions of the frame that changed, when only those are being presented
+#define MAXDIRTYRECTS 32
+
+static vdirtyrect_t dirtyrects[MAXDIRTYRECTS];
+static SDL_Rect     updaterects[MAXDIRTYRECTS];
+
+//
+// I_SDLBlitPrimary
+//
+// Converts and scales part of the primary surface straight into the video
+// surface.
+//
+static void I_SDLBlitPrimary(const vdirtyrect_t &r)
+{
+   const int   psize = truecolor ? 4 : 1;
+   const byte *src   = static_cast<const byte *>(primary_surface->pixels) +
+                       r.y * primary_surface->pitch + r.x * psize;
+   byte       *dest  = static_cast<byte *>(sdlscreen->pixels) + 
+                       (blity + r.y * softscale) * sdlscreen->pitch + 
+                       (blitx + r.x * softscale) * 4;
+
+   if(truecolor)
+   {
+      V_Blit32To32(src, primary_surface->pitch, r.w, r.h, 
+                   dest, sdlscreen->pitch, softscale);
+   }
+   else
+   {
+      V_BlitPal8To32(src, primary_surface->pitch, r.w, r.h, 
+                     dest, sdlscreen->pitch, softscale, Col2RGB32);
+   }
+}
+
+//
+// I_SDLPresent
+//
+// Gets the given regions of the primary surface onto the video surface.
+//
+static void I_SDLPresent(const vdirtyrect_t *rects, int numrects)
+{
+   if(fastblit)
+   {
+      if(SDL_MUSTLOCK(sdlscreen) && SDL_LockSurface(sdlscreen) < 0)
+         return;
+
+      for(int i = 0; i < numrects; i++)
+         I_SDLBlitPrimary(rects[i]);
+
+      if(SDL_MUSTLOCK(sdlscreen))
+         SDL_UnlockSurface(sdlscreen);
+   }
+   else
+   {
+      for(int i = 0; i < numrects; i++)
+      {
+         SDL_Rect src, dest;
+
+         src.x  = static_cast<Sint16>(rects[i].x);
+         src.y  = static_cast<Sint16>(rects[i].y);
+         src.w  = static_cast<Uint16>(rects[i].w);
+         src.h  = static_cast<Uint16>(rects[i].h);
+         dest.x = static_cast<Sint16>(blitx + rects[i].x);
+         dest.y = static_cast<Sint16>(blity + rects[i].y);
+
+         SDL_BlitSurface(primary_surface, &src, sdlscreen, &dest);
+      }
+   }
+}
+
 //
 // SDLVideoDriver::FinishUpdate
 //
@@ -84,6 +163,8 @@ static bool crossbitdepth;
 //
 void SDLVideoDriver::FinishUpdate()
 {
+   static int lastpalserial;
+
    // haleyjd 10/08/05: from Chocolate DOOM:
    UpdateGrab();
 
@@ -93,20 +174,64 @@ void SDLVideoDriver::FinishUpdate()
    if(!(SDL_GetAppState() & SDL_APPACTIVE))
       return;
 
+   // a converted frame has to be redone whole when its colors change
+   bool remapped = (crossbitdepth && !truecolor && 
+                    (setpalette || lastpalserial != v_palette32serial));
+   lastpalserial = v_palette32serial;
+
    if(setpalette)
    {
       if(!crossbitdepth)
          SDL_SetPalette(sdlscreen, SDL_LOGPAL|SDL_PHYSPAL, colors, 0, 256);
 
-      if(primary_surface)
+      if(primary_surface && !truecolor)
          SDL_SetPalette(primary_surface, SDL_LOGPAL|SDL_PHYSPAL, colors, 0, 256);
 
       setpalette = false;
    }
 
+   // A single-buffered software surface can be updated a piece at a time, so
+   // only what changed since the last frame is presented.
+   if(primary_surface && !(sdlscreen->flags & (SDL_HWSURFACE|SDL_DOUBLEBUF)) &&
+      vbscreen.data == primary_surface->pixels)
+   {
+      int numrects = V_CollectDirtyRects(&vbscreen, dirtyrects, MAXDIRTYRECTS);
+
+      if(remapped)
+      {
+         numrects = 1;
+         dirtyrects[0].x = dirtyrects[0].y = 0;
+         dirtyrects[0].w = video.width;
+         dirtyrects[0].h = video.height;
+      }
+
+      if(numrects)
+      {
+         I_SDLPresent(dirtyrects, numrects);
+
+         for(int i = 0; i < numrects; i++)
+         {
+            updaterects[i].x = static_cast<Sint16>(blitx + dirtyrects[i].x * softscale);
+            updaterects[i].y = static_cast<Sint16>(blity + dirtyrects[i].y * softscale);
+            updaterects[i].w = static_cast<Uint16>(dirtyrects[i].w * softscale);
+            updaterects[i].h = static_cast<Uint16>(dirtyrects[i].h * softscale);
+         }
+         SDL_UpdateRects(sdlscreen, numrects, updaterects);
+      }
+      return;
+   }
+
    // haleyjd 11/12/09: blit *after* palette set improves behavior.
    if(primary_surface)
-      SDL_BlitSurface(primary_surface, NULL, sdlscreen, destrect);
+   {
+      if(fastblit)
+      {
+         vdirtyrect_t whole = { 0, 0, video.width, video.height };
+         I_SDLPresent(&whole, 1);
+      }
+      else
+         SDL_BlitSurface(primary_surface, NULL, sdlscreen, destrect);
+   }
 
    // haleyjd 11/12/09: ALWAYS update. Causes problems with some video surface
    // types otherwise.
@@ -122,8 +247,9 @@ void SDLVideoDriver::ReadScreen(byte *scr)
 {
    VBuffer temp;
 
+   // callers always want paletted pixels; a truecolor screen is quantized
    V_InitVBufferFrom(&temp, vbscreen.width, vbscreen.height, 
-                     vbscreen.width, video.bitdepth, scr);
+                     vbscreen.width, 8, scr);
    V_BlitVBuffer(&temp, 0, 0, &vbscreen, 0, 0, vbscreen.width, vbscreen.height);
    V_FreeVBuffer(&temp);
 }
@@ -135,6 +261,8 @@ void SDLVideoDriver::ReadScreen(byte *scr)
 //
 static void I_SDLSetPaletteDirect(byte *palette)
 {
+   V_SetPalette32(palette);
+
    for(int i = 0; i < 256; i++)
    {
       colors[i].r = gammatable[usegamma][(basepal[i].r = *palette++)];
@@ -145,7 +273,7 @@ static void I_SDLSetPaletteDirect(byte *palette)
    if(sdlscreen && !crossbitdepth)
       SDL_SetPalette(sdlscreen, SDL_LOGPAL|SDL_PHYSPAL, colors, 0, 256);
 
-   if(primary_surface)
+   if(primary_surface && !truecolor)
       SDL_SetPalette(primary_surface, SDL_LOGPAL|SDL_PHYSPAL, colors, 0, 256);
 }
 
@@ -207,9 +335,18 @@ void SDLVideoDriver::SetPrimaryBuffer()
 
    if(sdlscreen)
    {
-      primary_surface = 
-         SDL_CreateRGBSurface(SDL_SWSURFACE, video.width + bump, video.height,
-                              8, 0, 0, 0, 0);
+      if(truecolor)
+      {
+         primary_surface = 
+            SDL_CreateRGBSurface(SDL_SWSURFACE, video.width + bump, video.height,
+                                 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+      }
+      else
+      {
+         primary_surface = 
+            SDL_CreateRGBSurface(SDL_SWSURFACE, video.width + bump, video.height,
+                                 8, 0, 0, 0, 0);
+      }
       if(!primary_surface)
          I_Error("SDLVideoDriver::SetPrimaryBuffer: failed to create screen temp buffer\n");
 
@@ -273,8 +410,10 @@ bool SDLVideoDriver::InitGraphicsMode()
    int  v_bd           = 8;
    int  flags          = SDL_SWSURFACE;
 
+   truecolor = i_truecolor;
+
    // haleyjd 12/03/07: cross-bit-depth support
-   if(M_CheckParm("-8in32"))
+   if(M_CheckParm("-8in32") || truecolor)
      v_bd = 32;
    else if(i_softbitdepth > 8)
    {
@@ -353,7 +492,17 @@ bool SDLVideoDriver::InitGraphicsMode()
    // haleyjd 12/03/07: if the video surface is not high-color, we
    // disable cross-bit-depth drawing for efficiency
    if(sdlscreen->format->BitsPerPixel == 8)
-      crossbitdepth = false;
+      crossbitdepth = truecolor = false;
+
+   // Col2RGB32 and truecolor pixels can be written to the surface as they are
+   const SDL_PixelFormat *fmt = sdlscreen->format;
+   fastblit = (fmt->BitsPerPixel == 32 && fmt->Rmask == 0x00ff0000 &&
+               fmt->Gmask == 0x0000ff00 && fmt->Bmask == 0x000000ff);
+
+   // scaling is only done by the engine's blitters, and never below 320x200
+   softscale = fastblit ? i_softscale : 1;
+   while(softscale > 1 && (v_w / softscale < SCREENWIDTH || v_h / softscale < SCREENHEIGHT))
+      --softscale;
 
    SDL_WM_SetCaption(ee_wmCaption, ee_wmCaption);
 
@@ -370,19 +519,22 @@ bool SDLVideoDriver::InitGraphicsMode()
       staticDestRect.w = static_cast<Uint16>(v_w);
       staticDestRect.h = static_cast<Uint16>(hs);
 
-      video.width  = v_w;
-      video.height = hs;
+      video.width  = v_w / softscale;
+      video.height = hs  / softscale;
       destrect     = &staticDestRect;
+      blity        = staticDestRect.y + (hs - video.height * softscale) / 2;
    }
    else
    {
-      video.width  = v_w;
-      video.height = v_h;
+      video.width  = v_w / softscale;
+      video.height = v_h / softscale;
       destrect     = NULL;
+      blity        = (v_h - video.height * softscale) / 2;
    }
+   blitx = (v_w - video.width * softscale) / 2;
 
-   video.bitdepth  = 8;
-   video.pixelsize = 1;
+   video.bitdepth  = truecolor ? 32 : 8;
+   video.pixelsize = truecolor ?  4 : 1;
 
    UnsetPrimaryBuffer();
    SetPrimaryBuffer();
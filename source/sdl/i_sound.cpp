@@ -199,6 +199,18 @@ void I_CacheSound(sfxinfo_t *sound)
       i_sounddriver->CacheSound(sound);
 }
 
+//
+// I_PrecacheSounds
+//
+// Have the driver fully load a set of sounds, such as those needed by a new
+// level, so they don't have to be loaded as they are first played.
+//
+void I_PrecacheSounds(sfxinfo_t *const *sounds, int numsounds)
+{
+   if(snd_init && i_sounddriver->PrecacheSounds)
+      i_sounddriver->PrecacheSounds(sounds, numsounds);
+}
+
 // haleyjd 11/07/08: sound driver objects
 
 #ifdef _SDL_VER
@@ -33,6 +33,7 @@
 
 // HAL modules
 #include "../hal/i_gamepads.h"
+#include "../hal/i_thread.h"
 #include "../hal/i_timer.h"
 
 #include "../z_zone.h"
@@ -83,6 +84,9 @@ void I_Shutdown()
    
    // haleyjd 04/15/02: shutdown joystick
    I_ShutdownGamePads();
+
+   // stop any worker threads
+   I_ShutdownWorkerThreads();
 }
 
 extern bool unicodeinput;
@@ -110,6 +114,9 @@ void I_Init()
    // haleyjd 01/10/14: initialize timer
    I_InitHALTimer();
 
+   // initialize threads; workers are started on demand
+   I_InitHALThreads();
+
    // haleyjd 04/15/02: initialize joystick
    I_InitGamePads();
  
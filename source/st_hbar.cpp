@@ -220,7 +220,7 @@ static void ST_BlockDrawerS(int x, int y, int startcmap, int mapdir)
    w     = subscreen43.x2lookup[cx2] - realx + 1;
    h     = subscreen43.y2lookup[cy2] - realy + 1;
 
-   dest = subscreen43.data + realy * subscreen43.pitch + realx;
+   dest = VBADDRESS(&subscreen43, realx, realy);
 
    mapstep = mapdir * (16 << FRACBITS) / w;
 
@@ -239,12 +239,27 @@ static void ST_BlockDrawerS(int x, int y, int startcmap, int mapdir)
       i = w;
       mapnum = startcmap << FRACBITS;
       
-      while(i--)
+      if(subscreen43.pixelsize == 4)
       {
-         colormap = colormaps[0] + (mapnum >> FRACBITS) * 256;
-         *row = colormap[*row];
-         ++row;
-         mapnum += mapstep;
+         // truecolor: scale by the light level the colormap represents
+         uint32_t *row32 = (uint32_t *)row;
+
+         while(i--)
+         {
+            *row32 = V_ScaleRGB32(*row32, (32 - (mapnum >> FRACBITS)) * 8);
+            ++row32;
+            mapnum += mapstep;
+         }
+      }
+      else
+      {
+         while(i--)
+         {
+            colormap = colormaps[0] + (mapnum >> FRACBITS) * 256;
+            *row = colormap[*row];
+            ++row;
+            mapnum += mapstep;
+         }
       }
 
       dest += subscreen43.pitch;
@@ -0,0 +1,242 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Screen blitters.
+//
+//    The software video driver used to hand its paletted frame to
+//    SDL_BlitSurface, which converts one pixel at a time and can't scale.
+//    These take the frame straight to the locked video surface instead,
+//    widening and replicating each pixel in one pass. Only the first row of
+//    each scaled block is built; the others are copied from it while it is
+//    still in the cache.
+//
+//    SSE2 has no gather, so palette lookups are still made one at a time;
+//    the vector path builds four pixels in a register and spreads them over
+//    the scaled block with shuffles.
+//
+//-----------------------------------------------------------------------------
+
+#include "z_zone.h"
+#include "doomtype.h"
+#include "hal/i_platform.h"
+#include "v_blit.h"
+
+#ifdef EE_FEATURE_SSE2
+#include <emmintrin.h>
+#endif
+
+//
+// Source pixel fetchers
+//
+
+// Palette indices, expanded through a lookup table
+struct pal8fetch_t
+{
+   const uint32_t *lut;
+
+   uint32_t get(const byte *row, int x) const { return lut[row[x]]; }
+
+#ifdef EE_FEATURE_SSE2
+   __m128i get4(const byte *row, int x) const
+   {
+      return _mm_setr_epi32(int(lut[row[x    ]]), int(lut[row[x + 1]]),
+                            int(lut[row[x + 2]]), int(lut[row[x + 3]]));
+   }
+#endif
+};
+
+// Pixels that are already 0x00RRGGBB
+struct rgb32fetch_t
+{
+   uint32_t get(const byte *row, int x) const
+   {
+      return reinterpret_cast<const uint32_t *>(row)[x];
+   }
+
+#ifdef EE_FEATURE_SSE2
+   __m128i get4(const byte *row, int x) const
+   {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x * 4));
+   }
+#endif
+};
+
+//
+// V_copyBlockRows
+//
+// Fills out the remaining rows of a scaled row of blocks from its first row,
+// and returns where the next one starts.
+//
+static byte *V_copyBlockRows(byte *dest, int destpitch, int rowbytes, int scale)
+{
+   byte *first = dest;
+
+   dest += destpitch;
+   for(int i = 1; i < scale; i++, dest += destpitch)
+      memcpy(dest, first, rowbytes);
+
+   return dest;
+}
+
+//
+// V_blitC
+//
+template<typename F>
+static void V_blitC(const F &fetch, const byte *src, int srcpitch, int w, int h,
+                    byte *dest, int destpitch, int scale)
+{
+   const int rowbytes = w * scale * int(sizeof(uint32_t));
+
+   for(int y = 0; y < h; y++, src += srcpitch)
+   {
+      uint32_t *row = reinterpret_cast<uint32_t *>(dest);
+
+      if(scale == 1)
+      {
+         for(int x = 0; x < w; x++)
+            row[x] = fetch.get(src, x);
+      }
+      else
+      {
+         for(int x = 0; x < w; x++)
+         {
+            const uint32_t p = fetch.get(src, x);
+            for(int i = 0; i < scale; i++)
+               *row++ = p;
+         }
+      }
+
+      dest = V_copyBlockRows(dest, destpitch, rowbytes, scale);
+   }
+}
+
+#ifdef EE_FEATURE_SSE2
+
+//
+// V_blitSSE2
+//
+template<typename F>
+static void V_blitSSE2(const F &fetch, const byte *src, int srcpitch, int w, int h,
+                       byte *dest, int destpitch, int scale)
+{
+   const int rowbytes = w * scale * int(sizeof(uint32_t));
+   const int w4       = w & ~3;
+
+   for(int y = 0; y < h; y++, src += srcpitch)
+   {
+      __m128i *out = reinterpret_cast<__m128i *>(dest);
+
+      switch(scale)
+      {
+      case 1:
+         for(int x = 0; x < w4; x += 4)
+            _mm_storeu_si128(out++, fetch.get4(src, x));
+         break;
+      case 2:
+         for(int x = 0; x < w4; x += 4)
+         {
+            const __m128i p = fetch.get4(src, x);
+            _mm_storeu_si128(out++, _mm_unpacklo_epi32(p, p));
+            _mm_storeu_si128(out++, _mm_unpackhi_epi32(p, p));
+         }
+         break;
+      case 3:
+         for(int x = 0; x < w4; x += 4)
+         {
+            const __m128i p = fetch.get4(src, x);
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 2)));
+         }
+         break;
+      case 4:
+         for(int x = 0; x < w4; x += 4)
+         {
+            const __m128i p = fetch.get4(src, x);
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(0, 0, 0, 0)));
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 2, 2, 2)));
+            _mm_storeu_si128(out++, _mm_shuffle_epi32(p, _MM_SHUFFLE(3, 3, 3, 3)));
+         }
+         break;
+      }
+
+      // the last few pixels of the row
+      uint32_t *row = reinterpret_cast<uint32_t *>(out);
+      for(int x = w4; x < w; x++)
+      {
+         const uint32_t p = fetch.get(src, x);
+         for(int i = 0; i < scale; i++)
+            *row++ = p;
+      }
+
+      dest = V_copyBlockRows(dest, destpitch, rowbytes, scale);
+   }
+}
+
+#endif
+
+//
+// V_blit
+//
+// Picks the vector path when the processor has it.
+//
+template<typename F>
+static void V_blit(const F &fetch, const byte *src, int srcpitch, int w, int h,
+                   byte *dest, int destpitch, int scale)
+{
+#ifdef EE_FEATURE_SSE2
+   static const bool usesse2 = I_CPUHasSSE2();
+
+   if(usesse2 && scale >= 1 && scale <= V_MAXBLITSCALE)
+   {
+      V_blitSSE2(fetch, src, srcpitch, w, h, dest, destpitch, scale);
+      return;
+   }
+#endif
+
+   V_blitC(fetch, src, srcpitch, w, h, dest, destpitch, scale);
+}
+
+//
+// V_BlitPal8To32
+//
+void V_BlitPal8To32(const byte *src, int srcpitch, int w, int h,
+                    byte *dest, int destpitch, int scale, const uint32_t *lut)
+{
+   pal8fetch_t fetch = { lut };
+
+   V_blit(fetch, src, srcpitch, w, h, dest, destpitch, scale);
+}
+
+//
+// V_Blit32To32
+//
+void V_Blit32To32(const byte *src, int srcpitch, int w, int h,
+                  byte *dest, int destpitch, int scale)
+{
+   rgb32fetch_t fetch;
+
+   V_blit(fetch, src, srcpitch, w, h, dest, destpitch, scale);
+}
+
+// EOF
+
@@ -0,0 +1,54 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// Copyright (C) 2026 James Haley et al.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//    Screen blitters: expand the finished frame to a 32-bit video surface
+//    and scale it up by a whole factor in the same pass.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef V_BLIT_H__
+#define V_BLIT_H__
+
+// Largest factor the blitters scale by
+#define V_MAXBLITSCALE 4
+
+//
+// V_BlitPal8To32
+//
+// Converts a w by h block of palette indices to 0x00RRGGBB pixels through
+// lut, writing each source pixel as a scale by scale square at dest.
+// Pitches are in bytes.
+//
+void V_BlitPal8To32(const byte *src, int srcpitch, int w, int h,
+                    byte *dest, int destpitch, int scale, const uint32_t *lut);
+
+//
+// V_Blit32To32
+//
+// As above, for a source that's already 0x00RRGGBB.
+//
+void V_Blit32To32(const byte *src, int srcpitch, int w, int h,
+                  byte *dest, int destpitch, int scale);
+
+#endif
+
+// EOF
+
@@ -36,10 +36,16 @@
 // * V_BlockDrawer   -- unscaled
 // * V_BlockDrawerS  -- general scaling
 //
+// All of the drawers here are templated on the pixel format of the buffer
+// (see vpixel8_t and vpixel32_t), and V_SetBlockFuncs picks the instance.
+//
 
+template<typename P>
 static void V_BlockDrawer(int x, int y, VBuffer *buffer, 
                           int width, int height, byte *source)
 {
+   typedef typename P::pixel_t pixel_t;
+
    byte *src, *dest;
    int cx1, cy1, cx2, cy2, cw, ch;
    int dx, dy;
@@ -78,16 +84,20 @@ static void V_BlockDrawer(int x, int y, VBuffer *buffer,
 
    while(ch--)
    {
-      memcpy(dest, src, cw);
+      P::Copy((pixel_t *)dest, src, cw);
       src += width;
       dest += buffer->pitch;
    }
 }
 
+template<typename P>
 static void V_BlockDrawerS(int x, int y, VBuffer *buffer, 
                            int width, int height, byte *source)
 {
-   byte *src, *dest, *row;
+   typedef typename P::pixel_t pixel_t;
+
+   byte *src, *dest;
+   pixel_t *row;
    fixed_t xstep, ystep, xfrac, yfrac;
    int xtex, ytex, w, h, i, realx, realy;
    int cx1, cy1, cx2, cy2, cw, ch;
@@ -144,7 +154,7 @@ static void V_BlockDrawerS(int x, int y, VBuffer *buffer,
 
    while(h--)
    {
-      row = dest;
+      row = (pixel_t *)dest;
       i = w;
       xfrac = 0;
       ytex = (yfrac >> FRACBITS) * width;
@@ -152,7 +162,7 @@ static void V_BlockDrawerS(int x, int y, VBuffer *buffer,
       while(i--)
       {
          xtex = (xfrac >> FRACBITS);
-         *row++ = src[ytex + xtex];
+         *row++ = P::Color(src[ytex + xtex]);
          xfrac += xstep;
       }
 
@@ -168,10 +178,13 @@ static void V_BlockDrawerS(int x, int y, VBuffer *buffer,
 // haleyjd 06/29/08
 //
 
+template<typename P>
 static void V_MaskedBlockDrawer(int x, int y, VBuffer *buffer, 
                                 int width, int height, int srcpitch,
                                 byte *source, byte *cmap)
 {
+   typedef typename P::pixel_t pixel_t;
+
    byte *src, *dest;
    int cx1, cy1, cx2, cy2, cw, ch;
    int dx, dy, i;
@@ -213,18 +226,22 @@ static void V_MaskedBlockDrawer(int x, int y, VBuffer *buffer,
       for(i = 0; i < cw; ++i)
       {
          if(*(src + i))
-            *(dest + i) = cmap[*(src + i)];
+            ((pixel_t *)dest)[i] = P::Color(cmap[*(src + i)]);
       }
       src += srcpitch;
       dest += buffer->pitch;
    }
 }
 
+template<typename P>
 static void V_MaskedBlockDrawerS(int x, int y, VBuffer *buffer, 
                                  int width, int height, int srcpitch,
                                  byte *source, byte *cmap)
 {
-   byte *src, *dest, *row;
+   typedef typename P::pixel_t pixel_t;
+
+   byte *src, *dest;
+   pixel_t *row;
    fixed_t xstep, ystep, xfrac, yfrac;
    int xtex, ytex, w, h, i, realx, realy;
    int cx1, cy1, cx2, cy2, cw, ch;
@@ -281,7 +298,7 @@ static void V_MaskedBlockDrawerS(int x, int y, VBuffer *buffer,
 
    while(h--)
    {
-      row = dest;
+      row = (pixel_t *)dest;
       i = w;
       xfrac = 0;
       ytex = (yfrac >> FRACBITS) * srcpitch;
@@ -290,7 +307,7 @@ static void V_MaskedBlockDrawerS(int x, int y, VBuffer *buffer,
       {
          xtex = (xfrac >> FRACBITS);
          if(src[ytex + xtex])
-            *row = cmap[src[ytex + xtex]];
+            *row = P::Color(cmap[src[ytex + xtex]]);
          ++row;
          xfrac += xstep;
       }
@@ -305,6 +322,27 @@ static void V_MaskedBlockDrawerS(int x, int y, VBuffer *buffer,
 // Color block drawing
 //
 
+//
+// V_colorBlockTL32
+//
+// Blends a solid color into a region of a 32-bit buffer.
+//
+static void V_colorBlockTL32(byte *dest, int pitch, byte color, int w, int h,
+                             unsigned int alpha)
+{
+   uint32_t fg = Col2RGB32[color];
+
+   while(h--)
+   {
+      uint32_t *row = (uint32_t *)dest;
+
+      for(int i = 0; i < w; i++)
+         row[i] = V_BlendRGB32(fg, row[i], alpha);
+
+      dest += pitch;
+   }
+}
+
 void V_ColorBlockScaled(VBuffer *dest, byte color, int x, int y, int w, int h)
 {
    byte *d;
@@ -343,7 +381,10 @@ void V_ColorBlockScaled(VBuffer *dest, byte color, int x, int y, int w, int h)
 
    for(i = 0; i < h; i++)
    {
-      memset(d, color, size);
+      if(dest->pixelsize == 4)
+         vpixel32_t::Fill((uint32_t *)d, color, size);
+      else
+         memset(d, color, size);
       d += dest->pitch;
    }
 }
@@ -399,6 +440,12 @@ void V_ColorBlockTLScaled(VBuffer *dest, byte color, int x, int y, int w, int h,
 
    d = VBADDRESS(dest, x, y);
 
+   if(dest->pixelsize == 4)
+   {
+      V_colorBlockTL32(d, dest->pitch, color, w, h, fglevel >> 8);
+      return;
+   }
+
    for(i = 0; i < h; i++)
    {
       row = d;
@@ -432,7 +479,10 @@ void V_ColorBlock(VBuffer *buffer, byte color, int x, int y, int w, int h)
    
    while(h--)
    {
-      memset(dest, color, w);
+      if(buffer->pixelsize == 4)
+         vpixel32_t::Fill((uint32_t *)dest, color, w);
+      else
+         memset(dest, color, w);
       dest += buffer->pitch;
    }
 }
@@ -470,6 +520,12 @@ void V_ColorBlockTL(VBuffer *buffer, byte color, int x, int y,
    bg2rgb  = Col2RGB8[bglevel >> 10];
 
    dest = VBADDRESS(buffer, x, y);
+
+   if(buffer->pixelsize == 4)
+   {
+      V_colorBlockTL32(dest, buffer->pitch, color, w, h, fglevel >> 8);
+      return;
+   }
    
    while(h--)
    { 
@@ -495,10 +551,14 @@ void V_ColorBlockTL(VBuffer *buffer, byte color, int x, int y,
 //
 // Works for any video mode.
 //
+template<typename P>
 static void V_TileBlock64(VBuffer *buffer, byte *src)
 {
+   typedef typename P::pixel_t pixel_t;
+
    int x, y;
-   byte *row, *dest = buffer->data;
+   pixel_t *row;
+   byte *dest = buffer->data;
    int wmod;
 
    // if width % 64 != 0, we must do some extra copying at the end
@@ -506,13 +566,13 @@ static void V_TileBlock64(VBuffer *buffer, byte *src)
    {
       for(y = 0; y < buffer->height; y++)
       {
-         row = dest;
+         row = (pixel_t *)dest;
          for(x = 0; x < buffer->width >> 6; x++)
          {
-            memcpy(row, src + ((y & 63) << 6), 64);
+            P::Copy(row, src + ((y & 63) << 6), 64);
             row += 64;
          }
-         memcpy(row, src + ((y & 63) << 6), wmod);
+         P::Copy(row, src + ((y & 63) << 6), wmod);
          dest += buffer->pitch;
       }
    }
@@ -520,10 +580,10 @@ static void V_TileBlock64(VBuffer *buffer, byte *src)
    {
       for(y = 0; y < buffer->height; y++)
       {
-         row = dest;         
+         row = (pixel_t *)dest;
          for(x = 0; x < buffer->width >> 6; x++)
          {
-            memcpy(row, src + ((y & 63) << 6), 64);
+            P::Copy(row, src + ((y & 63) << 6), 64);
             row += 64;
          }
          dest += buffer->pitch;
@@ -534,9 +594,13 @@ static void V_TileBlock64(VBuffer *buffer, byte *src)
 //
 // General scaling
 //
+template<typename P>
 static void V_TileBlock64S(VBuffer *buffer, byte *src)
 {
-   byte *dest, *row;
+   typedef typename P::pixel_t pixel_t;
+
+   byte *dest;
+   pixel_t *row;
    fixed_t xstep, ystep, xfrac, yfrac = 0;
    int xtex, ytex, w, h;
    
@@ -550,14 +614,14 @@ static void V_TileBlock64S(VBuffer *buffer, byte *src)
    while(h--)
    {
       int i = w;
-      row = dest;
+      row = (pixel_t *)dest;
       xfrac = 0;
       ytex = ((yfrac >> FRACBITS) & 63) << 6;
       
       while(i--)
       {
          xtex = (xfrac >> FRACBITS) & 63;
-         *row++ = src[ytex + xtex];
+         *row++ = P::Color(src[ytex + xtex]);
          xfrac += xstep;
       }
       
@@ -573,9 +637,13 @@ static void V_TileBlock64S(VBuffer *buffer, byte *src)
 // Fill a VBuffer with a texture.
 //
 
-void V_FillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
+template<typename P>
+static void V_fillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
 {
-   byte    *dest = buffer->data, *row;
+   typedef typename P::pixel_t pixel_t;
+
+   byte    *dest = buffer->data;
+   pixel_t *row;
    int      w = buffer->width;
    int      h = buffer->height;
    fixed_t  xstep = (texw << FRACBITS) / w;
@@ -586,14 +654,14 @@ void V_FillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
    while(h--)
    {
       int x = w;
-      row   = dest;
+      row   = (pixel_t *)dest;
       xfrac = 0;
       ytex  = eclamp(yfrac >> FRACBITS, 0, texh - 1);
 
       while(x--)
       {
          xtex = eclamp(xfrac >> FRACBITS, 0, texw - 1);
-         *row++ = src[ytex * texw + xtex];
+         *row++ = P::Color(src[ytex * texw + xtex]);
          xfrac += xstep;
       }
 
@@ -602,6 +670,14 @@ void V_FillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
    }
 }
 
+void V_FillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
+{
+   if(buffer->pixelsize == 4)
+      V_fillBuffer<vpixel32_t>(buffer, src, texw, texh);
+   else
+      V_fillBuffer<vpixel8_t>(buffer, src, texw, texh);
+}
+
 //=============================================================================
 //
 // Function pointer assignment
@@ -613,24 +689,33 @@ void V_FillBuffer(VBuffer *buffer, byte *src, int texw, int texh)
 // Sets the block drawing function pointers in a VBuffer object
 // based on the size of the buffer. Called from V_SetupBufferFuncs.
 //
-void V_SetBlockFuncs(VBuffer *buffer, int drawtype)
+template<typename P>
+static void V_setBlockFuncs(VBuffer *buffer, int drawtype)
 {
    switch(drawtype)
    {
    case DRAWTYPE_UNSCALED:
-      buffer->BlockDrawer       = V_BlockDrawer;
-      buffer->MaskedBlockDrawer = V_MaskedBlockDrawer;
-      buffer->TileBlock64       = V_TileBlock64;
+      buffer->BlockDrawer       = V_BlockDrawer<P>;
+      buffer->MaskedBlockDrawer = V_MaskedBlockDrawer<P>;
+      buffer->TileBlock64       = V_TileBlock64<P>;
       break;
    case DRAWTYPE_GENSCALED:
-      buffer->BlockDrawer       = V_BlockDrawerS;
-      buffer->MaskedBlockDrawer = V_MaskedBlockDrawerS;
-      buffer->TileBlock64       = V_TileBlock64S;
+      buffer->BlockDrawer       = V_BlockDrawerS<P>;
+      buffer->MaskedBlockDrawer = V_MaskedBlockDrawerS<P>;
+      buffer->TileBlock64       = V_TileBlock64S<P>;
       break;
    default:
       break;
    }
 }
 
+void V_SetBlockFuncs(VBuffer *buffer, int drawtype)
+{
+   if(buffer->pixelsize == 4)
+      V_setBlockFuncs<vpixel32_t>(buffer, drawtype);
+   else
+      V_setBlockFuncs<vpixel8_t>(buffer, drawtype);
+}
+
 // EOF
 
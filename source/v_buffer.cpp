@@ -30,9 +30,11 @@
 #include "z_zone.h"
 #include "i_system.h"
 
+#include "m_compare.h"
 #include "v_buffer.h"
 #include "v_misc.h"
 #include "v_patch.h"
+#include "v_video.h"
 #include "r_state.h"
 
 //
@@ -74,7 +76,7 @@ void V_InitVBuffer(VBuffer *vb, int width, int height, int bitdepth)
               width, height);
    }
 
-   if(bitdepth != 8)
+   if(bitdepth != 8 && bitdepth != 32)
       I_Error("V_InitVBuffer: Invalid bitdepth %d\n", bitdepth);
 
    psize = bitdepth / 8;
@@ -108,7 +110,7 @@ VBuffer *V_CreateVBuffer(int width, int height, int bitdepth)
               width, height);
    }
 
-   if(bitdepth != 8)
+   if(bitdepth != 8 && bitdepth != 32)
       I_Error("V_CreateVBuffer: Invalid bitdepth %d\n", bitdepth);
 
    ret = estructalloc(VBuffer, 1);
@@ -136,7 +138,7 @@ void V_InitVBufferFrom(VBuffer *vb, int width, int height, int pitch,
               width, height);
    }
 
-   if(bitdepth != 8)
+   if(bitdepth != 8 && bitdepth != 32)
       I_Error("V_CreateVBufferFrom: Invalid bitdepth %d\n", bitdepth);
 
    psize = bitdepth / 8;
@@ -173,7 +175,7 @@ VBuffer *V_CreateVBufferFrom(int width, int height, int pitch,
               width, height);
    }
 
-   if(bitdepth != 8)
+   if(bitdepth != 8 && bitdepth != 32)
       I_Error("V_CreateVBufferFrom: Invalid bitdepth %d\n", bitdepth);
 
    ret = estructalloc(VBuffer, 1);
@@ -244,6 +246,207 @@ VBuffer *V_SubVBuffer(VBuffer *parent, int x, int y, int width, int height)
    return ret;
 }
 
+//=============================================================================
+//
+// Dirty Rectangles
+//
+// A copy of the frame that was last presented is kept, and each band of rows
+// is compared against it to find what changed. Bands that are marked are
+// redrawn every frame anyway (the 3D view, mostly), so comparing them would
+// only find them changed; they are reported without looking, and their copy
+// is left stale. The first frame that doesn't mark them again reports them
+// whole and brings the copy up to date.
+//
+
+#define VDIRTYBANDSHIFT 4 // 16 rows to a band
+
+struct vdirty_t
+{
+   byte *shadow;   // the frame as last presented; width * pixelsize to a row
+   int   numbands;
+   byte *marked;   // band was marked since the last collection
+   byte *stale;    // band's rows in the shadow are out of date
+};
+
+//
+// V_freeDirty
+//
+static void V_freeDirty(VBuffer *buffer)
+{
+   vdirty_t *vd = buffer->dirty;
+
+   if(vd)
+   {
+      efree(vd->shadow);
+      efree(vd->marked);
+      efree(vd->stale);
+      efree(vd);
+      buffer->dirty = NULL;
+   }
+}
+
+//
+// V_newDirty
+//
+// Starts tracking with every band stale, so the first frame is reported whole.
+//
+static vdirty_t *V_newDirty(VBuffer *buffer)
+{
+   vdirty_t *vd = estructalloc(vdirty_t, 1);
+
+   vd->numbands = (buffer->height + (1 << VDIRTYBANDSHIFT) - 1) >> VDIRTYBANDSHIFT;
+   vd->shadow   = emalloc(byte *, buffer->width * buffer->height * buffer->pixelsize);
+   vd->marked   = ecalloc(byte *, vd->numbands, 1);
+   vd->stale    = emalloc(byte *, vd->numbands);
+   memset(vd->stale, 1, vd->numbands);
+
+   return vd;
+}
+
+//
+// V_MarkDirty
+//
+// Tracking goes by whole bands of rows, so only the vertical extent matters.
+//
+void V_MarkDirty(VBuffer *buffer, int x, int y, int width, int height)
+{
+   vdirty_t *vd = buffer->dirty;
+
+   if(!vd || width <= 0 || height <= 0)
+      return;
+
+   int y1 = emax(y, 0);
+   int y2 = emin(y + height, buffer->height) - 1;
+
+   if(y1 <= y2)
+   {
+      for(int band = y1 >> VDIRTYBANDSHIFT; band <= y2 >> VDIRTYBANDSHIFT; band++)
+         vd->marked[band] = 1;
+   }
+}
+
+//
+// V_diffRow
+//
+// Finds the first and last bytes that differ between a row and its shadow,
+// and brings the shadow up to date. Returns false if nothing differs.
+//
+static bool V_diffRow(const byte *row, byte *shadow, int len, int &first, int &last)
+{
+   if(!memcmp(row, shadow, len))
+      return false;
+
+   int f = 0, l = len - 1;
+
+   while(row[f] == shadow[f])
+      ++f;
+   while(row[l] == shadow[l])
+      --l;
+
+   memcpy(shadow + f, row + f, l - f + 1);
+
+   first = f;
+   last  = l;
+   return true;
+}
+
+//
+// V_addDirtyRect
+//
+// Adds a changed band, merging it into the previous rectangle when the two
+// meet, or when there's no room left for another.
+//
+static void V_addDirtyRect(vdirtyrect_t *rects, int &numrects, int maxrects, 
+                           int x, int y, int w, int h)
+{
+   if(numrects)
+   {
+      vdirtyrect_t &last = rects[numrects - 1];
+
+      if(numrects == maxrects || 
+         (last.y + last.h == y && x <= last.x + last.w && x + w >= last.x))
+      {
+         int x2 = emax(last.x + last.w, x + w);
+         int y2 = emax(last.y + last.h, y + h);
+
+         last.x = emin(last.x, x);
+         last.y = emin(last.y, y);
+         last.w = x2 - last.x;
+         last.h = y2 - last.y;
+         return;
+      }
+   }
+
+   vdirtyrect_t &r = rects[numrects++];
+   r.x = x;
+   r.y = y;
+   r.w = w;
+   r.h = h;
+}
+
+//
+// V_CollectDirtyRects
+//
+int V_CollectDirtyRects(VBuffer *buffer, vdirtyrect_t *rects, int maxrects)
+{
+   if(maxrects <= 0)
+      return 0;
+
+   if(!buffer->dirty)
+      buffer->dirty = V_newDirty(buffer);
+
+   vdirty_t  *vd       = buffer->dirty;
+   const int  psize    = buffer->pixelsize;
+   const int  rowbytes = buffer->width * psize;
+   int        numrects = 0;
+
+   for(int band = 0; band < vd->numbands; band++)
+   {
+      int y1 = band << VDIRTYBANDSHIFT;
+      int y2 = emin(y1 + (1 << VDIRTYBANDSHIFT), buffer->height);
+      int first = rowbytes, last = -1; // changed bytes across the band's rows
+
+      if(vd->marked[band])
+      {
+         vd->marked[band] = 0;
+         vd->stale[band]  = 1;
+         first = 0;
+         last  = rowbytes - 1;
+      }
+      else if(vd->stale[band])
+      {
+         for(int y = y1; y < y2; y++)
+            memcpy(vd->shadow + y * rowbytes, buffer->data + y * buffer->pitch, rowbytes);
+         vd->stale[band] = 0;
+         first = 0;
+         last  = rowbytes - 1;
+      }
+      else
+      {
+         for(int y = y1; y < y2; y++)
+         {
+            int f, l;
+
+            if(V_diffRow(buffer->data + y * buffer->pitch, vd->shadow + y * rowbytes,
+                         rowbytes, f, l))
+            {
+               first = emin(first, f);
+               last  = emax(last,  l);
+            }
+         }
+      }
+
+      if(last >= first)
+      {
+         int x1 = first / psize;
+         int x2 = last  / psize;
+         V_addDirtyRect(rects, numrects, maxrects, x1, y1, x2 - x1 + 1, y2 - y1);
+      }
+   }
+
+   return numrects;
+}
+
 //
 // V_FreeVBuffer
 //
@@ -254,6 +457,7 @@ VBuffer *V_SubVBuffer(VBuffer *parent, int x, int y, int width, int height)
 void V_FreeVBuffer(VBuffer *buffer)
 {
    V_UnsetScaling(buffer);
+   V_freeDirty(buffer);
 
    if(buffer->owndata)
    {
@@ -425,12 +629,22 @@ void V_BlitVBuffer(VBuffer *dest, int dx, int dy, VBuffer *src,
    if(slice < 0 || i < 0)
       return;
 
-   dbuf = dest->data + (dpitch * dy) + dx;
-   sbuf = src->data + (spitch * sy) + sx;
+   dbuf = dest->data + (dpitch * dy) + dx * dest->pixelsize;
+   sbuf = src->data + (spitch * sy) + sx * src->pixelsize;
 
    while(i--)
    {
-      memcpy(dbuf, sbuf, slice);
+      if(dest->pixelsize == src->pixelsize)
+         memcpy(dbuf, sbuf, slice * src->pixelsize);
+      else if(dest->pixelsize == 4)
+         vpixel32_t::Copy((uint32_t *)dbuf, sbuf, slice);
+      else
+      {
+         // down-convert truecolor to the palette (used by screenshots)
+         const uint32_t *s32 = (const uint32_t *)sbuf;
+         for(int x = 0; x < slice; x++)
+            dbuf[x] = V_QuantizeRGB32(s32[x]);
+      }
       dbuf += dpitch;
       sbuf += spitch;
    }
@@ -35,6 +35,14 @@
 #define VBADDRESS(vb, x, y) \
    ((vb)->data + (vb)->pitch * (y) + (vb)->pixelsize * (x))
 
+// A region of a VBuffer, in pixels
+struct vdirtyrect_t
+{
+   int x, y, w, h;
+};
+
+struct vdirty_t; // dirty rectangle tracking state, private to v_buffer.cpp
+
 struct VBuffer
 {
    int  width;
@@ -63,6 +71,9 @@ struct VBuffer
    // Only change this if you want memory leaks and/or crashes :P
    bool needfree;
 
+   // what has been presented, for V_CollectDirtyRects; NULL until first used
+   vdirty_t *dirty;
+
    fixed_t getRealAspectRatio()    const;
    fixed_t getVirtualAspectRatio() const;
 }; 
@@ -117,6 +128,20 @@ void V_BlitVBuffer(VBuffer *dest, int dx, int dy, VBuffer *src,
                    unsigned int sx, unsigned int sy, unsigned int width, 
                    unsigned int height);
 
+
+// V_MarkDirty
+// Tells dirty rectangle tracking that a region is redrawn every frame, so it
+// is passed on without being compared against what was last presented.
+void V_MarkDirty(VBuffer *buffer, int x, int y, int width, int height);
+
+
+// V_CollectDirtyRects
+// Finds the regions that have changed since the last call, for video drivers
+// that can present part of a frame. Returns how many rectangles were stored;
+// when there are more changes than maxrects, the last rectangle grows to hold
+// them. The first call reports the whole buffer.
+int V_CollectDirtyRects(VBuffer *buffer, vdirtyrect_t *rects, int maxrects);
+
 #endif //V_BUFFER_H__
 
 // EOF
@@ -438,15 +438,19 @@ static void V_InitScreenVBuffer()
                      video.bitdepth, video.screens[0]);
    V_SetScaling(&vbscreen, SCREENWIDTH, SCREENHEIGHT);
 
-   V_InitVBufferFrom(&backscreen1, video.width, video.height, video.width, 
-                     video.bitdepth, video.screens[1]);
+   V_InitVBufferFrom(&backscreen1, video.width, video.height, 
+                     video.width * video.pixelsize, video.bitdepth, 
+                     video.screens[1]);
    V_SetScaling(&backscreen1, SCREENWIDTH, SCREENHEIGHT);
 
    // Only vbscreen and backscreen1 need scaling set.
+   // backscreen2 is always paletted, since screenshots are written from it;
+   // V_BlitVBuffer quantizes a truecolor screen on the way in.
    V_InitVBufferFrom(&backscreen2, video.width, video.height, video.width, 
-                     video.bitdepth, video.screens[2]);
-   V_InitVBufferFrom(&backscreen3, video.width, video.height, video.width, 
-                     video.bitdepth, video.screens[3]);
+                     8, video.screens[2]);
+   V_InitVBufferFrom(&backscreen3, video.width, video.height, 
+                     video.width * video.pixelsize, video.bitdepth, 
+                     video.screens[3]);
 
    // Init subscreen43
    V_initSubScreen43();
@@ -462,7 +466,8 @@ void V_Init()
 {
    static byte *s = NULL;
    
-   int size = video.width * video.height;
+   int size  = video.width * video.height;
+   int tsize = size * video.pixelsize; // backscreens 1 and 3 match the screen
 
    // haleyjd 04/29/13: purge and reallocate all VAllocItem instances
    VAllocItem::FreeAllocs();
@@ -473,7 +478,7 @@ void V_Init()
 
    video.screens[3] =
       (video.screens[2] =
-         (video.screens[1] = s = (ecalloc(byte *, size, 3))) + size) + size;  
+         (video.screens[1] = s = (ecalloc(byte *, tsize * 2 + size, 1))) + tsize) + size;
 
    R_SetupViewScaling();
    
@@ -47,8 +47,11 @@ static int ytop;
 //
 // Draws a plain patch column with no remappings.
 //
+template<typename P>
 static void V_DrawPatchColumn() 
 { 
+   typedef typename P::pixel_t pixel_t;
+
    int      count;
    byte    *dest;    // killough
    fixed_t  frac;    // killough
@@ -81,15 +84,15 @@ static void V_DrawPatchColumn()
             
       while((count -= 2) >= 0)
       {
-         *dest = source[frac >> FRACBITS];
+         *(pixel_t *)dest = P::Color(source[frac >> FRACBITS]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
-         *dest = source[frac >> FRACBITS];
+         *(pixel_t *)dest = P::Color(source[frac >> FRACBITS]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
       }
       if(count & 1)
-         *dest = source[frac >> FRACBITS];
+         *(pixel_t *)dest = P::Color(source[frac >> FRACBITS]);
    }
 } 
 
@@ -98,8 +101,11 @@ static void V_DrawPatchColumn()
 //
 // Draws a plain patch column with color translation.
 //
+template<typename P>
 static void V_DrawPatchColumnTR() 
 { 
+   typedef typename P::pixel_t pixel_t;
+
    int      count;
    byte    *dest;    // killough
    fixed_t  frac;    // killough
@@ -132,15 +138,15 @@ static void V_DrawPatchColumnTR()
             
       while((count -= 2) >= 0)
       {
-         *dest = patchcol.translation[source[frac >> FRACBITS]];
+         *(pixel_t *)dest = P::Color(patchcol.translation[source[frac >> FRACBITS]]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
-         *dest = patchcol.translation[source[frac >> FRACBITS]];
+         *(pixel_t *)dest = P::Color(patchcol.translation[source[frac >> FRACBITS]]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
       }
       if(count & 1)
-         *dest = patchcol.translation[source[frac >> FRACBITS]];
+         *(pixel_t *)dest = P::Color(patchcol.translation[source[frac >> FRACBITS]]);
    }
 } 
 
@@ -149,8 +155,11 @@ static void V_DrawPatchColumnTR()
 //
 // Draws a plain patch column with color translation and light remapping
 //
+template<typename P>
 static void V_DrawPatchColumnTRLit() 
 { 
+   typedef typename P::pixel_t pixel_t;
+
    int      count;
    byte    *dest;    // killough
    fixed_t  frac;    // killough
@@ -183,15 +192,18 @@ static void V_DrawPatchColumnTRLit()
             
       while((count -= 2) >= 0)
       {
-         *dest = patchcol.light[patchcol.translation[source[frac >> FRACBITS]]];
+         *(pixel_t *)dest =
+            P::Color(patchcol.light[patchcol.translation[source[frac >> FRACBITS]]]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
-         *dest = patchcol.light[patchcol.translation[source[frac >> FRACBITS]]];
+         *(pixel_t *)dest =
+            P::Color(patchcol.light[patchcol.translation[source[frac >> FRACBITS]]]);
          dest += patchcol.buffer->pitch;
          frac += fracstep;
       }
       if(count & 1)
-         *dest = patchcol.light[patchcol.translation[source[frac >> FRACBITS]]];
+         *(pixel_t *)dest =
+            P::Color(patchcol.light[patchcol.translation[source[frac >> FRACBITS]]]);
    }
 } 
 
@@ -446,7 +458,74 @@ void V_DrawPatchColumnAddTR()
 
 #undef DO_COLOR_BLEND
 
+//
+// 32-bit translucent patch columns
+//
+// On truecolor buffers the blends are done directly on the pixels, so these
+// share one loop and differ only in the per-pixel operation.
+//
+
+struct vpatchblend_t
+{
+   static uint32_t Blend(byte c, uint32_t bg)
+   {
+      return V_BlendRGB32(Col2RGB32[c], bg, patchcol.alpha);
+   }
+};
+
+struct vpatchadd_t
+{
+   static uint32_t Blend(byte c, uint32_t bg)
+   {
+      return V_AddRGB32(V_ScaleRGB32(Col2RGB32[c], patchcol.alpha), bg);
+   }
+};
+
+//
+// V_drawPatchColumn32
+//
+// Draws a 32-bit translucent patch column, optionally translated.
+//
+template<typename B, bool translated>
+static void V_drawPatchColumn32()
+{
+   int      count;
+   byte    *dest;
+   fixed_t  frac;
+   fixed_t  fracstep;
+
+   if((count = patchcol.y2 - patchcol.y1 + 1) <= 0)
+      return; // Zero length, column does not exceed a pixel.
+
+#ifdef RANGECHECK 
+   if((unsigned int)patchcol.x  >= (unsigned int)patchcol.buffer->width || 
+      (unsigned int)patchcol.y1 >= (unsigned int)patchcol.buffer->height) 
+      I_Error("V_drawPatchColumn32: %i to %i at %i\n", patchcol.y1, patchcol.y2, patchcol.x); 
+#endif 
+
+   dest = VBADDRESS(patchcol.buffer, patchcol.x, patchcol.y1);
+
+   fracstep = patchcol.step; 
+   frac = patchcol.frac + ((patchcol.y1 * fracstep) & 0xFFFF);
+
+   {
+      const byte *source = patchcol.source;
+
+      do
+      {
+         byte c = source[frac >> FRACBITS];
+
+         if(translated)
+            c = patchcol.translation[c];
 
+         *(uint32_t *)dest = B::Blend(c, *(uint32_t *)dest);
+
+         dest += patchcol.buffer->pitch;
+         frac += fracstep;
+      }
+      while(--count);
+   }
+}
 
 static void V_DrawMaskedColumn(column_t *column)
 {
@@ -530,13 +609,25 @@ typedef void (*patchcolfunc_t)(void);
 
 static patchcolfunc_t colfuncfordrawstyle[PSTYLE_NUMSTYLES] =
 {
-   V_DrawPatchColumn,
-   V_DrawPatchColumnTR,
+   V_DrawPatchColumn<vpixel8_t>,
+   V_DrawPatchColumnTR<vpixel8_t>,
    V_DrawPatchColumnTL,
    V_DrawPatchColumnTRTL,
    V_DrawPatchColumnAdd,
    V_DrawPatchColumnAddTR,
-   V_DrawPatchColumnTRLit
+   V_DrawPatchColumnTRLit<vpixel8_t>
+};
+
+// drawers for 32-bit buffers
+static patchcolfunc_t colfuncfordrawstyle32[PSTYLE_NUMSTYLES] =
+{
+   V_DrawPatchColumn<vpixel32_t>,
+   V_DrawPatchColumnTR<vpixel32_t>,
+   V_drawPatchColumn32<vpatchblend_t, false>,
+   V_drawPatchColumn32<vpatchblend_t, true>,
+   V_drawPatchColumn32<vpatchadd_t, false>,
+   V_drawPatchColumn32<vpatchadd_t, true>,
+   V_DrawPatchColumnTRLit<vpixel32_t>
 };
 
 //
@@ -642,7 +733,10 @@ void V_DrawPatchInt(PatchInfo *pi, VBuffer *buffer)
       if(pi->drawstyle < 0 || pi->drawstyle >= PSTYLE_NUMSTYLES)
          I_Error("V_DrawPatchInt: unknown patch drawstyle %d\n", pi->drawstyle);
 #endif
-      patchcol.colfunc = colfuncfordrawstyle[pi->drawstyle];
+      if(buffer->pixelsize == 4)
+         patchcol.colfunc = colfuncfordrawstyle32[pi->drawstyle];
+      else
+         patchcol.colfunc = colfuncfordrawstyle[pi->drawstyle];
 
       ytop = pi->y - patch->topoffset;
       
@@ -671,10 +765,11 @@ void V_SetPatchLight(byte *lighttable)
    patchcol.light = lighttable;
 }
 
-void V_SetPatchTL(unsigned int *fg, unsigned int *bg)
+void V_SetPatchTL(unsigned int *fg, unsigned int *bg, unsigned int alpha)
 {
    patchcol.fg2rgb = fg;
    patchcol.bg2rgb = bg;
+   patchcol.alpha  = alpha;
 }
 
 //
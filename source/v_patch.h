@@ -57,7 +57,7 @@ enum
 
 void V_SetPatchColrng(byte *colrng);
 void V_SetPatchLight(byte *lighttable);
-void V_SetPatchTL(unsigned int *fg, unsigned int *bg);
+void V_SetPatchTL(unsigned int *fg, unsigned int *bg, unsigned int alpha);
 void V_DrawPatchInt(PatchInfo *pi, VBuffer *buffer);
 
 enum
@@ -92,6 +92,7 @@ struct cb_patch_column_t  // It's cardboard now, bitches!
    // haleyjd: translucency lookups
    unsigned int *fg2rgb;
    unsigned int *bg2rgb;
+   unsigned int  alpha;  // 0 to 256, for 32-bit buffers
 }; 
 
 // Conversion routines
@@ -35,6 +35,9 @@
 #include "doomstat.h"
 #include "i_video.h"
 #include "m_bbox.h"
+#include "m_hash.h"
+#include "m_qstr.h"
+#include "m_swap.h"
 #include "r_draw.h"
 #include "r_main.h"
 #include "v_block.h"
@@ -308,6 +311,9 @@ void V_CopyRect(int srcx, int srcy, VBuffer *src, int width,
    {
       I_Error("V_CopyRect: src and dest VBuffers have different scaling\n");
    }
+
+   if(src->pixelsize != dest->pixelsize)
+      I_Error("V_CopyRect: src and dest VBuffers have different bitdepths\n");
 #endif
 
    // quick rejection if source rect is off-screen
@@ -378,7 +384,7 @@ void V_CopyRect(int srcx, int srcy, VBuffer *src, int width,
    {
       while(useh--)
       {
-         memcpy(dstp, srcp, usew);
+         memcpy(dstp, srcp, usew * src->pixelsize);
          srcp += src->pitch;
          dstp += dest->pitch;
       }
@@ -541,7 +547,7 @@ void V_DrawPatchTL(int x, int y, VBuffer *buffer, patch_t *patch,
       unsigned int fglevel, bglevel;
       fglevel = tl & ~0x3ff;
       bglevel = FRACUNIT - fglevel;
-      V_SetPatchTL(Col2RGB8[fglevel >> 10], Col2RGB8[bglevel >> 10]);
+      V_SetPatchTL(Col2RGB8[fglevel >> 10], Col2RGB8[bglevel >> 10], fglevel >> 8);
    }
 
    V_DrawPatchInt(&pi, buffer);
@@ -587,7 +593,7 @@ void V_DrawPatchAdd(int x, int y, VBuffer *buffer, patch_t *patch,
       fglevel = tl & ~0x3ff;    // normal foreground level
       bglevel = FRACUNIT;       // full background level
       V_SetPatchTL(Col2RGB8_LessPrecision[fglevel >> 10], 
-                   Col2RGB8_LessPrecision[bglevel >> 10]);
+                   Col2RGB8_LessPrecision[bglevel >> 10], fglevel >> 8);
    }
 
    V_DrawPatchInt(&pi, buffer);
@@ -807,6 +813,9 @@ unsigned int  Col2RGB8[65][256];
 unsigned int *Col2RGB8_LessPrecision[65];
 byte RGB32k[32][32][32];
 
+byte *flexblendmaps[NUMBLENDLEVELS];
+byte *addblendmaps[NUMBLENDLEVELS];
+
 static unsigned int Col2RGB8_2[63][256];
 
 #define MAKECOLOR(a) (((a)<<3)|((a)>>2))
@@ -816,6 +825,141 @@ typedef struct tpalcol_s
    unsigned int r, g, b;
 } tpalcol_t;
 
+//
+// Blend map disk cache
+//
+// RGB32k and all of the blend maps are derived purely from the palette, and
+// finding the best color for each of the 32K RGB32k entries takes a while,
+// so they are saved to the user directory along with the palette's CRC32
+// and reloaded whenever the same palette is seen again.
+//
+
+#define BLENDCACHE_NAME    "blendmaps.dat"
+#define BLENDCACHE_ID      "EEBLEND1"
+#define BLENDCACHE_IDLEN   8
+#define BLENDCACHE_MAPSIZE (NUMBLENDLEVELS * 2 * 65536)
+
+//
+// V_blendCachePath
+//
+static void V_blendCachePath(qstring &path)
+{
+   path = userpath;
+   path.pathConcatenate(BLENDCACHE_NAME);
+}
+
+//
+// V_loadBlendCache
+//
+// Returns true if RGB32k and the blend maps were read from a cache file made
+// for this palette.
+//
+static bool V_loadBlendCache(const byte *palette, uint32_t crc)
+{
+   qstring  path;
+   FILE    *f;
+   byte     id[BLENDCACHE_IDLEN];
+   uint32_t cachedcrc;
+   byte     cachedpal[768];
+   bool     ok = false;
+
+   V_blendCachePath(path);
+
+   if(!(f = fopen(path.constPtr(), "rb")))
+      return false;
+
+   if(fread(id, sizeof(id), 1, f) == 1 &&
+      !memcmp(id, BLENDCACHE_ID, BLENDCACHE_IDLEN) &&
+      fread(&cachedcrc, sizeof(cachedcrc), 1, f) == 1 &&
+      SwapULong(cachedcrc) == crc &&
+      fread(cachedpal, sizeof(cachedpal), 1, f) == 1 &&
+      !memcmp(cachedpal, palette, sizeof(cachedpal)) &&
+      fread(RGB32k, sizeof(RGB32k), 1, f) == 1 &&
+      fread(flexblendmaps[0], BLENDCACHE_MAPSIZE, 1, f) == 1)
+      ok = true;
+
+   fclose(f);
+
+   return ok;
+}
+
+//
+// V_saveBlendCache
+//
+// Writes RGB32k and the blend maps out for next time. Failure is harmless.
+//
+static void V_saveBlendCache(const byte *palette, uint32_t crc)
+{
+   qstring  path;
+   FILE    *f;
+   uint32_t savedcrc = SwapULong(crc);
+   bool     ok;
+
+   V_blendCachePath(path);
+
+   if(!(f = fopen(path.constPtr(), "wb")))
+      return;
+
+   ok = fwrite(BLENDCACHE_ID, BLENDCACHE_IDLEN, 1, f) == 1 &&
+        fwrite(&savedcrc, sizeof(savedcrc), 1, f) == 1 &&
+        fwrite(palette, 768, 1, f) == 1 &&
+        fwrite(RGB32k, sizeof(RGB32k), 1, f) == 1 &&
+        fwrite(flexblendmaps[0], BLENDCACHE_MAPSIZE, 1, f) == 1;
+
+   fclose(f);
+
+   // don't leave a truncated file behind
+   if(!ok)
+      remove(path.constPtr());
+}
+
+//
+// V_buildBlendMaps
+//
+// Runs the Col2RGB8 arithmetic of the old flex and additive drawers for
+// every pair of colors at every level.
+//
+static void V_buildBlendMaps()
+{
+   for(int level = 0; level < NUMBLENDLEVELS; level++)
+   {
+      const unsigned int *fg2rgb = Col2RGB8[level];
+      const unsigned int *bg2rgb = Col2RGB8[64 - level];
+      byte *map = flexblendmaps[level];
+
+      for(int dest = 0; dest < 256; dest++)
+      {
+         for(int src = 0; src < 256; src++)
+         {
+            unsigned int t = (fg2rgb[src] + bg2rgb[dest]) | 0x1f07c1f;
+            *map++ = RGB32k[0][0][t & (t >> 15)];
+         }
+      }
+
+      fg2rgb = Col2RGB8_LessPrecision[level];
+      bg2rgb = Col2RGB8_LessPrecision[64];
+      map    = addblendmaps[level];
+
+      for(int dest = 0; dest < 256; dest++)
+      {
+         for(int src = 0; src < 256; src++)
+         {
+            // mask out LSBs in green and red to allow overflow
+            unsigned int a = fg2rgb[src] + bg2rgb[dest];
+            unsigned int b = a;
+
+            a |= 0x01f07c1f;
+            b &= 0x40100400;
+            a &= 0x3fffffff;
+            b  = b - (b >> 5);
+            a |= b;
+
+            *map++ = RGB32k[0][0][a & (a >> 15)];
+         }
+      }
+   }
+}
+
 void V_InitFlexTranTable(const byte *palette)
 {
    int i, r, g, b, x, y;
@@ -834,20 +978,6 @@ void V_InitFlexTranTable(const byte *palette)
       tempRGBpal[i].b = palRover[2];
    }
 
-   // build RGB table
-   for(r = 0; r < 32; ++r)
-   {
-      for(g = 0; g < 32; ++g)
-      {
-         for(b = 0; b < 32; ++b)
-         {
-            RGB32k[r][g][b] = 
-               V_FindBestColor(palette, 
-                               MAKECOLOR(r), MAKECOLOR(g), MAKECOLOR(b));
-         }
-      }
-   }
-   
    // build lookup table
    for(x = 0; x < 65; ++x)
    {
@@ -873,6 +1003,73 @@ void V_InitFlexTranTable(const byte *palette)
    Col2RGB8_LessPrecision[64] = Col2RGB8[64];
 
    Z_Free(tempRGBpal);
+
+   // the blend maps are one block: flex levels 0-64, then additive levels 0-64
+   if(!flexblendmaps[0])
+   {
+      byte *maps = emalloc(byte *, BLENDCACHE_MAPSIZE);
+
+      for(x = 0; x < NUMBLENDLEVELS; x++)
+      {
+         flexblendmaps[x] = maps + x * 65536;
+         addblendmaps[x]  = maps + (NUMBLENDLEVELS + x) * 65536;
+      }
+   }
+
+   uint32_t crc = HashData(HashData::CRC32, palette, 768).getDigestPart(0);
+
+   if(V_loadBlendCache(palette, crc))
+      return;
+
+   // build RGB table
+   for(r = 0; r < 32; ++r)
+   {
+      for(g = 0; g < 32; ++g)
+      {
+         for(b = 0; b < 32; ++b)
+         {
+            RGB32k[r][g][b] = 
+               V_FindBestColor(palette, 
+                               MAKECOLOR(r), MAKECOLOR(g), MAKECOLOR(b));
+         }
+      }
+   }
+
+   V_buildBlendMaps();
+   V_saveBlendCache(palette, crc);
+}
+
+//
+// Truecolor palette
+//
+
+uint32_t Col2RGB32[256];
+int      v_palette32serial;
+
+//
+// V_SetPalette32
+//
+// Called alongside the video driver's SetPalette, so 32-bit surfaces see the
+// same palette and gamma changes that paletted ones get through hardware.
+//
+void V_SetPalette32(const byte *palette)
+{
+   static byte lastpal[768];
+
+   if(palette)
+      memcpy(lastpal, palette, sizeof(lastpal));
+
+   const byte *gamma = gammatable[usegamma];
+   const byte *p     = lastpal;
+
+   for(int i = 0; i < 256; i++, p += 3)
+   {
+      Col2RGB32[i] = (uint32_t(gamma[p[0]]) << 16) |
+                     (uint32_t(gamma[p[1]]) <<  8) |
+                      uint32_t(gamma[p[2]]);
+   }
+
+   ++v_palette32serial;
 }
 
 //
@@ -100,6 +100,131 @@ extern unsigned int Col2RGB8[65][256];
 extern unsigned int *Col2RGB8_LessPrecision[65];
 extern byte RGB32k[32][32][32];
 
+// Precomputed flex and additive blends, one 64K map per level, indexed like
+// tranmap by [(dest << 8) + src]. Each entry is exactly what the Col2RGB8
+// arithmetic would produce for that pair of colors.
+#define NUMBLENDLEVELS 65
+
+extern byte *flexblendmaps[NUMBLENDLEVELS];
+extern byte *addblendmaps[NUMBLENDLEVELS];
+
+// V_BlendLevel
+// Converts a fixed-point translucency level into a blend map index.
+inline int V_BlendLevel(fixed_t translevel)
+{
+   return (translevel & ~0x3ff) >> 10;
+}
+
+// ----------------------------------------------------------------------------
+// Truecolor
+//
+// 32-bit VBuffers hold 0x00RRGGBB pixels. Col2RGB32 maps palette indices into
+// that format through the current palette and gamma level, so everything that
+// draws from paletted data only needs one extra lookup at the end.
+
+extern uint32_t Col2RGB32[256];
+extern int      v_palette32serial; // bumped each time Col2RGB32 changes
+
+// V_SetPalette32
+// Rebuilds Col2RGB32 from the given palette. NULL means the gamma level has
+// changed and the last palette should be reapplied.
+void V_SetPalette32(const byte *palette);
+
+// V_BlendRGB32
+// Alpha blend; alpha runs from 0 (all bg) to 256 (all fg).
+inline uint32_t V_BlendRGB32(uint32_t fg, uint32_t bg, unsigned int alpha)
+{
+   unsigned int ialpha = 256 - alpha;
+   uint32_t rb = ((fg & 0xff00ff) * alpha + (bg & 0xff00ff) * ialpha) >> 8;
+   uint32_t g  = ((fg & 0x00ff00) * alpha + (bg & 0x00ff00) * ialpha) >> 8;
+
+   return (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+// V_ScaleRGB32
+// Scales every channel by scale / 256.
+inline uint32_t V_ScaleRGB32(uint32_t c, unsigned int scale)
+{
+   return ((((c & 0xff00ff) * scale) >> 8) & 0xff00ff) |
+          ((((c & 0x00ff00) * scale) >> 8) & 0x00ff00);
+}
+
+// V_AddRGB32
+// Saturating per-channel add.
+inline uint32_t V_AddRGB32(uint32_t fg, uint32_t bg)
+{
+   uint32_t rb = (fg & 0xff00ff) + (bg & 0xff00ff);
+   uint32_t g  = (fg & 0x00ff00) + (bg & 0x00ff00);
+
+   // turn each carry out of a channel into a full channel
+   rb |= (rb & 0x1000100) - ((rb & 0x1000100) >> 8);
+   g  |= (g  & 0x0010000) - ((g  & 0x0010000) >> 8);
+
+   return (rb & 0xff00ff) | (g & 0x00ff00);
+}
+
+// V_SubRGB32
+// Per-channel bg - fg, clamped at zero (main_submap's operation).
+inline uint32_t V_SubRGB32(uint32_t fg, uint32_t bg)
+{
+   uint32_t res = 0;
+
+   for(int shift = 0; shift < 24; shift += 8)
+   {
+      int c = int((bg >> shift) & 0xff) - int((fg >> shift) & 0xff);
+      if(c > 0)
+         res |= uint32_t(c) << shift;
+   }
+
+   return res;
+}
+
+// V_QuantizeRGB32
+// Nearest palette index for a 32-bit pixel, via RGB32k.
+inline byte V_QuantizeRGB32(uint32_t c)
+{
+   return RGB32k[(c >> 19) & 31][(c >> 11) & 31][(c >> 3) & 31];
+}
+
+//
+// Pixel formats for code templated over the VBuffer bitdepth. Color converts
+// a palette index into a pixel; Copy converts a run of them and Fill sets a
+// run to one color.
+//
+struct vpixel8_t
+{
+   typedef byte pixel_t;
+
+   static pixel_t Color(byte c) { return c; }
+   static void Copy(pixel_t *dest, const byte *src, int count)
+   {
+      memcpy(dest, src, count);
+   }
+   static void Fill(pixel_t *dest, byte c, int count)
+   {
+      memset(dest, c, count);
+   }
+};
+
+struct vpixel32_t
+{
+   typedef uint32_t pixel_t;
+
+   static pixel_t Color(byte c) { return Col2RGB32[c]; }
+   static void Copy(pixel_t *dest, const byte *src, int count)
+   {
+      while(count--)
+         *dest++ = Col2RGB32[*src++];
+   }
+   static void Fill(pixel_t *dest, byte c, int count)
+   {
+      pixel_t p = Col2RGB32[c];
+
+      while(count--)
+         *dest++ = p;
+   }
+};
+
 
 // ----------------------------------------------------------------------------
 // Initalization
@@ -114,7 +239,8 @@ void V_Init (void);
 
 // V_InitFlexTranTable
 // Initializes the tables used in Flex translucency calculations, given the
-// data in the given palette.
+// data in the given palette. RGB32k and the blend maps are cached on disk
+// by palette checksum, since building them is slow.
 void V_InitFlexTranTable(const byte *palette);
 
 // ----------------------------------------------------------------------------
@@ -1595,8 +1595,18 @@ bool WadDirectory::writeLump(const char *lumpname, const char *destpath)
 //
 uint32_t W_LumpCheckSum(int lumpnum)
 {
-   uint8_t  *lump    = (uint8_t *)(wGlobalDir.cacheLumpNum(lumpnum, PU_CACHE));
-   uint32_t  lumplen = (uint32_t )(wGlobalDir.lumpLength(lumpnum));
+   return W_LumpCheckSum(wGlobalDir, lumpnum);
+}
+
+//
+// W_LumpCheckSum
+//
+// As above, for a lump in any directory, such as a private level wad.
+//
+uint32_t W_LumpCheckSum(WadDirectory &dir, int lumpnum)
+{
+   uint8_t  *lump    = (uint8_t *)(dir.cacheLumpNum(lumpnum, PU_CACHE));
+   uint32_t  lumplen = (uint32_t )(dir.lumpLength(lumpnum));
 
    return HashData(HashData::CRC32, lump, lumplen).getDigestPart(0);
 }
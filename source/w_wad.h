@@ -349,6 +349,7 @@ int         W_GetNumForName(const char* name);
 
 int         W_LumpLength(int lump);
 uint32_t    W_LumpCheckSum(int lumpnum);
+uint32_t    W_LumpCheckSum(WadDirectory &dir, int lumpnum);
 int         W_ReadLumpHeader(int lump, void *dest, size_t size);
 
 #endif
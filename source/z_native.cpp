@@ -29,6 +29,11 @@
 // When running with this heap, there is no limitation to the amount of memory
 // allocated except what the system will provide.
 //
+// Small PU_LEVEL blocks without an owner are carved out of large chunks by
+// the level arena instead of being malloc'd one at a time. Freed ones are
+// kept on free lists by size for reuse, and everything left in the arena at
+// level exit goes at once, chunk by chunk.
+//
 // Limitations:
 // * Purgables are never currently dumped unless the machine runs out of RAM.
 // * Instrumentation cannot track the amount of free memory.
@@ -80,6 +85,13 @@
 // signature for block header
 #define ZONEID  0x931d4a11
 
+// level arena: size of each chunk, and the largest block it will hold
+#define ZARENA_CHUNKSIZE (256*1024)
+#define ZARENA_MAXSIZE   1024
+
+// arena blocks are rounded up to a multiple of this, one free list apiece
+#define ZARENA_GRANULE   16
+
 // End Tunables
 
 //=============================================================================
@@ -87,6 +99,8 @@
 // Memblock Structure
 // 
 
+struct zarenachunk_t;
+
 typedef struct memblock
 {
 #ifdef ZONEIDCHECK
@@ -96,6 +110,7 @@ typedef struct memblock
   struct memblock *next,**prev;
   size_t size;
   void **user;
+  zarenachunk_t *chunk; // arena chunk the block lives in, if any
   unsigned char tag;
 
 #ifdef INSTRUMENTED
@@ -121,6 +136,231 @@ static memblock_t *blockbytag[PU_MAX];   // used for tracking all zone blocks
 ZoneObject *ZoneObject::objectbytag[PU_MAX]; // like blockbytag but for objects
 void       *ZoneObject::newalloc;            // most recent ZoneObject alloc
 
+//=============================================================================
+//
+// Level Arena
+//
+// A block carved from the arena stays out of blockbytag while it is tagged
+// PU_LEVEL, which is what lets a level be freed without visiting each block.
+// One that is re-tagged to anything else is linked into blockbytag like any
+// other, and keeps its chunk alive past the end of the level until it is
+// freed.
+//
+
+#define ZARENA_ROUND(s)   (((s) + ZARENA_GRANULE - 1) & ~(size_t)(ZARENA_GRANULE - 1))
+#define ZARENA_CLASS(s)   (ZARENA_ROUND(s) / ZARENA_GRANULE - 1)
+#define ZARENA_NUMCLASSES (ZARENA_MAXSIZE / ZARENA_GRANULE)
+
+// slab objects start on a cache line
+#define ZPOOL_ALIGN 64
+
+struct zarenachunk_t
+{
+   zarenachunk_t *next;
+   zonepool_t    *pool;   // pool the chunk is a slab for, if any
+   byte  *first;          // first block
+   byte  *top;            // next unused byte
+   byte  *end;
+   size_t stride;         // bytes per block in a slab
+   int    retained;       // blocks living here that are in blockbytag
+   bool   orphan;         // left over from a previous level
+};
+
+static const size_t chunkheader_size = (sizeof(zarenachunk_t) + 15) & ~15;
+
+static zarenachunk_t *arenachunks;                  // all of this level's
+static zarenachunk_t *arenacur;                     // being carved from
+static memblock_t    *arenafree[ZARENA_NUMCLASSES]; // linked through next
+static size_t         arenainuse;                   // bytes in live blocks
+
+static zonepool_t *zonepools; // pools that have been used
+
+//
+// Z_arenaNext
+//
+// Steps to the next block in a chunk, from chunk->first up to chunk->top.
+//
+static memblock_t *Z_arenaNext(const zarenachunk_t *chunk, memblock_t *block)
+{
+   size_t step = chunk->stride ? chunk->stride : 
+                                 header_size + ZARENA_ROUND(block->size);
+
+   return (memblock_t *)((byte *)block + step);
+}
+
+//
+// Z_arenaLive
+//
+// True if the block is a PU_LEVEL block still held by the arena.
+//
+static bool Z_arenaLive(const memblock_t *block)
+{
+   return block->tag == PU_LEVEL && !block->prev;
+}
+
+//
+// Z_newChunk
+//
+static zarenachunk_t *Z_newChunk(zonepool_t *pool)
+{
+   zarenachunk_t *chunk;
+
+   if(!(chunk = (zarenachunk_t *)(malloc(ZARENA_CHUNKSIZE))))
+      return NULL;
+
+   chunk->pool     = pool;
+   chunk->first    = (byte *)chunk + chunkheader_size;
+   chunk->end      = (byte *)chunk + ZARENA_CHUNKSIZE;
+   chunk->stride   = 0;
+   chunk->retained = 0;
+   chunk->orphan   = false;
+
+   if(pool)
+   {
+      // line the objects, not the headers, up with the cache
+      uintptr_t obj = (uintptr_t)(chunk->first + header_size);
+
+      obj = (obj + ZPOOL_ALIGN - 1) & ~(uintptr_t)(ZPOOL_ALIGN - 1);
+      chunk->first  = (byte *)obj - header_size;
+      chunk->stride = pool->stride;
+   }
+   chunk->top = chunk->first;
+
+   chunk->next = arenachunks;
+   arenachunks = chunk;
+
+   return chunk;
+}
+
+//
+// Z_arenaAlloc
+//
+// Returns a block from the free list for its size, or carves a new one.
+// The caller fills in the rest of the header.
+//
+static memblock_t *Z_arenaAlloc(size_t size)
+{
+   size_t      cls   = ZARENA_CLASS(size);
+   size_t      need  = header_size + ZARENA_ROUND(size);
+   memblock_t *block = arenafree[cls];
+
+   if(block)
+   {
+      arenafree[cls] = block->next;
+      return block;
+   }
+
+   if(!arenacur || (size_t)(arenacur->end - arenacur->top) < need)
+   {
+      if(!(arenacur = Z_newChunk(NULL)))
+         return NULL;
+   }
+
+   block = (memblock_t *)arenacur->top;
+   block->chunk = arenacur;
+   arenacur->top += need;
+
+   return block;
+}
+
+//
+// Z_poolSlab
+//
+// Adds a new slab to a pool, with all of its blocks on the free list.
+//
+static bool Z_poolSlab(zonepool_t *pool)
+{
+   zarenachunk_t *chunk;
+
+   if(!(chunk = Z_newChunk(pool)))
+      return false;
+
+   while((size_t)(chunk->end - chunk->top) >= pool->stride)
+   {
+      memblock_t *block = (memblock_t *)chunk->top;
+
+      block->chunk = chunk;
+      block->prev  = NULL;
+      block->tag   = PU_FREE;
+      block->size  = pool->objsize;
+      block->next  = (memblock_t *)pool->freelist;
+      pool->freelist = block;
+
+      chunk->top += pool->stride;
+   }
+
+   ++pool->numslabs;
+   return true;
+}
+
+//
+// Z_arenaFree
+//
+// Takes back a block freed by Z_Free, which has already unlinked it.
+//
+static void Z_arenaFree(memblock_t *block)
+{
+   zarenachunk_t *chunk = block->chunk;
+
+   if(chunk->orphan)
+   {
+      // the last block keeping an old level's chunk around
+      if(!chunk->retained)
+         free(chunk);
+   }
+   else if(chunk->pool)
+   {
+      block->next = (memblock_t *)chunk->pool->freelist;
+      chunk->pool->freelist = block;
+      --chunk->pool->live;
+   }
+   else
+   {
+      size_t cls = ZARENA_CLASS(block->size);
+
+      block->next = arenafree[cls];
+      arenafree[cls] = block;
+   }
+}
+
+//
+// Z_resetArena
+//
+// Called when PU_LEVEL is freed. Chunks with re-tagged blocks in them are
+// left to be freed along with the last of those blocks.
+//
+static void Z_resetArena()
+{
+   zarenachunk_t *chunk = arenachunks;
+
+   while(chunk)
+   {
+      zarenachunk_t *next = chunk->next;
+
+      if(chunk->retained)
+      {
+         chunk->orphan = true;
+         chunk->next   = NULL;
+      }
+      else
+         free(chunk);
+
+      chunk = next;
+   }
+
+   arenachunks = NULL;
+   arenacur    = NULL;
+   arenainuse  = 0;
+   memset(arenafree, 0, sizeof(arenafree));
+
+   for(zonepool_t *pool = zonepools; pool; pool = pool->nextpool)
+   {
+      pool->freelist = NULL;
+      pool->numslabs = 0;
+      pool->live     = 0;
+   }
+}
+
 //=============================================================================
 //
 // Debug Macros
@@ -321,13 +561,25 @@ void *(Z_Malloc)(size_t size, int tag, void **user, const char *file, int line)
 
    if(!size)
       return user ? *user = NULL : NULL;          // malloc(0) returns NULL
-   
-   if(!(block = (memblock_t *)(malloc(size + header_size))))
+
+   if(tag == PU_LEVEL && !user && size <= ZARENA_MAXSIZE)
+   {
+      if((block = Z_arenaAlloc(size)))
+      {
+         block->next = NULL;
+         block->prev = NULL;
+      }
+   }
+   else if((block = (memblock_t *)(malloc(size + header_size))))
+      block->chunk = NULL;
+
+   if(!block)
    {
       if(blockbytag[PU_CACHE])
       {
          Z_FreeTags(PU_CACHE, PU_CACHE);
-         block = (memblock_t *)(malloc(size + header_size));
+         if((block = (memblock_t *)(malloc(size + header_size))))
+            block->chunk = NULL;
       }
    }
 
@@ -339,10 +591,15 @@ void *(Z_Malloc)(size_t size, int tag, void **user, const char *file, int line)
    
    block->size = size;
    
-   if((block->next = blockbytag[tag]))
-      block->next->prev = &block->next;
-   blockbytag[tag] = block;
-   block->prev = &blockbytag[tag];
+   if(!block->chunk)
+   {
+      if((block->next = blockbytag[tag]))
+         block->next->prev = &block->next;
+      blockbytag[tag] = block;
+      block->prev = &blockbytag[tag];
+   }
+   else
+      arenainuse += size;
            
    INSTRUMENT(memorybytag[tag] += block->size);
    INSTRUMENT(block->file = file);
@@ -402,6 +659,8 @@ void (Z_Free)(void *p, const char *file, int line)
                      );
       }
       INSTRUMENT(memorybytag[block->tag] -= block->size);
+      if(block->chunk && Z_arenaLive(block))
+         arenainuse -= block->size;
       block->tag = PU_FREE;       // Mark block freed
 
       // scramble memory -- weed out any bugs
@@ -410,10 +669,20 @@ void (Z_Free)(void *p, const char *file, int line)
       if(block->user)            // Nullify user if one exists
          *block->user = NULL;
 
-      if((*block->prev = block->next))
-         block->next->prev = block->prev;
-         
-      free(block);
+      if(block->prev)
+      {
+         if((*block->prev = block->next))
+            block->next->prev = block->prev;
+         block->prev = NULL;
+
+         if(block->chunk)
+            --block->chunk->retained;
+      }
+
+      if(block->chunk)
+         Z_arenaFree(block);
+      else
+         free(block);
          
       Z_LogPrintf("* Z_Free(p=%p, file=%s:%d)\n", p, file, line);
    }
@@ -434,6 +703,13 @@ void (Z_FreeTags)(int lowtag, int hightag, const char *file, int line)
 
    if(hightag > PU_CACHE)
       hightag = PU_CACHE;
+
+   // whatever the arena still holds goes all at once
+   if(lowtag <= PU_LEVEL && hightag >= PU_LEVEL)
+   {
+      INSTRUMENT(memorybytag[PU_LEVEL] -= arenainuse);
+      Z_resetArena();
+   }
    
    for(; lowtag <= hightag; ++lowtag)
    {
@@ -483,12 +759,33 @@ void (Z_ChangeTag)(void *ptr, int tag, const char *file, int line)
              "Z_ChangeTag: an owner is required for purgable blocks",
              block, file, line);
 
-   if((*block->prev = block->next))
-      block->next->prev = block->prev;
-   if((block->next = blockbytag[tag]))
-      block->next->prev = &block->next;
-   block->prev = &blockbytag[tag];
-   blockbytag[tag] = block;
+   if(block->prev)
+   {
+      if((*block->prev = block->next))
+         block->next->prev = block->prev;
+   }
+   else
+   {
+      // leaving the arena's keeping
+      ++block->chunk->retained;
+      arenainuse -= block->size;
+   }
+
+   if(block->chunk && tag == PU_LEVEL && !block->chunk->orphan)
+   {
+      // back in the arena's keeping
+      --block->chunk->retained;
+      arenainuse += block->size;
+      block->next = NULL;
+      block->prev = NULL;
+   }
+   else
+   {
+      if((block->next = blockbytag[tag]))
+         block->next->prev = &block->next;
+      block->prev = &blockbytag[tag];
+      blockbytag[tag] = block;
+   }
 
    INSTRUMENT(memorybytag[block->tag] -= block->size);
    INSTRUMENT(memorybytag[tag] += block->size);
@@ -534,6 +831,18 @@ void *(Z_Realloc)(void *ptr, size_t n, int tag, void **user,
    if(block->tag == PU_PERMANENT)
       tag = PU_PERMANENT;
 
+   // arena blocks can't be resized where they are
+   if(block->chunk)
+   {
+      size_t oldsize = block->size;
+
+      p = (Z_Malloc)(n, tag, user, file, line);
+      memcpy(p, ptr, oldsize < n ? oldsize : n);
+      (Z_Free)(ptr, file, line);
+
+      return p;
+   }
+
    // nullify current user, if any
    if(block->user)
       *(block->user) = NULL;
@@ -616,6 +925,62 @@ char *(Z_Strdup)(const char *s, int tag, void **user,
    return strcpy((char *)((Z_Malloc)(strlen(s)+1, tag, user, file, line)), s);
 }
 
+//
+// Z_PoolAlloc
+//
+// Returns a zeroed PU_LEVEL block from a pool. A size other than the one the
+// pool was made for, as for a subclass of the pooled type, gets an ordinary
+// block instead.
+//
+void *(Z_PoolAlloc)(zonepool_t *pool, size_t size, const char *file, int line)
+{
+   memblock_t *block;
+   byte *ret;
+
+   DEBUG_CHECKHEAP();
+
+   if(!pool->stride)
+   {
+      pool->stride = (header_size + pool->objsize + ZPOOL_ALIGN - 1) & 
+                     ~(size_t)(ZPOOL_ALIGN - 1);
+      pool->nextpool = zonepools;
+      zonepools = pool;
+   }
+
+   if(size != pool->objsize || pool->stride > ZARENA_CHUNKSIZE / 4 ||
+      (!pool->freelist && !Z_poolSlab(pool)))
+      return (Z_Calloc)(1, size, PU_LEVEL, NULL, file, line);
+
+   block = (memblock_t *)pool->freelist;
+   pool->freelist = block->next;
+
+   block->size = size;
+   block->next = NULL;
+   block->prev = NULL;
+   arenainuse += size;
+
+   INSTRUMENT(memorybytag[PU_LEVEL] += size);
+   INSTRUMENT(block->file = file);
+   INSTRUMENT(block->line = line);
+
+   IDCHECK(block->id = ZONEID);
+
+   block->tag  = PU_LEVEL;
+   block->user = NULL;
+
+   if(++pool->live > pool->peak)
+      pool->peak = pool->live;
+   ++pool->allocs;
+
+   ret = (byte *)block + header_size;
+   memset(ret, 0, size);
+
+   Z_LogPrintf("* %p = Z_PoolAlloc(pool=%s, size=%lu, source=%s:%d)\n", 
+               ret, pool->name, size, file, line);
+
+   return ret;
+}
+
 //=============================================================================
 //
 // Heap Verification
@@ -639,6 +1004,17 @@ void (Z_CheckHeap)(const char *file, int line)
                    block, file, line);
       }
    }
+
+   for(zarenachunk_t *chunk = arenachunks; chunk; chunk = chunk->next)
+   {
+      for(block = (memblock_t *)chunk->first; (byte *)block < chunk->top; 
+          block = Z_arenaNext(chunk, block))
+      {
+         Z_IDCheck(IDBOOL(Z_arenaLive(block) && block->id != ZONEID),
+                   "Z_CheckHeap: Arena block found without ZONEID", 
+                   block, file, line);
+      }
+   }
 #endif
 
 #ifndef CHECKHEAP
@@ -666,14 +1042,56 @@ int (Z_CheckTag)(void *ptr, const char *file, int line)
    return block->tag;
 }
 
+//
+// Z_forEachBlock
+//
+// Calls func on every block in use: those in blockbytag, and those the
+// level arena is holding.
+//
+template<typename F> static void Z_forEachBlock(F func)
+{
+   for(int tag = PU_FREE+1; tag < PU_MAX; tag++)
+   {
+      for(memblock_t *block = blockbytag[tag]; block; block = block->next)
+         func(block);
+   }
+
+   for(zarenachunk_t *chunk = arenachunks; chunk; chunk = chunk->next)
+   {
+      for(memblock_t *block = (memblock_t *)chunk->first; 
+          (byte *)block < chunk->top; block = Z_arenaNext(chunk, block))
+      {
+         if(Z_arenaLive(block))
+            func(block);
+      }
+   }
+}
+
+static const char *namefortag[PU_MAX] =
+{
+   "PU_FREE", 
+   "PU_STATIC",
+   "PU_PERMANENT",
+   "PU_SOUND",
+   "PU_MUSIC",
+   "PU_RENDERER",
+   "PU_VALLOC",
+   "PU_AUTO",
+   "PU_LEVEL",
+   "PU_CACHE",
+};
+
 //
 // Z_PrintZoneHeap
 //
+// Writes every block to heap.txt, followed by totals for each tag and for
+// the level arena.
+//
 void Z_PrintZoneHeap(void)
 {
-   memblock_t *block;
-   int lowtag;
    FILE *outfile;
+   size_t countbytag[PU_MAX];
+   size_t bytesbytag[PU_MAX];
 
    const char *fmtstr =
 #if defined(ZONEIDCHECK) && defined(INSTRUMENTED)
@@ -691,36 +1109,81 @@ void Z_PrintZoneHeap(void)
    if(!outfile)
       return;
 
-   for(lowtag = PU_FREE; lowtag < PU_MAX; ++lowtag)
-   {
-      for(block = blockbytag[lowtag]; block; block = block->next)
-      {
-         fprintf(outfile, fmtstr, block,
+   memset(countbytag, 0, sizeof(countbytag));
+   memset(bytesbytag, 0, sizeof(bytesbytag));
+
+   Z_forEachBlock([&] (memblock_t *block) {
+      fprintf(outfile, fmtstr, block,
 #if defined(ZONEIDCHECK)
-                 block->id, 
+              block->id, 
 #endif
-                 block->next, block->prev, block->size,
-                 block->user, block->tag
+              block->next, block->prev, block->size,
+              block->user, block->tag
 #if defined(INSTRUMENTED)
 #if defined(ZONEVERBOSE)
-                 , block->file, block->line
+              , block->file, block->line
 #else
-                 , "not printed", 0
+              , "not printed", 0
 #endif
 #endif
-                 );
-         // warnings
+              );
+      // warnings
 #if defined(ZONEIDCHECK)
-         if(block->tag != PU_FREE && block->id != ZONEID)
-            fputs("\tWARNING: block does not have ZONEID\n", outfile);
+      if(block->tag != PU_FREE && block->id != ZONEID)
+         fputs("\tWARNING: block does not have ZONEID\n", outfile);
 #endif
-         if(!block->user && block->tag >= PU_PURGELEVEL)
-            fputs("\tWARNING: purgable block with no user\n", outfile);
-         if(block->tag >= PU_MAX)
-            fputs("\tWARNING: invalid cache level\n", outfile);
-         
-         fflush(outfile);
+      if(!block->user && block->tag >= PU_PURGELEVEL)
+         fputs("\tWARNING: purgable block with no user\n", outfile);
+      if(block->tag >= PU_MAX)
+         fputs("\tWARNING: invalid cache level\n", outfile);
+      else
+      {
+         ++countbytag[block->tag];
+         bytesbytag[block->tag] += block->size;
       }
+      
+      fflush(outfile);
+   });
+
+   fputs("\nTotals by tag:\n", outfile);
+   for(int tag = PU_FREE+1; tag < PU_MAX; tag++)
+   {
+      fprintf(outfile, "%-12s: %8u blocks, %10u bytes\n", namefortag[tag],
+              (unsigned int)countbytag[tag], (unsigned int)bytesbytag[tag]);
+   }
+
+   int    numchunks = 0;
+   size_t carved    = 0;
+   size_t onfree    = 0;
+
+   for(zarenachunk_t *chunk = arenachunks; chunk; chunk = chunk->next)
+   {
+      if(!chunk->pool)
+      {
+         ++numchunks;
+         carved += chunk->top - chunk->first;
+      }
+   }
+   for(int cls = 0; cls < ZARENA_NUMCLASSES; cls++)
+   {
+      for(memblock_t *block = arenafree[cls]; block; block = block->next)
+         onfree += header_size + ZARENA_ROUND(block->size);
+   }
+
+   fprintf(outfile, 
+           "\nLevel arena: %d chunks, %u bytes carved, %u bytes in use, "
+           "%u bytes on free lists\n",
+           numchunks, (unsigned int)carved, (unsigned int)arenainuse,
+           (unsigned int)onfree);
+
+   fputs("\nObject pools:\n", outfile);
+   for(zonepool_t *pool = zonepools; pool; pool = pool->nextpool)
+   {
+      fprintf(outfile, 
+              "%-24s: %5u bytes each, %3u slabs, %6u live, %6u peak, "
+              "%9u allocated\n",
+              pool->name, (unsigned int)pool->objsize, pool->numslabs,
+              pool->live, pool->peak, pool->allocs);
    }
 
    fclose(outfile);
@@ -733,31 +1196,11 @@ void Z_PrintZoneHeap(void)
 //
 void Z_DumpCore()
 {
-   static const char *namefortag[PU_MAX] =
-   {
-      "PU_FREE", 
-      "PU_STATIC",
-      "PU_PERMANENT",
-      "PU_SOUND",
-      "PU_MUSIC",
-      "PU_RENDERER",
-      "PU_VALLOC",
-      "PU_AUTO",
-      "PU_LEVEL",
-      "PU_CACHE",
-   };
-
-   int tag;
-   memblock_t *block;
    uint32_t dirofs = 12;
    uint32_t dirlen;
    uint32_t numentries = 0;
 
-   for(tag = PU_FREE+1; tag < PU_MAX; tag++)
-   {
-      for(block = blockbytag[tag]; block; block = block->next)
-         ++numentries;
-   }
+   Z_forEachBlock([&] (memblock_t *) { ++numentries; });
 
    dirlen = numentries * 64; // crazy PAK format...
 
@@ -769,31 +1212,25 @@ void Z_DumpCore()
    fwrite(&dirlen, sizeof(dirlen), 1, f);
 
    uint32_t offs = 12 + 64 * numentries;
-   for(tag = PU_FREE+1; tag < PU_MAX; tag++)
-   {
-      for(block = blockbytag[tag]; block; block = block->next)
-      {
-         char     name[56];
-         uint32_t filepos = offs;
-         uint32_t filelen = (uint32_t)(block->size);
-
-         memset(name, 0, sizeof(name));
-         sprintf(name, "/%s/%p", 
-                 block->tag < PU_MAX ? namefortag[block->tag] : "UNKNOWN",
-                 block);
-         fwrite(name,     sizeof(name),    1, f);
-         fwrite(&filepos, sizeof(filepos), 1, f);
-         fwrite(&filelen, sizeof(filelen), 1, f);
-
-         offs += filelen;
-      }
-   }
-
-   for(tag = PU_FREE+1; tag < PU_MAX; tag++)
-   {
-      for(block = blockbytag[tag]; block; block = block->next)
-         fwrite(((byte *)block + header_size), block->size, 1, f);
-   }
+   Z_forEachBlock([&] (memblock_t *block) {
+      char     name[56];
+      uint32_t filepos = offs;
+      uint32_t filelen = (uint32_t)(block->size);
+
+      memset(name, 0, sizeof(name));
+      sprintf(name, "/%s/%p", 
+              block->tag < PU_MAX ? namefortag[block->tag] : "UNKNOWN",
+              block);
+      fwrite(name,     sizeof(name),    1, f);
+      fwrite(&filepos, sizeof(filepos), 1, f);
+      fwrite(&filelen, sizeof(filelen), 1, f);
+
+      offs += filelen;
+   });
+
+   Z_forEachBlock([&] (memblock_t *block) {
+      fwrite(((byte *)block + header_size), block->size, 1, f);
+   });
 
    fclose(f);
 }
@@ -1001,6 +1438,16 @@ void *ZoneObject::operator new(size_t size, int tag, void **user)
    return (newalloc = Z_Calloc(1, size, tag, user));
 }
 
+//
+// ZoneObject::operator new
+//
+// Overload for objects kept in a zonepool_t.
+//
+void *ZoneObject::operator new(size_t size, zonepool_t *pool)
+{
+   return (newalloc = Z_PoolAlloc(pool, size));
+}
+
 //
 // ZoneObject Constructor
 //
@@ -1108,6 +1555,16 @@ void ZoneObject::operator delete (void *p, int, void **)
    Z_Free(p);
 }
 
+//
+// ZoneObject::operator delete
+//
+// As above, for the pool overload.
+//
+void ZoneObject::operator delete (void *p, zonepool_t *)
+{
+   Z_Free(p);
+}
+
 //
 // ZoneObject::FreeTags
 //
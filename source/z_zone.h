@@ -94,6 +94,30 @@ enum
 
 #define PU_PURGELEVEL PU_CACHE        /* First purgable tag's level */
 
+//
+// zonepool_t
+//
+// A pool of same-sized PU_LEVEL objects, kept in slabs of their own with
+// each object starting on a cache line. Define one with ZONEPOOL and
+// allocate from it with Z_PoolAlloc; objects are freed with Z_Free as usual.
+//
+struct zonepool_t
+{
+   const char *name;
+   size_t      objsize;
+
+   // maintained by the zone heap
+   zonepool_t  *nextpool;  // next pool that has been used
+   void        *freelist;
+   size_t       stride;    // bytes per object, header included
+   unsigned int numslabs;  // slabs this level
+   unsigned int live;      // objects in use
+   unsigned int peak;      // most objects in use at once
+   unsigned int allocs;    // objects handed out since startup
+};
+
+#define ZONEPOOL(var, type) zonepool_t var = { #type, sizeof(type) }
+
 // killough 3/22/98: add file/line info
 
 void *(Z_Malloc)(size_t size, int tag, void **ptr, const char *, int);
@@ -110,6 +134,7 @@ void *(Z_Realloca)(void *ptr, size_t n, const char *file, int line);
 char *(Z_Strdupa)(const char *s, const char *file, int line);
 void  (Z_CheckHeap)(const char *, int);   
 int   (Z_CheckTag)(void *, const char *, int);
+void *(Z_PoolAlloc)(zonepool_t *pool, size_t size, const char *, int);
 
 void *Z_SysMalloc(size_t size);
 void *Z_SysCalloc(size_t n1, size_t n2);
@@ -128,6 +153,7 @@ void  Z_SysFree(void *p);
 #define Z_Strdupa(a)       (Z_Strdupa)  (a,      __FILE__,__LINE__)
 #define Z_CheckHeap()      (Z_CheckHeap)(        __FILE__,__LINE__)
 #define Z_CheckTag(a)      (Z_CheckTag) (a,      __FILE__,__LINE__)
+#define Z_PoolAlloc(a,b)   (Z_PoolAlloc)(a,b,    __FILE__,__LINE__)
 
 #define emalloc(type, n) \
    static_cast<type>((Z_Malloc)(n, PU_STATIC, 0, __FILE__, __LINE__))
@@ -208,8 +234,10 @@ public:
    virtual ~ZoneObject();
    void *operator new (size_t size);
    void *operator new (size_t size, int tag, void **user = NULL);
+   void *operator new (size_t size, zonepool_t *pool);
    void  operator delete (void *p);
    void  operator delete (void *p, int, void **);
+   void  operator delete (void *p, zonepool_t *);
    void  changeTag(int tag);
 
    // zone memblock reflection